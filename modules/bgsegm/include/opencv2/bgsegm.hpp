@@ -371,6 +371,46 @@ public:
  */
 CV_EXPORTS_W Ptr<SyntheticSequenceGenerator> createSyntheticSequenceGenerator(InputArray background, InputArray object, double amplitude = 2.0, double wavelength = 20.0, double wavespeed = 0.2, double objspeed = 6.0);
 
+/** @brief Container that updates the background models of several independent video streams at once.
+
+ Each stream is served by its own background subtractor, which may be of any type. apply() takes one frame
+ per stream and updates all of them in a single parallel pass over the streams. This keeps all cores busy
+ for many low resolution streams, where the per-frame parallelism of a single subtractor is too fine grained.
+ The models of the streams served by BackgroundSubtractorMOG, BackgroundSubtractorCNT or BackgroundSubtractorGMG
+ are packed into one shared buffer, which is rebuilt, keeping the models state, when a frame size or type changes.
+ The foreground masks of streams with equal frame sizes are stored in one shared buffer as well.
+ */
+class CV_EXPORTS_W BackgroundSubtractorMultiStream : public Algorithm
+{
+public:
+    /** @brief Adds a stream served by the given background subtractor.
+
+    @param subtractor Background subtractor of the new stream. It must not be shared with other streams.
+    @return Index of the new stream.
+     */
+    CV_WRAP virtual int addStream(const Ptr<BackgroundSubtractor>& subtractor) = 0;
+
+    /** @brief Returns the background subtractor of the stream with the given index. */
+    CV_WRAP virtual Ptr<BackgroundSubtractor> getStream(int idx) const = 0;
+
+    /** @brief Returns the number of streams. */
+    CV_WRAP virtual int getNumStreams() const = 0;
+
+    /** @brief Computes the foreground masks of all streams.
+
+    @param frames Next frame of each stream, in stream order. Empty frames leave their stream untouched.
+    @param fgmasks Output foreground mask of each stream. The mask of a stream with an empty frame is empty.
+    When fgmasks is a std::vector<Mat> and the frame sizes agree, the masks are views of the internal shared
+    buffer: they are overwritten by the next call, clone them to keep them.
+    @param learningRate Learning rate passed to BackgroundSubtractor::apply of each stream.
+     */
+    CV_WRAP virtual void apply(InputArrayOfArrays frames, OutputArrayOfArrays fgmasks, double learningRate=-1) = 0;
+};
+
+/** @brief Creates an empty BackgroundSubtractorMultiStream, streams are added with BackgroundSubtractorMultiStream::addStream.
+ */
+CV_EXPORTS_W Ptr<BackgroundSubtractorMultiStream> createBackgroundSubtractorMultiStream();
+
 //! @}
 
 }
@@ -0,0 +1,70 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+enum { BGS_MOG, BGS_GMG, BGS_CNT, BGS_GSOC, BGS_LSBP };
+CV_ENUM(BGSegmMethod, BGS_MOG, BGS_GMG, BGS_CNT, BGS_GSOC, BGS_LSBP)
+CV_ENUM(FrameTypes, CV_8UC1, CV_8UC3)
+typedef tuple<BGSegmMethod, FrameTypes, Size> BGSegmParams;
+
+typedef TestBaseWithParam<BGSegmParams> BGSegmPerfTest;
+
+static Ptr<BackgroundSubtractor> createSubtractor(int method)
+{
+    switch (method)
+    {
+    case BGS_MOG: return createBackgroundSubtractorMOG();
+    case BGS_GMG: return createBackgroundSubtractorGMG();
+    case BGS_CNT: return createBackgroundSubtractorCNT();
+    case BGS_GSOC: return createBackgroundSubtractorGSOC();
+    case BGS_LSBP: return createBackgroundSubtractorLSBP();
+    default: CV_Error(Error::StsBadArg, "Unknown background subtraction method");
+    }
+}
+
+PERF_TEST_P( BGSegmPerfTest, apply, Combine(BGSegmMethod::all(), FrameTypes::all(), Values(sz1080p)) )
+{
+    const int method = get<0>(GetParam());
+    const int frameType = get<1>(GetParam());
+    const Size sz = get<2>(GetParam());
+    const int numFrames = 8;
+
+    RNG rng(0);
+    Mat background(sz, CV_8UC3), object(sz.height / 8, sz.width / 8, CV_8UC3);
+    rng.fill(background, RNG::UNIFORM, 0, 256);
+    rng.fill(object, RNG::UNIFORM, 0, 256);
+
+    // a moving object over a waving background
+    Ptr<SyntheticSequenceGenerator> generator = createSyntheticSequenceGenerator(background, object);
+    std::vector<Mat> frames(numFrames);
+    for (int i = 0; i < numFrames; ++i)
+    {
+        Mat frame, gtMask;
+        generator->getNextFrame(frame, gtMask);
+        if (frameType == CV_8UC1)
+            cvtColor(frame, frames[i], COLOR_BGR2GRAY);
+        else
+            frames[i] = frame;
+    }
+
+    Ptr<BackgroundSubtractor> subtractor = createSubtractor(method);
+    Mat fgmask;
+
+    // let the model settle so the cycle measures steady state updates
+    for (int i = 0; i < numFrames; ++i)
+        subtractor->apply(frames[i], fgmask);
+
+    int i = 0;
+    TEST_CYCLE_N(10)
+    {
+        subtractor->apply(frames[i], fgmask);
+        i = (i + 1) % numFrames;
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
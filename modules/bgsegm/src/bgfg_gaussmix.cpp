@@ -69,7 +69,7 @@ static const double defaultVarThreshold = 2.5*2.5;
 static const double defaultNoiseSigma = 30*0.5;
 static const double defaultInitialWeight = 0.05;
 
-class BackgroundSubtractorMOGImpl CV_FINAL : public BackgroundSubtractorMOG
+class BackgroundSubtractorMOGImpl CV_FINAL : public BackgroundSubtractorMOG, public ModelArenaClient
 {
 public:
     //! the default constructor
@@ -122,6 +122,23 @@ public:
         bgmodel = Scalar::all(0);
     }
 
+    virtual size_t modelWords(Size _frameSize, int _frameType) const CV_OVERRIDE
+    {
+        if( _frameType != CV_8UC1 && _frameType != CV_8UC3 )
+            return 0;
+        return arenaViewWords( 1, _frameSize.area()*nmixtures*(2 + 2*CV_MAT_CN(_frameType)), CV_32F );
+    }
+
+    virtual void attachModel(const Mat& arena, size_t& offset, Size _frameSize, int _frameType) CV_OVERRIDE
+    {
+        Mat view = arenaView( arena, offset, 1, _frameSize.area()*nmixtures*(2 + 2*CV_MAT_CN(_frameType)), CV_32F );
+        if( nframes > 0 && _frameSize == frameSize && _frameType == frameType && bgmodel.size() == view.size() )
+            bgmodel.copyTo(view);
+        else
+            nframes = 0; // the next apply initializes the model in place
+        bgmodel = view;
+    }
+
     virtual void getBackgroundImage(OutputArray) const CV_OVERRIDE
     {
         CV_Error( Error::StsNotImplemented, "" );
@@ -184,127 +201,133 @@ static void process8uC1( const Mat& image, Mat& fgmask, double learningRate,
                          Mat& bgmodel, int nmixtures, double backgroundRatio,
                          double varThreshold, double noiseSigma )
 {
-    int x, y, k, k1, rows = image.rows, cols = image.cols;
+    int rows = image.rows, cols = image.cols;
     float alpha = (float)learningRate, T = (float)backgroundRatio, vT = (float)varThreshold;
     int K = nmixtures;
-    MixData<float>* mptr = (MixData<float>*)bgmodel.data;
+    MixData<float>* mbase = bgmodel.ptr<MixData<float>>();
 
     const float w0 = (float)defaultInitialWeight;
     const float sk0 = (float)(w0/(defaultNoiseSigma*2));
     const float var0 = (float)(defaultNoiseSigma*defaultNoiseSigma*4);
     const float minVar = (float)(noiseSigma*noiseSigma);
 
-    for( y = 0; y < rows; y++ )
+    parallel_for_(Range(0, rows), [&](const Range& range)
     {
-        const uchar* src = image.ptr<uchar>(y);
-        uchar* dst = fgmask.ptr<uchar>(y);
-
-        if( alpha > 0 )
+        int x, k, k1;
+        for( int y = range.start; y < range.end; y++ )
         {
-            for( x = 0; x < cols; x++, mptr += K )
-            {
-                float wsum = 0;
-                float pix = src[x];
-                int kHit = -1, kForeground = -1;
+            // each row owns its own slice of the model
+            MixData<float>* mptr = mbase + (size_t)y*cols*K;
+            const uchar* src = image.ptr<uchar>(y);
+            uchar* dst = fgmask.ptr<uchar>(y);
 
-                for( k = 0; k < K; k++ )
+            if( alpha > 0 )
+            {
+                for( x = 0; x < cols; x++, mptr += K )
                 {
-                    float w = mptr[k].weight;
-                    wsum += w;
-                    if( w < FLT_EPSILON )
-                        break;
-                    float mu = mptr[k].mean;
-                    float var = mptr[k].var;
-                    float diff = pix - mu;
-                    float d2 = diff*diff;
-                    if( d2 < vT*var )
+                    float wsum = 0;
+                    float pix = src[x];
+                    int kHit = -1, kForeground = -1;
+
+                    for( k = 0; k < K; k++ )
                     {
-                        wsum -= w;
-                        float dw = alpha*(1.f - w);
-                        mptr[k].weight = w + dw;
-                        mptr[k].mean = mu + alpha*diff;
-                        var = std::max(var + alpha*(d2 - var), minVar);
-                        mptr[k].var = var;
-                        mptr[k].sortKey = w/std::sqrt(var);
-
-                        for( k1 = k-1; k1 >= 0; k1-- )
+                        float w = mptr[k].weight;
+                        wsum += w;
+                        if( w < FLT_EPSILON )
+                            break;
+                        float mu = mptr[k].mean;
+                        float var = mptr[k].var;
+                        float diff = pix - mu;
+                        float d2 = diff*diff;
+                        if( d2 < vT*var )
                         {
-                            if( mptr[k1].sortKey >= mptr[k1+1].sortKey )
-                                break;
-                            std::swap( mptr[k1], mptr[k1+1] );
+                            wsum -= w;
+                            float dw = alpha*(1.f - w);
+                            mptr[k].weight = w + dw;
+                            mptr[k].mean = mu + alpha*diff;
+                            var = std::max(var + alpha*(d2 - var), minVar);
+                            mptr[k].var = var;
+                            mptr[k].sortKey = w/std::sqrt(var);
+
+                            for( k1 = k-1; k1 >= 0; k1-- )
+                            {
+                                if( mptr[k1].sortKey >= mptr[k1+1].sortKey )
+                                    break;
+                                std::swap( mptr[k1], mptr[k1+1] );
+                            }
+
+                            kHit = k1+1;
+                            break;
                         }
+                    }
 
-                        kHit = k1+1;
-                        break;
+                    if( kHit < 0 ) // no appropriate gaussian mixture found at all, remove the weakest mixture and create a new one
+                    {
+                        kHit = k = std::min(k, K-1);
+                        wsum += w0 - mptr[k].weight;
+                        mptr[k].weight = w0;
+                        mptr[k].mean = pix;
+                        mptr[k].var = var0;
+                        mptr[k].sortKey = sk0;
                     }
-                }
+                    else
+                        for( ; k < K; k++ )
+                            wsum += mptr[k].weight;
 
-                if( kHit < 0 ) // no appropriate gaussian mixture found at all, remove the weakest mixture and create a new one
-                {
-                    kHit = k = std::min(k, K-1);
-                    wsum += w0 - mptr[k].weight;
-                    mptr[k].weight = w0;
-                    mptr[k].mean = pix;
-                    mptr[k].var = var0;
-                    mptr[k].sortKey = sk0;
-                }
-                else
-                    for( ; k < K; k++ )
-                        wsum += mptr[k].weight;
+                    float wscale = 1.f/wsum;
+                    wsum = 0;
+                    for( k = 0; k < K; k++ )
+                    {
+                        wsum += mptr[k].weight *= wscale;
+                        mptr[k].sortKey *= wscale;
+                        if( wsum > T && kForeground < 0 )
+                            kForeground = k+1;
+                    }
 
-                float wscale = 1.f/wsum;
-                wsum = 0;
-                for( k = 0; k < K; k++ )
-                {
-                    wsum += mptr[k].weight *= wscale;
-                    mptr[k].sortKey *= wscale;
-                    if( wsum > T && kForeground < 0 )
-                        kForeground = k+1;
+                    dst[x] = (uchar)(-(kHit >= kForeground));
                 }
-
-                dst[x] = (uchar)(-(kHit >= kForeground));
             }
-        }
-        else
-        {
-            for( x = 0; x < cols; x++, mptr += K )
+            else
             {
-                float pix = src[x];
-                int kHit = -1, kForeground = -1;
-
-                for( k = 0; k < K; k++ )
+                for( x = 0; x < cols; x++, mptr += K )
                 {
-                    if( mptr[k].weight < FLT_EPSILON )
-                        break;
-                    float mu = mptr[k].mean;
-                    float var = mptr[k].var;
-                    float diff = pix - mu;
-                    float d2 = diff*diff;
-                    if( d2 < vT*var )
-                    {
-                        kHit = k;
-                        break;
-                    }
-                }
+                    float pix = src[x];
+                    int kHit = -1, kForeground = -1;
 
-                if( kHit >= 0 )
-                {
-                    float wsum = 0;
                     for( k = 0; k < K; k++ )
                     {
-                        wsum += mptr[k].weight;
-                        if( wsum > T )
+                        if( mptr[k].weight < FLT_EPSILON )
+                            break;
+                        float mu = mptr[k].mean;
+                        float var = mptr[k].var;
+                        float diff = pix - mu;
+                        float d2 = diff*diff;
+                        if( d2 < vT*var )
                         {
-                            kForeground = k+1;
+                            kHit = k;
                             break;
                         }
                     }
-                }
 
-                dst[x] = (uchar)(kHit < 0 || kHit >= kForeground ? 255 : 0);
+                    if( kHit >= 0 )
+                    {
+                        float wsum = 0;
+                        for( k = 0; k < K; k++ )
+                        {
+                            wsum += mptr[k].weight;
+                            if( wsum > T )
+                            {
+                                kForeground = k+1;
+                                break;
+                            }
+                        }
+                    }
+
+                    dst[x] = (uchar)(kHit < 0 || kHit >= kForeground ? 255 : 0);
+                }
             }
         }
-    }
+    });
 }
 
 
@@ -312,7 +335,7 @@ static void process8uC3( const Mat& image, Mat& fgmask, double learningRate,
                          Mat& bgmodel, int nmixtures, double backgroundRatio,
                          double varThreshold, double noiseSigma )
 {
-    int x, y, k, k1, rows = image.rows, cols = image.cols;
+    int rows = image.rows, cols = image.cols;
     float alpha = (float)learningRate, T = (float)backgroundRatio, vT = (float)varThreshold;
     int K = nmixtures;
 
@@ -320,121 +343,127 @@ static void process8uC3( const Mat& image, Mat& fgmask, double learningRate,
     const float sk0 = (float)(w0/(defaultNoiseSigma*2*std::sqrt(3.)));
     const float var0 = (float)(defaultNoiseSigma*defaultNoiseSigma*4);
     const float minVar = (float)(noiseSigma*noiseSigma);
-    MixData<Vec3f>* mptr = (MixData<Vec3f>*)bgmodel.data;
+    MixData<Vec3f>* mbase = bgmodel.ptr<MixData<Vec3f>>();
 
-    for( y = 0; y < rows; y++ )
+    parallel_for_(Range(0, rows), [&](const Range& range)
     {
-        const uchar* src = image.ptr<uchar>(y);
-        uchar* dst = fgmask.ptr<uchar>(y);
-
-        if( alpha > 0 )
+        int x, k, k1;
+        for( int y = range.start; y < range.end; y++ )
         {
-            for( x = 0; x < cols; x++, mptr += K )
-            {
-                float wsum = 0;
-                Vec3f pix(src[x*3], src[x*3+1], src[x*3+2]);
-                int kHit = -1, kForeground = -1;
+            // each row owns its own slice of the model
+            MixData<Vec3f>* mptr = mbase + (size_t)y*cols*K;
+            const uchar* src = image.ptr<uchar>(y);
+            uchar* dst = fgmask.ptr<uchar>(y);
 
-                for( k = 0; k < K; k++ )
+            if( alpha > 0 )
+            {
+                for( x = 0; x < cols; x++, mptr += K )
                 {
-                    float w = mptr[k].weight;
-                    wsum += w;
-                    if( w < FLT_EPSILON )
-                        break;
-                    Vec3f mu = mptr[k].mean;
-                    Vec3f var = mptr[k].var;
-                    Vec3f diff = pix - mu;
-                    float d2 = diff.dot(diff);
-                    if( d2 < vT*(var[0] + var[1] + var[2]) )
+                    float wsum = 0;
+                    Vec3f pix(src[x*3], src[x*3+1], src[x*3+2]);
+                    int kHit = -1, kForeground = -1;
+
+                    for( k = 0; k < K; k++ )
                     {
-                        wsum -= w;
-                        float dw = alpha*(1.f - w);
-                        mptr[k].weight = w + dw;
-                        mptr[k].mean = mu + alpha*diff;
-                        var = Vec3f(std::max(var[0] + alpha*(diff[0]*diff[0] - var[0]), minVar),
-                                    std::max(var[1] + alpha*(diff[1]*diff[1] - var[1]), minVar),
-                                    std::max(var[2] + alpha*(diff[2]*diff[2] - var[2]), minVar));
-                        mptr[k].var = var;
-                        mptr[k].sortKey = w/std::sqrt(var[0] + var[1] + var[2]);
-
-                        for( k1 = k-1; k1 >= 0; k1-- )
+                        float w = mptr[k].weight;
+                        wsum += w;
+                        if( w < FLT_EPSILON )
+                            break;
+                        Vec3f mu = mptr[k].mean;
+                        Vec3f var = mptr[k].var;
+                        Vec3f diff = pix - mu;
+                        float d2 = diff.dot(diff);
+                        if( d2 < vT*(var[0] + var[1] + var[2]) )
                         {
-                            if( mptr[k1].sortKey >= mptr[k1+1].sortKey )
-                                break;
-                            std::swap( mptr[k1], mptr[k1+1] );
+                            wsum -= w;
+                            float dw = alpha*(1.f - w);
+                            mptr[k].weight = w + dw;
+                            mptr[k].mean = mu + alpha*diff;
+                            var = Vec3f(std::max(var[0] + alpha*(diff[0]*diff[0] - var[0]), minVar),
+                                        std::max(var[1] + alpha*(diff[1]*diff[1] - var[1]), minVar),
+                                        std::max(var[2] + alpha*(diff[2]*diff[2] - var[2]), minVar));
+                            mptr[k].var = var;
+                            mptr[k].sortKey = w/std::sqrt(var[0] + var[1] + var[2]);
+
+                            for( k1 = k-1; k1 >= 0; k1-- )
+                            {
+                                if( mptr[k1].sortKey >= mptr[k1+1].sortKey )
+                                    break;
+                                std::swap( mptr[k1], mptr[k1+1] );
+                            }
+
+                            kHit = k1+1;
+                            break;
                         }
+                    }
 
-                        kHit = k1+1;
-                        break;
+                    if( kHit < 0 ) // no appropriate gaussian mixture found at all, remove the weakest mixture and create a new one
+                    {
+                        kHit = k = std::min(k, K-1);
+                        wsum += w0 - mptr[k].weight;
+                        mptr[k].weight = w0;
+                        mptr[k].mean = pix;
+                        mptr[k].var = Vec3f(var0, var0, var0);
+                        mptr[k].sortKey = sk0;
                     }
-                }
+                    else
+                        for( ; k < K; k++ )
+                            wsum += mptr[k].weight;
 
-                if( kHit < 0 ) // no appropriate gaussian mixture found at all, remove the weakest mixture and create a new one
-                {
-                    kHit = k = std::min(k, K-1);
-                    wsum += w0 - mptr[k].weight;
-                    mptr[k].weight = w0;
-                    mptr[k].mean = pix;
-                    mptr[k].var = Vec3f(var0, var0, var0);
-                    mptr[k].sortKey = sk0;
-                }
-                else
-                    for( ; k < K; k++ )
-                        wsum += mptr[k].weight;
+                    float wscale = 1.f/wsum;
+                    wsum = 0;
+                    for( k = 0; k < K; k++ )
+                    {
+                        wsum += mptr[k].weight *= wscale;
+                        mptr[k].sortKey *= wscale;
+                        if( wsum > T && kForeground < 0 )
+                            kForeground = k+1;
+                    }
 
-                float wscale = 1.f/wsum;
-                wsum = 0;
-                for( k = 0; k < K; k++ )
-                {
-                    wsum += mptr[k].weight *= wscale;
-                    mptr[k].sortKey *= wscale;
-                    if( wsum > T && kForeground < 0 )
-                        kForeground = k+1;
+                    dst[x] = (uchar)(-(kHit >= kForeground));
                 }
-
-                dst[x] = (uchar)(-(kHit >= kForeground));
             }
-        }
-        else
-        {
-            for( x = 0; x < cols; x++, mptr += K )
+            else
             {
-                Vec3f pix(src[x*3], src[x*3+1], src[x*3+2]);
-                int kHit = -1, kForeground = -1;
-
-                for( k = 0; k < K; k++ )
+                for( x = 0; x < cols; x++, mptr += K )
                 {
-                    if( mptr[k].weight < FLT_EPSILON )
-                        break;
-                    Vec3f mu = mptr[k].mean;
-                    Vec3f var = mptr[k].var;
-                    Vec3f diff = pix - mu;
-                    float d2 = diff.dot(diff);
-                    if( d2 < vT*(var[0] + var[1] + var[2]) )
-                    {
-                        kHit = k;
-                        break;
-                    }
-                }
+                    Vec3f pix(src[x*3], src[x*3+1], src[x*3+2]);
+                    int kHit = -1, kForeground = -1;
 
-                if( kHit >= 0 )
-                {
-                    float wsum = 0;
                     for( k = 0; k < K; k++ )
                     {
-                        wsum += mptr[k].weight;
-                        if( wsum > T )
+                        if( mptr[k].weight < FLT_EPSILON )
+                            break;
+                        Vec3f mu = mptr[k].mean;
+                        Vec3f var = mptr[k].var;
+                        Vec3f diff = pix - mu;
+                        float d2 = diff.dot(diff);
+                        if( d2 < vT*(var[0] + var[1] + var[2]) )
                         {
-                            kForeground = k+1;
+                            kHit = k;
                             break;
                         }
                     }
-                }
 
-                dst[x] = (uchar)(kHit < 0 || kHit >= kForeground ? 255 : 0);
+                    if( kHit >= 0 )
+                    {
+                        float wsum = 0;
+                        for( k = 0; k < K; k++ )
+                        {
+                            wsum += mptr[k].weight;
+                            if( wsum > T )
+                            {
+                                kForeground = k+1;
+                                break;
+                            }
+                        }
+                    }
+
+                    dst[x] = (uchar)(kHit < 0 || kHit >= kForeground ? 255 : 0);
+                }
             }
         }
-    }
+    });
 }
 
 void BackgroundSubtractorMOGImpl::apply(InputArray _image, OutputArray _fgmask, double learningRate)
@@ -57,7 +57,7 @@ namespace cv
 namespace bgsegm
 {
 
-class BackgroundSubtractorGMGImpl CV_FINAL : public BackgroundSubtractorGMG
+class BackgroundSubtractorGMGImpl CV_FINAL : public BackgroundSubtractorGMG, public ModelArenaClient
 {
 public:
     BackgroundSubtractorGMGImpl()
@@ -98,6 +98,9 @@ public:
      */
     virtual void apply(InputArray image, OutputArray fgmask, double learningRate=-1.0) CV_OVERRIDE;
 
+    virtual size_t modelWords(Size frameSize, int frameType) const CV_OVERRIDE;
+    virtual void attachModel(const Mat& arena, size_t& offset, Size frameSize, int frameType) CV_OVERRIDE;
+
     /**
      * Releases all inner buffers.
      */
@@ -221,6 +224,30 @@ void BackgroundSubtractorGMGImpl::initialize(Size frameSize, double minVal, doub
     nfeatures_.setTo(Scalar::all(0));
 }
 
+size_t BackgroundSubtractorGMGImpl::modelWords(Size frameSize, int) const
+{
+    return arenaViewWords(frameSize.height, frameSize.width, CV_32S)
+         + 2 * arenaViewWords(frameSize.area(), maxFeatures, CV_32S);
+}
+
+void BackgroundSubtractorGMGImpl::attachModel(const Mat& arena, size_t& offset, Size frameSize, int)
+{
+    Mat_<int> nfeatures = arenaView(arena, offset, frameSize.height, frameSize.width, CV_32S);
+    Mat_<int> colors = arenaView(arena, offset, frameSize.area(), maxFeatures, CV_32S);
+    Mat_<float> weights = arenaView(arena, offset, frameSize.area(), maxFeatures, CV_32F);
+    if (frameSize == frameSize_ && colors_.size() == colors.size())
+    {
+        nfeatures_.copyTo(nfeatures);
+        colors_.copyTo(colors);
+        weights_.copyTo(weights);
+    }
+    else
+        frameSize_ = Size(); // the next apply initializes the model in place
+    nfeatures_ = nfeatures;
+    colors_ = colors;
+    weights_ = weights;
+}
+
 static float findFeature(int color, const int* colors, const float* weights, int nfeatures)
 {
     for (int i = 0; i < nfeatures; ++i)
@@ -0,0 +1,195 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+
+namespace cv
+{
+namespace bgsegm
+{
+
+// the views start on 64-byte boundaries, so the models of streams updated by different threads do not share cache lines
+static const int ARENA_ALIGN_WORDS = 16;
+
+size_t arenaViewWords(int rows, int cols, int type)
+{
+    return alignSize((size_t)rows * cols * CV_MAT_CN(type), ARENA_ALIGN_WORDS);
+}
+
+Mat arenaView(const Mat& arena, size_t& offset, int rows, int cols, int type)
+{
+    CV_Assert(arena.type() == CV_32SC1 && arena.rows == 1);
+    CV_Assert(CV_ELEM_SIZE1(type) == 4 && rows > 0 && cols > 0);
+    const size_t words = (size_t)rows * cols * CV_MAT_CN(type);
+    CV_Assert(offset + words <= (size_t)arena.cols);
+
+    Mat view = arena.colRange((int)offset, (int)(offset + words)).reshape(CV_MAT_CN(type), rows);
+    // the element size is the same, only the depth is reinterpreted
+    view.flags = (view.flags & ~CV_MAT_DEPTH_MASK) | CV_MAT_DEPTH(type);
+    offset += arenaViewWords(rows, cols, type);
+    return view;
+}
+
+namespace
+{
+
+class BackgroundSubtractorMultiStreamImpl CV_FINAL : public BackgroundSubtractorMultiStream
+{
+public:
+    int addStream(const Ptr<BackgroundSubtractor>& subtractor) CV_OVERRIDE
+    {
+        CV_Assert(!subtractor.empty());
+        for (size_t i = 0; i < subtractors.size(); ++i)
+            CV_Assert(subtractors[i] != subtractor);
+
+        subtractors.push_back(subtractor);
+        modelSizes.push_back(Size());
+        modelTypes.push_back(-1);
+        return static_cast<int>(subtractors.size()) - 1;
+    }
+
+    Ptr<BackgroundSubtractor> getStream(int idx) const CV_OVERRIDE
+    {
+        CV_Assert(idx >= 0 && idx < getNumStreams());
+        return subtractors[idx];
+    }
+
+    int getNumStreams() const CV_OVERRIDE { return static_cast<int>(subtractors.size()); }
+
+    void apply(InputArrayOfArrays frames, OutputArrayOfArrays fgmasks, double learningRate) CV_OVERRIDE;
+
+private:
+    void packModels(const std::vector<Mat>& frames);
+    void allocateMasks(const std::vector<Mat>& frames);
+
+    std::vector<Ptr<BackgroundSubtractor> > subtractors;
+
+    // models of the streams whose subtractor supports it (MOG, CNT, GMG), packed in one buffer,
+    // and the frame size and type each stream was packed for
+    Mat modelArena;
+    std::vector<Size> modelSizes;
+    std::vector<int> modelTypes;
+
+    // masks of all streams, rows of one shared buffer when the frame sizes agree.
+    // The subtractors write into it in place and the output masks are views of it.
+    Mat maskArena;
+    std::vector<Mat> masks;
+};
+
+void BackgroundSubtractorMultiStreamImpl::packModels(const std::vector<Mat>& frames)
+{
+    bool changed = false;
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        if (frames[i].empty() || (frames[i].size() == modelSizes[i] && frames[i].type() == modelTypes[i]))
+            continue;
+        modelSizes[i] = frames[i].size();
+        modelTypes[i] = frames[i].type();
+        changed = true;
+    }
+    if (!changed)
+        return;
+
+    std::vector<ModelArenaClient*> clients(subtractors.size());
+    size_t total = 0;
+    for (size_t i = 0; i < subtractors.size(); ++i)
+    {
+        ModelArenaClient* client = dynamic_cast<ModelArenaClient*>(subtractors[i].get());
+        const size_t words = client && modelSizes[i].area() > 0 ? client->modelWords(modelSizes[i], modelTypes[i]) : 0;
+        clients[i] = words > 0 ? client : 0;
+        total += words;
+    }
+    if (total == 0)
+        return;
+    CV_Assert(total <= (size_t)INT_MAX);
+
+    // the models move to a new buffer keeping their state, the previous buffer is freed with its last view
+    Mat arena(1, static_cast<int>(total), CV_32SC1);
+    size_t offset = 0;
+    for (size_t i = 0; i < subtractors.size(); ++i)
+    {
+        if (clients[i])
+            clients[i]->attachModel(arena, offset, modelSizes[i], modelTypes[i]);
+    }
+    CV_Assert(offset == total);
+    modelArena = arena;
+}
+
+void BackgroundSubtractorMultiStreamImpl::allocateMasks(const std::vector<Mat>& frames)
+{
+    const int n = static_cast<int>(frames.size());
+    Size sz;
+    bool sameSize = true;
+    for (int i = 0; i < n && sameSize; ++i)
+    {
+        if (frames[i].empty())
+            continue;
+        if (sz.area() == 0)
+            sz = frames[i].size();
+        sameSize = frames[i].size() == sz;
+    }
+
+    masks.resize(n);
+    if (sameSize && sz.area() > 0)
+    {
+        maskArena.create(n * sz.height, sz.width, CV_8UC1);
+        for (int i = 0; i < n; ++i)
+            masks[i] = maskArena.rowRange(i * sz.height, (i + 1) * sz.height);
+    }
+    else
+    {
+        // let every subtractor allocate its own mask
+        for (int i = 0; i < n; ++i)
+        {
+            if (!maskArena.empty() && masks[i].u == maskArena.u)
+                masks[i].release();
+        }
+        maskArena.release();
+    }
+}
+
+void BackgroundSubtractorMultiStreamImpl::apply(InputArrayOfArrays _frames, OutputArrayOfArrays _fgmasks, double learningRate)
+{
+    CV_INSTRUMENT_REGION();
+
+    std::vector<Mat> frames;
+    _frames.getMatVector(frames);
+    CV_Assert(frames.size() == subtractors.size());
+
+    packModels(frames);
+    allocateMasks(frames);
+
+    // one stripe per stream, the nested parallel loops of the subtractors run serially inside
+    const int n = getNumStreams();
+    parallel_for_(Range(0, n), [&](const Range& range)
+    {
+        for (int i = range.start; i < range.end; ++i)
+        {
+            if (frames[i].empty())
+                masks[i].release();
+            else
+                subtractors[i]->apply(frames[i], masks[i], learningRate);
+        }
+    }, n);
+
+    _fgmasks.create(n, 1, CV_8UC1, -1, true);
+    if (_fgmasks.kind() == _InputArray::STD_VECTOR_MAT)
+    {
+        // hand out the headers of the shared buffer, no copy
+        for (int i = 0; i < n; ++i)
+            _fgmasks.getMatRef(i) = masks[i];
+    }
+    else
+        _fgmasks.assign(masks);
+}
+
+}
+
+Ptr<BackgroundSubtractorMultiStream> createBackgroundSubtractorMultiStream()
+{
+    return makePtr<BackgroundSubtractorMultiStreamImpl>();
+}
+
+}
+}
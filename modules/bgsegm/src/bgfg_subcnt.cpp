@@ -50,7 +50,7 @@ namespace cv
 namespace bgsegm
 {
 
-class BackgroundSubtractorCNTImpl CV_FINAL : public BackgroundSubtractorCNT
+class BackgroundSubtractorCNTImpl CV_FINAL : public BackgroundSubtractorCNT, public ModelArenaClient
 {
 public:
 
@@ -75,6 +75,10 @@ public:
     bool getIsParallel() const CV_OVERRIDE;
     void setIsParallel(bool value) CV_OVERRIDE;
 
+    // ModelArenaClient interface
+    size_t modelWords(Size frameSize, int frameType) const CV_OVERRIDE;
+    void attachModel(const Mat& arena, size_t& offset, Size frameSize, int frameType) CV_OVERRIDE;
+
     //! the destructor
     virtual ~BackgroundSubtractorCNTImpl() {}
 
@@ -339,6 +343,21 @@ private:
     CNTFunctor &functor;
 };
 
+size_t BackgroundSubtractorCNTImpl::modelWords(Size frameSize, int frameType) const
+{
+    return CV_MAT_DEPTH(frameType) == CV_8U ? arenaViewWords(frameSize.height, frameSize.width, CV_32SC4) : 0;
+}
+
+void BackgroundSubtractorCNTImpl::attachModel(const Mat& arena, size_t& offset, Size frameSize, int)
+{
+    Mat view = arenaView(arena, offset, frameSize.height, frameSize.width, CV_32SC4);
+    if (!data.empty() && data.size() == frameSize && prevFrame.size() == frameSize)
+        data.copyTo(view);
+    else
+        prevFrame.release(); // the next apply initializes the model in place
+    data = view;
+}
+
 void BackgroundSubtractorCNTImpl::apply(InputArray image, OutputArray _fgmask, double learningRate)
 {
     CV_Assert(image.depth() == CV_8U);
@@ -356,7 +375,8 @@ void BackgroundSubtractorCNTImpl::apply(InputArray image, OutputArray _fgmask, d
 
     if (needToInitialize)
     {   // Usually done only once
-        data = Mat_<Vec4i>::zeros(frame.rows, frame.cols);
+        data.create(frame.rows, frame.cols);
+        data.setTo(Scalar::all(0));
         prevFrame = frame;
 
         // mixChannels requires same types to mix,
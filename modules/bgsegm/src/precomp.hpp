@@ -49,4 +49,34 @@ the use of this software, even if advised of the possibility of such damage.
 #include <algorithm>
 #include <cmath>
 
+namespace cv
+{
+namespace bgsegm
+{
+
+/** Internal interface of the subtractors whose model is made of plain 32-bit Mats.
+ * BackgroundSubtractorMultiStream packs the models of such streams into one shared buffer.
+ */
+class ModelArenaClient
+{
+public:
+    virtual ~ModelArenaClient() {}
+
+    //! number of 32-bit words of the model for frames of the given size and type, 0 if it cannot be packed
+    virtual size_t modelWords(Size frameSize, int frameType) const = 0;
+
+    //! moves the model to the arena, starting at word offset which is advanced past it.
+    //! The current state is kept when it was built for frames of the given size and type.
+    virtual void attachModel(const Mat& arena, size_t& offset, Size frameSize, int frameType) = 0;
+};
+
+//! a rows x cols view of the given 32-bit type on the arena words, it keeps the arena alive
+Mat arenaView(const Mat& arena, size_t& offset, int rows, int cols, int type);
+
+//! number of arena words taken by such a view
+size_t arenaViewWords(int rows, int cols, int type);
+
+}
+}
+
 #endif
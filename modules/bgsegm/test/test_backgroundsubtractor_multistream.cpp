@@ -0,0 +1,165 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+static Ptr<BackgroundSubtractor> createStreamSubtractor(int i)
+{
+    switch (i % 3)
+    {
+    case 0: return createBackgroundSubtractorMOG();
+    case 1: return createBackgroundSubtractorCNT();
+    default: return createBackgroundSubtractorGMG(5);
+    }
+}
+
+static void checkMatchesStandalone(const std::vector<Size>& sizes)
+{
+    const int numStreams = static_cast<int>(sizes.size());
+    RNG rng(42);
+
+    Ptr<BackgroundSubtractorMultiStream> multi = createBackgroundSubtractorMultiStream();
+    std::vector<Ptr<BackgroundSubtractor> > reference(numStreams);
+    std::vector<Ptr<SyntheticSequenceGenerator> > generators(numStreams);
+    for (int i = 0; i < numStreams; ++i)
+    {
+        multi->addStream(createStreamSubtractor(i));
+        reference[i] = createStreamSubtractor(i);
+
+        Mat background(sizes[i], CV_8UC3), object(sizes[i].height / 4, sizes[i].width / 4, CV_8UC3);
+        rng.fill(background, RNG::UNIFORM, 0, 256);
+        rng.fill(object, RNG::UNIFORM, 0, 256);
+        generators[i] = createSyntheticSequenceGenerator(background, object);
+    }
+    ASSERT_EQ(numStreams, multi->getNumStreams());
+
+    for (int t = 0; t < 10; ++t)
+    {
+        std::vector<Mat> frames(numStreams), masks;
+        for (int i = 0; i < numStreams; ++i)
+        {
+            Mat gtMask;
+            generators[i]->getNextFrame(frames[i], gtMask);
+        }
+
+        multi->apply(frames, masks);
+        ASSERT_EQ(frames.size(), masks.size());
+
+        for (int i = 0; i < numStreams; ++i)
+        {
+            Mat expected;
+            reference[i]->apply(frames[i], expected);
+            EXPECT_MAT_NEAR(expected, masks[i], 0) << "stream " << i << " frame " << t;
+        }
+    }
+}
+
+TEST(BackgroundSubtractor_MultiStream, sameSize)
+{
+    checkMatchesStandalone(std::vector<Size>(6, Size(64, 48)));
+}
+
+TEST(BackgroundSubtractor_MultiStream, sameSizeMasksShareBuffer)
+{
+    const int numStreams = 4;
+    const Size sz(32, 24);
+    Ptr<BackgroundSubtractorMultiStream> multi = createBackgroundSubtractorMultiStream();
+    for (int i = 0; i < numStreams; ++i)
+        multi->addStream(i % 2 == 0 ? Ptr<BackgroundSubtractor>(createBackgroundSubtractorMOG())
+                                    : Ptr<BackgroundSubtractor>(createBackgroundSubtractorCNT()));
+
+    std::vector<Mat> frames(numStreams), masks;
+    for (int i = 0; i < numStreams; ++i)
+        frames[i] = Mat(sz, CV_8UC1, Scalar::all(10 * i));
+
+    multi->apply(frames, masks);
+    ASSERT_EQ((size_t)numStreams, masks.size());
+    const uchar* arena = masks[0].data;
+
+    for (int t = 0; t < 2; ++t)
+    {
+        for (int i = 0; i < numStreams; ++i)
+        {
+            ASSERT_EQ(sz, masks[i].size());
+            // consecutive rows of one buffer, reused across calls
+            EXPECT_EQ(arena + (size_t)i * sz.area(), masks[i].data) << "stream " << i;
+            EXPECT_EQ(masks[0].u, masks[i].u) << "stream " << i;
+        }
+        multi->apply(frames, masks);
+    }
+}
+
+TEST(BackgroundSubtractor_MultiStream, differentSizes)
+{
+    std::vector<Size> sizes;
+    sizes.push_back(Size(64, 48));
+    sizes.push_back(Size(80, 60));
+    sizes.push_back(Size(32, 32));
+    checkMatchesStandalone(sizes);
+}
+
+// the streams added later and the size changes repack the models, the running streams must keep their state
+TEST(BackgroundSubtractor_MultiStream, repackKeepsState)
+{
+    const int numStreams = 6;
+    RNG rng(7);
+
+    Ptr<BackgroundSubtractorMultiStream> multi = createBackgroundSubtractorMultiStream();
+    std::vector<Ptr<BackgroundSubtractor> > reference;
+    std::vector<Mat> backgrounds(numStreams);
+    for (int i = 0; i < numStreams; ++i)
+    {
+        backgrounds[i].create(32 + 8 * i, 40, CV_8UC3);
+        rng.fill(backgrounds[i], RNG::UNIFORM, 0, 256);
+    }
+
+    for (int t = 0; t < 12; ++t)
+    {
+        // a stream joins every other frame, stream 1 switches to its next size at frame 6
+        if (t % 2 == 0 && multi->getNumStreams() < numStreams)
+        {
+            multi->addStream(createStreamSubtractor(multi->getNumStreams()));
+            reference.push_back(createStreamSubtractor(static_cast<int>(reference.size())));
+        }
+        const int n = multi->getNumStreams();
+
+        std::vector<Mat> frames(n), masks;
+        for (int i = 0; i < n; ++i)
+        {
+            const Mat& background = backgrounds[i == 1 && t >= 6 ? 2 : i];
+            Mat noise(background.size(), CV_8UC3);
+            rng.fill(noise, RNG::UNIFORM, 0, 8);
+            frames[i] = background + noise;
+            // a moving foreground square
+            frames[i](Rect((3 * t) % 24, 4, 8, 8)).setTo(Scalar::all(255));
+        }
+
+        multi->apply(frames, masks);
+        ASSERT_EQ((size_t)n, masks.size());
+        for (int i = 0; i < n; ++i)
+        {
+            Mat expected;
+            reference[i]->apply(frames[i], expected);
+            EXPECT_MAT_NEAR(expected, masks[i], 0) << "stream " << i << " frame " << t;
+        }
+    }
+}
+
+TEST(BackgroundSubtractor_MultiStream, emptyFrame)
+{
+    Ptr<BackgroundSubtractorMultiStream> multi = createBackgroundSubtractorMultiStream();
+    multi->addStream(createBackgroundSubtractorMOG());
+    multi->addStream(createBackgroundSubtractorMOG());
+
+    std::vector<Mat> frames(2), masks;
+    frames[0] = Mat(16, 16, CV_8UC1, Scalar::all(100));
+
+    multi->apply(frames, masks);
+    ASSERT_EQ(2u, masks.size());
+    EXPECT_EQ(frames[0].size(), masks[0].size());
+    EXPECT_TRUE(masks[1].empty());
+}
+
+}} // namespace
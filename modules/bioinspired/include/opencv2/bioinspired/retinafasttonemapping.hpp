@@ -127,6 +127,25 @@ public:
      */
     CV_WRAP virtual void setup(const float photoreceptorsNeighborhoodRadius=3.f, const float ganglioncellsNeighborhoodRadius=1.f, const float meanLuminanceModulatorK=1.f)=0;
 
+    /** @brief sets the temporal constant of the adaptation state for video streams
+
+    The object keeps its adaptation state (local luminance maps of both stages and global luminance
+    statistics) between calls to applyFastToneMapping. When the temporal constant is greater than 0,
+    this state is smoothed by a first order temporal low pass filter, which avoids flickering when
+    successive frames of a video stream are tone mapped.
+
+    @param temporalConstant the time constant of the adaptation state (unit is frames), 0 (default)
+    processes each frame independently
+     */
+    CV_WRAP virtual void setTemporalConstant(const float temporalConstant)=0;
+    CV_WRAP virtual float getTemporalConstant() const=0;
+
+    /** @brief Clears the adaptation state, call it when a new video sequence starts
+
+    The state is also cleared when applyFastToneMapping receives a frame of another size.
+     */
+    CV_WRAP virtual void clearBuffers()=0;
+
     CV_WRAP static Ptr<RetinaFastToneMapping> create(Size inputSize);
 };
 
@@ -0,0 +1,98 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+typedef tuple<Size, bool> Size_ColorMode_t;
+typedef perf::TestBaseWithParam<Size_ColorMode_t> Size_ColorMode;
+
+PERF_TEST_P( Size_ColorMode, Retina_run,
+    testing::Combine(
+        testing::Values( szVGA, sz1080p ),
+        testing::Bool()
+    )
+)
+{
+    Size size = get<0>(GetParam());
+    bool colorMode = get<1>(GetParam());
+
+    Mat input = imread(getDataPath("cv/shared/lena.png"), colorMode ? IMREAD_COLOR : IMREAD_GRAYSCALE);
+    ASSERT_FALSE(input.empty());
+    resize(input, input, size);
+
+    Ptr<bioinspired::Retina> retina = bioinspired::Retina::create(size, colorMode);
+
+    // let the temporal filters settle
+    retina->run(input);
+
+    Mat parvo, magno;
+    declare.in(input).time(60);
+    TEST_CYCLE()
+    {
+        retina->run(input);
+        retina->getParvo(parvo);
+        retina->getMagno(magno);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P( Size_ColorMode, Retina_run_logSampling,
+    testing::Combine(
+        testing::Values( szVGA, sz1080p ),
+        testing::Bool()
+    )
+)
+{
+    Size size = get<0>(GetParam());
+    bool colorMode = get<1>(GetParam());
+
+    Mat input = imread(getDataPath("cv/shared/lena.png"), colorMode ? IMREAD_COLOR : IMREAD_GRAYSCALE);
+    ASSERT_FALSE(input.empty());
+    resize(input, input, size);
+
+    Ptr<bioinspired::Retina> retina = bioinspired::Retina::create(size, colorMode, bioinspired::RETINA_COLOR_BAYER, true, 2.0f, 10.0f);
+    retina->run(input);
+
+    Mat parvo;
+    declare.in(input).time(60);
+    TEST_CYCLE()
+    {
+        retina->run(input);
+        retina->getParvo(parvo);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P( Size_ColorMode, RetinaFastToneMapping_stream,
+    testing::Combine(
+        testing::Values( sz1080p, sz2160p ),
+        testing::Bool()
+    )
+)
+{
+    Size size = get<0>(GetParam());
+    bool colorMode = get<1>(GetParam());
+
+    Mat input = imread(getDataPath("cv/shared/lena.png"), colorMode ? IMREAD_COLOR : IMREAD_GRAYSCALE);
+    ASSERT_FALSE(input.empty());
+    resize(input, input, size);
+    // HDR-like float input
+    input.convertTo(input, CV_32F, 4.0);
+
+    Ptr<bioinspired::RetinaFastToneMapping> toneMapper = bioinspired::RetinaFastToneMapping::create(size);
+    toneMapper->setTemporalConstant(2.f);
+
+    Mat output;
+    toneMapper->applyFastToneMapping(input, output);
+
+    declare.in(input).out(output).time(60);
+    TEST_CYCLE() toneMapper->applyFastToneMapping(input, output);
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
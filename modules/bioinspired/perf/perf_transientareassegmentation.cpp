@@ -0,0 +1,40 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+typedef perf::TestBaseWithParam<Size> Size_Only;
+
+PERF_TEST_P( Size_Only, TransientAreasSegmentationModule_run,
+    testing::Values( szVGA, sz1080p )
+)
+{
+    Size size = GetParam();
+
+    Mat input = imread(getDataPath("cv/shared/lena.png"), IMREAD_GRAYSCALE);
+    ASSERT_FALSE(input.empty());
+    resize(input, input, size);
+
+    // two alternating frames, a shifted copy simulates motion
+    Mat shifted;
+    Mat shift = (Mat_<double>(2, 3) << 1, 0, 4, 0, 1, 2);
+    warpAffine(input, shifted, shift, size);
+
+    Ptr<bioinspired::TransientAreasSegmentationModule> segmenter = bioinspired::TransientAreasSegmentationModule::create(size);
+    segmenter->run(input);
+
+    Mat transientAreas;
+    int frame = 0;
+    declare.in(input, shifted).time(60);
+    TEST_CYCLE()
+    {
+        segmenter->run((frame++ & 1) ? input : shifted);
+        segmenter->getSegmentationPicture(transientAreas);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
@@ -67,6 +67,7 @@
 #include <iostream>
 #include <cstdlib>
 #include "basicretinafilter.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 #include <cmath>
 
 
@@ -420,11 +421,112 @@ void BasicRetinaFilter::_spatiotemporalLPfilter(const float *inputFrame, float *
     _tau=_filteringCoeficientsTable[2+coefTableOffset];
 
     // launch the serie of 1D directional filters in order to compute the 2D low pass filter
-    _horizontalCausalFilter_addInput(inputFrame, outputFrame, 0,_filterOutput.getNBrows());
-    _horizontalAnticausalFilter(outputFrame, 0, _filterOutput.getNBrows());
-    _verticalCausalFilter(outputFrame, 0, _filterOutput.getNBcolumns());
-    _verticalAnticausalFilter_multGain(outputFrame, 0, _filterOutput.getNBcolumns());
+    const LPfilterJob job={inputFrame, outputFrame, _a, _gain, _tau, false};
+    runLPfilterJobs(&job, 1, _filterOutput.getNBrows(), _filterOutput.getNBcolumns());
+}
+
+BasicRetinaFilter::LPfilterJob BasicRetinaFilter::getLPfilterJob(const float *inputFrame, float *outputFrame, const unsigned int filterIndex) const
+{
+    unsigned int coefTableOffset=filterIndex*3;
+    const LPfilterJob job={inputFrame, outputFrame, _filteringCoeficientsTable[coefTableOffset], _filteringCoeficientsTable[1+coefTableOffset], _filteringCoeficientsTable[2+coefTableOffset], false};
+    return job;
+}
+
+// run independent LP filters in the same parallel passes: all the rows of all the jobs, then all the column stripes of all the jobs
+void BasicRetinaFilter::runLPfilterJobs(const LPfilterJob *jobs, const unsigned int nbJobs, const unsigned int NBrows, const unsigned int NBcolumns)
+{
+    const unsigned int nbStripes=(NBcolumns+LP_FILTER_STRIPE_WIDTH-1)/LP_FILTER_STRIPE_WIDTH;
+#ifdef MAKE_PARALLEL
+    cv::parallel_for_(cv::Range(0, (int)(nbJobs*NBrows)), Parallel_horizontalLPfilterJobs(jobs, NBrows, NBcolumns));
+    cv::parallel_for_(cv::Range(0, (int)(nbJobs*nbStripes)), Parallel_verticalLPfilterJobs(jobs, NBrows, NBcolumns, nbStripes));
+#else
+    for (unsigned int IDjob=0; IDjob<nbJobs; ++IDjob)
+    {
+        for (unsigned int IDrow=0; IDrow<NBrows; ++IDrow)
+            _horizontalLPfilterRow(jobs[IDjob], IDrow, NBcolumns);
+        for (unsigned int IDcolumn=0; IDcolumn<NBcolumns; IDcolumn+=LP_FILTER_STRIPE_WIDTH)
+            _verticalLPfilterStripe(jobs[IDjob], IDcolumn, std::min(IDcolumn+LP_FILTER_STRIPE_WIDTH, NBcolumns), NBrows, NBcolumns);
+    }
+#endif
+}
+
+//  horizontal causal filter which adds the input, followed by the horizontal anticausal filter on the same row
+void BasicRetinaFilter::_horizontalLPfilterRow(const LPfilterJob &job, const unsigned int IDrow, const unsigned int nbColumns)
+{
+    float* outputPTR=job.outputFrame+IDrow*nbColumns;
+    const float* inputPTR=job.inputFrame+IDrow*nbColumns;
+    float result=0;
+    if (job.squareInput)
+    {
+        for (unsigned int index=0; index<nbColumns; ++index)
+        {
+            result = *(inputPTR)**(inputPTR) + job.tau**(outputPTR)+  job.a* result;
+            *(outputPTR++) = result;
+            ++inputPTR;
+        }
+    }
+    else
+    {
+        for (unsigned int index=0; index<nbColumns; ++index)
+        {
+            result = *(inputPTR++) + job.tau**(outputPTR)+  job.a* result;
+            *(outputPTR++) = result;
+        }
+    }
+    result=0;
+    for (unsigned int index=0; index<nbColumns; ++index)
+    {
+        result = *(--outputPTR)+  job.a* result;
+        *(outputPTR) = result;
+    }
+}
+
+//  vertical causal filter followed by the vertical anticausal filter which multiplies the output by the gain
+//  the stripe is processed row by row so that the columns are filtered together with contiguous (SIMD) accesses
+void BasicRetinaFilter::_verticalLPfilterStripe(const LPfilterJob &job, const unsigned int IDcolumnStart, const unsigned int IDcolumnEnd, const unsigned int nbRows, const unsigned int nbColumns)
+{
+    const int width=(int)(IDcolumnEnd-IDcolumnStart);
+    float *stripe=job.outputFrame+IDcolumnStart;
+    const float a=job.a, gain=job.gain;
+#if CV_SIMD
+    const int vlanes=VTraits<v_float32>::vlanes();
+    const v_float32 v_a=vx_setall_f32(a), v_gain=vx_setall_f32(gain);
+#endif
+
+    // causal way: the previous row already holds the filter state
+    for (unsigned int IDrow=1; IDrow<nbRows; ++IDrow)
+    {
+        const float *previousRowPTR=stripe+(IDrow-1)*nbColumns;
+        float *rowPTR=stripe+IDrow*nbColumns;
+        int index=0;
+#if CV_SIMD
+        for (; index<=width-vlanes; index+=vlanes)
+            v_store(rowPTR+index, v_add(vx_load(rowPTR+index), v_mul(v_a, vx_load(previousRowPTR+index))));
+#endif
+        for (; index<width; ++index)
+            rowPTR[index] = rowPTR[index] + a * previousRowPTR[index];
+    }
 
+    // anticausal way: the output is multiplied by the gain, the filter state is kept apart
+    float result[LP_FILTER_STRIPE_WIDTH]={0};
+    for (unsigned int IDrow=nbRows; IDrow-->0;)
+    {
+        float *rowPTR=stripe+IDrow*nbColumns;
+        int index=0;
+#if CV_SIMD
+        for (; index<=width-vlanes; index+=vlanes)
+        {
+            v_float32 v_result=v_add(vx_load(rowPTR+index), v_mul(v_a, vx_load(result+index)));
+            v_store(result+index, v_result);
+            v_store(rowPTR+index, v_mul(v_gain, v_result));
+        }
+#endif
+        for (; index<width; ++index)
+        {
+            result[index] = rowPTR[index] + a * result[index];
+            rowPTR[index] = gain*result[index];
+        }
+    }
 }
 
 // run SQUARING LP filter for a new frame input and save result at a specific output adress
@@ -437,11 +539,9 @@ float BasicRetinaFilter::_squaringSpatiotemporalLPfilter(const float *inputFrame
     _tau=_filteringCoeficientsTable[2+coefTableOffset];
 
     // launch the serie of 1D directional filters in order to compute the 2D low pass filter
-
-    _squaringHorizontalCausalFilter(inputFrame, outputFrame, 0, _filterOutput.getNBrows());
-    _horizontalAnticausalFilter(outputFrame, 0, _filterOutput.getNBrows());
-    _verticalCausalFilter(outputFrame, 0, _filterOutput.getNBcolumns());
-    return _verticalAnticausalFilter_returnMeanValue(outputFrame, 0, _filterOutput.getNBcolumns());
+    const LPfilterJob job={inputFrame, outputFrame, _a, _gain, _tau, true};
+    runLPfilterJobs(&job, 1, _filterOutput.getNBrows(), _filterOutput.getNBcolumns());
+    return (float)(cv::sum(Mat((int)_filterOutput.getNBrows(), (int)_filterOutput.getNBcolumns(), CV_32F, outputFrame))[0]/(double)_filterOutput.getNBpixels());
 }
 
 /////////////////////////////////////////////////
@@ -185,6 +185,35 @@ namespace bioinspired
         */
         void runFilter_LPfilter_Autonomous(std::valarray<float> &inputOutputFrame, const unsigned int filterIndex=0);// run LP filter on the input data and rewrite it
 
+        /**
+        * description of one spatio-temporal low pass filtering job, see runLPfilterJobs()
+        */
+        struct LPfilterJob
+        {
+            const float *inputFrame;
+            float *outputFrame; // also holds the previous output used by the temporal part of the filter
+            float a, gain, tau;
+            bool squareInput; // the input is squared before filtering (local energy integration)
+        };
+
+        /**
+        * prepare a low pass filtering job that uses one of the parameter sets of this object
+        * @param inputFrame: the input image to be processed
+        * @param outputFrame: the output buffer in which the result is writed
+        * @param filterIndex: the offset which specifies the parameter set that should be used for the filtering
+        */
+        LPfilterJob getLPfilterJob(const float *inputFrame, float *outputFrame, const unsigned int filterIndex=0) const;
+
+        /**
+        * run several low pass filtering jobs that work on independent buffers of the same size within shared parallel passes
+        * this allows to process the ON and OFF ways of a channel or several retina channels as a single pipeline stage
+        * @param jobs: the table of jobs to run
+        * @param nbJobs: the number of jobs
+        * @param NBrows: number of rows of the processed buffers
+        * @param NBcolumns: number of columns of the processed buffers
+        */
+        static void runLPfilterJobs(const LPfilterJob *jobs, const unsigned int nbJobs, const unsigned int NBrows, const unsigned int NBcolumns);
+
         /**
         *  local luminance adaptation call and run (contrast enhancement property of the photoreceptors)
         * @param inputOutputFrame: the input image to be processed
@@ -447,6 +476,12 @@ namespace bioinspired
         void _verticalAnticausalFilter_Irregular_multGain(float *outputFrame, unsigned int IDcolumnStart, unsigned int IDcolumnEnd);
 
 
+        // fused 1D filters used by runLPfilterJobs: horizontal causal (with input) and anticausal filters on a row,
+        // vertical causal and anticausal (with gain) filters on a stripe of columns, processed row by row with SIMD
+        static void _horizontalLPfilterRow(const LPfilterJob &job, const unsigned int IDrow, const unsigned int nbColumns);
+        static void _verticalLPfilterStripe(const LPfilterJob &job, const unsigned int IDcolumnStart, const unsigned int IDcolumnEnd, const unsigned int nbRows, const unsigned int nbColumns);
+        enum { LP_FILTER_STRIPE_WIDTH=64 };
+
         // 1D filters in which the output is multiplied by _gain
         void _verticalAnticausalFilter_multGain(float *outputFrame, unsigned int IDcolumnStart, unsigned int IDcolumnEnd); // this functions affects _gain at the output // parallelized with TBB
         void _horizontalAnticausalFilter_multGain(float *outputFrame, unsigned int IDcolumnStart, unsigned int IDcolumnEnd); // this functions affects _gain at the output
@@ -590,6 +625,39 @@ namespace bioinspired
             }
         };
 
+        class Parallel_horizontalLPfilterJobs: public cv::ParallelLoopBody
+        {
+        private:
+            const LPfilterJob *jobs;
+            unsigned int nbRows, nbColumns;
+        public:
+            Parallel_horizontalLPfilterJobs(const LPfilterJob *jobsTable, const unsigned int nbRws, const unsigned int nbCols)
+                :jobs(jobsTable), nbRows(nbRws), nbColumns(nbCols){}
+
+            virtual void operator()( const Range& r ) const CV_OVERRIDE {
+                for (int IDtask=r.start; IDtask!=r.end; ++IDtask)
+                    _horizontalLPfilterRow(jobs[IDtask/nbRows], IDtask%nbRows, nbColumns);
+            }
+        };
+
+        class Parallel_verticalLPfilterJobs: public cv::ParallelLoopBody
+        {
+        private:
+            const LPfilterJob *jobs;
+            unsigned int nbRows, nbColumns, nbStripes;
+        public:
+            Parallel_verticalLPfilterJobs(const LPfilterJob *jobsTable, const unsigned int nbRws, const unsigned int nbCols, const unsigned int nbStrps)
+                :jobs(jobsTable), nbRows(nbRws), nbColumns(nbCols), nbStripes(nbStrps){}
+
+            virtual void operator()( const Range& r ) const CV_OVERRIDE {
+                for (int IDtask=r.start; IDtask!=r.end; ++IDtask)
+                {
+                    const unsigned int IDcolumnStart=(IDtask%nbStripes)*LP_FILTER_STRIPE_WIDTH;
+                    _verticalLPfilterStripe(jobs[IDtask/nbStripes], IDcolumnStart, std::min(IDcolumnStart+LP_FILTER_STRIPE_WIDTH, nbColumns), nbRows, nbColumns);
+                }
+            }
+        };
+
         class Parallel_localAdaptation: public cv::ParallelLoopBody
         {
         private:
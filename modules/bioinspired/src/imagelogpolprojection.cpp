@@ -64,6 +64,7 @@
 
 #include "precomp.hpp"
 #include "imagelogpolprojection.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 #include <cmath>
 #include <iostream>
@@ -290,6 +291,7 @@ bool ImageLogPolProjection::_initLogRetinaSampling(const double reductionFactor,
     // (re)creating and filling the transform table
     _transformTable.resize(_usefullpixelIndex);
     memcpy(&_transformTable[0], &tempTransformTable[0], sizeof(unsigned int)*_usefullpixelIndex);
+    _initSamplingTable();
 
     // reset all buffers
     clearAllBuffers();
@@ -387,6 +389,7 @@ bool ImageLogPolProjection::_initLogPolarCortexSampling(const double reductionFa
     // (re)creating and filling the transform table
     _transformTable.resize(_usefullpixelIndex);
     memcpy(&_transformTable[0], &tempTransformTable[0], sizeof(unsigned int)*_usefullpixelIndex);
+    _initSamplingTable();
 
     // reset all buffers
     clearAllBuffers();
@@ -394,6 +397,50 @@ bool ImageLogPolProjection::_initLogPolarCortexSampling(const double reductionFa
     return true;
 }
 
+void ImageLogPolProjection::_initSamplingTable()
+{
+    // the transform table is sparse and ordered by input quadrant, a dense table ordered by output pixel
+    // allows contiguous writes and SIMD gathers, the last table entry wins as with the sequential transform
+    _samplingTable.resize(_outputNBpixels);
+    _samplingTable=-1;
+    for (unsigned int i=0 ; i<_usefullpixelIndex ; i+=2)
+        _samplingTable[_transformTable[i]]=(int)_transformTable[i+1];
+}
+
+void ImageLogPolProjection::_applySamplingTable(const float *inputFrame, float *outputFrame) const
+{
+    const int *samplingTable=&_samplingTable[0];
+    const int nbColumns=(int)_outputNBcolumns;
+    cv::parallel_for_(cv::Range(0, (int)_outputNBrows), [&](const cv::Range& range)
+    {
+        for (int IDrow=range.start; IDrow<range.end; ++IDrow)
+        {
+            const int *samplingRowPTR=samplingTable+IDrow*nbColumns;
+            float *outputRowPTR=outputFrame+IDrow*nbColumns;
+            int index=0;
+#if CV_SIMD
+            const int vlanes=VTraits<v_float32>::vlanes();
+            const v_int32 v_zero=vx_setzero_s32();
+            for (; index<=nbColumns-vlanes; index+=vlanes)
+            {
+                // blocks that contain pixels out of the sampled area are left to the scalar path
+                if (v_check_any(v_lt(vx_load(samplingRowPTR+index), v_zero)))
+                {
+                    for (int i=index; i<index+vlanes; ++i)
+                        if (samplingRowPTR[i]>=0)
+                            outputRowPTR[i]=inputFrame[samplingRowPTR[i]];
+                    continue;
+                }
+                v_store(outputRowPTR+index, vx_lut(inputFrame, samplingRowPTR+index));
+            }
+#endif
+            for (; index<nbColumns; ++index)
+                if (samplingRowPTR[index]>=0)
+                    outputRowPTR[index]=inputFrame[samplingRowPTR[index]];
+        }
+    });
+}
+
 // action function
 std::valarray<float> &ImageLogPolProjection::runProjection(const std::valarray<float> &inputFrame, const bool colorMode)
 {
@@ -410,16 +457,9 @@ std::valarray<float> &ImageLogPolProjection::runProjection(const std::valarray<f
         _spatiotemporalLPfilter_Irregular(&_irregularLPfilteredFrame[0], &_tempBuffer[0]+_filterOutput.getNBpixels()*2);
 
         // applying image projection/resampling
-        unsigned int *transformTablePTR=&_transformTable[0];
-        for (unsigned int i=0 ; i<_usefullpixelIndex ; i+=2, transformTablePTR+=2)
-        {
-#ifdef IMAGELOGPOLPROJECTION_DEBUG
-            std::cout<<"ImageLogPolProjection::i:"<<i<<"output(max="<<_outputNBpixels<<")="<<_transformTable[i]<<" / intput(max="<<_filterOutput.getNBpixels()<<")="<<_transformTable[i+1]<<std::endl;
-#endif
-            _sampledFrame[*(transformTablePTR)]=_tempBuffer[*(transformTablePTR+1)];
-            _sampledFrame[*(transformTablePTR)+_outputNBpixels]=_tempBuffer[*(transformTablePTR+1)+_filterOutput.getNBpixels()];
-            _sampledFrame[*(transformTablePTR)+_outputDoubleNBpixels]=_tempBuffer[*(transformTablePTR+1)+_inputDoubleNBpixels];
-        }
+        _applySamplingTable(&_tempBuffer[0], &_sampledFrame[0]);
+        _applySamplingTable(&_tempBuffer[0]+_filterOutput.getNBpixels(), &_sampledFrame[0]+_outputNBpixels);
+        _applySamplingTable(&_tempBuffer[0]+_inputDoubleNBpixels, &_sampledFrame[0]+_outputDoubleNBpixels);
 
 #ifdef IMAGELOGPOLPROJECTION_DEBUG
         std::cout<<"ImageLogPolProjection::runProjection: color image projection OK"<<std::endl;
@@ -430,14 +470,7 @@ std::valarray<float> &ImageLogPolProjection::runProjection(const std::valarray<f
         _spatiotemporalLPfilter_Irregular(get_data(inputFrame), &_irregularLPfilteredFrame[0]);
         _spatiotemporalLPfilter_Irregular(&_irregularLPfilteredFrame[0], &_irregularLPfilteredFrame[0]);
         // applying image projection/resampling
-        unsigned int *transformTablePTR=&_transformTable[0];
-        for (unsigned int i=0 ; i<_usefullpixelIndex ; i+=2, transformTablePTR+=2)
-        {
-#ifdef IMAGELOGPOLPROJECTION_DEBUG
-            std::cout<<"i:"<<i<<"output(max="<<_outputNBpixels<<")="<<_transformTable[i]<<" / intput(max="<<_filterOutput.getNBpixels()<<")="<<_transformTable[i+1]<<std::endl;
-#endif
-            _sampledFrame[*(transformTablePTR)]=_irregularLPfilteredFrame[*(transformTablePTR+1)];
-        }
+        _applySamplingTable(&_irregularLPfilteredFrame[0], &_sampledFrame[0]);
         //normalizeGrayOutput_0_maxOutputValue(_sampledFrame, _outputNBpixels);
 #ifdef IMAGELOGPOLPROJECTION_DEBUG
         std::cout<<"ImageLogPolProjection::runProjection: gray level image projection OK"<<std::endl;
@@ -220,6 +220,7 @@ private:
     std::valarray<float>_sampledFrame;
     std::valarray<float>&_tempBuffer;
     std::valarray<unsigned int>_transformTable;
+    std::valarray<int>_samplingTable; // input pixel index of each output pixel (-1 if the output pixel is not sampled), built from _transformTable
 
     std::valarray<float> &_irregularLPfilteredFrame; // just a reference for easier understanding
     unsigned int _usefullpixelIndex;
@@ -233,6 +234,10 @@ private:
     // private init projections functions called by "initProjection(...)" function
     bool _initLogRetinaSampling(const double reductionFactor, const double samplingStrength);
     bool _initLogPolarCortexSampling(const double reductionFactor, const double samplingStrength);
+    // builds the dense sampling table from the transform table
+    void _initSamplingTable();
+    // applies the sampling table on one input plane, output rows are processed in parallel
+    void _applySamplingTable(const float *inputFrame, float *outputFrame) const;
 
     ImageLogPolProjection(const ImageLogPolProjection&);
     ImageLogPolProjection& operator=(const ImageLogPolProjection&);
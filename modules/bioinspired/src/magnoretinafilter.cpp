@@ -187,16 +187,34 @@ void MagnoRetinaFilter::_amacrineCellsComputing(const float *OPL_ON, const float
 const std::valarray<float> &MagnoRetinaFilter::runFilter(const std::valarray<float> &OPL_ON, const std::valarray<float> &OPL_OFF)
 {
     // Compute the high pass temporal filter
-    _amacrineCellsComputing(get_data(OPL_ON), get_data(OPL_OFF));
+    runAmacrineCellsFilter(OPL_ON, OPL_OFF);
 
     // apply low pass filtering on ON and OFF ways after temporal high pass filtering
-    _spatiotemporalLPfilter(&_amacrinCellsTempOutput_ON[0], &_magnoXOutputON[0], 0);
-    _spatiotemporalLPfilter(&_amacrinCellsTempOutput_OFF[0], &_magnoXOutputOFF[0], 0);
+    LPfilterJob jobs[2];
+    getAmacrineCellsLPfilterJobs(jobs);
+    runLPfilterJobs(jobs, 2, _filterOutput.getNBrows(), _filterOutput.getNBcolumns());
+
+    return runGanglionCellsFilter();
+}
 
+void MagnoRetinaFilter::runAmacrineCellsFilter(const std::valarray<float> &OPL_ON, const std::valarray<float> &OPL_OFF)
+{
+    _amacrineCellsComputing(get_data(OPL_ON), get_data(OPL_OFF));
+}
+
+void MagnoRetinaFilter::getAmacrineCellsLPfilterJobs(LPfilterJob *jobs)
+{
+    jobs[0]=getLPfilterJob(&_amacrinCellsTempOutput_ON[0], &_magnoXOutputON[0], 0);
+    jobs[1]=getLPfilterJob(&_amacrinCellsTempOutput_OFF[0], &_magnoXOutputOFF[0], 0);
+}
+
+const std::valarray<float> &MagnoRetinaFilter::runGanglionCellsFilter()
+{
     // local adaptation of the ganglion cells to the local contrast of the moving contours
-    _spatiotemporalLPfilter(&_magnoXOutputON[0], &_localProcessBufferON[0], 1);
+    LPfilterJob jobs[2]={getLPfilterJob(&_magnoXOutputON[0], &_localProcessBufferON[0], 1),
+                         getLPfilterJob(&_magnoXOutputOFF[0], &_localProcessBufferOFF[0], 1)};
+    runLPfilterJobs(jobs, 2, _filterOutput.getNBrows(), _filterOutput.getNBcolumns());
     _localLuminanceAdaptation(&_magnoXOutputON[0], &_localProcessBufferON[0]);
-    _spatiotemporalLPfilter(&_magnoXOutputOFF[0], &_localProcessBufferOFF[0], 1);
     _localLuminanceAdaptation(&_magnoXOutputOFF[0], &_localProcessBufferOFF[0]);
 
     /* Compute MagnoY */
@@ -148,6 +148,25 @@ namespace bioinspired
         */
         const std::valarray<float> &runFilter(const std::valarray<float> &OPL_ON, const std::valarray<float> &OPL_OFF);
 
+        /**
+        * staged version of runFilter() that allows to pipeline the magnocellular channel with other retina channels:
+        * runAmacrineCellsFilter(), then the low pass filtering jobs given by getAmacrineCellsLPfilterJobs() (see BasicRetinaFilter::runLPfilterJobs), then runGanglionCellsFilter()
+        * @param OPL_ON: the output of the bipolar ON cells of the retina
+        * @param OPL_OFF: the output of the bipolar OFF cells of the retina
+        */
+        void runAmacrineCellsFilter(const std::valarray<float> &OPL_ON, const std::valarray<float> &OPL_OFF);
+
+        /**
+        * @param jobs: table that receives the 2 low pass filtering jobs of the amacrine cells outputs (ON and OFF ways)
+        */
+        void getAmacrineCellsLPfilterJobs(LPfilterJob *jobs);
+
+        /**
+        * last stage of the staged version of runFilter(), computes the local adaptation of the ganglion cells
+        * @return the processed result without post-processing
+        */
+        const std::valarray<float> &runGanglionCellsFilter();
+
         /**
         * @return the Magnocellular ON channel filtering output
         */
@@ -174,33 +174,51 @@ void ParvoRetinaFilter::setOPLandParvoFiltersParameters(const float beta1, const
 // output return is (*_parvocellularOutputONminusOFF)
 const std::valarray<float> &ParvoRetinaFilter::runFilter(const std::valarray<float> &inputFrame, const bool useParvoOutput)
 {
-    _spatiotemporalLPfilter(get_data(inputFrame), &_photoreceptorsOutput[0]);
-    _spatiotemporalLPfilter(&_photoreceptorsOutput[0], &_horizontalCellsOutput[0], 1);
-    _OPL_OnOffWaysComputing();
+    runOPLfilter(inputFrame);
 
     if (useParvoOutput)
     {
         // local adaptation processes on ON and OFF ways
-        _spatiotemporalLPfilter(&_bipolarCellsOutputON[0], &(*_localAdaptationON)[0], 2);
-        _localLuminanceAdaptation(&_parvocellularOutputON[0], &(*_localAdaptationON)[0]);
-
-        _spatiotemporalLPfilter(&_bipolarCellsOutputOFF[0], &_localAdaptationOFF[0], 2);
-        _localLuminanceAdaptation(&_parvocellularOutputOFF[0], &_localAdaptationOFF[0]);
-
-        //// Final loop that computes the main output of this filter
-        //
-        //// loop that makes the difference between photoreceptor cells output and horizontal cells
-        //// positive part goes on the ON way, negative pat goes on the OFF way
-        float *parvocellularOutputONminusOFF_PTR=&(*_parvocellularOutputONminusOFF)[0];
-        float *parvocellularOutputON_PTR=&_parvocellularOutputON[0];
-        float *parvocellularOutputOFF_PTR=&_parvocellularOutputOFF[0];
-
-        for (unsigned int IDpixel=0 ; IDpixel<_filterOutput.getNBpixels() ; ++IDpixel)
-            *(parvocellularOutputONminusOFF_PTR++)= (*(parvocellularOutputON_PTR++)-*(parvocellularOutputOFF_PTR++));
+        LPfilterJob jobs[2];
+        getLocalAdaptationLPfilterJobs(jobs);
+        runLPfilterJobs(jobs, 2, _filterOutput.getNBrows(), _filterOutput.getNBcolumns());
+        runIPLfilter();
     }
     return (*_parvocellularOutputONminusOFF);
 }
 
+void ParvoRetinaFilter::runOPLfilter(const std::valarray<float> &inputFrame)
+{
+    _spatiotemporalLPfilter(get_data(inputFrame), &_photoreceptorsOutput[0]);
+    _spatiotemporalLPfilter(&_photoreceptorsOutput[0], &_horizontalCellsOutput[0], 1);
+    _OPL_OnOffWaysComputing();
+}
+
+void ParvoRetinaFilter::getLocalAdaptationLPfilterJobs(LPfilterJob *jobs)
+{
+    jobs[0]=getLPfilterJob(&_bipolarCellsOutputON[0], &(*_localAdaptationON)[0], 2);
+    jobs[1]=getLPfilterJob(&_bipolarCellsOutputOFF[0], &_localAdaptationOFF[0], 2);
+}
+
+const std::valarray<float> &ParvoRetinaFilter::runIPLfilter()
+{
+    _localLuminanceAdaptation(&_parvocellularOutputON[0], &(*_localAdaptationON)[0]);
+    _localLuminanceAdaptation(&_parvocellularOutputOFF[0], &_localAdaptationOFF[0]);
+
+    //// Final loop that computes the main output of this filter
+    //
+    //// loop that makes the difference between photoreceptor cells output and horizontal cells
+    //// positive part goes on the ON way, negative pat goes on the OFF way
+    float *parvocellularOutputONminusOFF_PTR=&(*_parvocellularOutputONminusOFF)[0];
+    float *parvocellularOutputON_PTR=&_parvocellularOutputON[0];
+    float *parvocellularOutputOFF_PTR=&_parvocellularOutputOFF[0];
+
+    for (unsigned int IDpixel=0 ; IDpixel<_filterOutput.getNBpixels() ; ++IDpixel)
+        *(parvocellularOutputONminusOFF_PTR++)= (*(parvocellularOutputON_PTR++)-*(parvocellularOutputOFF_PTR++));
+
+    return (*_parvocellularOutputONminusOFF);
+}
+
 void ParvoRetinaFilter::_OPL_OnOffWaysComputing() // WARNING : this method requires many buffer accesses, parallelizing can increase bandwith & core efficacy
 {
     // loop that makes the difference between photoreceptor cells output and horizontal cells
@@ -165,6 +165,24 @@ public:
     */
     const std::valarray<float> &runFilter(const std::valarray<float> &inputFrame, const bool useParvoOutput=true); // output return is _parvocellularOutputONminusOFF
 
+    /**
+    * staged version of runFilter() that allows to pipeline the parvocellular channel with other retina channels:
+    * runOPLfilter(), then the low pass filtering jobs given by getLocalAdaptationLPfilterJobs() (see BasicRetinaFilter::runLPfilterJobs), then runIPLfilter()
+    * @param inputFrame: the input image to be processed
+    */
+    void runOPLfilter(const std::valarray<float> &inputFrame);
+
+    /**
+    * @param jobs: table that receives the 2 low pass filtering jobs of the bipolar cells outputs (ON and OFF ways) used for the local adaptation
+    */
+    void getLocalAdaptationLPfilterJobs(LPfilterJob *jobs);
+
+    /**
+    * last stage of the staged version of runFilter(), computes the local contrast enhancement of the Parvocellular channel
+    * @return the processed Parvocellular channel output
+    */
+    const std::valarray<float> &runIPLfilter();
+
     /**
     * @return the output of the photoreceptors filtering step (high cut frequency spatio-temporal low pass filter)
     */
@@ -103,22 +103,12 @@ public:
      */
     RetinaFastToneMappingImpl(Size imageInput)
     {
-        unsigned int nbPixels=imageInput.height*imageInput.width;
-
-        // basic error check
-        if (nbPixels <= 0)
-        throw cv::Exception(-1, "Bad retina size setup : size height and with must be superior to zero", "RetinaImpl::setup", "retinafasttonemapping.cpp", 0);
-
-        // resize buffers
-        _inputBuffer.resize(nbPixels*3); // buffer supports gray images but also 3 channels color buffers... (larger is better...)
-        _imageOutput.resize(nbPixels*3);
-        _temp2.resize(nbPixels);
-        // allocate the main filter with 2 setup sets properties (one for each low pass filter
-        _multiuseFilter = makePtr<BasicRetinaFilter>(imageInput.height, imageInput.width, 2);
-        // allocate the color manager (multiplexer/demultiplexer
-        _colorEngine = makePtr<RetinaColor>(imageInput.height, imageInput.width);
         // setup filter behaviors with default values
-        setup();
+        _temporalConstant=0.f;
+        _meanLuminanceModulatorK=1.f;
+        _photoreceptorsNeighborhoodRadius=3.f;
+        _ganglioncellsNeighborhoodRadius=1.f;
+        _allocateBuffers(imageInput);
     }
 
     /**
@@ -134,14 +124,19 @@ public:
      */
     virtual void applyFastToneMapping(InputArray inputImage, OutputArray outputToneMappedImage) CV_OVERRIDE
     {
+        // a new frame size starts a new sequence : reallocate the buffers, this also resets the adaptation state
+        const Size inputSize = inputImage.size();
+        if (inputSize != Size((int)_multiuseFilter->getNBcolumns(), (int)_multiuseFilter->getNBrows()))
+            _allocateBuffers(inputSize);
+
         // first convert input image to the compatible format :
-        const bool colorMode = _convertCvMat2ValarrayBuffer(inputImage.getMat(), _inputBuffer);
+        const bool colorMode = _convertCvMat2ValarrayBuffer(inputImage, _inputBuffer);
 
         // process tone mapping
         if (colorMode)
         {
             _runRGBToneMapping(_inputBuffer, _imageOutput, true);
-            _convertValarrayBuffer2cvMat(_imageOutput, _multiuseFilter->getNBrows(), _multiuseFilter->getNBcolumns(), true, outputToneMappedImage);
+            _convertValarrayBuffer2cvMat(_colorEngine->getDemultiplexedColorFrame(), _multiuseFilter->getNBrows(), _multiuseFilter->getNBcolumns(), true, outputToneMappedImage);
         }
         else
         {
@@ -161,9 +156,28 @@ public:
     {
         // setup the spatio-temporal properties of each filter
         _meanLuminanceModulatorK = meanLuminanceModulatorK;
+        _photoreceptorsNeighborhoodRadius = photoreceptorsNeighborhoodRadius;
+        _ganglioncellsNeighborhoodRadius = ganglioncellsNeighborhoodRadius;
         _multiuseFilter->setV0CompressionParameter(1.f, 255.f, 128.f);
-        _multiuseFilter->setLPfilterParameters(0.f, 0.f, photoreceptorsNeighborhoodRadius, 1);
-        _multiuseFilter->setLPfilterParameters(0.f, 0.f, ganglioncellsNeighborhoodRadius, 2);
+        _multiuseFilter->setLPfilterParameters(0.f, _temporalConstant, photoreceptorsNeighborhoodRadius, 0);
+        _multiuseFilter->setLPfilterParameters(0.f, _temporalConstant, ganglioncellsNeighborhoodRadius, 1);
+    }
+
+    virtual void setTemporalConstant(const float temporalConstant) CV_OVERRIDE
+    {
+        CV_Assert(temporalConstant >= 0.f);
+        _temporalConstant = temporalConstant;
+        setup(_photoreceptorsNeighborhoodRadius, _ganglioncellsNeighborhoodRadius, _meanLuminanceModulatorK);
+    }
+
+    virtual float getTemporalConstant() const CV_OVERRIDE { return _temporalConstant; }
+
+    virtual void clearBuffers() CV_OVERRIDE
+    {
+        _photoreceptorsLocalLuminance=0.f;
+        _ganglionCellsLocalLuminance=0.f;
+        _adaptationStateInitialized=false;
+        _colorEngine->clearAllBuffers();
     }
 
 private:
@@ -175,45 +189,65 @@ private:
     std::valarray<float> _inputBuffer;
     std::valarray<float> _imageOutput;
     std::valarray<float> _temp2;
+    //!< conversion buffers kept between calls
+    Mat _inputColorBuffer, _outputColorBuffer;
     float _meanLuminanceModulatorK;
+    float _photoreceptorsNeighborhoodRadius;
+    float _ganglioncellsNeighborhoodRadius;
+
+    //!< adaptation state kept between frames: low pass filters outputs and global luminance statistics of each stage
+    std::valarray<float> _photoreceptorsLocalLuminance;
+    std::valarray<float> _ganglionCellsLocalLuminance;
+    float _temporalConstant;
+    float _maxLuminance[2];
+    float _meanLuminance[2];
+    bool _adaptationStateInitialized;
+
 
+// allocate the buffers and the filters for the given frame size, keeps the current setup and clears the adaptation state
+void _allocateBuffers(const Size imageInput)
+{
+    unsigned int nbPixels=imageInput.height*imageInput.width;
+
+    // basic error check
+    if (nbPixels <= 0)
+    throw cv::Exception(-1, "Bad retina size setup : size height and with must be superior to zero", "RetinaImpl::setup", "retinafasttonemapping.cpp", 0);
+
+    // resize buffers
+    _inputBuffer.resize(nbPixels*3); // buffer supports gray images but also 3 channels color buffers... (larger is better...)
+    _imageOutput.resize(nbPixels*3);
+    _temp2.resize(nbPixels);
+    _photoreceptorsLocalLuminance.resize(nbPixels);
+    _ganglionCellsLocalLuminance.resize(nbPixels);
+    // allocate the main filter with 2 setup sets properties (one for each low pass filter
+    _multiuseFilter = makePtr<BasicRetinaFilter>(imageInput.height, imageInput.width, 2);
+    // allocate the color manager (multiplexer/demultiplexer
+    _colorEngine = makePtr<RetinaColor>(imageInput.height, imageInput.width);
+    setup(_photoreceptorsNeighborhoodRadius, _ganglioncellsNeighborhoodRadius, _meanLuminanceModulatorK);
+    clearBuffers();
+}
 
 void _convertValarrayBuffer2cvMat(const std::valarray<float> &grayMatrixToConvert, const unsigned int nbRows, const unsigned int nbColumns, const bool colorMode, OutputArray outBuffer)
 {
     // fill output buffer with the valarray buffer
-    const float *valarrayPTR=get_data(grayMatrixToConvert);
+    float *valarrayPTR=const_cast<float*>(get_data(grayMatrixToConvert));
     if (!colorMode)
     {
-        outBuffer.create(cv::Size(nbColumns, nbRows), CV_8U);
-        Mat outMat = outBuffer.getMat();
-        for (unsigned int i=0;i<nbRows;++i)
-        {
-            for (unsigned int j=0;j<nbColumns;++j)
-            {
-                cv::Point2d pixel(j,i);
-                outMat.at<unsigned char>(pixel)=(unsigned char)*(valarrayPTR++);
-            }
-        }
+        Mat(nbRows, nbColumns, CV_32F, valarrayPTR).convertTo(outBuffer, CV_8U);
     }
     else
     {
         const unsigned int nbPixels=nbColumns*nbRows;
         const unsigned int doubleNBpixels=nbColumns*nbRows*2;
-        outBuffer.create(cv::Size(nbColumns, nbRows), CV_8UC3);
-        Mat outMat = outBuffer.getMat();
-        for (unsigned int i=0;i<nbRows;++i)
+        // the valarray holds R, G and B planes
+        Mat planes[] =
         {
-            for (unsigned int j=0;j<nbColumns;++j,++valarrayPTR)
-            {
-                cv::Point2d pixel(j,i);
-                cv::Vec3b pixelValues;
-                pixelValues[2]=(unsigned char)*(valarrayPTR);
-                pixelValues[1]=(unsigned char)*(valarrayPTR+nbPixels);
-                pixelValues[0]=(unsigned char)*(valarrayPTR+doubleNBpixels);
-
-                outMat.at<cv::Vec3b>(pixel)=pixelValues;
-            }
-        }
+            Mat(nbRows, nbColumns, CV_32F, valarrayPTR+doubleNBpixels),
+            Mat(nbRows, nbColumns, CV_32F, valarrayPTR+nbPixels),
+            Mat(nbRows, nbColumns, CV_32F, valarrayPTR)
+        };
+        cv::merge(planes, 3, _outputColorBuffer);
+        _outputColorBuffer.convertTo(outBuffer, CV_8U);
     }
 }
 
@@ -223,6 +257,7 @@ bool _convertCvMat2ValarrayBuffer(InputArray inputMat, std::valarray<float> &out
     // first check input consistency
     if (inputMatToConvert.empty())
         throw cv::Exception(-1, "RetinaImpl cannot be applied, input buffer is empty", "RetinaImpl::run", "RetinaImpl.h", 0);
+    CV_Assert(inputMatToConvert.rows == (int)_multiuseFilter->getNBrows() && inputMatToConvert.cols == (int)_multiuseFilter->getNBcolumns());
 
     // retreive color mode from image input
     int imageNumberOfChannels = inputMatToConvert.channels();
@@ -231,33 +266,22 @@ bool _convertCvMat2ValarrayBuffer(InputArray inputMat, std::valarray<float> &out
     typedef float T; // define here the target pixel format, here, float
     const int dsttype = DataType<T>::depth; // output buffer is float format
 
-    const unsigned int nbPixels=inputMat.getMat().rows*inputMat.getMat().cols;
-    const unsigned int doubleNBpixels=inputMat.getMat().rows*inputMat.getMat().cols*2;
+    const unsigned int nbPixels=inputMatToConvert.rows*inputMatToConvert.cols;
+    const unsigned int doubleNBpixels=inputMatToConvert.rows*inputMatToConvert.cols*2;
 
-    if(imageNumberOfChannels==4)
-    {
-    // create a cv::Mat table (for RGBA planes)
-        cv::Mat planes[4] =
-        {
-            cv::Mat(inputMatToConvert.size(), dsttype, &outputValarrayMatrix[doubleNBpixels]),
-            cv::Mat(inputMatToConvert.size(), dsttype, &outputValarrayMatrix[nbPixels]),
-            cv::Mat(inputMatToConvert.size(), dsttype, &outputValarrayMatrix[0])
-        };
-        planes[3] = cv::Mat(inputMatToConvert.size(), dsttype);     // last channel (alpha) does not point on the valarray (not usefull in our case)
-        // split color cv::Mat in 4 planes... it fills valarray directely
-        cv::split(Mat_<Vec<T, 4> >(inputMatToConvert), planes);
-    }
-    else if (imageNumberOfChannels==3)
+    if(imageNumberOfChannels==3 || imageNumberOfChannels==4)
     {
-        // create a cv::Mat table (for RGB planes)
+        // create a cv::Mat table (for RGB planes), the alpha channel of RGBA inputs is not considered
         cv::Mat planes[] =
         {
         cv::Mat(inputMatToConvert.size(), dsttype, &outputValarrayMatrix[doubleNBpixels]),
         cv::Mat(inputMatToConvert.size(), dsttype, &outputValarrayMatrix[nbPixels]),
         cv::Mat(inputMatToConvert.size(), dsttype, &outputValarrayMatrix[0])
         };
-        // split color cv::Mat in 3 planes... it fills valarray directely
-        cv::split(cv::Mat_<Vec<T, 3> >(inputMatToConvert), planes);
+        // convert in a buffer kept between calls, then split the color planes... it fills valarray directely
+        inputMatToConvert.convertTo(_inputColorBuffer, dsttype);
+        const int fromTo[] = { 0,0, 1,1, 2,2 };
+        cv::mixChannels(&_inputColorBuffer, 1, planes, 3, fromTo, 3);
     }
     else if(imageNumberOfChannels==1)
     {
@@ -271,24 +295,47 @@ bool _convertCvMat2ValarrayBuffer(InputArray inputMat, std::valarray<float> &out
     return imageNumberOfChannels>1; // return bool : false for gray level image processing, true for color mode
 }
 
+// update the global luminance statistics of a local adaptation stage, they are smoothed as the local luminance maps
+void _updateAdaptationState(const int stage, const float maxLuminance, const float meanLuminance)
+{
+    if (!_adaptationStateInitialized)
+    {
+        _maxLuminance[stage]=maxLuminance;
+        _meanLuminance[stage]=meanLuminance;
+        return;
+    }
+    const float normalization=1.f/(1.f+_temporalConstant);
+    _maxLuminance[stage]=(maxLuminance+_temporalConstant*_maxLuminance[stage])*normalization;
+    _meanLuminance[stage]=(meanLuminance+_temporalConstant*_meanLuminance[stage])*normalization;
+}
 
 // run the initilized retina filter in order to perform gray image tone mapping, after this call all retina outputs are updated
 void _runGrayToneMapping(const std::valarray<float> &grayImageInput, std::valarray<float> &grayImageOutput)
 {
+    const int nbRows=(int)_multiuseFilter->getNBrows(), nbColumns=(int)_multiuseFilter->getNBcolumns();
+    double maxValue=0;
+
      // apply tone mapping on the multiplexed image
     // -> photoreceptors local adaptation (large area adaptation)
-    _multiuseFilter->runFilter_LPfilter(grayImageInput, grayImageOutput, 0); // compute low pass filtering modeling the horizontal cells filtering to acess local luminance
-    _multiuseFilter->setV0CompressionParameterToneMapping(1.f, grayImageOutput.max(), _meanLuminanceModulatorK*grayImageOutput.sum()/(float)_multiuseFilter->getNBpixels());
-    _multiuseFilter->runFilter_LocalAdapdation(grayImageInput, grayImageOutput, _temp2); // adapt contrast to local luminance
+    _multiuseFilter->runFilter_LPfilter(grayImageInput, _photoreceptorsLocalLuminance, 0); // compute low pass filtering modeling the horizontal cells filtering to acess local luminance
+    const Mat photoreceptorsLocalLuminance(nbRows, nbColumns, CV_32F, &_photoreceptorsLocalLuminance[0]);
+    cv::minMaxIdx(photoreceptorsLocalLuminance, NULL, &maxValue);
+    _updateAdaptationState(0, (float)maxValue, (float)cv::mean(photoreceptorsLocalLuminance)[0]);
+    _multiuseFilter->setV0CompressionParameterToneMapping(1.f, _maxLuminance[0], _meanLuminanceModulatorK*_meanLuminance[0]);
+    _multiuseFilter->runFilter_LocalAdapdation(grayImageInput, _photoreceptorsLocalLuminance, _temp2); // adapt contrast to local luminance
 
     // -> ganglion cells local adaptation (short area adaptation)
-    _multiuseFilter->runFilter_LPfilter(_temp2, grayImageOutput, 1); // compute low pass filtering (high cut frequency (remove spatio-temporal noise)
-    _multiuseFilter->setV0CompressionParameterToneMapping(1.f, _temp2.max(), _meanLuminanceModulatorK*grayImageOutput.sum()/(float)_multiuseFilter->getNBpixels());
-    _multiuseFilter->runFilter_LocalAdapdation(_temp2, grayImageOutput, grayImageOutput); // adapt contrast to local luminance
+    _multiuseFilter->runFilter_LPfilter(_temp2, _ganglionCellsLocalLuminance, 1); // compute low pass filtering (high cut frequency (remove spatio-temporal noise)
+    cv::minMaxIdx(Mat(nbRows, nbColumns, CV_32F, &_temp2[0]), NULL, &maxValue);
+    _updateAdaptationState(1, (float)maxValue, (float)cv::mean(Mat(nbRows, nbColumns, CV_32F, &_ganglionCellsLocalLuminance[0]))[0]);
+    _multiuseFilter->setV0CompressionParameterToneMapping(1.f, _maxLuminance[1], _meanLuminanceModulatorK*_meanLuminance[1]);
+    _multiuseFilter->runFilter_LocalAdapdation(_temp2, _ganglionCellsLocalLuminance, grayImageOutput); // adapt contrast to local luminance
 
+    _adaptationStateInitialized=true;
 }
 
 // run the initilized retina filter in order to perform color tone mapping, after this call all retina outputs are updated
+// the result is available in the demultiplexed frame of the color engine
 void _runRGBToneMapping(const std::valarray<float> &RGBimageInput, std::valarray<float> &RGBimageOutput, const bool useAdaptiveFiltering)
 {
     // multiplex the image with the color sampling method specified in the constructor
@@ -302,9 +349,6 @@ void _runRGBToneMapping(const std::valarray<float> &RGBimageInput, std::valarray
 
     // rescaling result between 0 and 255
     _colorEngine->normalizeRGBOutput_0_maxOutputValue(255.0);
-
-    // return the result
-    RGBimageOutput=_colorEngine->getDemultiplexedColorFrame();
 }
 
 };
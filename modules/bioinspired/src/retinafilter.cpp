@@ -307,7 +307,23 @@ namespace bioinspired
         //_photoreceptorsPrefilter.normalizeGrayOutput_0_maxOutputValue(_maxOutputValue);
 
         // run parvo filter
-        _ParvoRetinaFilter.runFilter(_photoreceptorsPrefilter.getOutput(), _useParvoOutput);
+        if (_useParvoOutput&&_useMagnoOutput)
+        {
+            // both IPL channels only depend on the bipolar cells outputs once the OPL stage is done,
+            // then the parvo local adaptation and the magno amacrine low pass filters are run as a single stage
+            _ParvoRetinaFilter.runOPLfilter(_photoreceptorsPrefilter.getOutput());
+            _MagnoRetinaFilter.runAmacrineCellsFilter(_ParvoRetinaFilter.getBipolarCellsON(), _ParvoRetinaFilter.getBipolarCellsOFF());
+
+            BasicRetinaFilter::LPfilterJob jobs[4];
+            _ParvoRetinaFilter.getLocalAdaptationLPfilterJobs(jobs);
+            _MagnoRetinaFilter.getAmacrineCellsLPfilterJobs(jobs+2);
+            BasicRetinaFilter::runLPfilterJobs(jobs, 4, _ParvoRetinaFilter.getNBrows(), _ParvoRetinaFilter.getNBcolumns());
+
+            _ParvoRetinaFilter.runIPLfilter();
+            _MagnoRetinaFilter.runGanglionCellsFilter();
+        }
+        else
+            _ParvoRetinaFilter.runFilter(_photoreceptorsPrefilter.getOutput(), _useParvoOutput);
 
         if (_useParvoOutput)
         {
@@ -320,7 +336,6 @@ namespace bioinspired
 
         if (_useParvoOutput&&_useMagnoOutput)
         {
-            _MagnoRetinaFilter.runFilter(_ParvoRetinaFilter.getBipolarCellsON(), _ParvoRetinaFilter.getBipolarCellsOFF());
             if (_normalizeMagnoOutput_0_maxOutputValue)
             {
                 _MagnoRetinaFilter.normalizeGrayOutput_0_maxOutputValue(_maxOutputValue);
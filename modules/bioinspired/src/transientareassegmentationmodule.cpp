@@ -431,11 +431,18 @@ void TransientAreasSegmentationModuleImpl::run(InputArray inputToProcess, const
     typedef float T; // define here the target pixel format, here, float
     const int dsttype = cv::DataType<T>::depth; // output buffer is float format
     cv::Mat dst(inputToSegment.size(), dsttype, &_inputToSegment[0]);
-    inputToSegment.convertTo(dst, dsttype);
+    if (inputToSegment.channels()>1)
+    {
+        // only the selected channel is converted, the internal buffer is single channel
+        cv::extractChannel(inputToSegment, _conversionBuffer, channelIndex);
+        _conversionBuffer.convertTo(dst, dsttype);
+    }
+    else
+        inputToSegment.convertTo(dst, dsttype);
     //cv::imshow("Mask",dst);
     //cv::waitKey();
     // call the low level method
-    _run(_inputToSegment, channelIndex);
+    _run(_inputToSegment);
 }
 
 void TransientAreasSegmentationModuleImpl::_run(const std::valarray<float> &inputToSegment, const int channelIndex)
@@ -450,55 +457,38 @@ void TransientAreasSegmentationModuleImpl::_run(const std::valarray<float> &inpu
 
     // first square the input in order to increase the signal to noise ratio
     // get motion local energy
-    _squaringSpatiotemporalLPfilter(&const_cast<std::valarray<float>&>(inputToSegment)[channelIndex*getNBpixels()], &_localMotion[0]);
-
-    // second low pass filter: access to the neighborhood motion energy
-    _spatiotemporalLPfilter(&_localMotion[0], &_neighborhoodMotion[0], 1);
-
-    // third low pass filter: access to the background motion energy
-    _spatiotemporalLPfilter(&_localMotion[0], &_contextMotionEnergy[0], 2);
-
-    // compute the ON and OFF ways (positive and negative values of the difference of the two filterings)
-    float*localMotionPTR=&_localMotion[0], *neighborhoodMotionPTR=&_neighborhoodMotion[0], *contextMotionPTR=&_contextMotionEnergy[0];
-
-    // float meanEnergy=LPfilter2.sum()/(float)_LPfilter2.size();
-    bool *segmentationPicturePTR= &_segmentedAreas[0];
-    for (unsigned int index=0; index<_filterOutput.getNBpixels() ; ++index, ++segmentationPicturePTR, ++localMotionPTR, ++neighborhoodMotionPTR, contextMotionPTR++)
+    LPfilterJob localMotionJob=getLPfilterJob(&inputToSegment[channelIndex*getNBpixels()], &_localMotion[0], 0);
+    localMotionJob.squareInput=true;
+    runLPfilterJobs(&localMotionJob, 1, getNBrows(), getNBcolumns());
+
+    // second and third low pass filters: access to the neighborhood and to the background motion energy
+    // they only depend on the local motion energy, then they are run as a single stage
+    const LPfilterJob integrationJobs[2]={getLPfilterJob(&_localMotion[0], &_neighborhoodMotion[0], 1),
+                                          getLPfilterJob(&_localMotion[0], &_contextMotionEnergy[0], 2)};
+    runLPfilterJobs(integrationJobs, 2, getNBrows(), getNBcolumns());
+
+    // compute the segmentation decision, rows are processed in parallel
+    const float *localMotion=&_localMotion[0], *neighborhoodMotion=&_neighborhoodMotion[0], *contextMotion=&_contextMotionEnergy[0];
+    bool *segmentationPicture=&_segmentedAreas[0];
+    const float thresholdON=_segmentationParameters.thresholdON;
+    const unsigned int nbColumns=getNBcolumns();
+
+    cv::parallel_for_(cv::Range(0, (int)getNBrows()), [&](const cv::Range& range)
     {
-        float generalMotionContextDecision=*neighborhoodMotionPTR-*contextMotionPTR;
-
-        if (generalMotionContextDecision>0) // local maximum should be detected in this case
+        const unsigned int start=range.start*nbColumns, end=range.end*nbColumns;
+        for (unsigned int index=start; index<end; ++index)
         {
-            /* apply segmentation on local motion superior to its neighborhood
+            const float generalMotionContextDecision=neighborhoodMotion[index]-contextMotion[index];
+
+            /* local maximum should be detected if the neighborhood is more active than the context,
+             * then apply segmentation on local motion superior to its neighborhood
              * => to segment objects moving faster than their neighborhood
              */
-            if (generalMotionContextDecision>_segmentationParameters.thresholdON)// && meanEnergy*1.1<*neighborhoodMotionPTR)
-            {
-                *segmentationPicturePTR=((*localMotionPTR-*neighborhoodMotionPTR)>_segmentationParameters.thresholdON);
-            }
-            else
-                *segmentationPicturePTR=false;
+            segmentationPicture[index]=(generalMotionContextDecision>0)
+                                     &&(generalMotionContextDecision>thresholdON)
+                                     &&((localMotion[index]-neighborhoodMotion[index])>thresholdON);
         }
-#ifdef USE_LOCALMINIMUMS
-        else  // local minimum should be detected in this case
-        {
-            /* apply segmentation for non moving objects
-             * only if the wide area around motion energy is high
-             * => to segment object moving slower than the neighborhood
-             */
-            if (-1.0*generalMotionContextDecision>_segmentationParameters.thresholdOFF && meanEnergy*0.9>*neighborhoodMotionPTR)
-            {
-                /* in order to segment non moving objects in a camera motion case
-                 * we focus on local energy which is much lower than the wide neighborhood
-                 */
-                *segmentationPicturePTR+=(*neighborhoodMotionPTR-*localMotionPTR>_segmentationParameters.thresholdOFF)*127;
-            }
-        }
-#else
-        else
-            *segmentationPicturePTR=false;
-#endif
-    }
+    });
     /*
 #ifdef SEGMENTATIONDEBUG
     std::cout<<"ON: max, min="<<_localMotionON.min()<<", "<<_localMotionON.max();
@@ -525,11 +515,9 @@ void TransientAreasSegmentationModuleImpl::_convertValarrayBuffer2cvMat(const st
     Mat outMat = outBuffer.getMat();
     for (unsigned int i=0;i<nbRows;++i)
     {
+        unsigned char *outPTR=outMat.ptr<unsigned char>(i);
         for (unsigned int j=0;j<nbColumns;++j)
-        {
-            cv::Point2d pixel(j,i);
-            outMat.at<unsigned char>(pixel)=(unsigned char)*(valarrayPTR++);
-        }
+            *(outPTR++)=(unsigned char)*(valarrayPTR++);
     }
 }
 
@@ -0,0 +1,103 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+/** A high dynamic range frame: a dark to bright ramp with a few very bright spots */
+static Mat makeHdrFrame(const Size& size, bool colorMode)
+{
+    Mat_<Vec3f> frame(size);
+    for (int y = 0; y < size.height; y++)
+        for (int x = 0; x < size.width; x++)
+        {
+            float v = 1.f + 500.f * x / size.width + 50.f * y / size.height;
+            if ((x / 8 + y / 8) % 5 == 0)
+                v *= 8.f;
+            frame(y, x) = Vec3f(v, 0.8f * v, 0.6f * v);
+        }
+    if (colorMode)
+        return frame;
+    Mat planes[3];
+    split(frame, planes);
+    return planes[0];
+}
+
+static Mat toneMapFirstFrame(const Mat& input)
+{
+    Ptr<bioinspired::RetinaFastToneMapping> toneMapper = bioinspired::RetinaFastToneMapping::create(input.size());
+    toneMapper->setTemporalConstant(2.f);
+    Mat output;
+    toneMapper->applyFastToneMapping(input, output);
+    return output;
+}
+
+typedef testing::TestWithParam<bool> RetinaFastToneMapping_Stream;
+
+TEST_P(RetinaFastToneMapping_Stream, converges_on_constant_input)
+{
+    const Mat input = makeHdrFrame(Size(64, 48), GetParam());
+    Ptr<bioinspired::RetinaFastToneMapping> toneMapper = bioinspired::RetinaFastToneMapping::create(input.size());
+    toneMapper->setTemporalConstant(2.f);
+    EXPECT_EQ(2.f, toneMapper->getTemporalConstant());
+
+    Mat first, previous, output;
+    toneMapper->applyFastToneMapping(input, first);
+    first.copyTo(output);
+    for (int i = 0; i < 60; i++)
+    {
+        output.copyTo(previous);
+        toneMapper->applyFastToneMapping(input, output);
+    }
+    // the adaptation state starts from zero, so the smoothing has to show on the first frames...
+    EXPECT_GT(cvtest::norm(first, output, NORM_INF), 0);
+    // ...and it settles to a fixed point
+    EXPECT_EQ(0, cvtest::norm(previous, output, NORM_INF));
+}
+
+TEST_P(RetinaFastToneMapping_Stream, clearBuffers_restores_first_frame)
+{
+    const Mat input = makeHdrFrame(Size(64, 48), GetParam());
+    const Mat other = makeHdrFrame(Size(64, 48), GetParam()) * 0.1;
+    const Mat expected = toneMapFirstFrame(input);
+
+    Ptr<bioinspired::RetinaFastToneMapping> toneMapper = bioinspired::RetinaFastToneMapping::create(input.size());
+    toneMapper->setTemporalConstant(2.f);
+    Mat output;
+    for (int i = 0; i < 10; i++)
+        toneMapper->applyFastToneMapping(other, output);
+    toneMapper->clearBuffers();
+    toneMapper->applyFastToneMapping(input, output);
+
+    EXPECT_EQ(0, cvtest::norm(expected, output, NORM_INF));
+}
+
+TEST_P(RetinaFastToneMapping_Stream, size_change_resets_state)
+{
+    const Mat small = makeHdrFrame(Size(64, 48), GetParam());
+    const Mat large = makeHdrFrame(Size(96, 80), GetParam());
+
+    Ptr<bioinspired::RetinaFastToneMapping> toneMapper = bioinspired::RetinaFastToneMapping::create(small.size());
+    toneMapper->setTemporalConstant(2.f);
+    Mat output;
+    for (int i = 0; i < 10; i++)
+        toneMapper->applyFastToneMapping(small, output);
+
+    toneMapper->applyFastToneMapping(large, output);
+    ASSERT_EQ(large.size(), output.size());
+    EXPECT_EQ(0, cvtest::norm(toneMapFirstFrame(large), output, NORM_INF));
+    // the setup survives the reallocation
+    EXPECT_EQ(2.f, toneMapper->getTemporalConstant());
+
+    for (int i = 0; i < 10; i++)
+        toneMapper->applyFastToneMapping(large, output);
+    toneMapper->applyFastToneMapping(small, output);
+    ASSERT_EQ(small.size(), output.size());
+    EXPECT_EQ(0, cvtest::norm(toneMapFirstFrame(small), output, NORM_INF));
+}
+
+INSTANTIATE_TEST_CASE_P(Bioinspired, RetinaFastToneMapping_Stream, testing::Bool());
+
+}} // namespace
@@ -8,6 +8,7 @@
 #include "opencv2/img_hash/average_hash.hpp"
 #include "opencv2/img_hash/block_mean_hash.hpp"
 #include "opencv2/img_hash/color_moment_hash.hpp"
+#include "opencv2/img_hash/hash_index.hpp"
 #include "opencv2/img_hash/marr_hildreth_hash.hpp"
 #include "opencv2/img_hash/phash.hpp"
 #include "opencv2/img_hash/radial_variance_hash.hpp"
@@ -0,0 +1,65 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef OPENCV_HASH_INDEX_HPP
+#define OPENCV_HASH_INDEX_HPP
+
+#include "img_hash_base.hpp"
+
+namespace cv {
+namespace img_hash {
+
+//! @addtogroup img_hash
+//! @{
+
+/** @brief Index of image hashes for the near-duplicate search.
+
+The hashes compared with the Hamming distance (AverageHash, PHash, BlockMeanHash and
+MarrHildrethHash) are indexed with multi-index hashing: every hash is split into numTables
+substrings, each substring is the key of its own hash table. A hash within the distance r of the
+query has at least one substring within the distance r / numTables of the corresponding substring
+of the query, so only the buckets around the query substrings have to be checked.
+
+The hashes of ColorMomentHash are searched exhaustively with a vectorized L2 distance, the hashes
+of RadialVarianceHash are compared in parallel with RadialVarianceHash::compare.
+*/
+class CV_EXPORTS_W HashIndex : public Algorithm
+{
+public:
+    /** @brief Creates an empty index
+        @param algorithm the algorithm which computed the hashes
+        @param numTables the number of substrings of the binary hashes, 0 selects 16-bit substrings.
+        Not used by the other hashes.
+    */
+    CV_WRAP static Ptr<HashIndex> create(const Ptr<ImgHashBase>& algorithm, int numTables = 0);
+
+    /** @brief Adds hashes to the index
+        @param hashes hashes computed by the algorithm, one hash per row (e.g. the output of
+        ImgHashBase::computeBatch). They get the indices following the ones already in the index.
+    */
+    CV_WRAP virtual void add(InputArray hashes) = 0;
+
+    /** @brief Removes all the hashes from the index */
+    CV_WRAP virtual void clear() = 0;
+
+    /** @brief Returns the number of the hashes in the index */
+    CV_WRAP virtual int size() const = 0;
+
+    /** @brief Finds the hashes similar to the query
+        @param hash the query hash
+        @param threshold the maximal value of ImgHashBase::compare for the returned hashes, for
+        RadialVarianceHash it is the minimal peak correlation
+        @param indices the indices of the found hashes, the most similar first
+        @param distances the values of ImgHashBase::compare for the found hashes
+    */
+    CV_WRAP virtual void radiusSearch(InputArray hash, double threshold,
+                                      CV_OUT std::vector<int>& indices,
+                                      CV_OUT std::vector<double>& distances) const = 0;
+};
+
+//! @}
+
+}} // cv::img_hash::
+
+#endif // OPENCV_HASH_INDEX_HPP
@@ -26,6 +26,14 @@ public:
         @param outputArr hash of the image
     */
     CV_WRAP void compute(cv::InputArray inputArr, cv::OutputArray outputArr);
+    /** @brief Computes hashes of several images in parallel
+        @param inputArrs input images want to compute hash values
+        @param outputArr hashes of the images, the i-th row is the hash of the i-th image
+
+        Each worker thread uses its own copy of the algorithm state, so the result is the
+        same as calling compute() for every image.
+    */
+    CV_WRAP void computeBatch(cv::InputArrayOfArrays inputArrs, cv::OutputArray outputArr);
     /** @brief Compare the hash value between inOne and inTwo
         @param hashOne Hash value one
         @param hashTwo Hash value two
@@ -78,6 +78,11 @@ public:
         return norm(hashOne, hashTwo, NORM_HAMMING);
     }
 
+    virtual Ptr<ImgHashBase::ImgHashImpl> clone() const CV_OVERRIDE
+    {
+        return makePtr<BlockMeanHashImpl>(mode_);
+    }
+
     void setMode(int mode)
     {
         CV_Assert(mode == BLOCK_MEAN_HASH_MODE_0 || mode == BLOCK_MEAN_HASH_MODE_1);
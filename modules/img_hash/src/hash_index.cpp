@@ -0,0 +1,331 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+
+#include "opencv2/core/hal/hal.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+using namespace cv;
+using namespace cv::img_hash;
+using namespace std;
+
+namespace {
+
+enum HashKind
+{
+    HASH_HAMMING,     //!< binary hashes compared with the Hamming distance
+    HASH_L2,          //!< ColorMomentHash
+    HASH_CORRELATION  //!< RadialVarianceHash, the higher the more similar
+};
+
+typedef std::unordered_map<uint64, std::vector<int> > SubstringTable;
+
+void collectNeighbours(SubstringTable const &table, uint64 key, int nbits, int firstBit, int radius,
+                       std::vector<int> &candidates)
+{
+    SubstringTable::const_iterator const it = table.find(key);
+    if(it != table.end())
+    {
+        candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+    }
+    if(radius == 0)
+    {
+        return;
+    }
+    //every key within the radius is visited once: the bits are flipped in increasing order
+    for(int bit = firstBit; bit < nbits; ++bit)
+    {
+        collectNeighbours(table, key ^ (uint64(1) << bit), nbits, bit + 1, radius - 1, candidates);
+    }
+}
+
+double countNeighbours(int nbits, int radius)
+{
+    double count = 0, binomial = 1;
+    for(int k = 0; k <= radius && k <= nbits; ++k)
+    {
+        count += binomial;
+        binomial = binomial * (nbits - k) / (k + 1);
+    }
+    return count;
+}
+
+class HashIndexImpl CV_FINAL : public HashIndex
+{
+public:
+    HashIndexImpl(const Ptr<ImgHashBase> &algorithm, int numTables)
+        : algorithm_(algorithm), kind_(HASH_HAMMING), numTables_(numTables)
+    {
+        CV_Assert(algorithm_);
+        CV_Assert(numTables_ >= 0);
+        if(algorithm_.dynamicCast<ColorMomentHash>())
+        {
+            kind_ = HASH_L2;
+        }
+        else if(algorithm_.dynamicCast<RadialVarianceHash>())
+        {
+            kind_ = HASH_CORRELATION;
+        }
+    }
+
+    virtual void add(cv::InputArray hashesArr) CV_OVERRIDE
+    {
+        cv::Mat hashes = hashesArr.getMat();
+        if(hashes.empty())
+        {
+            return;
+        }
+        CV_Assert(hashes.dims == 2 && hashes.channels() == 1);
+        CV_Assert(kind_ == HASH_L2 ? hashes.depth() == CV_64F : hashes.depth() == CV_8U);
+        if(kind_ == HASH_L2)
+        {
+            //batchDistance works with floats
+            hashes.convertTo(hashes, CV_32F);
+        }
+
+        if(hashes_.empty())
+        {
+            initTables(hashes.cols);
+        }
+        else
+        {
+            CV_Assert(hashes.cols == hashes_.cols);
+        }
+
+        int const first = hashes_.rows;
+        hashes_.push_back(hashes);
+        if(kind_ != HASH_HAMMING)
+        {
+            return;
+        }
+
+        for(int i = 0; i < hashes.rows; ++i)
+        {
+            uchar const *hash = hashes.ptr<uchar>(i);
+            for(size_t t = 0; t < tables_.size(); ++t)
+            {
+                tables_[t][substring(hash, (int)t)].push_back(first + i);
+            }
+        }
+    }
+
+    virtual void clear() CV_OVERRIDE
+    {
+        hashes_.release();
+        tables_.clear();
+        chunkStart_.clear();
+    }
+
+    virtual int size() const CV_OVERRIDE
+    {
+        return hashes_.rows;
+    }
+
+    virtual bool empty() const CV_OVERRIDE
+    {
+        return hashes_.empty();
+    }
+
+    virtual void radiusSearch(cv::InputArray hashArr, double threshold,
+                              std::vector<int> &indices, std::vector<double> &distances) const CV_OVERRIDE
+    {
+        indices.clear();
+        distances.clear();
+        if(hashes_.empty())
+        {
+            return;
+        }
+
+        cv::Mat query = hashArr.getMat();
+        CV_Assert(query.total() == (size_t)hashes_.cols && query.channels() == 1);
+        if(kind_ == HASH_L2)
+        {
+            CV_Assert(query.depth() == CV_64F);
+            query.reshape(1, 1).convertTo(query, CV_32F);
+        }
+        else
+        {
+            CV_Assert(query.depth() == CV_8U);
+            query = query.reshape(1, 1).clone();
+        }
+
+        std::vector<std::pair<double, int> > found;
+        switch(kind_)
+        {
+        case HASH_HAMMING:
+            searchHamming(query, threshold, found);
+            break;
+        case HASH_L2:
+            searchL2(query, threshold, found);
+            break;
+        case HASH_CORRELATION:
+            searchCorrelation(query, threshold, found);
+            break;
+        }
+
+        if(kind_ == HASH_CORRELATION)
+        {
+            for(size_t i = 0; i < found.size(); ++i)
+            {
+                found[i].first = -found[i].first;
+            }
+        }
+        std::sort(found.begin(), found.end());
+
+        indices.resize(found.size());
+        distances.resize(found.size());
+        for(size_t i = 0; i < found.size(); ++i)
+        {
+            indices[i] = found[i].second;
+            distances[i] = kind_ == HASH_CORRELATION ? -found[i].first : found[i].first;
+        }
+    }
+
+private:
+    void initTables(int hashBytes)
+    {
+        int const numTables = numTables_ > 0 ? numTables_ : (hashBytes + 1) / 2;
+        if(kind_ == HASH_HAMMING)
+        {
+            CV_Assert(numTables <= hashBytes);
+            CV_Assert((hashBytes + numTables - 1) / numTables <= (int)sizeof(uint64));
+        }
+        else
+        {
+            return;
+        }
+
+        chunkStart_.resize(numTables + 1);
+        for(int t = 0; t <= numTables; ++t)
+        {
+            chunkStart_[t] = t * hashBytes / numTables;
+        }
+        tables_.assign(numTables, SubstringTable());
+    }
+
+    uint64 substring(uchar const *hash, int table) const
+    {
+        uint64 key = 0;
+        for(int i = chunkStart_[table]; i < chunkStart_[table + 1]; ++i)
+        {
+            key = (key << 8) | hash[i];
+        }
+        return key;
+    }
+
+    void searchHamming(cv::Mat const &query, double threshold, std::vector<std::pair<double, int> > &found) const
+    {
+        if(threshold < 0)
+        {
+            return;
+        }
+        int const radius = std::min(cvFloor(threshold), hashes_.cols * 8);
+        int const numTables = (int)tables_.size();
+        int const subRadius = radius / numTables;
+        uchar const *queryPtr = query.ptr<uchar>(0);
+
+        double lookups = 0;
+        for(int t = 0; t < numTables; ++t)
+        {
+            lookups += countNeighbours(8 * (chunkStart_[t + 1] - chunkStart_[t]), subRadius);
+        }
+
+        std::vector<int> candidates;
+        if(lookups < hashes_.rows)
+        {
+            for(int t = 0; t < numTables; ++t)
+            {
+                int const nbits = 8 * (chunkStart_[t + 1] - chunkStart_[t]);
+                collectNeighbours(tables_[t], substring(queryPtr, t), nbits, 0, std::min(subRadius, nbits),
+                                  candidates);
+            }
+            std::sort(candidates.begin(), candidates.end());
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+            for(size_t i = 0; i < candidates.size(); ++i)
+            {
+                int const distance = cv::hal::normHamming(queryPtr, hashes_.ptr<uchar>(candidates[i]), hashes_.cols);
+                if(distance <= radius)
+                {
+                    found.push_back(std::make_pair((double)distance, candidates[i]));
+                }
+            }
+        }
+        else
+        {
+            //the radius is too large for the tables, a linear scan is cheaper
+            cv::Mutex mtx;
+            cv::parallel_for_(cv::Range(0, hashes_.rows), [&](const cv::Range &range)
+            {
+                std::vector<std::pair<double, int> > localFound;
+                for(int i = range.start; i < range.end; ++i)
+                {
+                    int const distance = cv::hal::normHamming(queryPtr, hashes_.ptr<uchar>(i), hashes_.cols);
+                    if(distance <= radius)
+                    {
+                        localFound.push_back(std::make_pair((double)distance, i));
+                    }
+                }
+                cv::AutoLock lock(mtx);
+                found.insert(found.end(), localFound.begin(), localFound.end());
+            });
+        }
+    }
+
+    void searchL2(cv::Mat const &query, double threshold, std::vector<std::pair<double, int> > &found) const
+    {
+        cv::Mat dist;
+        cv::batchDistance(query, hashes_, dist, CV_32F, cv::noArray(), NORM_L2);
+        float const *distPtr = dist.ptr<float>(0);
+        for(int i = 0; i < hashes_.rows; ++i)
+        {
+            //the same scale as ColorMomentHash::compare
+            double const distance = distPtr[i] * 10000.0;
+            if(distance <= threshold)
+            {
+                found.push_back(std::make_pair(distance, i));
+            }
+        }
+    }
+
+    void searchCorrelation(cv::Mat const &query, double threshold, std::vector<std::pair<double, int> > &found) const
+    {
+        cv::Mutex mtx;
+        cv::parallel_for_(cv::Range(0, hashes_.rows), [&](const cv::Range &range)
+        {
+            std::vector<std::pair<double, int> > localFound;
+            for(int i = range.start; i < range.end; ++i)
+            {
+                double const correlation = algorithm_->compare(query, hashes_.row(i));
+                if(correlation >= threshold)
+                {
+                    localFound.push_back(std::make_pair(correlation, i));
+                }
+            }
+            cv::AutoLock lock(mtx);
+            found.insert(found.end(), localFound.begin(), localFound.end());
+        });
+    }
+
+    Ptr<ImgHashBase> algorithm_;
+    HashKind kind_;
+    int numTables_;
+    cv::Mat hashes_;
+    std::vector<int> chunkStart_;
+    std::vector<SubstringTable> tables_;
+};
+
+}
+
+namespace cv { namespace img_hash {
+
+Ptr<HashIndex> HashIndex::create(const Ptr<ImgHashBase>& algorithm, int numTables)
+{
+    return makePtr<HashIndexImpl>(algorithm, numTables);
+}
+
+} } // cv::img_hash::
@@ -20,6 +20,31 @@ void ImgHashBase::compute(cv::InputArray inputArr, cv::OutputArray outputArr)
     pImpl->compute(inputArr, outputArr);
 }
 
+void ImgHashBase::computeBatch(cv::InputArrayOfArrays inputArrs, cv::OutputArray outputArr)
+{
+    std::vector<cv::Mat> inputs;
+    inputArrs.getMatVector(inputs);
+    if(inputs.empty())
+    {
+        outputArr.release();
+        return;
+    }
+
+    std::vector<cv::Mat> hashes(inputs.size());
+    // one stripe per thread, so the buffers of every clone are reused for several images
+    int const nstripes = std::min((int)inputs.size(), std::max(cv::getNumThreads(), 1));
+    cv::parallel_for_(cv::Range(0, (int)inputs.size()), [&](const cv::Range& range)
+    {
+        Ptr<ImgHashImpl> impl = pImpl->clone();
+        for(int i = range.start; i < range.end; ++i)
+        {
+            impl->compute(inputs[i], hashes[i]);
+        }
+    }, nstripes);
+
+    cv::vconcat(hashes, outputArr);
+}
+
 double ImgHashBase::compare(cv::InputArray hashOne, cv::InputArray hashTwo) const
 {
     return pImpl->compare(hashOne, hashTwo);
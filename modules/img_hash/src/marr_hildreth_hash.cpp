@@ -129,6 +129,11 @@ public:
         return norm(hashOne, hashTwo, NORM_HAMMING);
     }
 
+    virtual Ptr<ImgHashBase::ImgHashImpl> clone() const CV_OVERRIDE
+    {
+        return makePtr<MarrHildrethHashImpl>(alphaVal, scaleVal);
+    }
+
     float getAlpha() const
     {
         return alphaVal;
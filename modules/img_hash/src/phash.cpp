@@ -55,6 +55,11 @@ public:
         return norm(hashOne, hashTwo, NORM_HAMMING);
     }
 
+    virtual Ptr<ImgHashBase::ImgHashImpl> clone() const CV_OVERRIDE
+    {
+        return makePtr<PHashImpl>();
+    }
+
 private:
     cv::Mat bitsImg;
     cv::Mat dctImg;
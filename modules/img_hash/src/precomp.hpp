@@ -21,6 +21,8 @@ class ImgHashBase::ImgHashImpl
 public:
     virtual void compute(cv::InputArray inputArr, cv::OutputArray outputArr) = 0;
     virtual double compare(cv::InputArray hashOne, cv::InputArray hashTwo) const = 0;
+    //! creates an implementation with the same parameters and its own buffers
+    virtual Ptr<ImgHashImpl> clone() const = 0;
     virtual ~ImgHashImpl() {}
 };
 
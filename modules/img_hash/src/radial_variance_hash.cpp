@@ -111,6 +111,11 @@ public:
         return max;
     }
 
+    virtual Ptr<ImgHashBase::ImgHashImpl> clone() const CV_OVERRIDE
+    {
+        return makePtr<RadialVarianceHashImpl>(sigma_, numOfAngelLine_);
+    }
+
     int getNumOfAngleLine() const
     {
         return numOfAngelLine_;
@@ -0,0 +1,86 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+static std::vector<cv::Mat> makeImages(int count)
+{
+    cv::RNG rng(0);
+    std::vector<cv::Mat> images(count);
+    for(int i = 0; i != count; ++i)
+    {
+        images[i].create(64, 64, CV_8UC3);
+        rng.fill(images[i], cv::RNG::UNIFORM, 0, 256);
+    }
+    return images;
+}
+
+TEST(img_hash_batch, matches_compute)
+{
+    std::vector<cv::Mat> const images = makeImages(16);
+    cv::Ptr<cv::img_hash::ImgHashBase> const hashers[] =
+    {
+        cv::img_hash::AverageHash::create(),
+        cv::img_hash::PHash::create(),
+        cv::img_hash::BlockMeanHash::create(),
+        cv::img_hash::ColorMomentHash::create()
+    };
+    for(size_t h = 0; h != sizeof(hashers) / sizeof(hashers[0]); ++h)
+    {
+        cv::Mat batch;
+        hashers[h]->computeBatch(images, batch);
+        ASSERT_EQ((int)images.size(), batch.rows);
+        for(size_t i = 0; i != images.size(); ++i)
+        {
+            cv::Mat hash;
+            hashers[h]->compute(images[i], hash);
+            EXPECT_EQ(0, cvtest::norm(hash, batch.row((int)i), NORM_INF));
+        }
+    }
+}
+
+TEST(img_hash_index, radius_search)
+{
+    std::vector<cv::Mat> const images = makeImages(32);
+    cv::Ptr<cv::img_hash::ImgHashBase> const hasher = cv::img_hash::PHash::create();
+    cv::Mat hashes;
+    hasher->computeBatch(images, hashes);
+
+    cv::Ptr<cv::img_hash::HashIndex> const index = cv::img_hash::HashIndex::create(hasher);
+    index->add(hashes);
+    ASSERT_EQ(hashes.rows, index->size());
+
+    for(int i = 0; i != hashes.rows; ++i)
+    {
+        for(double threshold = 0; threshold <= 16; threshold += 4)
+        {
+            std::vector<int> indices;
+            std::vector<double> distances;
+            index->radiusSearch(hashes.row(i), threshold, indices, distances);
+            ASSERT_FALSE(indices.empty());
+            EXPECT_EQ(i, indices[0]);
+            EXPECT_EQ(0, distances[0]);
+
+            //the index has to return exactly the hashes a linear scan finds
+            std::vector<int> expected;
+            for(int j = 0; j != hashes.rows; ++j)
+            {
+                if(hasher->compare(hashes.row(i), hashes.row(j)) <= threshold)
+                {
+                    expected.push_back(j);
+                }
+            }
+            std::vector<int> sortedIndices = indices;
+            std::sort(sortedIndices.begin(), sortedIndices.end());
+            EXPECT_EQ(expected, sortedIndices);
+        }
+    }
+
+    index->clear();
+    EXPECT_EQ(0, index->size());
+}
+
+}} // namespace
@@ -34,6 +34,26 @@ public:
     */
     virtual CV_WRAP cv::Scalar compute( InputArray img ) = 0;
 
+    /**
+    @brief Compute quality scores for a batch of images
+    @param imgs comparison images, or images to evaluate for no-reference quality algorithms
+    @param scores output vector of cv::Scalar (CV_64FC4) with the per-channel score of each image, in the order of imgs
+
+    Algorithms which support it score the images in parallel and do not generate the quality map.  The default
+    implementation calls compute() for each image.
+    */
+    virtual CV_WRAP void computeBatch( InputArrayOfArrays imgs, OutputArray scores )
+    {
+        std::vector<cv::Mat> mats;
+        imgs.getMatVector(mats);
+
+        std::vector<cv::Scalar> result(mats.size());
+        for (size_t i = 0; i < mats.size(); ++i)
+            result[i] = compute(mats[i]);
+
+        cv::Mat(result).copyTo(scores);
+    }
+
     /** @brief Returns output quality map that was generated during computation, if supported by the algorithm  */
     virtual CV_WRAP void getQualityMap(OutputArray dst) const
     {
@@ -32,6 +32,12 @@ public:
     */
     CV_WRAP cv::Scalar compute( InputArray img ) CV_OVERRIDE;
 
+    /** @brief Computes BRISQUE quality scores for a batch of images, in parallel
+    @param imgs Images for which to compute quality
+    @param scores output vector of cv::Scalar (CV_64FC4) with the score of each image in the first element
+    */
+    CV_WRAP void computeBatch( InputArrayOfArrays imgs, OutputArray scores ) CV_OVERRIDE;
+
     /**
     @brief Create an object which calculates quality
     @param model_file_path cv::String which contains a path to the BRISQUE model data, eg. /path/to/brisque_model_live.yml
@@ -24,6 +24,13 @@ public:
     */
     CV_WRAP cv::Scalar compute( InputArrayOfArrays cmpImgs ) CV_OVERRIDE;
 
+    /**
+    @brief Computes MSE for a batch of comparison images against the reference, in parallel
+    @param cmpImgs comparison images
+    @param scores output vector of cv::Scalar (CV_64FC4) with per-channel quality values of each image.  The quality map is not generated
+    */
+    CV_WRAP void computeBatch( InputArrayOfArrays cmpImgs, OutputArray scores ) CV_OVERRIDE;
+
     /** @brief Implements Algorithm::empty()  */
     CV_WRAP bool empty() const CV_OVERRIDE { return _ref.empty() && QualityBase::empty(); }
 
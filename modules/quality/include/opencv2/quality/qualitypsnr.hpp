@@ -55,6 +55,20 @@ public:
         );
     }
 
+    /**
+    @brief Compute the PSNR for a batch of comparison images, in parallel
+    @param cmpImgs comparison images
+    @param scores output vector of cv::Scalar (CV_64FC4) with per-channel PSNR values of each image.  The quality map is not generated
+    */
+    CV_WRAP void computeBatch( InputArrayOfArrays cmpImgs, OutputArray scores ) CV_OVERRIDE
+    {
+        std::vector<cv::Scalar> result;
+        _qualityMSE->computeBatch(cmpImgs, result);
+        for (auto& score : result)
+            score = _mse_to_psnr(score, _maxPixelValue);
+        cv::Mat(result).copyTo(scores);
+    }
+
     /** @brief Implements Algorithm::empty()  */
     CV_WRAP bool empty() const CV_OVERRIDE { return _qualityMSE->empty() && QualityBase::empty(); }
 
@@ -26,6 +26,13 @@ public:
     */
     CV_WRAP cv::Scalar compute( InputArray cmp ) CV_OVERRIDE;
 
+    /**
+    @brief Computes SSIM for a batch of comparison images against the reference, in parallel
+    @param cmpImgs comparison images
+    @param scores output vector of cv::Scalar (CV_64FC4) with per-channel quality values of each image.  The quality map is not generated
+    */
+    CV_WRAP void computeBatch( InputArrayOfArrays cmpImgs, OutputArray scores ) CV_OVERRIDE;
+
     /** @brief Implements Algorithm::empty()  */
     CV_WRAP bool empty() const CV_OVERRIDE { return _refImgData.empty() && QualityBase::empty(); }
 
@@ -78,6 +85,9 @@ protected:
         // computes ssim and quality map for single frame
         static std::pair<cv::Scalar, mat_type> compute(const _mat_data& lhs, const _mat_data& rhs);
 
+        // computes the score for a single frame without generating the quality map
+        static cv::Scalar compute_score(const _mat_data& lhs, const _mat_data& rhs);
+
     };  // mat_data
 
     /** @brief Reference image data */
@@ -4,5 +4,66 @@
 #ifndef OPENCV_QUALITY_PRECOMP_HPP
 #define OPENCV_QUALITY_PRECOMP_HPP
 #include <opencv2/core.hpp>
+#include "opencv2/core/ocl.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 #include "opencv2/quality/qualitybase.hpp"
-#endif
\ No newline at end of file
+
+namespace cv
+{
+namespace quality
+{
+namespace detail
+{
+
+// runs fn(i) for every image of a batch
+//  images are scored in parallel on the CPU; with OpenCL, the device queue serializes the work anyway
+template <typename Fn>
+inline void for_each_image(int count, Fn&& fn)
+{
+    const auto body = [&](const cv::Range& range)
+    {
+        for (int i = range.start; i < range.end; ++i)
+            fn(i);
+    };
+
+    if (cv::ocl::useOpenCL())
+        body(cv::Range(0, count));
+    else
+        cv::parallel_for_(cv::Range(0, count), body);
+}
+
+// sum of a per-element expression over an image, without materializing the expression
+//  row_fn(y, acc) accumulates row y into acc.  rows run in parallel, per-row sums are reduced serially
+//  so that the result does not depend on the number of threads
+template <typename Acc, typename RowFn>
+inline Acc parallel_row_sum(int rows, RowFn&& row_fn)
+{
+    std::vector<Acc> row_sums(rows, Acc());
+    cv::parallel_for_(cv::Range(0, rows), [&](const cv::Range& range)
+    {
+        for (int y = range.start; y < range.end; ++y)
+            row_fn(y, row_sums[y]);
+    });
+
+    Acc result = Acc();
+    for (const auto& s : row_sums)
+        result += s;
+    return result;
+}
+
+#if CV_SIMD128
+// adds the lanes of a float accumulator to per-channel sums
+//  valid when the accumulated elements start at a multiple of 4 and 4 % cn == 0, so that lane k holds channel k % cn
+inline void add_lanes(const v_float32x4& acc, int cn, cv::Scalar& sums)
+{
+    float CV_DECL_ALIGNED(16) buf[4];
+    v_store_aligned(buf, acc);
+    for (int k = 0; k < 4; ++k)
+        sums[k % cn] += buf[k];
+}
+#endif
+
+}   // detail
+}   // quality
+}   // cv
+#endif
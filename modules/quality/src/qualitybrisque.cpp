@@ -277,6 +277,20 @@ cv::Scalar QualityBRISQUE::compute( InputArray img )
     return ::compute(this->_model, this->_range, mat );
 }
 
+void QualityBRISQUE::computeBatch( InputArrayOfArrays imgs, OutputArray scores )
+{
+    std::vector<brisque_mat_type> mats;
+    imgs.getMatVector(mats);
+
+    std::vector<cv::Scalar> result(mats.size());
+    quality::detail::for_each_image((int)mats.size(), [&](int i)
+    {
+        result[i] = ::compute(this->_model, this->_range, mat_convert(quality_utils::extract_mat<brisque_mat_type>(mats[i])));
+    });
+
+    cv::Mat(result).copyTo(scores);
+}
+
 //static
 void QualityBRISQUE::computeFeatures(InputArray img, OutputArray features)
 {
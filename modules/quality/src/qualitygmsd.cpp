@@ -78,6 +78,95 @@ namespace
                 .rowRange((kernel.rows - 1) / 2, dest.rows - kernel.rows / 2);
         }
     }
+
+    // GMSD constant
+    static const double GMSD_T = 170.;
+
+    // per-channel sums of the quality map and of its squares
+    struct gmsd_sums
+    {
+        cv::Scalar sum, sum_sq;
+
+        gmsd_sums& operator+=(const gmsd_sums& rhs)
+        {
+            sum += rhs.sum;
+            sum_sq += rhs.sum_sq;
+            return *this;
+        }
+    };
+
+    // GMSD inputs of a fused kernel row
+    enum { GM1, GM2, GM1_SQ, GM2_SQ, GMSD_INPUTS };
+
+    // sums leading elements of a row with SIMD, returns the number of elements processed
+    template <typename T>
+    int gmsd_row_simd(const T* const*, int, int, gmsd_sums&) { return 0; }
+
+#if CV_SIMD128
+    template <>
+    int gmsd_row_simd<float>(const float* const* p, int len, int cn, gmsd_sums& sums)
+    {
+        if (4 % cn != 0)
+            return 0;
+
+        const v_float32x4
+            t = v_setall_f32((float)GMSD_T)
+            , two = v_setall_f32(2.f)
+            ;
+        v_float32x4
+            acc = v_setzero_f32()
+            , acc_sq = v_setzero_f32()
+            ;
+
+        int x = 0;
+        for (; x <= len - 4; x += 4)
+        {
+            const v_float32x4 num = v_fma(two, v_mul(v_load(p[GM1] + x), v_load(p[GM2] + x)), t);
+            const v_float32x4 denom = v_add(v_add(v_load(p[GM1_SQ] + x), v_load(p[GM2_SQ] + x)), t);
+            const v_float32x4 q = v_div(num, denom);
+            acc = v_add(acc, q);
+            acc_sq = v_fma(q, q, acc_sq);
+        }
+        quality::detail::add_lanes(acc, cn, sums.sum);
+        quality::detail::add_lanes(acc_sq, cn, sums.sum_sq);
+        return x;
+    }
+#endif
+
+    // fused GMSD kernel:  standard deviation of the quality map, computed without generating it
+    template <typename T>
+    cv::Scalar gmsd_stddev(const cv::Mat (&m)[GMSD_INPUTS])
+    {
+        const int
+            cn = m[GM1].channels()
+            , len = m[GM1].cols * cn
+            ;
+        const T t = (T)GMSD_T;
+
+        const auto sums = quality::detail::parallel_row_sum<gmsd_sums>(m[GM1].rows, [&](int y, gmsd_sums& acc)
+        {
+            const T* p[GMSD_INPUTS];
+            for (int k = 0; k < GMSD_INPUTS; ++k)
+                p[k] = m[k].ptr<T>(y);
+
+            for (int x = gmsd_row_simd<T>(p, len, cn, acc); x < len; ++x)
+            {
+                const double q = (double)((2 * p[GM1][x] * p[GM2][x] + t) / (p[GM1_SQ][x] + p[GM2_SQ][x] + t));
+                acc.sum[x % cn] += q;
+                acc.sum_sq[x % cn] += q * q;
+            }
+        });
+
+        // same as cv::meanStdDev
+        const double scale = 1. / (double)m[GM1].total();
+        cv::Scalar result = cv::Scalar::all(0.);
+        for (int c = 0; c < cn; ++c)
+        {
+            const double mean = sums.sum[c] * scale;
+            result[c] = std::sqrt(std::max(sums.sum_sq[c] * scale - mean * mean, 0.));
+        }
+        return result;
+    }
 }   // ns
 
 // construct mat_data from _mat_type
@@ -136,6 +225,9 @@ Ptr<QualityGMSD> QualityGMSD::create( InputArray ref )
 // static
 cv::Scalar QualityGMSD::compute( InputArray ref, InputArray cmp, OutputArray qualityMap )
 {
+    if (!qualityMap.needed())
+        return _mat_data::compute_score( _mat_data(ref), _mat_data(cmp) );
+
     auto result = _mat_data::compute( _mat_data(ref), _mat_data(cmp) );
 
     if (qualityMap.needed())
@@ -150,6 +242,20 @@ cv::Scalar QualityGMSD::compute( InputArray cmp )
     return result.first;
 }
 
+void QualityGMSD::computeBatch( InputArrayOfArrays cmpImgs, OutputArray scores )
+{
+    std::vector<cv::Mat> cmp;
+    cmpImgs.getMatVector(cmp);
+
+    std::vector<cv::Scalar> result(cmp.size());
+    quality::detail::for_each_image((int)cmp.size(), [&](int i)
+    {
+        result[i] = _mat_data::compute_score(this->_refImgData, _mat_data(cmp[i]));
+    });
+
+    cv::Mat(result).copyTo(scores);
+}
+
 // computes gmsd and quality map for single frame
 std::pair<cv::Scalar, _quality_map_type> QualityGMSD::_mat_data::compute(const QualityGMSD::_mat_data& lhs, const QualityGMSD::_mat_data& rhs)
 {
@@ -175,4 +281,22 @@ std::pair<cv::Scalar, _quality_map_type> QualityGMSD::_mat_data::compute(const Q
     result.second = std::move(qm);
 
     return result;
-}   // compute
\ No newline at end of file
+}   // compute
+
+// computes gmsd for single frame without generating the quality map
+cv::Scalar QualityGMSD::_mat_data::compute_score(const QualityGMSD::_mat_data& lhs, const QualityGMSD::_mat_data& rhs)
+{
+    CV_Assert(lhs.gradient_map.size() == rhs.gradient_map.size() && lhs.gradient_map.type() == rhs.gradient_map.type());
+
+    const cv::Mat m[GMSD_INPUTS] = {
+        lhs.gradient_map.getMat(ACCESS_READ)
+        , rhs.gradient_map.getMat(ACCESS_READ)
+        , lhs.gradient_map_squared.getMat(ACCESS_READ)
+        , rhs.gradient_map_squared.getMat(ACCESS_READ)
+    };
+
+    return (lhs.gradient_map.depth() == CV_32F)
+        ? ::gmsd_stddev<float>(m)
+        : ::gmsd_stddev<double>(m)
+        ;
+}   // compute_score
@@ -28,6 +28,74 @@ namespace
 
         return result;
     }
+
+    // sums leading elements of a row with SIMD, returns the number of elements processed
+    template <typename T>
+    int mse_row_simd(const T*, const T*, int, int, cv::Scalar&) { return 0; }
+
+#if CV_SIMD128
+    template <>
+    int mse_row_simd<float>(const float* lhs, const float* rhs, int len, int cn, cv::Scalar& sums)
+    {
+        if (4 % cn != 0)
+            return 0;
+
+        // squared differences of 8 bit images reach 65025, so the float accumulator is flushed to the double sums
+        //  every block to keep the precision of cv::mean
+        const int block = 64;
+        int x = 0;
+        while (x <= len - 4)
+        {
+            const int block_end = std::min(x + block, len - 3);
+            v_float32x4 acc = v_setzero_f32();
+            for (; x < block_end; x += 4)
+            {
+                const v_float32x4 diff = v_sub(v_load(lhs + x), v_load(rhs + x));
+                acc = v_fma(diff, diff, acc);
+            }
+            quality::detail::add_lanes(acc, cn, sums);
+        }
+        return x;
+    }
+#endif
+
+    template <typename T>
+    cv::Scalar mse_mean(const cv::Mat& lhs, const cv::Mat& rhs)
+    {
+        const int
+            cn = lhs.channels()
+            , len = lhs.cols * cn
+            ;
+
+        const auto sum = quality::detail::parallel_row_sum<cv::Scalar>(lhs.rows, [&](int y, cv::Scalar& sums)
+        {
+            const T* l = lhs.ptr<T>(y);
+            const T* r = rhs.ptr<T>(y);
+            for (int x = mse_row_simd<T>(l, r, len, cn, sums); x < len; ++x)
+            {
+                const double diff = (double)l[x] - (double)r[x];
+                sums[x % cn] += diff * diff;
+            }
+        });
+
+        return sum * (1. / (double)lhs.total());
+    }
+
+    // computes mse for single frame without generating the quality map
+    cv::Scalar compute_score(const mse_mat_type& lhs, const mse_mat_type& rhs)
+    {
+        CV_Assert(lhs.size() == rhs.size() && lhs.type() == rhs.type());
+
+        const cv::Mat
+            l = lhs.getMat(ACCESS_READ)
+            , r = rhs.getMat(ACCESS_READ)
+            ;
+
+        return (l.depth() == CV_32F)
+            ? mse_mean<float>(l, r)
+            : mse_mean<double>(l, r)
+            ;
+    }
 }
 
 // static
@@ -42,6 +110,9 @@ cv::Scalar QualityMSE::compute( InputArray ref_, InputArray cmp_, OutputArray qu
     auto ref = quality_utils::expand_mat<mse_mat_type>(ref_);
     auto cmp = quality_utils::expand_mat<mse_mat_type>(cmp_);
 
+    if (!qualityMap.needed())
+        return ::compute_score(ref, cmp);
+
     auto result = ::compute(ref, cmp);
 
     if (qualityMap.needed())
@@ -56,4 +127,18 @@ cv::Scalar QualityMSE::compute( InputArray cmp_ )
     auto result = ::compute( this->_ref, cmp );
     OutputArray(this->_qualityMap).assign(result.second);
     return result.first;
-}
\ No newline at end of file
+}
+
+void QualityMSE::computeBatch( InputArrayOfArrays cmpImgs, OutputArray scores )
+{
+    std::vector<cv::Mat> cmp;
+    cmpImgs.getMatVector(cmp);
+
+    std::vector<cv::Scalar> result(cmp.size());
+    quality::detail::for_each_image((int)cmp.size(), [&](int i)
+    {
+        result[i] = ::compute_score(this->_ref, quality_utils::expand_mat<mse_mat_type>(cmp[i]));
+    });
+
+    cv::Mat(result).copyTo(scores);
+}
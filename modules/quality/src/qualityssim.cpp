@@ -22,6 +22,81 @@ namespace
         cv::GaussianBlur( mat, result, cv::Size(11, 11), 1.5 );
         return result;
     }
+
+    // SSIM constants
+    static const double
+        SSIM_C1 = 6.5025
+        , SSIM_C2 = 58.5225
+        ;
+
+    // SSIM inputs of a fused kernel row
+    enum { MU1, MU2, MU1_2, MU2_2, SIGMA1_2, SIGMA2_2, BLUR_I1_I2, SSIM_INPUTS };
+
+    // sums leading elements of a row with SIMD, returns the number of elements processed
+    template <typename T>
+    int ssim_row_simd(const T* const*, int, int, cv::Scalar&) { return 0; }
+
+#if CV_SIMD128
+    template <>
+    int ssim_row_simd<float>(const float* const* p, int len, int cn, cv::Scalar& sums)
+    {
+        if (4 % cn != 0)
+            return 0;
+
+        const v_float32x4
+            c1 = v_setall_f32((float)SSIM_C1)
+            , c2 = v_setall_f32((float)SSIM_C2)
+            , two = v_setall_f32(2.f)
+            ;
+        v_float32x4 acc = v_setzero_f32();
+
+        int x = 0;
+        for (; x <= len - 4; x += 4)
+        {
+            const v_float32x4 mu1_mu2 = v_mul(v_load(p[MU1] + x), v_load(p[MU2] + x));
+            const v_float32x4 sigma12 = v_sub(v_load(p[BLUR_I1_I2] + x), mu1_mu2);
+            const v_float32x4 num = v_mul(v_fma(two, mu1_mu2, c1), v_fma(two, sigma12, c2));
+            const v_float32x4 denom = v_mul(
+                v_add(v_add(v_load(p[MU1_2] + x), v_load(p[MU2_2] + x)), c1)
+                , v_add(v_add(v_load(p[SIGMA1_2] + x), v_load(p[SIGMA2_2] + x)), c2)
+            );
+            acc = v_add(acc, v_div(num, denom));
+        }
+        quality::detail::add_lanes(acc, cn, sums);
+        return x;
+    }
+#endif
+
+    // fused SSIM kernel:  mean of the quality map, computed without generating it
+    template <typename T>
+    cv::Scalar ssim_mean(const cv::Mat (&m)[SSIM_INPUTS])
+    {
+        const int
+            cn = m[MU1].channels()
+            , len = m[MU1].cols * cn
+            ;
+        const T
+            C1 = (T)SSIM_C1
+            , C2 = (T)SSIM_C2
+            ;
+
+        const auto sum = quality::detail::parallel_row_sum<cv::Scalar>(m[MU1].rows, [&](int y, cv::Scalar& sums)
+        {
+            const T* p[SSIM_INPUTS];
+            for (int k = 0; k < SSIM_INPUTS; ++k)
+                p[k] = m[k].ptr<T>(y);
+
+            for (int x = ssim_row_simd<T>(p, len, cn, sums); x < len; ++x)
+            {
+                const T mu1_mu2 = p[MU1][x] * p[MU2][x];
+                const T sigma12 = p[BLUR_I1_I2][x] - mu1_mu2;
+                sums[x % cn] += ((2 * mu1_mu2 + C1) * (2 * sigma12 + C2))
+                    / ((p[MU1_2][x] + p[MU2_2][x] + C1) * (p[SIGMA1_2][x] + p[SIGMA2_2][x] + C2));
+            }
+        });
+
+        return sum * (1. / (double)m[MU1].total());
+    }
 }   // ns
 
 QualitySSIM::_mat_data::_mat_data( const _mat_type& mat )
@@ -47,6 +122,9 @@ Ptr<QualitySSIM> QualitySSIM::create( InputArray ref )
 // static
 cv::Scalar QualitySSIM::compute( InputArray ref, InputArray cmp, OutputArray qualityMap )
 {
+    if (!qualityMap.needed())
+        return _mat_data::compute_score( _mat_data(ref), _mat_data(cmp) );
+
     auto result = _mat_data::compute( _mat_data(ref), _mat_data(cmp) );
 
     if (qualityMap.needed())
@@ -66,6 +144,20 @@ cv::Scalar QualitySSIM::compute( InputArray cmp )
     return result.first;
 }
 
+void QualitySSIM::computeBatch( InputArrayOfArrays cmpImgs, OutputArray scores )
+{
+    std::vector<cv::Mat> cmp;
+    cmpImgs.getMatVector(cmp);
+
+    std::vector<cv::Scalar> result(cmp.size());
+    quality::detail::for_each_image((int)cmp.size(), [&](int i)
+    {
+        result[i] = _mat_data::compute_score(this->_refImgData, _mat_data(cmp[i]));
+    });
+
+    cv::Mat(result).copyTo(scores);
+}
+
 // static.  computes ssim and quality map for single frame
 // based on https://docs.opencv.org/2.4/doc/tutorials/highgui/video-input-psnr-ssim/video-input-psnr-ssim.html
 std::pair<cv::Scalar, _mat_type> QualitySSIM::_mat_data::compute(const _mat_data& lhs, const _mat_data& rhs)
@@ -115,4 +207,29 @@ std::pair<cv::Scalar, _mat_type> QualitySSIM::_mat_data::compute(const _mat_data
         cv::mean(t3)
         , std::move(t3)
     };
-}   // compute
\ No newline at end of file
+}   // compute
+
+// static.  computes ssim for single frame without generating the quality map
+cv::Scalar QualitySSIM::_mat_data::compute_score(const _mat_data& lhs, const _mat_data& rhs)
+{
+    CV_Assert(lhs.I.size() == rhs.I.size() && lhs.I.type() == rhs.I.type());
+
+    mat_type I1_I2;
+    cv::multiply(lhs.I, rhs.I, I1_I2);
+    const mat_type blur_I1_I2 = ::blur(I1_I2);
+
+    const cv::Mat m[SSIM_INPUTS] = {
+        lhs.mu.getMat(ACCESS_READ)
+        , rhs.mu.getMat(ACCESS_READ)
+        , lhs.mu_2.getMat(ACCESS_READ)
+        , rhs.mu_2.getMat(ACCESS_READ)
+        , lhs.sigma_2.getMat(ACCESS_READ)
+        , rhs.sigma_2.getMat(ACCESS_READ)
+        , blur_I1_I2.getMat(ACCESS_READ)
+    };
+
+    return (lhs.I.depth() == CV_32F)
+        ? ::ssim_mean<float>(m)
+        : ::ssim_mean<double>(m)
+        ;
+}   // compute_score
@@ -39,6 +39,20 @@ TEST(TEST_CASE_NAME, multi_channel)
     quality_test(quality::QualityGMSD::create(get_testfile_2a()), get_testfile_2b(), GMSD_EXPECTED_2);
 }
 
+// static method without quality map
+TEST(TEST_CASE_NAME, static_no_map)
+{
+    quality_expect_near(quality::QualityGMSD::compute(get_testfile_1a(), get_testfile_1a(), cv::noArray()), cv::Scalar(0.));
+    quality_expect_near(quality::QualityGMSD::compute(get_testfile_2a(), get_testfile_2b(), cv::noArray()), GMSD_EXPECTED_2);
+}
+
+// batch of comparison images
+TEST(TEST_CASE_NAME, batch)
+{
+    quality_batch_test(quality::QualityGMSD::create(get_testfile_1a()), get_testfile_1b(), GMSD_EXPECTED_1);
+    quality_batch_test(quality::QualityGMSD::create(get_testfile_2a()), get_testfile_2b(), GMSD_EXPECTED_2);
+}
+
 // internal A/B test
 /*
 TEST(TEST_CASE_NAME, performance)
@@ -33,6 +33,20 @@ TEST(TEST_CASE_NAME, multi_channel)
     quality_test(quality::QualityMSE::create(get_testfile_2a()), get_testfile_2b(), MSE_EXPECTED_2);
 }
 
+// static method without quality map
+TEST(TEST_CASE_NAME, static_no_map)
+{
+    quality_expect_near(quality::QualityMSE::compute(get_testfile_1a(), get_testfile_1a(), cv::noArray()), cv::Scalar(0.));
+    quality_expect_near(quality::QualityMSE::compute(get_testfile_2a(), get_testfile_2b(), cv::noArray()), MSE_EXPECTED_2);
+}
+
+// batch of comparison images
+TEST(TEST_CASE_NAME, batch)
+{
+    quality_batch_test(quality::QualityMSE::create(get_testfile_1a()), get_testfile_1b(), MSE_EXPECTED_1);
+    quality_batch_test(quality::QualityMSE::create(get_testfile_2a()), get_testfile_2b(), MSE_EXPECTED_2);
+}
+
 // internal a/b test
 /*
 TEST(TEST_CASE_NAME, performance)
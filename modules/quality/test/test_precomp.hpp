@@ -101,6 +101,22 @@ inline void quality_test(cv::Ptr<quality::QualityBase> ptr, const TMat& cmp, con
     EXPECT_TRUE(ptr->empty());
 }
 
+// execute batch quality test:  every image of the batch scores like a single compute, no quality map is generated
+inline void quality_batch_test(cv::Ptr<quality::QualityBase> ptr, const cv::Mat& cmp, const Scalar& expected)
+{
+    const std::vector<cv::Mat> batch = { cmp, cmp.clone(), cmp };
+
+    std::vector<cv::Scalar> scores;
+    ptr->computeBatch(batch, scores);
+    ASSERT_EQ(batch.size(), scores.size());
+    for (const auto& score : scores)
+        quality_expect_near(expected, score);
+
+    cv::Mat qMat = {};
+    ptr->getQualityMap(qMat);
+    EXPECT_TRUE(qMat.empty());
+}
+
 /* A/B test benchmarking for development purposes */
 /*
 template <typename Fn>
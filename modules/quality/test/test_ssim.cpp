@@ -39,6 +39,20 @@ TEST(TEST_CASE_NAME, multi_channel)
     quality_test(quality::QualitySSIM::create(get_testfile_2a()), get_testfile_2b(), SSIM_EXPECTED_2);
 }
 
+// static method without quality map
+TEST(TEST_CASE_NAME, static_no_map)
+{
+    quality_expect_near(quality::QualitySSIM::compute(get_testfile_1a(), get_testfile_1a(), cv::noArray()), cv::Scalar(1.));
+    quality_expect_near(quality::QualitySSIM::compute(get_testfile_2a(), get_testfile_2b(), cv::noArray()), SSIM_EXPECTED_2);
+}
+
+// batch of comparison images
+TEST(TEST_CASE_NAME, batch)
+{
+    quality_batch_test(quality::QualitySSIM::create(get_testfile_1a()), get_testfile_1b(), SSIM_EXPECTED_1);
+    quality_batch_test(quality::QualitySSIM::create(get_testfile_2a()), get_testfile_2b(), SSIM_EXPECTED_2);
+}
+
 // internal a/b test
 /*
 TEST(TEST_CASE_NAME, performance)
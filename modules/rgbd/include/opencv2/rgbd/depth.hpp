@@ -324,6 +324,36 @@ namespace rgbd
   void
   rescaleDepth(InputArray in, int depth, OutputArray out, double depth_factor = 1000.0);
 
+  /** Per-frame depth preprocessing in one call: the depth is registered to an external camera (see registerDepth),
+   * cleaned (see DepthCleaner) and back-projected to an organized cloud (see depthTo3d).
+   * The intermediate depth images are owned by the object and reused from frame to frame. The cloud is written in
+   * place when it is preallocated with the external camera size and the type depthTo3d gives for the input depth.
+   */
+  class CV_EXPORTS_W RgbdDepthPipeline: public Algorithm
+  {
+  public:
+    /**
+     * @param unregisteredCameraMatrix the camera matrix of the depth camera
+     * @param registeredCameraMatrix the camera matrix of the external camera
+     * @param registeredDistCoeffs the distortion coefficients of the external camera
+     * @param Rt the rigid body transform between the cameras. Transforms points from depth camera frame to external camera frame.
+     * @param outputImagePlaneSize the image plane dimensions of the external camera (width, height)
+     * @param depthDilation whether or not the depth is dilated to avoid holes and occlusion errors (optional)
+     * @param window_size the window size of the DepthCleaner: can only be 1,3,5 or 7
+     */
+    CV_WRAP static Ptr<RgbdDepthPipeline> create(InputArray unregisteredCameraMatrix, InputArray registeredCameraMatrix,
+                                                 InputArray registeredDistCoeffs, InputArray Rt,
+                                                 const Size& outputImagePlaneSize, bool depthDilation = false,
+                                                 int window_size = 5);
+
+    /** Registers, cleans and back-projects one depth image
+     * @param unregisteredDepth the input depth data, CV_16U in millimeters or CV_32F/CV_64F in meters
+     * @param points3d the organized cloud in the external camera frame, CV_64FC3 for CV_64F depth and CV_32FC3 otherwise
+     */
+    CV_WRAP_AS(apply) virtual void
+    operator()(InputArray unregisteredDepth, OutputArray points3d) = 0;
+  };
+
   /** Object that can compute planes in an image
    */
   class CV_EXPORTS_W RgbdPlane: public Algorithm
@@ -586,6 +616,8 @@ namespace rgbd
 
     /** One more method to compute a transformation from the source frame to the destination one.
      * It is designed to save on computing the frame data (image pyramids, normals, etc.).
+     * The frames keep their pyramids between the calls, so for a sequence of frames the destination frame
+     * of one call can be passed as the source frame of the next one: only the missing data is computed then.
      */
     CV_WRAP_AS(compute2) bool
     compute(Ptr<OdometryFrame>& srcFrame, Ptr<OdometryFrame>& dstFrame, OutputArray Rt, const Mat& initRt = Mat()) const;
@@ -0,0 +1,77 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+/** A tilted plane with a bump in the middle, seen by a 640x480 camera */
+static Mat makePoints3d(const Size& size, const Matx33f& K, int depth)
+{
+    Mat_<float> z(size);
+    for (int y = 0; y < size.height; y++)
+        for (int x = 0; x < size.width; x++)
+        {
+            float dx = (x - size.width * 0.5f) / size.width, dy = (y - size.height * 0.5f) / size.height;
+            z(y, x) = 1.5f + 0.5f * dx + 0.25f * dy + 0.2f * std::exp(-20.f * (dx * dx + dy * dy));
+        }
+
+    Mat points3d;
+    depthTo3d(z, K, points3d);
+    points3d.convertTo(points3d, depth);
+    return points3d;
+}
+
+static const Matx33f perfK(525.f, 0.f, 319.5f,
+                           0.f, 525.f, 239.5f,
+                           0.f, 0.f, 1.f);
+
+CV_ENUM(NormalsMethod, RgbdNormals::RGBD_NORMALS_METHOD_FALS, RgbdNormals::RGBD_NORMALS_METHOD_LINEMOD,
+                       RgbdNormals::RGBD_NORMALS_METHOD_SRI)
+
+typedef tuple<NormalsMethod, MatDepth> NormalsParams;
+typedef TestBaseWithParam<NormalsParams> NormalsPerfTest;
+
+PERF_TEST_P(NormalsPerfTest, compute,
+            ::testing::Combine(NormalsMethod::all(), ::testing::Values(CV_32F, CV_64F)))
+{
+    const int method = get<0>(GetParam());
+    const int depth = get<1>(GetParam());
+    const Size size(640, 480);
+
+    Mat points3d = makePoints3d(size, perfK, depth);
+    Ptr<RgbdNormals> normalsComputer = RgbdNormals::create(size.height, size.width, depth, Mat(perfK), 5, method);
+    // Keep the one-time cache computation out of the measurements
+    normalsComputer->initialize();
+
+    Mat normals;
+    TEST_CYCLE()
+    {
+        (*normalsComputer)(points3d, normals);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST(PlanePerfTest, compute)
+{
+    const Size size(640, 480);
+    Mat points3d = makePoints3d(size, perfK, CV_32F);
+
+    Mat normals;
+    Ptr<RgbdNormals> normalsComputer = RgbdNormals::create(size.height, size.width, CV_32F, Mat(perfK), 5,
+                                                           RgbdNormals::RGBD_NORMALS_METHOD_FALS);
+    (*normalsComputer)(points3d, normals);
+
+    Ptr<RgbdPlane> planeComputer = RgbdPlane::create(RgbdPlane::RGBD_PLANE_METHOD_DEFAULT, 40, 1600, 0.01);
+    Mat mask, planes;
+    TEST_CYCLE()
+    {
+        (*planeComputer)(points3d, normals, mask, planes);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
@@ -88,13 +88,28 @@ namespace rgbd
         case CV_32F:
         {
           const Mat_<float> &depth(depth_in);
-          computeImpl<float, float>(depth, depth_out, 1);
+          // the rows are gathered in parallel from their neighbours, so they cannot be overwritten in place
+          if (depth_out.data == depth_in.data)
+          {
+            Mat depth_out_tmp;
+            computeImpl<float, float>(depth, depth_out_tmp, 1);
+            depth_out_tmp.copyTo(depth_out);
+          }
+          else
+            computeImpl<float, float>(depth, depth_out, 1);
           break;
         }
         case CV_64F:
         {
           const Mat_<double> &depth(depth_in);
-          computeImpl<double, double>(depth, depth_out, 1);
+          if (depth_out.data == depth_in.data)
+          {
+            Mat depth_out_tmp;
+            computeImpl<double, double>(depth, depth_out_tmp, 1);
+            depth_out_tmp.copyTo(depth_out);
+          }
+          else
+            computeImpl<double, double>(depth, depth_out, 1);
           break;
         }
       }
@@ -116,50 +131,74 @@ namespace rgbd
       // Precompute some data
       const ContainerDepth sigma_L = (float)(0.8 + 0.035 * theta_mean / (CV_PI / 2 - theta_mean));
       Mat_<ContainerDepth> sigma_z(rows, cols);
-      for (int y = 0; y < rows; ++y)
-        for (int x = 0; x < cols; ++x)
-          sigma_z(y, x) = (float)(0.0012 + 0.0019 * (depth_in(y, x) * scale - 0.4) * (depth_in(y, x) * scale - 0.4));
+      parallel_for_(Range(0, rows), [&](const Range& range)
+      {
+        for (int y = range.start; y < range.end; ++y)
+          for (int x = 0; x < cols; ++x)
+            sigma_z(y, x) = (float)(0.0012 + 0.0019 * (depth_in(y, x) * scale - 0.4) * (depth_in(y, x) * scale - 0.4));
+      });
 
+      // A pixel (y, x) with 0 <= y < rows - 1 and 0 < x < cols - 1 is combined with itself and with
+      // the following neighbours (in a row-major way): both pixels of a pair receive the depth of the
+      // other one, weighted with their own sigma_z. Instead of scattering the contributions, every
+      // pixel gathers them from both directions so that the rows can be processed in parallel.
+      const int n_offsets = 4;
+      const int offsets_y[n_offsets] = { 0, 1, 1, 1 };
+      const int offsets_x[n_offsets] = { 1, -1, 0, 1 };
       ContainerDepth difference_threshold = 10;
-      Mat_<ContainerDepth> Dw_sum = Mat_<ContainerDepth>::zeros(rows, cols), w_sum =
-          Mat_<ContainerDepth>::zeros(rows, cols);
-      for (int y = 0; y < rows - 1; ++y)
+      depth_out.create(rows, cols, DataType<ContainerDepth>::type);
+      parallel_for_(Range(0, rows), [&](const Range& range)
       {
-        // Every pixel has had the contribution of previous pixels (in a row-major way)
-        for (int x = 1; x < cols - 1; ++x)
+        for (int y = range.start; y < range.end; ++y)
         {
-          for (int j = 0; j <= 1; ++j)
-            for (int i = -1; i <= 1; ++i)
+          ContainerDepth* out = depth_out.ptr<ContainerDepth>(y);
+          for (int x = 0; x < cols; ++x)
+          {
+            ContainerDepth Dw_sum = 0, w_sum = 0;
+            const ContainerDepth s_z = sigma_z(y, x);
+            const DepthDepth d = depth_in(y, x);
+
+            for (int k = -1; k < n_offsets; ++k)
             {
-              if ((j == 0) && (i == -1))
-                continue;
-              ContainerDepth delta_u = sqrt(
-                  ContainerDepth(j) * ContainerDepth(j) + ContainerDepth(i) * ContainerDepth(i));
-              ContainerDepth delta_z;
-              if (depth_in(y, x) > depth_in(y + j, x + i))
-                delta_z = (float)(depth_in(y, x) - depth_in(y + j, x + i));
-              else
-                delta_z = (float)(depth_in(y + j, x + i) - depth_in(y, x));
-              if (delta_z < difference_threshold)
+              // k == -1 is the pixel itself, for the others the pair is taken in both directions
+              for (int dir = 1; dir >= -1; dir -= 2)
               {
-                delta_z *= scale;
-                ContainerDepth w = exp(
-                    -delta_u * delta_u / 2 / sigma_L / sigma_L - delta_z * delta_z / 2 / sigma_z(y, x) / sigma_z(y, x));
-                w_sum(y, x) += w;
-                Dw_sum(y, x) += depth_in(y + j, x + i) * w;
-                if ((j != 0) || (i != 0))
+                int j = k < 0 ? 0 : dir * offsets_y[k];
+                int i = k < 0 ? 0 : dir * offsets_x[k];
+                // the pixel starting the pair has to be in the processed area
+                int y0 = dir > 0 ? y : y + j, x0 = dir > 0 ? x : x + i;
+                if ((y0 < 0) || (y0 >= rows - 1) || (x0 < 1) || (x0 >= cols - 1))
                 {
-                  w = exp(
-                      -delta_u * delta_u / 2 / sigma_L / sigma_L - delta_z * delta_z / 2 / sigma_z(y + j, x + i)
-                                                                   / sigma_z(y + j, x + i));
-                  w_sum(y + j, x + i) += w;
-                  Dw_sum(y + j, x + i) += depth_in(y, x) * w;
+                  if (k < 0)
+                    break;
+                  continue;
                 }
+
+                const DepthDepth d_n = depth_in(y + j, x + i);
+                ContainerDepth delta_u = sqrt(
+                    ContainerDepth(j) * ContainerDepth(j) + ContainerDepth(i) * ContainerDepth(i));
+                ContainerDepth delta_z;
+                if (d > d_n)
+                  delta_z = (float)(d - d_n);
+                else
+                  delta_z = (float)(d_n - d);
+                if (delta_z < difference_threshold)
+                {
+                  delta_z *= scale;
+                  ContainerDepth w = exp(
+                      -delta_u * delta_u / 2 / sigma_L / sigma_L - delta_z * delta_z / 2 / s_z / s_z);
+                  w_sum += w;
+                  Dw_sum += d_n * w;
+                }
+
+                if (k < 0)
+                  break;
               }
             }
+            out[x] = Dw_sum / w_sum;
+          }
         }
-      }
-      Mat(Dw_sum / w_sum).copyTo(depth_out);
+      });
     }
   };
 
@@ -82,6 +82,15 @@ namespace rgbd
  ///////////////////////////////////////////////////////////////////////////////////
 
 
+    /** Temporary clouds of the registration, RgbdDepthPipeline keeps them from frame to frame
+     */
+    struct RegistrationBuffers
+    {
+        Mat_<Point3f> cloud;
+        Mat_<Point3f> transformedCloud;
+        Mat_<Point2f> projectedPoints;
+    };
+
     /** Computes a registered depth image from an unregistered image.
      *
      * @param unregisteredDepth the input depth data
@@ -93,6 +102,7 @@ namespace rgbd
      * @param depthDilation whether or not the depth is dilated to avoid holes and occlusion errors
      * @param inputDepthToMetersScale the scale needed to transform the input depth units to meters
      * @param registeredDepth the result of transforming the depth into the external camera
+     * @param buffers the temporary clouds
      */
     template<typename DepthDepth>
     void
@@ -104,11 +114,16 @@ namespace rgbd
                         const Size outputImagePlaneSize,
                         const bool depthDilation,
                         const float inputDepthToMetersScale,
-                        Mat &registeredDepth)
+                        Mat &registeredDepth,
+                        RegistrationBuffers &buffers)
     {
 
-        // Create output Mat of the correct type, filled with an initial value indicating no depth
-        registeredDepth = Mat_<DepthDepth>(outputImagePlaneSize, noDepthSentinelValue<DepthDepth>());
+        // Create output Mat of the correct type, filled with an initial value indicating no depth.
+        // The input is still read while the output is filled, so they must not share their data.
+        if (registeredDepth.data == unregisteredDepth.data)
+            registeredDepth.release();
+        registeredDepth.create(outputImagePlaneSize, DataType<DepthDepth>::type);
+        registeredDepth.setTo(Scalar::all(noDepthSentinelValue<DepthDepth>()));
 
         // Figure out whether we'll have to apply a distortion
         bool hasDistortion = (countNonZero(registeredDistCoeffs) > 0);
@@ -144,71 +159,86 @@ namespace rgbd
         }
 
         // Apply the initial projection to the input depth
-        Mat_<Point3f> transformedCloud;
+        Mat_<Point3f> &transformedCloud = buffers.transformedCloud;
         {
-            Mat_<Point3f> point_tmp(outputImagePlaneSize,Point3f(0.,0.,0.));
+            Mat_<Point3f> &point_tmp = buffers.cloud;
+            point_tmp.create(unregisteredDepth.size());
 
-            for(int j = 0; j < unregisteredDepth.rows; ++j)
+            parallel_for_(Range(0, unregisteredDepth.rows), [&](const Range& range)
             {
-                const DepthDepth *unregisteredDepthPtr = unregisteredDepth[j];
-
-                Point3f *point = point_tmp[j];
-                for(int i = 0; i < unregisteredDepth.cols; ++i, ++unregisteredDepthPtr, ++point)
+                for(int j = range.start; j < range.end; ++j)
                 {
-                    float rescaled_depth = float(*unregisteredDepthPtr) * inputDepthToMetersScale;
+                    const DepthDepth *unregisteredDepthPtr = unregisteredDepth[j];
 
-                    // If the DepthDepth is of type unsigned short, zero is a sentinel value to indicate
-                    // no depth. CV_32F and CV_64F should already have NaN for no depth values.
-                    if (rescaled_depth == 0)
+                    Point3f *point = point_tmp[j];
+                    for(int i = 0; i < unregisteredDepth.cols; ++i, ++unregisteredDepthPtr, ++point)
                     {
-                        rescaled_depth = std::numeric_limits<float>::quiet_NaN();
+                        float rescaled_depth = float(*unregisteredDepthPtr) * inputDepthToMetersScale;
+
+                        // If the DepthDepth is of type unsigned short, zero is a sentinel value to indicate
+                        // no depth. CV_32F and CV_64F should already have NaN for no depth values.
+                        if (rescaled_depth == 0)
+                        {
+                            rescaled_depth = std::numeric_limits<float>::quiet_NaN();
+                        }
+
+                        point->x = i * rescaled_depth;
+                        point->y = j * rescaled_depth;
+                        point->z = rescaled_depth;
                     }
-
-                    point->x = i * rescaled_depth;
-                    point->y = j * rescaled_depth;
-                    point->z = rescaled_depth;
                 }
-            }
+            });
 
             perspectiveTransform(point_tmp, transformedCloud, initialProjection);
         }
 
-        std::vector<Point2f> transformedAndProjectedPoints(transformedCloud.cols);
-        const float metersToInputUnitsScale = 1/inputDepthToMetersScale;
-        const Rect registeredDepthBounds(Point(), outputImagePlaneSize);
-
-        for( int y = 0; y < transformedCloud.rows; y++ )
+        // Project all the points to the external camera in parallel, only the occlusion
+        // check below has to be done sequentially
+        Mat_<Point2f> &transformedAndProjectedPoints = buffers.projectedPoints;
+        transformedAndProjectedPoints.create(transformedCloud.size());
+        parallel_for_(Range(0, transformedCloud.rows), [&](const Range& range)
         {
-            if (hasDistortion)
+            std::vector<Point2f> projectedRow;
+            for( int y = range.start; y < range.end; y++ )
             {
+                if (hasDistortion)
+                {
 
-                // Project an entire row of points with distortion.
-                // Doing this for the entire image at once would require more memory.
-                projectPoints(transformedCloud.row(y),
-                              Vec3f(0,0,0),
-                              Vec3f(0,0,0),
-                              registeredCameraMatrix,
-                              registeredDistCoeffs,
-                              transformedAndProjectedPoints);
-
-            }
-            else
-            {
+                    // Project an entire row of points with distortion.
+                    // Doing this for the entire image at once would require more memory.
+                    projectPoints(transformedCloud.row(y),
+                                  Vec3f(0,0,0),
+                                  Vec3f(0,0,0),
+                                  registeredCameraMatrix,
+                                  registeredDistCoeffs,
+                                  projectedRow);
+                    std::copy(projectedRow.begin(), projectedRow.end(), transformedAndProjectedPoints[y]);
 
-                // With no distortion, we just have to dehomogenize the point since all major transforms
-                // already happened with initialProjection.
-                Point2f *point2d = &transformedAndProjectedPoints[0];
-                const Point2f *point2d_end = point2d + transformedAndProjectedPoints.size();
-                const Point3f *point3d = transformedCloud[y];
-                for( ; point2d < point2d_end; ++point2d, ++point3d )
-                {
-                    point2d->x = point3d->x / point3d->z;
-                    point2d->y = point3d->y / point3d->z;
                 }
+                else
+                {
+
+                    // With no distortion, we just have to dehomogenize the point since all major transforms
+                    // already happened with initialProjection.
+                    Point2f *point2d = transformedAndProjectedPoints[y];
+                    const Point2f *point2d_end = point2d + transformedCloud.cols;
+                    const Point3f *point3d = transformedCloud[y];
+                    for( ; point2d < point2d_end; ++point2d, ++point3d )
+                    {
+                        point2d->x = point3d->x / point3d->z;
+                        point2d->y = point3d->y / point3d->z;
+                    }
 
+                }
             }
+        });
+
+        const float metersToInputUnitsScale = 1/inputDepthToMetersScale;
+        const Rect registeredDepthBounds(Point(), outputImagePlaneSize);
 
-            const Point2f *outputProjectedPoint = &transformedAndProjectedPoints[0];
+        for( int y = 0; y < transformedCloud.rows; y++ )
+        {
+            const Point2f *outputProjectedPoint = transformedAndProjectedPoints[y];
             const Point3f *p = transformedCloud[y], *p_end = p + transformedCloud.cols;
 
 
@@ -301,6 +331,7 @@ namespace rgbd
 
 
         Mat &registeredDepthMat = registeredDepth.getMatRef();
+        RegistrationBuffers buffers;
 
         switch (unregisteredDepth.depth())
         {
@@ -309,7 +340,7 @@ namespace rgbd
                 performRegistration<unsigned short>(unregisteredDepth.getMat(), _unregisteredCameraMatrix,
                                                     _registeredCameraMatrix, _registeredDistCoeffs,
                                                     _rbtRgb2Depth, outputImagePlaneSize, depthDilation,
-                                                    .001f, registeredDepthMat);
+                                                    .001f, registeredDepthMat, buffers);
                 break;
             }
             case CV_32F:
@@ -317,7 +348,7 @@ namespace rgbd
                 performRegistration<float>(unregisteredDepth.getMat(), _unregisteredCameraMatrix,
                                            _registeredCameraMatrix, _registeredDistCoeffs,
                                            _rbtRgb2Depth, outputImagePlaneSize, depthDilation,
-                                           1.0f, registeredDepthMat);
+                                           1.0f, registeredDepthMat, buffers);
                 break;
             }
             case CV_64F:
@@ -325,7 +356,7 @@ namespace rgbd
                 performRegistration<double>(unregisteredDepth.getMat(), _unregisteredCameraMatrix,
                                             _registeredCameraMatrix, _registeredDistCoeffs,
                                             _rbtRgb2Depth, outputImagePlaneSize, depthDilation,
-                                            1.0f, registeredDepthMat);
+                                            1.0f, registeredDepthMat, buffers);
                 break;
             }
             default:
@@ -337,5 +368,102 @@ namespace rgbd
 
     }
 
+    /** Registration, cleaning and back-projection of the depth with buffers kept between frames
+     */
+    class RgbdDepthPipelineImpl CV_FINAL : public RgbdDepthPipeline
+    {
+    public:
+        RgbdDepthPipelineImpl(const Matx33f &unregisteredCameraMatrix, const Matx33f &registeredCameraMatrix,
+                              const Mat_<float> &registeredDistCoeffs, const Matx44f &rbtRgb2Depth,
+                              const Size &outputImagePlaneSize, bool depthDilation, int windowSize)
+            :
+              unregisteredCameraMatrix_(unregisteredCameraMatrix),
+              registeredCameraMatrix_(registeredCameraMatrix),
+              registeredK_(registeredCameraMatrix),
+              registeredDistCoeffs_(registeredDistCoeffs),
+              rbtRgb2Depth_(rbtRgb2Depth),
+              outputImagePlaneSize_(outputImagePlaneSize),
+              depthDilation_(depthDilation),
+              windowSize_(windowSize)
+        {
+        }
+
+        virtual void
+        operator()(InputArray unregisteredDepth, OutputArray points3d) CV_OVERRIDE
+        {
+            CV_Assert(unregisteredDepth.cols() > 0 && unregisteredDepth.rows() > 0 && unregisteredDepth.channels() == 1);
+            const int depth = unregisteredDepth.depth();
+
+            // the cleaner works on the type of the input depth
+            if (!cleaner_ || cleaner_->getDepth() != depth)
+                cleaner_ = DepthCleaner::create(depth, windowSize_, DepthCleaner::DEPTH_CLEANER_NIL);
+
+            switch (depth)
+            {
+                case CV_16U:
+                    performRegistration<unsigned short>(unregisteredDepth.getMat(), unregisteredCameraMatrix_,
+                                                        registeredCameraMatrix_, registeredDistCoeffs_,
+                                                        rbtRgb2Depth_, outputImagePlaneSize_, depthDilation_,
+                                                        .001f, registeredDepth_, buffers_);
+                    break;
+                case CV_32F:
+                    performRegistration<float>(unregisteredDepth.getMat(), unregisteredCameraMatrix_,
+                                               registeredCameraMatrix_, registeredDistCoeffs_,
+                                               rbtRgb2Depth_, outputImagePlaneSize_, depthDilation_,
+                                               1.0f, registeredDepth_, buffers_);
+                    break;
+                case CV_64F:
+                    performRegistration<double>(unregisteredDepth.getMat(), unregisteredCameraMatrix_,
+                                                registeredCameraMatrix_, registeredDistCoeffs_,
+                                                rbtRgb2Depth_, outputImagePlaneSize_, depthDilation_,
+                                                1.0f, registeredDepth_, buffers_);
+                    break;
+                default:
+                    CV_Error(Error::StsUnsupportedFormat, "Input depth must be unsigned short, float, or double.");
+            }
+
+            (*cleaner_)(registeredDepth_, cleanedDepth_);
+            depthTo3d(cleanedDepth_, registeredK_, points3d);
+        }
+
+    private:
+        Matx33f unregisteredCameraMatrix_;
+        Matx33f registeredCameraMatrix_;
+        Mat registeredK_;
+        Mat_<float> registeredDistCoeffs_;
+        Matx44f rbtRgb2Depth_;
+        Size outputImagePlaneSize_;
+        bool depthDilation_;
+        int windowSize_;
+
+        Ptr<DepthCleaner> cleaner_;
+        // intermediate results, reused from frame to frame
+        RegistrationBuffers buffers_;
+        Mat registeredDepth_;
+        Mat cleanedDepth_;
+    };
+
+    Ptr<RgbdDepthPipeline>
+    RgbdDepthPipeline::create(InputArray unregisteredCameraMatrix, InputArray registeredCameraMatrix,
+                              InputArray registeredDistCoeffs, InputArray Rt, const Size& outputImagePlaneSize,
+                              bool depthDilation, int window_size)
+    {
+        CV_Assert(unregisteredCameraMatrix.depth() == CV_64F || unregisteredCameraMatrix.depth() == CV_32F);
+        CV_Assert(registeredCameraMatrix.depth() == CV_64F || registeredCameraMatrix.depth() == CV_32F);
+        CV_Assert(registeredDistCoeffs.empty() || registeredDistCoeffs.depth() == CV_64F || registeredDistCoeffs.depth() == CV_32F);
+        CV_Assert(Rt.depth() == CV_64F || Rt.depth() == CV_32F);
+        CV_Assert(outputImagePlaneSize.height > 0 && outputImagePlaneSize.width > 0);
+
+        // Implicitly checking dimensions of the InputArrays
+        Matx33f _unregisteredCameraMatrix = unregisteredCameraMatrix.getMat();
+        Matx33f _registeredCameraMatrix = registeredCameraMatrix.getMat();
+        Mat_<float> _registeredDistCoeffs = registeredDistCoeffs.getMat();
+        Matx44f _rbtRgb2Depth = Rt.getMat();
+
+        return makePtr<RgbdDepthPipelineImpl>(_unregisteredCameraMatrix, _registeredCameraMatrix,
+                                              _registeredDistCoeffs.clone(), _rbtRgb2Depth,
+                                              outputImagePlaneSize, depthDilation, window_size);
+    }
+
 } /* namespace rgbd */
 } /* namespace cv */
@@ -97,6 +97,48 @@ namespace rgbd
     points3d = points3d.reshape(3, 1);
   }
 
+  /** Back-project one row of depth
+   * @param x_cache the (x - ox) / fx values of the row
+   * @param y_cache the (y - oy) / fy value of the row
+   * @param depth the depth row
+   * @param point the resulting 3d points
+   * @param cols the size of the row
+   */
+  template<typename T>
+  static inline void
+  depthTo3dRow(const T* x_cache, T y_cache, const T* depth, cv::Vec<T, 3>* point, int cols)
+  {
+    for (int x = 0; x < cols; ++x)
+    {
+      T z = depth[x];
+      point[x][0] = x_cache[x] * z;
+      point[x][1] = y_cache * z;
+      point[x][2] = z;
+    }
+  }
+
+  static inline void
+  depthTo3dRow(const float* x_cache, float y_cache, const float* depth, cv::Vec3f* point, int cols)
+  {
+    int x = 0;
+#if USE_INTRINSICS
+    const v_float32x4 vy = v_setall_f32(y_cache);
+    float* point_ptr = point[0].val;
+    for (; x <= cols - 4; x += 4)
+    {
+      v_float32x4 z = v_load(depth + x);
+      v_store_interleave(point_ptr + 3 * x, v_mul(v_load(x_cache + x), z), v_mul(vy, z), z);
+    }
+#endif
+    for (; x < cols; ++x)
+    {
+      float z = depth[x];
+      point[x][0] = x_cache[x] * z;
+      point[x][1] = y_cache * z;
+      point[x][2] = z;
+    }
+  }
+
   /**
    * @param K
    * @param depth the depth image
@@ -126,20 +168,11 @@ namespace rgbd
     for (int y = 0; y < in_depth.rows; ++y, ++y_cache_ptr)
       *y_cache_ptr = (y - oy) * inv_fy;
 
-    y_cache_ptr = y_cache[0];
-    for (int y = 0; y < in_depth.rows; ++y, ++y_cache_ptr)
+    parallel_for_(Range(0, in_depth.rows), [&](const Range& range)
     {
-      cv::Vec<T, 3>* point = points3d.ptr<cv::Vec<T, 3> >(y);
-      const T* x_cache_ptr_end = x_cache[0] + in_depth.cols;
-      const T* depth = z_mat[y];
-      for (x_cache_ptr = x_cache[0]; x_cache_ptr != x_cache_ptr_end; ++x_cache_ptr, ++point, ++depth)
-      {
-        T z = *depth;
-        (*point)[0] = (*x_cache_ptr) * z;
-        (*point)[1] = (*y_cache_ptr) * z;
-        (*point)[2] = z;
-      }
-    }
+      for (int y = range.start; y < range.end; ++y)
+        depthTo3dRow(x_cache[0], y_cache(y, 0), z_mat[y], points3d.ptr<cv::Vec<T, 3> >(y), in_depth.cols);
+    });
   }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -163,13 +196,14 @@ namespace rgbd
       points.convertTo(points_float, CV_32FC2);
     else
       points_float = points;
+    CV_Assert(points_float.type() == CV_32FC2);
 
     // Fill the depth matrix
     cv::Mat_<float> z_mat;
 
     if (depth.depth() == CV_16U)
       convertDepthToFloat<ushort>(depth, 1.0f / 1000.0f, points_float, z_mat);
-    else if (depth.depth() == CV_16U)
+    else if (depth.depth() == CV_16S)
       convertDepthToFloat<short>(depth, 1.0f / 1000.0f, points_float, z_mat);
     else
     {
@@ -177,12 +211,39 @@ namespace rgbd
       convertDepthToFloat<float>(depth, 1.0f, points_float, z_mat);
     }
 
-    std::vector<cv::Mat> channels(2);
-    cv::split(points_float, channels);
+    cv::Mat_<float> K;
+    if (K_in.depth() == CV_32F)
+      K = K_in.getMat();
+    else
+      K_in.getMat().convertTo(K, CV_32F);
+
+    const float fx = K(0, 0);
+    const float fy = K(1, 1);
+    const float s = K(0, 1);
+    const float cx = K(0, 2);
+    const float cy = K(1, 2);
 
-    points3d_out.create(channels[0].rows, channels[0].cols, CV_32FC3);
+    // Back-project the points directly instead of going through the matrix expressions
+    // of depthTo3d_from_uvz, which allocate several temporary matrices
+    points3d_out.create(points_float.rows, points_float.cols, CV_32FC3);
     cv::Mat points3d = points3d_out.getMat();
-    depthTo3d_from_uvz(K_in.getMat(), channels[0], channels[1], z_mat, points3d);
+    parallel_for_(Range(0, points_float.rows), [&](const Range& range)
+    {
+      for (int y = range.start; y < range.end; ++y)
+      {
+        const cv::Vec2f* uv = points_float.ptr<cv::Vec2f>(y);
+        const float* z = z_mat[y];
+        cv::Vec3f* point = points3d.ptr<cv::Vec3f>(y);
+        for (int x = 0; x < points_float.cols; ++x)
+        {
+          float u = uv[x][0], v = uv[x][1];
+          float px = (u - cx) / fx;
+          if (s != 0)
+            px = px + (-(s / fy) * v + cy * s / fy) / fx;
+          point[x] = cv::Vec3f(px * z[x], (v - cy) * z[x] * (1.f / fy), z[x]);
+        }
+      }
+    });
   }
 
   /**
@@ -5,6 +5,7 @@
 // This code is also subject to the license terms in the LICENSE_WillowGarage.md file found in this module's directory
 
 #include "precomp.hpp"
+#include "utils.hpp"
 
 namespace cv
 {
@@ -33,17 +34,17 @@ namespace rgbd
     typedef Vec<T, 3> PointT;
 
     // Compute the
-    Size size(points.cols, points.rows);
-    Mat_<T> r(size);
-    if (points.isContinuous())
-      size = Size(points.cols * points.rows, 1);
-    for (int y = 0; y < size.height; ++y)
+    Mat_<T> r(points.rows, points.cols);
+    parallel_for_(Range(0, points.rows), [&](const Range& range)
     {
-      const PointT* point = points.ptr < PointT > (y), *point_end = points.ptr < PointT > (y) + size.width;
-      T * row = r[y];
-      for (; point != point_end; ++point, ++row)
-        *row = norm_vec(*point);
-    }
+      for (int y = range.start; y < range.end; ++y)
+      {
+        const PointT* point = points.ptr < PointT > (y), *point_end = point + points.cols;
+        T * row = r[y];
+        for (; point != point_end; ++point, ++row)
+          *row = norm_vec(*point);
+      }
+    });
 
     return r;
   }
@@ -132,6 +133,137 @@ namespace rgbd
     }
   }
 
+#if USE_INTRINSICS
+  template<typename VecT>
+  inline VecT
+  setAllSimd(typename VTraits<VecT>::lane_type val);
+
+  template<>
+  inline v_float32x4
+  setAllSimd<v_float32x4>(float val)
+  {
+    return v_setall_f32(val);
+  }
+
+#if CV_SIMD128_64F
+  template<>
+  inline v_float64x2
+  setAllSimd<v_float64x2>(double val)
+  {
+    return v_setall_f64(val);
+  }
+#endif
+
+  /** Vector counterpart of signNormal(const Vec<T, 3>&, Vec<T, 3>&) for a batch of normals stored by coordinate
+   */
+  template<typename VecT>
+  inline void
+  signNormalSimd(VecT &x, VecT &y, VecT &z)
+  {
+    const VecT zero = setAllSimd<VecT>(0);
+    VecT norm = v_sqrt(v_add(v_add(v_mul(x, x), v_mul(y, y)), v_mul(z, z)));
+    VecT flip = v_gt(z, zero);
+    x = v_div(v_select(flip, v_sub(zero, x), x), norm);
+    y = v_div(v_select(flip, v_sub(zero, y), y), norm);
+    z = v_div(v_select(flip, v_sub(zero, z), z), norm);
+  }
+
+  /** Computes B = V / r for a row, zeroing the points where B is not finite
+   * @return the number of processed pixels, the tail is left to the caller
+   */
+  template<typename VecT, typename T>
+  int
+  falsComputeBRowSimd(const T* r, const T* V, T* B, int cols)
+  {
+    const int step = VTraits<VecT>::vlanes();
+    const VecT inf = setAllSimd<VecT>(std::numeric_limits<T>::infinity());
+    int x = 0;
+    for (; x <= cols - step; x += step)
+    {
+      VecT vr = v_load(r + x), b0, b1, b2;
+      v_load_deinterleave(V + 3 * x, b0, b1, b2);
+      b0 = v_div(b0, vr);
+      b1 = v_div(b1, vr);
+      b2 = v_div(b2, vr);
+      // |b| < inf fails for infinite and NaN values alike
+      VecT valid = v_and(v_and(v_lt(v_abs(b0), inf), v_lt(v_abs(b1), inf)), v_lt(v_abs(b2), inf));
+      v_store_interleave(B + 3 * x, v_and(valid, b0), v_and(valid, b1), v_and(valid, b2));
+    }
+    return x;
+  }
+
+  /** Computes the normals M_inv * B of a row, M_inv being given by its 6 distinct coefficients
+   * @return the number of processed pixels, the tail is left to the caller
+   */
+  template<typename VecT, typename T>
+  int
+  falsSolveRowSimd(const T* r, const T* B, const T* const * M_inv, T* normal, int cols)
+  {
+    const int step = VTraits<VecT>::vlanes();
+    int x = 0;
+    for (; x <= cols - step; x += step)
+    {
+      VecT b0, b1, b2;
+      v_load_deinterleave(B + 3 * x, b0, b1, b2);
+      VecT m00 = v_load(M_inv[0] + x), m01 = v_load(M_inv[1] + x), m02 = v_load(M_inv[2] + x);
+      VecT m11 = v_load(M_inv[3] + x), m12 = v_load(M_inv[4] + x), m22 = v_load(M_inv[5] + x);
+      VecT n0 = v_add(v_add(v_mul(m00, b0), v_mul(m01, b1)), v_mul(m02, b2));
+      VecT n1 = v_add(v_add(v_mul(m01, b0), v_mul(m11, b1)), v_mul(m12, b2));
+      VecT n2 = v_add(v_add(v_mul(m02, b0), v_mul(m12, b1)), v_mul(m22, b2));
+      signNormalSimd(n0, n1, n2);
+
+      // Points without depth get a NaN normal
+      VecT vr = v_load(r + x);
+      VecT no_depth = v_ne(vr, vr);
+      v_store_interleave(normal + 3 * x, v_select(no_depth, vr, n0), v_select(no_depth, vr, n1),
+                         v_select(no_depth, vr, n2));
+    }
+    return x;
+  }
+#endif
+
+  template<typename T>
+  inline int
+  falsComputeBRow(const T*, const T*, T*, int)
+  {
+    return 0;
+  }
+
+  template<typename T>
+  inline int
+  falsSolveRow(const T*, const T*, const T* const *, T*, int)
+  {
+    return 0;
+  }
+
+#if USE_INTRINSICS
+  inline int
+  falsComputeBRow(const float* r, const float* V, float* B, int cols)
+  {
+    return falsComputeBRowSimd<v_float32x4>(r, V, B, cols);
+  }
+
+  inline int
+  falsSolveRow(const float* r, const float* B, const float* const * M_inv, float* normal, int cols)
+  {
+    return falsSolveRowSimd<v_float32x4>(r, B, M_inv, normal, cols);
+  }
+
+#if CV_SIMD128_64F
+  inline int
+  falsComputeBRow(const double* r, const double* V, double* B, int cols)
+  {
+    return falsComputeBRowSimd<v_float64x2>(r, V, B, cols);
+  }
+
+  inline int
+  falsSolveRow(const double* r, const double* B, const double* const * M_inv, double* normal, int cols)
+  {
+    return falsSolveRowSimd<v_float64x2>(r, B, M_inv, normal, cols);
+  }
+#endif
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
   class RgbdNormalsImpl
@@ -227,16 +359,29 @@ namespace rgbd
 
       boxFilter(M, M, M.depth(), Size(window_size_, window_size_), Point(-1, -1), false);
 
-      // Compute M's inverse
-      Mat33T M_inv;
-      M_inv_.create(rows_, cols_);
-      Vec9T * M_inv_ptr = M_inv_[0];
-      for (M_ptr = &M(0); M_ptr != M_ptr_end; ++M_inv_ptr, ++M_ptr)
+      // Compute M's inverse. It is symmetric, so only its 6 distinct coefficients are kept,
+      // one plane each so that compute() can read them with vector loads
+      for (int i = 0; i < 6; ++i)
+        M_inv_[i].create(rows_, cols_);
+      parallel_for_(Range(0, rows_), [&](const Range& range)
       {
-        // We have a semi-definite matrix
-        invert(Mat33T(M_ptr->val), M_inv, DECOMP_CHOLESKY);
-        *M_inv_ptr = Vec9T(M_inv.val);
-      }
+        Mat33T M_inv;
+        for (int y = range.start; y < range.end; ++y)
+        {
+          const Vec9T * M_row = M[y];
+          for (int x = 0; x < cols_; ++x)
+          {
+            // We have a semi-definite matrix
+            invert(Mat33T(M_row[x].val), M_inv, DECOMP_CHOLESKY);
+            M_inv_[0](y, x) = M_inv(0, 0);
+            M_inv_[1](y, x) = M_inv(0, 1);
+            M_inv_[2](y, x) = M_inv(0, 2);
+            M_inv_[3](y, x) = M_inv(1, 1);
+            M_inv_[4](y, x) = M_inv(1, 2);
+            M_inv_[5](y, x) = M_inv(2, 2);
+          }
+        }
+      });
     }
 
     /** Compute the normals
@@ -249,49 +394,67 @@ namespace rgbd
       // Compute B
       Mat_<Vec3T> B(rows_, cols_);
 
-      const T* row_r = r.ptr < T > (0), *row_r_end = row_r + rows_ * cols_;
-      const Vec3T *row_V = V_[0];
-      Vec3T *row_B = B[0];
-      for (; row_r != row_r_end; ++row_r, ++row_B, ++row_V)
+      parallel_for_(Range(0, rows_), [&](const Range& range)
       {
-          Vec3T val = (*row_V) / (*row_r);
-          if(cvIsInf(val[0]) || cvIsNaN(val[0]) ||
-             cvIsInf(val[1]) || cvIsNaN(val[1]) ||
-             cvIsInf(val[2]) || cvIsNaN(val[2]))
-              *row_B = Vec3T();
-          else
-              *row_B = val;
-      }
+        for (int y = range.start; y < range.end; ++y)
+        {
+          const T* row_r = r.ptr < T > (y), *row_r_end = row_r + cols_;
+          const Vec3T *row_V = V_[y];
+          Vec3T *row_B = B[y];
+          const int done = falsComputeBRow(row_r, row_V->val, row_B->val, cols_);
+          row_r += done;
+          row_V += done;
+          row_B += done;
+          for (; row_r != row_r_end; ++row_r, ++row_B, ++row_V)
+          {
+              Vec3T val = (*row_V) / (*row_r);
+              if(cvIsInf(val[0]) || cvIsNaN(val[0]) ||
+                 cvIsInf(val[1]) || cvIsNaN(val[1]) ||
+                 cvIsInf(val[2]) || cvIsNaN(val[2]))
+                  *row_B = Vec3T();
+              else
+                  *row_B = val;
+          }
+        }
+      });
 
       // Apply a box filter to B
       boxFilter(B, B, B.depth(), Size(window_size_, window_size_), Point(-1, -1), false);
 
       // compute the Minv*B products
-      row_r = r.ptr < T > (0);
-      const Vec3T * B_vec = B[0];
-      const Mat33T * M_inv = reinterpret_cast<const Mat33T *>(M_inv_.ptr(0));
-      Vec3T *normal = normals.ptr<Vec3T>(0);
-      for (; row_r != row_r_end; ++row_r, ++B_vec, ++normal, ++M_inv)
-        if (cvIsNaN(*row_r))
-        {
-          (*normal)[0] = *row_r;
-          (*normal)[1] = *row_r;
-          (*normal)[2] = *row_r;
-        }
-        else
+      parallel_for_(Range(0, rows_), [&](const Range& range)
+      {
+        for (int y = range.start; y < range.end; ++y)
         {
-            Mat33T Mr = *M_inv;
-            Vec3T Br = *B_vec;
-            Vec3T MBr(Mr(0, 0) * Br[0] + Mr(0, 1)*Br[1] + Mr(0, 2)*Br[2],
-                      Mr(1, 0) * Br[0] + Mr(1, 1)*Br[1] + Mr(1, 2)*Br[2],
-                      Mr(2, 0) * Br[0] + Mr(2, 1)*Br[1] + Mr(2, 2)*Br[2]);
-           signNormal(MBr, *normal);
+          const T* row_r = r.ptr < T > (y);
+          const Vec3T * B_vec = B[y];
+          const T* M_inv[6];
+          for (int i = 0; i < 6; ++i)
+            M_inv[i] = M_inv_[i][y];
+          Vec3T *normal = normals.ptr<Vec3T>(y);
+          for (int x = falsSolveRow(row_r, B_vec->val, M_inv, normal->val, cols_); x < cols_; ++x)
+            if (cvIsNaN(row_r[x]))
+            {
+              normal[x][0] = row_r[x];
+              normal[x][1] = row_r[x];
+              normal[x][2] = row_r[x];
+            }
+            else
+            {
+              const Vec3T& Br = B_vec[x];
+              Vec3T MBr(M_inv[0][x] * Br[0] + M_inv[1][x] * Br[1] + M_inv[2][x] * Br[2],
+                        M_inv[1][x] * Br[0] + M_inv[3][x] * Br[1] + M_inv[4][x] * Br[2],
+                        M_inv[2][x] * Br[0] + M_inv[4][x] * Br[1] + M_inv[5][x] * Br[2]);
+              signNormal(MBr, normal[x]);
+            }
         }
+      });
     }
 
   private:
     Mat_<Vec3T> V_;
-    Mat_<Vec9T> M_inv_;
+    /** The coefficients (0,0), (0,1), (0,2), (1,1), (1,2) and (2,2) of the inverses of M */
+    Mat_<T> M_inv_[6];
   };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -313,6 +476,79 @@ multiply_by_K_inv(const Matx<T, 3, 3> & K_inv, U a, U b, U c, Vec<T, 3> &res)
   res[2] = (T)c;
 }
 
+  /** Computes the LINEMOD normals of a row of pixels starting at x, up to x_end excluded.
+   * The generic version leaves everything to the scalar loop of LINEMOD::computeImpl
+   * @return the number of processed pixels
+   */
+  template<typename DepthDepth, typename ContainerDepth, typename T>
+  inline int
+  linemodNormalsRow(const DepthDepth*, Vec<T, 3>*, int, int, int, const long*, const long*, const long*, int,
+                    const Matx<T, 3, 3>&, ContainerDepth)
+  {
+    return 0;
+  }
+
+#if USE_INTRINSICS
+  /** Float depth and float normals: 4 pixels at a time, with the same operations as the scalar loop
+   */
+  inline int
+  linemodNormalsRow(const float* p_line, Vec3f* normal, int x, int x_end, int y, const long* offsets,
+                    const long* offsets_x, const long* offsets_y, int n_offsets, const Matx33f& K_inv,
+                    float difference_threshold)
+  {
+    const int x_begin = x;
+    const v_float32x4 zero = v_setzero_f32(), threshold = v_setall_f32(difference_threshold);
+    const v_float32x4 k00 = v_setall_f32(K_inv(0, 0)), k01 = v_setall_f32(K_inv(0, 1)), k02 = v_setall_f32(K_inv(0, 2));
+    const v_float32x4 k11 = v_setall_f32(K_inv(1, 1)), k12 = v_setall_f32(K_inv(1, 2));
+    const v_float32x4 vy = v_setall_f32((float)y), vy1 = v_setall_f32((float)(y + 1));
+    for (; x <= x_end - 4; x += 4, p_line += 4, normal += 4)
+    {
+      v_float32x4 d = v_load(p_line);
+
+      // accum
+      v_float32x4 A0 = zero, A1 = zero, A3 = zero, b0 = zero, b1 = zero;
+      for (int i = 0; i < n_offsets; ++i)
+      {
+        v_float32x4 delta = v_sub(v_load(p_line + offsets[i]), d);
+        // Written as !(|delta| > threshold) so that NaN deltas are accumulated like in the scalar loop
+        v_float32x4 keep = v_not(v_gt(v_abs(delta), threshold));
+        float ox = (float)offsets_x[i], oy = (float)offsets_y[i];
+        A0 = v_add(A0, v_and(keep, v_setall_f32(ox * ox)));
+        A1 = v_add(A1, v_and(keep, v_setall_f32(ox * oy)));
+        A3 = v_add(A3, v_and(keep, v_setall_f32(oy * oy)));
+        b0 = v_add(b0, v_and(keep, v_mul(v_setall_f32(ox), delta)));
+        b1 = v_add(b1, v_and(keep, v_mul(v_setall_f32(oy), delta)));
+      }
+
+      // solve for the optimal gradient D of equation (8), without the division by det
+      v_float32x4 det = v_sub(v_mul(A0, A3), v_mul(A1, A1));
+      v_float32x4 dx = v_sub(v_mul(A3, b0), v_mul(A1, b1));
+      v_float32x4 dy = v_sub(v_mul(A0, b1), v_mul(A1, b0));
+
+      v_float32x4 vx((float)x, (float)(x + 1), (float)(x + 2), (float)(x + 3));
+      v_float32x4 d_det = v_mul(d, det);
+
+      // X1_minus_X = K_inv * (d * det + (x + 1) * dx, y * dx, dx)
+      v_float32x4 a = v_add(d_det, v_mul(v_add(vx, v_setall_f32(1.f)), dx)), b = v_mul(vy, dx);
+      v_float32x4 X1_0 = v_add(v_add(v_mul(k00, a), v_mul(k01, b)), v_mul(k02, dx));
+      v_float32x4 X1_1 = v_add(v_mul(k11, b), v_mul(k12, dx));
+      // X2_minus_X = K_inv * (x * dy, d * det + (y + 1) * dy, dy)
+      a = v_mul(vx, dy);
+      b = v_add(d_det, v_mul(vy1, dy));
+      v_float32x4 X2_0 = v_add(v_add(v_mul(k00, a), v_mul(k01, b)), v_mul(k02, dy));
+      v_float32x4 X2_1 = v_add(v_mul(k11, b), v_mul(k12, dy));
+
+      // X1_minus_X.cross(X2_minus_X)
+      v_float32x4 n0 = v_sub(v_mul(X1_1, dy), v_mul(dx, X2_1));
+      v_float32x4 n1 = v_sub(v_mul(dx, X2_0), v_mul(X1_0, dy));
+      v_float32x4 n2 = v_sub(v_mul(X1_0, X2_1), v_mul(X1_1, X2_0));
+      signNormalSimd(n0, n1, n2);
+      v_store_interleave(normal->val, n0, n1, n2);
+    }
+    return x - x_begin;
+  }
+#endif
+
   /** Given a depth image, compute the normals as detailed in the LINEMOD paper
    * ``Gradient Response Maps for Real-Time Detection of Texture-Less Objects``
    * by S. Hinterstoisser, C. Cagniart, S. Ilic, P. Sturm, N. Navab, P. Fua, and V. Lepetit
@@ -406,59 +642,68 @@ multiply_by_K_inv(const Matx<T, 3, 3> & K_inv, U a, U b, U c, Vec<T, 3> &res)
       K_inv(1, 1) = 1 / K(1, 1);
       K_inv(1, 2) = -K(1, 2) / K(1, 1);
 
-      Vec3T X1_minus_X, X2_minus_X;
-
       ContainerDepth difference_threshold = 50;
       normals.setTo(std::numeric_limits<DepthDepth>::quiet_NaN());
-      for (int y = r; y < rows_ - r - 1; ++y)
-      {
-        const DepthDepth * p_line = reinterpret_cast<const DepthDepth*>(depth.ptr(y, r));
-        Vec3T *normal = normals.ptr<Vec3T>(y, r);
+      if (rows_ - r - 1 <= r)
+        return normals;
 
-        for (int x = r; x < cols_ - r - 1; ++x)
+      parallel_for_(Range(r, rows_ - r - 1), [&](const Range& range)
+      {
+        Vec3T X1_minus_X, X2_minus_X;
+        for (int y = range.start; y < range.end; ++y)
         {
-          DepthDepth d = p_line[0];
-
-          // accum
-          long A[4];
-          A[0] = A[1] = A[2] = A[3] = 0;
-          ContainerDepth b[2];
-          b[0] = b[1] = 0;
-          for (unsigned int i = 0; i < square_size * square_size; ++i) {
-            // We need to cast to ContainerDepth in case we have unsigned DepthDepth
-            ContainerDepth delta = ContainerDepth(p_line[offsets[i]]) - ContainerDepth(d);
-            if (std::abs(delta) > difference_threshold)
-               continue;
-
-             A[0] += offsets_x_x[i];
-             A[1] += offsets_x_y[i];
-             A[3] += offsets_y_y[i];
-             b[0] += offsets_x[i] * delta;
-             b[1] += offsets_y[i] * delta;
+          const DepthDepth * p_line = reinterpret_cast<const DepthDepth*>(depth.ptr(y, r));
+          Vec3T *normal = normals.ptr<Vec3T>(y, r);
+
+          const int done = linemodNormalsRow(p_line, normal, r, cols_ - r - 1, y, offsets, offsets_x, offsets_y,
+                                             square_size * square_size, K_inv, difference_threshold);
+          p_line += done;
+          normal += done;
+          for (int x = r + done; x < cols_ - r - 1; ++x)
+          {
+            DepthDepth d = p_line[0];
+
+            // accum
+            long A[4];
+            A[0] = A[1] = A[2] = A[3] = 0;
+            ContainerDepth b[2];
+            b[0] = b[1] = 0;
+            for (unsigned int i = 0; i < square_size * square_size; ++i) {
+              // We need to cast to ContainerDepth in case we have unsigned DepthDepth
+              ContainerDepth delta = ContainerDepth(p_line[offsets[i]]) - ContainerDepth(d);
+              if (std::abs(delta) > difference_threshold)
+                 continue;
+
+               A[0] += offsets_x_x[i];
+               A[1] += offsets_x_y[i];
+               A[3] += offsets_y_y[i];
+               b[0] += offsets_x[i] * delta;
+               b[1] += offsets_y[i] * delta;
+            }
+
+            // solve for the optimal gradient D of equation (8)
+            long det = A[0] * A[3] - A[1] * A[1];
+            // We should divide the following two by det, but instead, we multiply
+            // X1_minus_X and X2_minus_X by det (which does not matter as we normalize the normals)
+            // Therefore, no division is done: this is only for speedup
+            ContainerDepth dx = (A[3] * b[0] - A[1] * b[1]);
+            ContainerDepth dy = (-A[1] * b[0] + A[0] * b[1]);
+
+            // Compute the dot product
+            //Vec3T X = K_inv * Vec3T(x, y, 1) * depth(y, x);
+            //Vec3T X1 = K_inv * Vec3T(x + 1, y, 1) * (depth(y, x) + dx);
+            //Vec3T X2 = K_inv * Vec3T(x, y + 1, 1) * (depth(y, x) + dy);
+            //Vec3T nor = (X1 - X).cross(X2 - X);
+            multiply_by_K_inv(K_inv, d * det + (x + 1) * dx, y * dx, dx, X1_minus_X);
+            multiply_by_K_inv(K_inv, x * dy, d * det + (y + 1) * dy, dy, X2_minus_X);
+            Vec3T nor = X1_minus_X.cross(X2_minus_X);
+            signNormal(nor, *normal);
+
+            ++p_line;
+            ++normal;
           }
-
-          // solve for the optimal gradient D of equation (8)
-          long det = A[0] * A[3] - A[1] * A[1];
-          // We should divide the following two by det, but instead, we multiply
-          // X1_minus_X and X2_minus_X by det (which does not matter as we normalize the normals)
-          // Therefore, no division is done: this is only for speedup
-          ContainerDepth dx = (A[3] * b[0] - A[1] * b[1]);
-          ContainerDepth dy = (-A[1] * b[0] + A[0] * b[1]);
-
-          // Compute the dot product
-          //Vec3T X = K_inv * Vec3T(x, y, 1) * depth(y, x);
-          //Vec3T X1 = K_inv * Vec3T(x + 1, y, 1) * (depth(y, x) + dx);
-          //Vec3T X2 = K_inv * Vec3T(x, y + 1, 1) * (depth(y, x) + dy);
-          //Vec3T nor = (X1 - X).cross(X2 - X);
-          multiply_by_K_inv(K_inv, d * det + (x + 1) * dx, y * dx, dx, X1_minus_X);
-          multiply_by_K_inv(K_inv, x * dy, d * det + (y + 1) * dy, dy, X2_minus_X);
-          Vec3T nor = X1_minus_X.cross(X2_minus_X);
-          signNormal(nor, *normal);
-
-          ++p_line;
-          ++normal;
         }
-      }
+      });
 
       return normals;
     }
@@ -597,35 +842,47 @@ multiply_by_K_inv(const Matx<T, 3, 3> & K_inv, U a, U b, U c, Vec<T, 3> &res)
       // Fill the result matrix
       Mat_<Vec3T> normals(rows_, cols_);
 
-      const T* r_theta_ptr = r_theta[0], *r_theta_ptr_end = r_theta_ptr + rows_ * cols_;
-      const T* r_phi_ptr = r_phi[0];
-      const Mat33T * R = reinterpret_cast<const Mat33T *>(R_hat_[0]);
-      const T* r_ptr = r[0];
-      Vec3T * normal = normals[0];
-      for (; r_theta_ptr != r_theta_ptr_end; ++r_theta_ptr, ++r_phi_ptr, ++R, ++r_ptr, ++normal)
+      parallel_for_(Range(0, rows_), [&](const Range& range)
       {
-        if (cvIsNaN(*r_ptr))
-        {
-          (*normal)[0] = *r_ptr;
-          (*normal)[1] = *r_ptr;
-          (*normal)[2] = *r_ptr;
-        }
-        else
+        for (int y = range.start; y < range.end; ++y)
         {
-          T r_theta_over_r = (*r_theta_ptr) / (*r_ptr);
-          T r_phi_over_r = (*r_phi_ptr) / (*r_ptr);
-          // R(1,1) is 0
-          signNormal((*R)(0, 0) + (*R)(0, 1) * r_theta_over_r + (*R)(0, 2) * r_phi_over_r,
-                     (*R)(1, 0) + (*R)(1, 2) * r_phi_over_r,
-                     (*R)(2, 0) + (*R)(2, 1) * r_theta_over_r + (*R)(2, 2) * r_phi_over_r, *normal);
+          const T* r_theta_ptr = r_theta[y], *r_theta_ptr_end = r_theta_ptr + cols_;
+          const T* r_phi_ptr = r_phi[y];
+          const Mat33T * R = reinterpret_cast<const Mat33T *>(R_hat_[y]);
+          const T* r_ptr = r[y];
+          Vec3T * normal = normals[y];
+          for (; r_theta_ptr != r_theta_ptr_end; ++r_theta_ptr, ++r_phi_ptr, ++R, ++r_ptr, ++normal)
+          {
+            if (cvIsNaN(*r_ptr))
+            {
+              (*normal)[0] = *r_ptr;
+              (*normal)[1] = *r_ptr;
+              (*normal)[2] = *r_ptr;
+            }
+            else
+            {
+              T r_theta_over_r = (*r_theta_ptr) / (*r_ptr);
+              T r_phi_over_r = (*r_phi_ptr) / (*r_ptr);
+              // R(1,1) is 0
+              signNormal((*R)(0, 0) + (*R)(0, 1) * r_theta_over_r + (*R)(0, 2) * r_phi_over_r,
+                         (*R)(1, 0) + (*R)(1, 2) * r_phi_over_r,
+                         (*R)(2, 0) + (*R)(2, 1) * r_theta_over_r + (*R)(2, 2) * r_phi_over_r, *normal);
+            }
+          }
         }
-      }
+      });
 
       remap(normals, normals_out, invxy_, invfxy_, INTER_LINEAR);
-      normal = normals_out.ptr<Vec3T>(0);
-      Vec3T * normal_end = normal + rows_ * cols_;
-      for (; normal != normal_end; ++normal)
-        signNormal((*normal)[0], (*normal)[1], (*normal)[2], *normal);
+      parallel_for_(Range(0, rows_), [&](const Range& range)
+      {
+        for (int y = range.start; y < range.end; ++y)
+        {
+          Vec3T * normal = normals_out.ptr<Vec3T>(y);
+          Vec3T * normal_end = normal + cols_;
+          for (; normal != normal_end; ++normal)
+            signNormal((*normal)[0], (*normal)[1], (*normal)[2], *normal);
+        }
+      });
     }
   private:
     /** Stores R */
@@ -444,12 +444,13 @@ void computeCorresps(const Mat& K, const Mat& K_inv, const Mat& Rt,
     CV_Assert(K_inv.type() == CV_64FC1);
     CV_Assert(Rt.type() == CV_64FC1);
 
-    Mat corresps(depth1.size(), CV_16SC2, Scalar::all(-1));
-
     Rect r(0, 0, depth1.cols, depth1.rows);
     Mat Kt = Rt(Rect(3,0,1,3)).clone();
     Kt = K * Kt;
     const double * Kt_ptr = Kt.ptr<const double>();
+    // the vectorized and the scalar projections both compute in float, so that a pixel is
+    // matched the same way whichever path it falls in
+    const float Kt0 = (float)Kt_ptr[0], Kt1 = (float)Kt_ptr[1], Kt2 = (float)Kt_ptr[2];
 
     AutoBuffer<float> buf(3 * (depth1.cols + depth1.rows));
     float *KRK_inv0_u1 = buf.data();
@@ -478,52 +479,112 @@ void computeCorresps(const Mat& K, const Mat& K_inv, const Mat& Rt,
         }
     }
 
-    int correspCount = 0;
-    for(int v1 = 0; v1 < depth1.rows; v1++)
+    // Project the selected pixels of depth1 to the frame 0 in parallel.
+    // projected keeps the linear index v0*cols+u0 of a valid match or -1,
+    // transformedDepth keeps the depth of the pixel in the frame 0.
+    Mat projected(depth1.size(), CV_32SC1);
+    Mat transformedDepth(depth1.size(), CV_32FC1);
+    parallel_for_(Range(0, depth1.rows), [&](const Range& range)
     {
-        const float *depth1_row = depth1.ptr<float>(v1);
-        const uchar *mask1_row = selectMask1.ptr<uchar>(v1);
-        for(int u1 = 0; u1 < depth1.cols; u1++)
+        for(int v1 = range.start; v1 < range.end; v1++)
         {
-            float d1 = depth1_row[u1];
-            if(mask1_row[u1])
+            const float *depth1_row = depth1.ptr<float>(v1);
+            const uchar *mask1_row = selectMask1.ptr<uchar>(v1);
+            int *projected_row = projected.ptr<int>(v1);
+            float *transformedDepth_row = transformedDepth.ptr<float>(v1);
+
+            int u1 = 0;
+#if USE_INTRINSICS
+            const v_float32x4 vKt0 = v_setall_f32(Kt0);
+            const v_float32x4 vKt1 = v_setall_f32(Kt1);
+            const v_float32x4 vKt2 = v_setall_f32(Kt2);
+            const v_float32x4 vKRK_inv_v1_0 = v_setall_f32(KRK_inv1_v1_plus_KRK_inv2[v1]);
+            const v_float32x4 vKRK_inv_v1_1 = v_setall_f32(KRK_inv4_v1_plus_KRK_inv5[v1]);
+            const v_float32x4 vKRK_inv_v1_2 = v_setall_f32(KRK_inv7_v1_plus_KRK_inv8[v1]);
+            const v_float32x4 vone = v_setall_f32(1.f), vzero = v_setzero_f32();
+            const v_int32x4 vcols = v_setall_s32(depth1.cols), vrows = v_setall_s32(depth1.rows);
+            const v_int32x4 vizero = v_setzero_s32(), vinvalid = v_setall_s32(-1);
+            for(; u1 <= depth1.cols - 4; u1 += 4)
+            {
+                v_float32x4 d1 = v_load(depth1_row + u1);
+                v_float32x4 td1 = v_add(v_mul(d1, v_add(v_load(KRK_inv6_u1 + u1), vKRK_inv_v1_2)), vKt2);
+                v_float32x4 td1_inv = v_div(vone, td1);
+                v_int32x4 u0 = v_round(v_mul(td1_inv, v_add(v_mul(d1, v_add(v_load(KRK_inv0_u1 + u1), vKRK_inv_v1_0)), vKt0)));
+                v_int32x4 v0 = v_round(v_mul(td1_inv, v_add(v_mul(d1, v_add(v_load(KRK_inv3_u1 + u1), vKRK_inv_v1_1)), vKt1)));
+
+                v_int32x4 selected = v_reinterpret_as_s32(v_ne(v_load_expand_q(mask1_row + u1), v_setzero_u32()));
+                v_int32x4 valid = v_and(selected, v_reinterpret_as_s32(v_gt(td1, vzero)));
+                valid = v_and(valid, v_and(v_ge(u0, vizero), v_lt(u0, vcols)));
+                valid = v_and(valid, v_and(v_ge(v0, vizero), v_lt(v0, vrows)));
+
+                v_store(projected_row + u1, v_select(valid, v_add(v_mul(v0, vcols), u0), vinvalid));
+                v_store(transformedDepth_row + u1, td1);
+            }
+#endif
+            for(; u1 < depth1.cols; u1++)
             {
-                CV_DbgAssert(!cvIsNaN(d1));
-                float transformed_d1 = static_cast<float>(d1 * (KRK_inv6_u1[u1] + KRK_inv7_v1_plus_KRK_inv8[v1]) +
-                                                          Kt_ptr[2]);
-                if(transformed_d1 > 0)
+                projected_row[u1] = -1;
+                float d1 = depth1_row[u1];
+                if(mask1_row[u1])
                 {
-                    float transformed_d1_inv = 1.f / transformed_d1;
-                    int u0 = cvRound(transformed_d1_inv * (d1 * (KRK_inv0_u1[u1] + KRK_inv1_v1_plus_KRK_inv2[v1]) +
-                                                           Kt_ptr[0]));
-                    int v0 = cvRound(transformed_d1_inv * (d1 * (KRK_inv3_u1[u1] + KRK_inv4_v1_plus_KRK_inv5[v1]) +
-                                                           Kt_ptr[1]));
-
-                    if(r.contains(Point(u0,v0)))
+                    CV_DbgAssert(!cvIsNaN(d1));
+                    float transformed_d1 = d1 * (KRK_inv6_u1[u1] + KRK_inv7_v1_plus_KRK_inv8[v1]) + Kt2;
+                    transformedDepth_row[u1] = transformed_d1;
+                    if(transformed_d1 > 0)
                     {
-                        float d0 = depth0.at<float>(v0,u0);
-                        if(validMask0.at<uchar>(v0, u0) && std::abs(transformed_d1 - d0) <= maxDepthDiff)
-                        {
-                            CV_DbgAssert(!cvIsNaN(d0));
-                            Vec2s& c = corresps.at<Vec2s>(v0,u0);
-                            if(c[0] != -1)
-                            {
-                                int exist_u1 = c[0], exist_v1 = c[1];
-
-                                float exist_d1 = (float)(depth1.at<float>(exist_v1,exist_u1) *
-                                    (KRK_inv6_u1[exist_u1] + KRK_inv7_v1_plus_KRK_inv8[exist_v1]) + Kt_ptr[2]);
-
-                                if(transformed_d1 > exist_d1)
-                                    continue;
-                            }
-                            else
-                                correspCount++;
-
-                            c = Vec2s((short)u1, (short)v1);
-                        }
+                        float transformed_d1_inv = 1.f / transformed_d1;
+                        float x0 = d1 * (KRK_inv0_u1[u1] + KRK_inv1_v1_plus_KRK_inv2[v1]) + Kt0;
+                        float y0 = d1 * (KRK_inv3_u1[u1] + KRK_inv4_v1_plus_KRK_inv5[v1]) + Kt1;
+                        int u0 = cvRound(transformed_d1_inv * x0);
+                        int v0 = cvRound(transformed_d1_inv * y0);
+                        if(r.contains(Point(u0,v0)))
+                            projected_row[u1] = v0 * depth1.cols + u0;
                     }
                 }
             }
+
+            // depth test against the frame 0
+            for(u1 = 0; u1 < depth1.cols; u1++)
+            {
+                int idx = projected_row[u1];
+                if(idx < 0)
+                    continue;
+
+                int v0 = idx / depth1.cols, u0 = idx - v0 * depth1.cols;
+                float d0 = depth0.at<float>(v0,u0);
+                if(!validMask0.at<uchar>(v0, u0) || !(std::abs(transformedDepth_row[u1] - d0) <= maxDepthDiff))
+                    projected_row[u1] = -1;
+                else
+                    CV_DbgAssert(!cvIsNaN(d0));
+            }
+        }
+    });
+
+    // Several pixels of depth1 may hit the same pixel of depth0, the nearest one wins.
+    // This pass is kept serial so that the result does not depend on the threads count.
+    Mat corresps(depth1.size(), CV_16SC2, Scalar::all(-1));
+    int correspCount = 0;
+    for(int v1 = 0; v1 < depth1.rows; v1++)
+    {
+        const int *projected_row = projected.ptr<int>(v1);
+        const float *transformedDepth_row = transformedDepth.ptr<float>(v1);
+        for(int u1 = 0; u1 < depth1.cols; u1++)
+        {
+            int idx = projected_row[u1];
+            if(idx < 0)
+                continue;
+
+            Vec2s& c = corresps.at<Vec2s>(idx / depth1.cols, idx % depth1.cols);
+            if(c[0] != -1)
+            {
+                int exist_u1 = c[0], exist_v1 = c[1];
+                if(transformedDepth_row[u1] > transformedDepth.at<float>(exist_v1, exist_u1))
+                    continue;
+            }
+            else
+                correspCount++;
+
+            c = Vec2s((short)u1, (short)v1);
         }
     }
 
@@ -614,6 +675,66 @@ void calcICPEquationCoeffsTranslation(double* C, const Point3f& /*p0*/, const Ve
 typedef
 void (*CalcICPEquationCoeffsPtr)(double*, const Point3f&, const Vec3f&);
 
+// Correspondences are processed in stripes of fixed size, whose partial sums are reduced
+// in stripe order afterwards, so the result does not depend on the number of threads
+static const int LSM_STRIPE_SIZE = 1024;
+
+static inline
+int lsmStripesCount(int correspsCount)
+{
+    return (correspsCount + LSM_STRIPE_SIZE - 1) / LSM_STRIPE_SIZE;
+}
+
+template<typename Body>
+static
+void parallelForLsmStripes(int correspsCount, const Body& body)
+{
+    parallel_for_(Range(0, lsmStripesCount(correspsCount)), [&](const Range& range)
+    {
+        for(int stripe = range.start; stripe < range.end; stripe++)
+            body(stripe, stripe * LSM_STRIPE_SIZE, std::min(correspsCount, (stripe + 1) * LSM_STRIPE_SIZE));
+    });
+}
+
+// Per-stripe accumulator of the upper triangle of A^T*A and of A^T*B
+struct LsmAccumulator
+{
+    explicit LsmAccumulator(int _transformDim) : transformDim(_transformDim)
+    {
+        std::fill(AtA, AtA + 36, 0.);
+        std::fill(AtB, AtB + 6, 0.);
+    }
+
+    inline void add(const double* A_ptr, double b)
+    {
+        for(int y = 0; y < transformDim; y++)
+        {
+            double* AtA_ptr = AtA + y * 6;
+            for(int x = y; x < transformDim; x++)
+                AtA_ptr[x] += A_ptr[y] * A_ptr[x];
+
+            AtB[y] += A_ptr[y] * b;
+        }
+    }
+
+    void mergeTo(Mat& _AtA, Mat& _AtB) const
+    {
+        double* AtB_ptr = _AtB.ptr<double>();
+        for(int y = 0; y < transformDim; y++)
+        {
+            double* AtA_ptr = _AtA.ptr<double>(y);
+            for(int x = y; x < transformDim; x++)
+                AtA_ptr[x] += AtA[y * 6 + x];
+
+            AtB_ptr[y] += AtB[y];
+        }
+    }
+
+    int transformDim;
+    double AtA[36];
+    double AtB[6];
+};
+
 static
 void calcRgbdLsmMatrices(const Mat& image0, const Mat& cloud0, const Mat& Rt,
                const Mat& image1, const Mat& dI_dx1, const Mat& dI_dy1,
@@ -622,7 +743,6 @@ void calcRgbdLsmMatrices(const Mat& image0, const Mat& cloud0, const Mat& Rt,
 {
     AtA = Mat(transformDim, transformDim, CV_64FC1, Scalar(0));
     AtB = Mat(transformDim, 1, CV_64FC1, Scalar(0));
-    double* AtB_ptr = AtB.ptr<double>();
 
     const int correspsCount = corresps.rows;
 
@@ -634,53 +754,62 @@ void calcRgbdLsmMatrices(const Mat& image0, const Mat& cloud0, const Mat& Rt,
 
     const Vec4i* corresps_ptr = corresps.ptr<Vec4i>();
 
-    double sigma = 0;
-    for(int correspIndex = 0; correspIndex < corresps.rows; correspIndex++)
+    std::vector<double> stripeSigmas(lsmStripesCount(correspsCount), 0.);
+    parallelForLsmStripes(correspsCount, [&](int stripe, int begin, int end)
     {
-         const Vec4i& c = corresps_ptr[correspIndex];
-         int u0 = c[0], v0 = c[1];
-         int u1 = c[2], v1 = c[3];
+        double localSigma = 0;
+        for(int correspIndex = begin; correspIndex < end; correspIndex++)
+        {
+             const Vec4i& c = corresps_ptr[correspIndex];
+             int u0 = c[0], v0 = c[1];
+             int u1 = c[2], v1 = c[3];
 
-         diffs_ptr[correspIndex] = static_cast<float>(static_cast<int>(image0.at<uchar>(v0,u0)) -
-                                                      static_cast<int>(image1.at<uchar>(v1,u1)));
-         sigma += diffs_ptr[correspIndex] * diffs_ptr[correspIndex];
-    }
-    sigma = std::sqrt(sigma/correspsCount);
+             diffs_ptr[correspIndex] = static_cast<float>(static_cast<int>(image0.at<uchar>(v0,u0)) -
+                                                          static_cast<int>(image1.at<uchar>(v1,u1)));
+             localSigma += diffs_ptr[correspIndex] * diffs_ptr[correspIndex];
+        }
 
-    std::vector<double> A_buf(transformDim);
-    double* A_ptr = &A_buf[0];
+        stripeSigmas[stripe] = localSigma;
+    });
 
-    for(int correspIndex = 0; correspIndex < corresps.rows; correspIndex++)
-    {
-         const Vec4i& c = corresps_ptr[correspIndex];
-         int u0 = c[0], v0 = c[1];
-         int u1 = c[2], v1 = c[3];
+    double sigma = 0;
+    for(size_t stripe = 0; stripe < stripeSigmas.size(); stripe++)
+        sigma += stripeSigmas[stripe];
+    sigma = std::sqrt(sigma/correspsCount);
 
-         double w = sigma + std::abs(diffs_ptr[correspIndex]);
-         w = w > DBL_EPSILON ? 1./w : 1.;
+    std::vector<LsmAccumulator> stripeAccs(lsmStripesCount(correspsCount), LsmAccumulator(transformDim));
+    parallelForLsmStripes(correspsCount, [&](int stripe, int begin, int end)
+    {
+        LsmAccumulator& acc = stripeAccs[stripe];
+        double A_ptr[6];
+        for(int correspIndex = begin; correspIndex < end; correspIndex++)
+        {
+             const Vec4i& c = corresps_ptr[correspIndex];
+             int u0 = c[0], v0 = c[1];
+             int u1 = c[2], v1 = c[3];
 
-         double w_sobelScale = w * sobelScaleIn;
+             double w = sigma + std::abs(diffs_ptr[correspIndex]);
+             w = w > DBL_EPSILON ? 1./w : 1.;
 
-         const Point3f& p0 = cloud0.at<Point3f>(v0,u0);
-         Point3f tp0;
-         tp0.x = (float)(p0.x * Rt_ptr[0] + p0.y * Rt_ptr[1] + p0.z * Rt_ptr[2] + Rt_ptr[3]);
-         tp0.y = (float)(p0.x * Rt_ptr[4] + p0.y * Rt_ptr[5] + p0.z * Rt_ptr[6] + Rt_ptr[7]);
-         tp0.z = (float)(p0.x * Rt_ptr[8] + p0.y * Rt_ptr[9] + p0.z * Rt_ptr[10] + Rt_ptr[11]);
+             double w_sobelScale = w * sobelScaleIn;
 
-         func(A_ptr,
-              w_sobelScale * dI_dx1.at<short int>(v1,u1),
-              w_sobelScale * dI_dy1.at<short int>(v1,u1),
-              tp0, fx, fy);
+             const Point3f& p0 = cloud0.at<Point3f>(v0,u0);
+             Point3f tp0;
+             tp0.x = (float)(p0.x * Rt_ptr[0] + p0.y * Rt_ptr[1] + p0.z * Rt_ptr[2] + Rt_ptr[3]);
+             tp0.y = (float)(p0.x * Rt_ptr[4] + p0.y * Rt_ptr[5] + p0.z * Rt_ptr[6] + Rt_ptr[7]);
+             tp0.z = (float)(p0.x * Rt_ptr[8] + p0.y * Rt_ptr[9] + p0.z * Rt_ptr[10] + Rt_ptr[11]);
 
-        for(int y = 0; y < transformDim; y++)
-        {
-            double* AtA_ptr = AtA.ptr<double>(y);
-            for(int x = y; x < transformDim; x++)
-                AtA_ptr[x] += A_ptr[y] * A_ptr[x];
+             func(A_ptr,
+                  w_sobelScale * dI_dx1.at<short int>(v1,u1),
+                  w_sobelScale * dI_dy1.at<short int>(v1,u1),
+                  tp0, fx, fy);
 
-            AtB_ptr[y] += A_ptr[y] * w * diffs_ptr[correspIndex];
+             acc.add(A_ptr, w * diffs_ptr[correspIndex]);
         }
-    }
+    });
+
+    for(size_t stripe = 0; stripe < stripeAccs.size(); stripe++)
+        stripeAccs[stripe].mergeTo(AtA, AtB);
 
     for(int y = 0; y < transformDim; y++)
         for(int x = y+1; x < transformDim; x++)
@@ -695,7 +824,6 @@ void calcICPLsmMatrices(const Mat& cloud0, const Mat& Rt,
 {
     AtA = Mat(transformDim, transformDim, CV_64FC1, Scalar(0));
     AtB = Mat(transformDim, 1, CV_64FC1, Scalar(0));
-    double* AtB_ptr = AtB.ptr<double>();
 
     const int correspsCount = corresps.rows;
 
@@ -710,50 +838,60 @@ void calcICPLsmMatrices(const Mat& cloud0, const Mat& Rt,
 
     const Vec4i* corresps_ptr = corresps.ptr<Vec4i>();
 
-    double sigma = 0;
-    for(int correspIndex = 0; correspIndex < corresps.rows; correspIndex++)
+    std::vector<double> stripeSigmas(lsmStripesCount(correspsCount), 0.);
+    parallelForLsmStripes(correspsCount, [&](int stripe, int begin, int end)
     {
-        const Vec4i& c = corresps_ptr[correspIndex];
-        int u0 = c[0], v0 = c[1];
-        int u1 = c[2], v1 = c[3];
-
-        const Point3f& p0 = cloud0.at<Point3f>(v0,u0);
-        Point3f tp0;
-        tp0.x = (float)(p0.x * Rt_ptr[0] + p0.y * Rt_ptr[1] + p0.z * Rt_ptr[2] + Rt_ptr[3]);
-        tp0.y = (float)(p0.x * Rt_ptr[4] + p0.y * Rt_ptr[5] + p0.z * Rt_ptr[6] + Rt_ptr[7]);
-        tp0.z = (float)(p0.x * Rt_ptr[8] + p0.y * Rt_ptr[9] + p0.z * Rt_ptr[10] + Rt_ptr[11]);
-
-        Vec3f n1 = normals1.at<Vec3f>(v1, u1);
-        Point3f v = cloud1.at<Point3f>(v1,u1) - tp0;
-
-        tps0_ptr[correspIndex] = tp0;
-        diffs_ptr[correspIndex] = n1[0] * v.x + n1[1] * v.y + n1[2] * v.z;
-        sigma += diffs_ptr[correspIndex] * diffs_ptr[correspIndex];
-    }
+        double localSigma = 0;
+        for(int correspIndex = begin; correspIndex < end; correspIndex++)
+        {
+            const Vec4i& c = corresps_ptr[correspIndex];
+            int u0 = c[0], v0 = c[1];
+            int u1 = c[2], v1 = c[3];
+
+            const Point3f& p0 = cloud0.at<Point3f>(v0,u0);
+            Point3f tp0;
+            tp0.x = (float)(p0.x * Rt_ptr[0] + p0.y * Rt_ptr[1] + p0.z * Rt_ptr[2] + Rt_ptr[3]);
+            tp0.y = (float)(p0.x * Rt_ptr[4] + p0.y * Rt_ptr[5] + p0.z * Rt_ptr[6] + Rt_ptr[7]);
+            tp0.z = (float)(p0.x * Rt_ptr[8] + p0.y * Rt_ptr[9] + p0.z * Rt_ptr[10] + Rt_ptr[11]);
+
+            Vec3f n1 = normals1.at<Vec3f>(v1, u1);
+            Point3f v = cloud1.at<Point3f>(v1,u1) - tp0;
+
+            tps0_ptr[correspIndex] = tp0;
+            diffs_ptr[correspIndex] = n1[0] * v.x + n1[1] * v.y + n1[2] * v.z;
+            localSigma += diffs_ptr[correspIndex] * diffs_ptr[correspIndex];
+        }
+
+        stripeSigmas[stripe] = localSigma;
+    });
+
+    double sigma = 0;
+    for(size_t stripe = 0; stripe < stripeSigmas.size(); stripe++)
+        sigma += stripeSigmas[stripe];
 
     sigma = std::sqrt(sigma/correspsCount);
 
-    std::vector<double> A_buf(transformDim);
-    double* A_ptr = &A_buf[0];
-    for(int correspIndex = 0; correspIndex < corresps.rows; correspIndex++)
+    std::vector<LsmAccumulator> stripeAccs(lsmStripesCount(correspsCount), LsmAccumulator(transformDim));
+    parallelForLsmStripes(correspsCount, [&](int stripe, int begin, int end)
     {
-        const Vec4i& c = corresps_ptr[correspIndex];
-        int u1 = c[2], v1 = c[3];
+        LsmAccumulator& acc = stripeAccs[stripe];
+        double A_ptr[6];
+        for(int correspIndex = begin; correspIndex < end; correspIndex++)
+        {
+            const Vec4i& c = corresps_ptr[correspIndex];
+            int u1 = c[2], v1 = c[3];
 
-        double w = sigma + std::abs(diffs_ptr[correspIndex]);
-        w = w > DBL_EPSILON ? 1./w : 1.;
+            double w = sigma + std::abs(diffs_ptr[correspIndex]);
+            w = w > DBL_EPSILON ? 1./w : 1.;
 
-        func(A_ptr, tps0_ptr[correspIndex], normals1.at<Vec3f>(v1, u1) * w);
+            func(A_ptr, tps0_ptr[correspIndex], normals1.at<Vec3f>(v1, u1) * w);
 
-        for(int y = 0; y < transformDim; y++)
-        {
-            double* AtA_ptr = AtA.ptr<double>(y);
-            for(int x = y; x < transformDim; x++)
-                AtA_ptr[x] += A_ptr[y] * A_ptr[x];
-
-            AtB_ptr[y] += A_ptr[y] * w * diffs_ptr[correspIndex];
+            acc.add(A_ptr, w * diffs_ptr[correspIndex]);
         }
-    }
+    });
+
+    for(size_t stripe = 0; stripe < stripeAccs.size(); stripe++)
+        stripeAccs[stripe].mergeTo(AtA, AtB);
 
     for(int y = 0; y < transformDim; y++)
         for(int x = y+1; x < transformDim; x++)
@@ -15,6 +15,7 @@
  */
 
 #include "precomp.hpp"
+#include "utils.hpp"
 
 namespace cv
 {
@@ -91,10 +92,10 @@ public:
   /** Update the different sum of point and sum of point*point.t()
    */
   void
-  UpdateStatistics(const Vec3f & point, const Matx33f & Q_local)
+  UpdateStatistics(const Vec3f & point)
   {
     m_sum_ += point;
-    Q_ += Q_local;
+    Q_ += point * point.t();
     ++K_;
   }
 
@@ -214,67 +215,92 @@ public:
     // Compute all the interesting quantities
     m_.create(mini_rows, mini_cols);
     n_.create(mini_rows, mini_cols);
-    Q_.create(points3d.rows, points3d.cols);
     mse_.create(mini_rows, mini_cols);
-    for (int y = 0; y < mini_rows; ++y)
-      for (int x = 0; x < mini_cols; ++x)
-      {
-        // Update the tiles
-        Matx33f Q = Matx33f::zeros();
-        Vec3f m = Vec3f(0, 0, 0);
-        int K = 0;
-        for (int j = y * block_size; j < std::min((y + 1) * block_size, points3d.rows); ++j)
+    // Every tile only touches its own statistics: process the rows of tiles in parallel
+    parallel_for_(Range(0, mini_rows), [&](const Range& range)
+    {
+      for (int y = range.start; y < range.end; ++y)
+        for (int x = 0; x < mini_cols; ++x)
         {
-          const Vec3f * vec = points3d.ptr < Vec3f > (j, x * block_size), *vec_end;
-          float * pointpointt = reinterpret_cast<float*>(Q_.ptr < Vec<float, 9> > (j, x * block_size));
-          if (x == mini_cols - 1)
-            vec_end = points3d.ptr < Vec3f > (j, points3d.cols - 1) + 1;
-          else
-            vec_end = vec + block_size;
-          for (; vec != vec_end; ++vec, pointpointt += 9)
+          // Update the tiles
+          Matx33f Q = Matx33f::zeros();
+          Vec3f m = Vec3f(0, 0, 0);
+          int K = 0;
+          const int width = std::min(block_size, points3d.cols - x * block_size);
+#if USE_INTRINSICS
+          v_float32x4 s_xx = v_setzero_f32(), s_xy = v_setzero_f32(), s_xz = v_setzero_f32();
+          v_float32x4 s_yy = v_setzero_f32(), s_yz = v_setzero_f32(), s_zz = v_setzero_f32();
+          v_float32x4 s_x = v_setzero_f32(), s_y = v_setzero_f32(), s_z = v_setzero_f32();
+          v_float32x4 s_K = v_setzero_f32();
+          const v_float32x4 one = v_setall_f32(1.f);
+#endif
+          for (int j = y * block_size; j < std::min((y + 1) * block_size, points3d.rows); ++j)
           {
-            if (cvIsNaN(vec->val[0]))
-              continue;
-            // Fill point*point.t()
-            *pointpointt = vec->val[0] * vec->val[0];
-            *(pointpointt + 1) = vec->val[0] * vec->val[1];
-            *(pointpointt + 2) = vec->val[0] * vec->val[2];
-            *(pointpointt + 3) = *(pointpointt + 1);
-            *(pointpointt + 4) = vec->val[1] * vec->val[1];
-            *(pointpointt + 5) = vec->val[1] * vec->val[2];
-            *(pointpointt + 6) = *(pointpointt + 2);
-            *(pointpointt + 7) = *(pointpointt + 5);
-            *(pointpointt + 8) = vec->val[2] * vec->val[2];
-
-            Q += *reinterpret_cast<Matx33f*>(pointpointt);
-            m += (*vec);
-            ++K;
+            const Vec3f * vec = points3d.ptr < Vec3f > (j, x * block_size);
+            int i = 0;
+#if USE_INTRINSICS
+            for (; i <= width - 4; i += 4)
+            {
+              v_float32x4 p_x, p_y, p_z;
+              v_load_deinterleave(vec[i].val, p_x, p_y, p_z);
+              // Like below, only the first coordinate tells whether the point is valid
+              v_float32x4 valid = v_eq(p_x, p_x);
+              p_x = v_and(valid, p_x);
+              p_y = v_and(valid, p_y);
+              p_z = v_and(valid, p_z);
+              s_xx = v_add(s_xx, v_mul(p_x, p_x));
+              s_xy = v_add(s_xy, v_mul(p_x, p_y));
+              s_xz = v_add(s_xz, v_mul(p_x, p_z));
+              s_yy = v_add(s_yy, v_mul(p_y, p_y));
+              s_yz = v_add(s_yz, v_mul(p_y, p_z));
+              s_zz = v_add(s_zz, v_mul(p_z, p_z));
+              s_x = v_add(s_x, p_x);
+              s_y = v_add(s_y, p_y);
+              s_z = v_add(s_z, p_z);
+              s_K = v_add(s_K, v_and(valid, one));
+            }
+#endif
+            for (; i < width; ++i)
+            {
+              if (cvIsNaN(vec[i][0]))
+                continue;
+              Q += vec[i] * vec[i].t();
+              m += vec[i];
+              ++K;
+            }
+          }
+#if USE_INTRINSICS
+          float q_xy = v_reduce_sum(s_xy), q_xz = v_reduce_sum(s_xz), q_yz = v_reduce_sum(s_yz);
+          Q += Matx33f(v_reduce_sum(s_xx), q_xy, q_xz,
+                       q_xy, v_reduce_sum(s_yy), q_yz,
+                       q_xz, q_yz, v_reduce_sum(s_zz));
+          m += Vec3f(v_reduce_sum(s_x), v_reduce_sum(s_y), v_reduce_sum(s_z));
+          K += cvRound(v_reduce_sum(s_K));
+#endif
+          if (K == 0)
+          {
+            mse_(y, x) = std::numeric_limits<float>::max();
+            continue;
           }
-        }
-        if (K == 0)
-        {
-          mse_(y, x) = std::numeric_limits<float>::max();
-          continue;
-        }
 
-        m /= K;
-        m_(y, x) = m;
+          m /= K;
+          m_(y, x) = m;
 
-        // Compute C
-        Matx33f C = Q - K * m * m.t();
+          // Compute C
+          Matx33f C = Q - K * m * m.t();
 
-        // Compute n
-        SVD svd(C);
-        n_(y, x) = Vec3f(svd.vt.at<float>(2, 0), svd.vt.at<float>(2, 1), svd.vt.at<float>(2, 2));
-        mse_(y, x) = svd.w.at<float>(2) / K;
-      }
+          // Compute n
+          SVD svd(C);
+          n_(y, x) = Vec3f(svd.vt.at<float>(2, 0), svd.vt.at<float>(2, 1), svd.vt.at<float>(2, 2));
+          mse_(y, x) = svd.w.at<float>(2) / K;
+        }
+    });
   }
 
   /** The size of the block */
   int block_size_;
   Mat_<Vec3f> m_;
   Mat_<Vec3f> n_;
-  Mat_<Vec<float, 9> > Q_;
   Mat_<float> mse_;
 };
 
@@ -392,14 +418,12 @@ public:
     {
       uchar* data = overall_mask.ptr(yy, range_x.start), *data_end = data + range_x.size();
       const Vec3f* point = points3d_.ptr < Vec3f > (yy, range_x.start);
-      const Matx33f* Q_local = reinterpret_cast<const Matx33f *>(plane_grid.Q_.ptr < Vec<float, 9>
-          > (yy, range_x.start));
 
       // Depending on whether you have a normal, check it
       if (!normals_.empty())
       {
         const Vec3f* normal = normals_.ptr < Vec3f > (yy, range_x.start);
-        for (; data != data_end; ++data, ++point, ++normal, ++Q_local)
+        for (; data != data_end; ++data, ++point, ++normal)
         {
           // Don't do anything if the point already belongs to another plane
           if (cvIsNaN(point->val[0]) || ((*data) != 255))
@@ -412,7 +436,7 @@ public:
             if (std::abs(plane->n().dot(*normal)) > 0.3)
             {
               // The point now belongs to the plane
-              plane->UpdateStatistics(*point, *Q_local);
+              plane->UpdateStatistics(*point);
               *data = plane_index_;
               ++n_valid_points;
             }
@@ -421,7 +445,7 @@ public:
       }
       else
       {
-        for (; data != data_end; ++data, ++point, ++Q_local)
+        for (; data != data_end; ++data, ++point)
         {
           // Don't do anything if the point already belongs to another plane
           if (cvIsNaN(point->val[0]) || ((*data) != 255))
@@ -431,7 +455,7 @@ public:
           if (plane->distance(*point) < err_)
           {
             // The point now belongs to the plane
-            plane->UpdateStatistics(*point, *Q_local);
+            plane->UpdateStatistics(*point);
             *data = plane_index_;
             ++n_valid_points;
           }
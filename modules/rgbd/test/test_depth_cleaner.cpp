@@ -0,0 +1,116 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+/** The NIL cleaner as it was first written: every pixel scatters the pair weights to its neighbours */
+static Mat_<float> cleanDepthReference(const Mat& depth_in, float scale)
+{
+  Mat_<float> depth;
+  depth_in.convertTo(depth, CV_32F);
+  const int rows = depth.rows, cols = depth.cols;
+
+  const float theta_mean = (float)(30. * CV_PI / 180);
+  const float sigma_L = (float)(0.8 + 0.035 * theta_mean / (CV_PI / 2 - theta_mean));
+  Mat_<float> sigma_z(rows, cols);
+  for (int y = 0; y < rows; ++y)
+    for (int x = 0; x < cols; ++x)
+      sigma_z(y, x) = (float)(0.0012 + 0.0019 * (depth(y, x) * scale - 0.4) * (depth(y, x) * scale - 0.4));
+
+  const float difference_threshold = 10;
+  Mat_<float> Dw_sum = Mat_<float>::zeros(rows, cols), w_sum = Mat_<float>::zeros(rows, cols);
+  for (int y = 0; y < rows - 1; ++y)
+    for (int x = 1; x < cols - 1; ++x)
+      for (int j = 0; j <= 1; ++j)
+        for (int i = -1; i <= 1; ++i)
+        {
+          if ((j == 0) && (i == -1))
+            continue;
+          float delta_u = std::sqrt(float(j * j + i * i));
+          float delta_z = std::abs(depth(y, x) - depth(y + j, x + i));
+          if (delta_z >= difference_threshold)
+            continue;
+          delta_z *= scale;
+          float w = std::exp(-delta_u * delta_u / 2 / sigma_L / sigma_L - delta_z * delta_z / 2 / sigma_z(y, x) / sigma_z(y, x));
+          w_sum(y, x) += w;
+          Dw_sum(y, x) += depth(y + j, x + i) * w;
+          if ((j != 0) || (i != 0))
+          {
+            w = std::exp(-delta_u * delta_u / 2 / sigma_L / sigma_L
+                         - delta_z * delta_z / 2 / sigma_z(y + j, x + i) / sigma_z(y + j, x + i));
+            w_sum(y + j, x + i) += w;
+            Dw_sum(y + j, x + i) += depth(y, x) * w;
+          }
+        }
+  return Dw_sum / w_sum;
+}
+
+TEST(Rgbd_DepthCleaner, same_as_scatter)
+{
+  std::string dataPath = cvtest::TS::ptr()->get_data_path();
+  Mat depth16U = imread(dataPath + "rgbd/depth.png", IMREAD_UNCHANGED);
+  ASSERT_FALSE(depth16U.empty());
+  ASSERT_EQ(CV_16UC1, depth16U.type());
+
+  Mat_<float> expected = cleanDepthReference(depth16U, 0.001f);
+
+  // The gather sums the weights in another order than the scatter, hence the tolerances
+  Ptr<DepthCleaner> cleaner16U = DepthCleaner::create(CV_16U, 5, DepthCleaner::DEPTH_CLEANER_NIL);
+  Mat cleaned16U;
+  (*cleaner16U)(depth16U, cleaned16U);
+  ASSERT_EQ(CV_16UC1, cleaned16U.type());
+  Mat expected16U;
+  expected.convertTo(expected16U, CV_16U);
+  EXPECT_LE(cvtest::norm(cleaned16U, expected16U, NORM_INF), 1);
+
+  Mat depth32F;
+  depth16U.convertTo(depth32F, CV_32F, 0.001);
+  Mat_<float> expected32F = cleanDepthReference(depth32F, 1.f);
+  Ptr<DepthCleaner> cleaner32F = DepthCleaner::create(CV_32F, 5, DepthCleaner::DEPTH_CLEANER_NIL);
+  Mat cleaned32F;
+  (*cleaner32F)(depth32F, cleaned32F);
+  ASSERT_EQ(CV_32FC1, cleaned32F.type());
+  ASSERT_EQ(expected32F.size(), cleaned32F.size());
+  int mismatches = 0;
+  for (int y = 0; y < expected32F.rows; ++y)
+    for (int x = 0; x < expected32F.cols; ++x)
+    {
+      float e = expected32F(y, x), v = cleaned32F.at<float>(y, x);
+      // Pixels that do not receive any weight are NaN in both
+      if (cvIsNaN(e) ? !cvIsNaN(v) : !(std::abs(e - v) <= 1e-5f * std::max(1.f, std::abs(e))))
+        ++mismatches;
+    }
+  EXPECT_EQ(0, mismatches);
+}
+
+TEST(Rgbd_DepthCleaner, in_place)
+{
+  std::string dataPath = cvtest::TS::ptr()->get_data_path();
+  Mat depth16U = imread(dataPath + "rgbd/depth.png", IMREAD_UNCHANGED);
+  ASSERT_FALSE(depth16U.empty());
+
+  const int depths[] = { CV_16U, CV_32F, CV_64F };
+  for (size_t i = 0; i < sizeof(depths) / sizeof(depths[0]); ++i)
+  {
+    Mat depth;
+    depth16U.convertTo(depth, depths[i], depths[i] == CV_16U ? 1. : 0.001);
+    Ptr<DepthCleaner> cleaner = DepthCleaner::create(depths[i], 5, DepthCleaner::DEPTH_CLEANER_NIL);
+
+    Mat expected;
+    (*cleaner)(depth, expected);
+
+    Mat cleaned = depth.clone();
+    const uchar* data = cleaned.data;
+    (*cleaner)(cleaned, cleaned);
+    ASSERT_EQ(data, cleaned.data);
+    // NaN pixels compare equal when both sides are NaN
+    Mat diff;
+    absdiff(cleaned, expected, diff);
+    EXPECT_EQ(0, countNonZero((diff > 0) | ((cleaned == cleaned) != (expected == expected)))) << "depth " << depths[i];
+  }
+}
+
+}} // namespace
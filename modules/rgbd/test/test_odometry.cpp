@@ -328,5 +328,82 @@ TEST(RGBD_Odometry_FastICP, algorithmic)
     test.safe_run();
 }
 
+TEST(RGBD_Odometry_Rgbd, reuse_frame_cache)
+{
+    std::string dataPath = cvtest::TS::ptr()->get_data_path();
+    Mat image = imread(dataPath + "rgbd/rgb.png", IMREAD_GRAYSCALE);
+    Mat depth16 = imread(dataPath + "rgbd/depth.png", IMREAD_UNCHANGED);
+    ASSERT_FALSE(image.empty());
+    ASSERT_FALSE(depth16.empty());
+
+    Mat depth;
+    depth16.convertTo(depth, CV_32FC1, 1.f/5000.f);
+    depth.setTo(std::numeric_limits<float>::quiet_NaN(), depth < FLT_EPSILON);
+
+    Mat K = (Mat_<float>(3, 3) << 525.f, 0.f, 319.5f, 0.f, 525.f, 239.5f, 0.f, 0.f, 1.f);
+    Mat rvec = (Mat_<double>(3, 1) << 0.01, -0.02, 0.005);
+    Mat tvec = (Mat_<double>(3, 1) << 0.005, 0.01, -0.01);
+    Mat warpedImage, warpedDepth;
+    warpFrame(image, depth, rvec, tvec, K, warpedImage, warpedDepth);
+    dilateFrame(warpedImage, warpedDepth);
+
+    Ptr<Odometry> odometry = Odometry::create("RgbdOdometry");
+    odometry->setCameraMatrix(K);
+
+    Mat mask(image.size(), CV_8UC1, Scalar(255));
+    Mat Rt01, Rt10;
+    ASSERT_TRUE(odometry->compute(image, depth, mask, warpedImage, warpedDepth, mask, Rt01));
+    ASSERT_TRUE(odometry->compute(warpedImage, warpedDepth, mask, image, depth, mask, Rt10));
+
+    // the destination frame of the first call is the source frame of the second one,
+    // its pyramids have to be reused and give the same result
+    Ptr<OdometryFrame> frame0 = OdometryFrame::create(image, depth, mask);
+    Ptr<OdometryFrame> frame1 = OdometryFrame::create(warpedImage, warpedDepth, mask);
+    Mat cachedRt01, cachedRt10;
+    ASSERT_TRUE(odometry->compute(frame0, frame1, cachedRt01));
+    ASSERT_FALSE(frame1->pyramidImage.empty());
+    ASSERT_TRUE(odometry->compute(frame1, frame0, cachedRt10));
+
+    EXPECT_LE(cvtest::norm(Rt01, cachedRt01, NORM_INF), 1e-6);
+    EXPECT_LE(cvtest::norm(Rt10, cachedRt10, NORM_INF), 1e-6);
+}
+
+TEST(RGBD_Odometry, independent_of_threads_count)
+{
+    std::string dataPath = cvtest::TS::ptr()->get_data_path();
+    Mat image = imread(dataPath + "rgbd/rgb.png", IMREAD_GRAYSCALE);
+    Mat depth16 = imread(dataPath + "rgbd/depth.png", IMREAD_UNCHANGED);
+    ASSERT_FALSE(image.empty());
+    ASSERT_FALSE(depth16.empty());
+
+    Mat depth;
+    depth16.convertTo(depth, CV_32FC1, 1.f/5000.f);
+    depth.setTo(std::numeric_limits<float>::quiet_NaN(), depth < FLT_EPSILON);
+
+    Mat K = (Mat_<float>(3, 3) << 525.f, 0.f, 319.5f, 0.f, 525.f, 239.5f, 0.f, 0.f, 1.f);
+    Mat rvec = (Mat_<double>(3, 1) << 0.01, -0.02, 0.005);
+    Mat tvec = (Mat_<double>(3, 1) << 0.005, 0.01, -0.01);
+    Mat warpedImage, warpedDepth;
+    warpFrame(image, depth, rvec, tvec, K, warpedImage, warpedDepth);
+    dilateFrame(warpedImage, warpedDepth);
+
+    const char* names[] = { "RgbdOdometry", "ICPOdometry", "RgbdICPOdometry" };
+    const int threads = getNumThreads();
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        Ptr<Odometry> odometry = Odometry::create(names[i]);
+        odometry->setCameraMatrix(K);
+
+        Mat serialRt, parallelRt;
+        setNumThreads(1);
+        ASSERT_TRUE(odometry->compute(image, depth, Mat(), warpedImage, warpedDepth, Mat(), serialRt)) << names[i];
+        setNumThreads(threads);
+        ASSERT_TRUE(odometry->compute(image, depth, Mat(), warpedImage, warpedDepth, Mat(), parallelRt)) << names[i];
+
+        // partial sums are reduced in a fixed order, the estimation must be bit-exact
+        EXPECT_EQ(0., cvtest::norm(serialRt, parallelRt, NORM_INF)) << names[i];
+    }
+}
+
 
 }} // namespace
@@ -134,5 +134,95 @@ TEST(Rgbd_DepthRegistration, issue_2234)
     EXPECT_EQ(0, cvtest::norm(subM, depthMat, NORM_INF));
 }
 
+TEST(Rgbd_DepthRegistration, larger_output)
+{
+    // The external camera has twice the resolution of the depth camera and sees the same scene
+    Matx33f intrinsicsDepth(100, 0, 40, 0, 100, 30, 0, 0, 1);
+    Matx33f intrinsicsColor(200, 0, 80, 0, 200, 60, 0, 0, 1);
+
+    Mat_<ushort> depthMat(60, 80);
+    for (int y = 0; y < depthMat.rows; y++)
+        for (int x = 0; x < depthMat.cols; x++)
+            depthMat(y, x) = (ushort)(1000 + x + y);
+
+    Mat registeredDepth;
+    registerDepth(intrinsicsDepth, intrinsicsColor, Mat(), Matx44f::eye(), depthMat, Size(160, 120), registeredDepth);
+
+    ASSERT_EQ(CV_16UC1, registeredDepth.type());
+    ASSERT_EQ(Size(160, 120), registeredDepth.size());
+    Mat_<ushort> expected = Mat_<ushort>::zeros(120, 160);
+    for (int y = 0; y < depthMat.rows; y++)
+        for (int x = 0; x < depthMat.cols; x++)
+            expected(2 * y, 2 * x) = depthMat(y, x);
+    EXPECT_EQ(0, cvtest::norm(registeredDepth, expected, NORM_INF));
+}
+
+TEST(Rgbd_DepthRegistration, smaller_output)
+{
+    // The external camera has half the resolution of the depth camera and sees the same scene
+    Matx33f intrinsicsDepth(200, 0, 80, 0, 200, 60, 0, 0, 1);
+    Matx33f intrinsicsColor(100, 0, 40, 0, 100, 30, 0, 0, 1);
+
+    Mat_<float> depthMat(120, 160, 1.5f);
+    Mat registeredDepth;
+    registerDepth(intrinsicsDepth, intrinsicsColor, Mat(), Matx44f::eye(), depthMat, Size(80, 60), registeredDepth);
+
+    // Every output pixel is hit by the input pixel at twice its coordinates
+    ASSERT_EQ(CV_32FC1, registeredDepth.type());
+    ASSERT_EQ(Size(80, 60), registeredDepth.size());
+    EXPECT_LE(cvtest::norm(registeredDepth, Mat(60, 80, CV_32FC1, Scalar(1.5)), NORM_INF), 1e-5);
+}
+
+/** Number of elements that differ, NaN matching NaN */
+static int countDifferences(const Mat& a, const Mat& b)
+{
+  Mat a1 = a.reshape(1), b1 = b.reshape(1), diff;
+  absdiff(a1, b1, diff);
+  return countNonZero((diff > 0) | ((a1 == a1) != (b1 == b1)));
+}
+
+TEST(Rgbd_DepthPipeline, same_as_separate_steps)
+{
+  std::string dataPath = cvtest::TS::ptr()->get_data_path();
+  Mat depth16U = imread(dataPath + "rgbd/depth.png", IMREAD_UNCHANGED);
+  ASSERT_FALSE(depth16U.empty());
+  ASSERT_EQ(CV_16UC1, depth16U.type());
+
+  const Matx33f intrinsicsDepth(525.f, 0.f, 319.5f, 0.f, 525.f, 239.5f, 0.f, 0.f, 1.f);
+  const Matx33f intrinsicsColor(262.5f, 0.f, 159.5f, 0.f, 262.5f, 119.5f, 0.f, 0.f, 1.f);
+  Matx44f Rt = Matx44f::eye();
+  Rt(0, 3) = 0.025f;
+  const Size colorSize(320, 240);
+
+  Mat depth32F;
+  depth16U.convertTo(depth32F, CV_32F, 0.001);
+  depth32F.setTo(std::numeric_limits<float>::quiet_NaN(), depth16U == 0);
+
+  const Mat depths[] = { depth16U, depth32F };
+  for (int k = 0; k < 2; ++k)
+  {
+    const Mat& depth = depths[k];
+
+    Mat registered, cleaned, expected;
+    registerDepth(intrinsicsDepth, intrinsicsColor, Mat(), Rt, depth, colorSize, registered, true);
+    Ptr<DepthCleaner> cleaner = DepthCleaner::create(depth.depth(), 5, DepthCleaner::DEPTH_CLEANER_NIL);
+    (*cleaner)(registered, cleaned);
+    depthTo3d(cleaned, Mat(intrinsicsColor), expected);
+
+    Ptr<RgbdDepthPipeline> pipeline = RgbdDepthPipeline::create(intrinsicsDepth, intrinsicsColor, Mat(), Rt,
+                                                                colorSize, true, 5);
+    Mat cloud;
+    (*pipeline)(depth, cloud);
+    ASSERT_EQ(CV_32FC3, cloud.type());
+    ASSERT_EQ(colorSize, cloud.size());
+    EXPECT_EQ(0, countDifferences(expected, cloud)) << "depth " << depth.depth();
+
+    // the next frame is written into the same cloud
+    const uchar* data = cloud.data;
+    (*pipeline)(depth, cloud);
+    EXPECT_EQ(data, cloud.data);
+    EXPECT_EQ(0, countDifferences(expected, cloud)) << "depth " << depth.depth();
+  }
+}
 
 }} // namespace
@@ -67,5 +67,36 @@ TEST(Rgbd_DepthTo3d, compute)
   test.safe_run();
 }
 
+TEST(Rgbd_DepthTo3dSparse, short_depth)
+{
+  Mat K = (Mat_<float>(3, 3) << 525., 0., 319.5, 0., 525., 239.5, 0., 0., 1.);
+
+  // Depth in millimeters, as signed and unsigned shorts, and in meters
+  RNG rng(1021);
+  Mat_<ushort> depth16U(480, 640);
+  rng.fill(depth16U, RNG::UNIFORM, 500, 5000);
+  Mat depth16S, depth32F;
+  depth16U.convertTo(depth16S, CV_16S);
+  depth16U.convertTo(depth32F, CV_32F, 1. / 1000);
+
+  Mat_<Vec2f> points(1, 100);
+  for (int i = 0; i < points.cols; ++i)
+    points(0, i) = Vec2f((float)rng.uniform(0, depth16U.cols), (float)rng.uniform(0, depth16U.rows));
+
+  Mat points3d16S, points3d16U, points3d;
+  depthTo3dSparse(depth16S, K, points, points3d16S);
+  depthTo3dSparse(depth16U, K, points, points3d16U);
+  depthTo3d(depth32F, K, points3d);
+
+  ASSERT_EQ(CV_32FC3, points3d16S.type());
+  ASSERT_EQ(points.size(), points3d16S.size());
+  EXPECT_EQ(0, cvtest::norm(points3d16S, points3d16U, NORM_INF));
+  for (int i = 0; i < points.cols; ++i)
+  {
+    Point pt((int)points(0, i)[0], (int)points(0, i)[1]);
+    EXPECT_LE(cvtest::norm(points3d16S.at<Vec3f>(0, i), points3d.at<Vec3f>(pt), NORM_INF), 1e-5) << pt;
+  }
+}
+
 
 }} // namespace
@@ -239,9 +239,9 @@ private:
   bool decisionThresholdAdaptation();
 
   // changing structure
-  std::vector<Ptr<Mat> > backgroundModel;// The vector represents the background template T0---TK of reference paper.
-  // Matrices are two-channel matrix. In the first layer there are the B (background value)
-  // for each pixel. In the second layer, there are the C (efficacy) value for each pixel
+  // The two vectors represent the background templates T0---TK of reference paper, stored as separate planes.
+  std::vector<Mat> backgroundModelB;// CV_32F, the B (background value) of each pixel
+  std::vector<Mat> backgroundModelC;// CV_32F, the C (efficacy) value of each pixel
   Mat potentialBackground;// Two channel Matrix. For each pixel, in the first level there are the Ba value (potential background value)
                           // and in the secon level there are the Ca value, the counter for each potential value.
   Mat epslonPixelsValue;// epslon threshold
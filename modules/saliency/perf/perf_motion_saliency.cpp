@@ -0,0 +1,49 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+typedef TestBaseWithParam<Size> MotionSaliencyBinWangPerfTest;
+
+PERF_TEST_P( MotionSaliencyBinWangPerfTest, computeSaliency, Values(szVGA, sz720p, sz1080p) )
+{
+    const Size sz = GetParam();
+
+    // Static textured background with some noise, and a square moving over it
+    Mat background(sz, CV_8UC1);
+    declare.in(background, WARMUP_RNG);
+    GaussianBlur(background, background, Size(9, 9), 0);
+    std::vector<Mat> frames(8);
+    RNG rng(0);
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        Mat noise(sz, CV_8UC1);
+        rng.fill(noise, RNG::UNIFORM, 0, 4);
+        add(background, noise, frames[i]);
+        rectangle(frames[i], Rect(sz.width / 4 + (int)i * sz.width / 32, sz.height / 4, sz.width / 8, sz.height / 8),
+                  Scalar::all(255), FILLED);
+    }
+
+    Ptr<MotionSaliencyBinWangApr2014> saliency = MotionSaliencyBinWangApr2014::create();
+    saliency->setImagesize(sz.width, sz.height);
+    saliency->init();
+
+    // Learn the background: the first template becomes active after about 150 frames, from then on
+    // the low resolution detection and the neighbourhood check of the template replacement run as well
+    Mat mask;
+    for (int i = 0; i < 160; i++)
+        saliency->computeSaliency(frames[0], mask);
+
+    size_t frame = 0;
+    TEST_CYCLE_N(10)
+    {
+        saliency->computeSaliency(frames[frame], mask);
+        frame = (frame + 1) % frames.size();
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
@@ -0,0 +1,28 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+typedef TestBaseWithParam<Size> ObjectnessBINGPerfTest;
+
+PERF_TEST_P( ObjectnessBINGPerfTest, computeSaliency, Values(szVGA, sz720p, sz1080p) )
+{
+    const Size sz = GetParam();
+    const string trainingPath = cvtest::findDataDirectory("cv/saliency/ObjectnessTrainedModel");
+
+    Mat image(sz, CV_8UC3);
+    declare.in(image, WARMUP_RNG);
+
+    Ptr<ObjectnessBING> bing = ObjectnessBING::create();
+    bing->setTrainingPath(trainingPath);
+    bing->setBBResDir(cv::tempfile("bing") + "/");
+
+    std::vector<Vec4i> boxes;
+    TEST_CYCLE_N(10) bing->computeSaliency(image, boxes);
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
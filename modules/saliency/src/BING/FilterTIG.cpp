@@ -41,6 +41,7 @@
 
 #include "../precomp.hpp"
 #include "CmShow.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv
 {
@@ -108,6 +109,27 @@ void ObjectnessBING::FilterTIG::reconstruct( Mat &w1f )
   }
 }
 
+#if CV_SIMD
+// Accumulates the popcount terms of TIGbits::accumulate for VTraits<v_uint64>::vlanes() neighbouring windows
+static inline void accumulateTIGbits( const v_uint64& tig, const v_uint64& tigMask0, const v_uint64& tigMask1,
+                                      v_int64& bc0, v_int64& bc1, int shift )
+{
+  v_int64 pc = v_reinterpret_as_s64( v_popcount( tig ) );
+  v_int64 pc0 = v_reinterpret_as_s64( v_popcount( v_and( tigMask0, tig ) ) );
+  v_int64 pc1 = v_reinterpret_as_s64( v_popcount( v_and( tigMask1, tig ) ) );
+  v_int64 d0 = v_sub( v_add( pc0, pc0 ), pc ), d1 = v_sub( v_add( pc1, pc1 ), pc );
+  switch ( shift )
+  {
+    case 1: d0 = v_shl<1>( d0 ), d1 = v_shl<1>( d1 ); break;
+    case 2: d0 = v_shl<2>( d0 ), d1 = v_shl<2>( d1 ); break;
+    case 3: d0 = v_shl<3>( d0 ), d1 = v_shl<3>( d1 ); break;
+    default: break;
+  }
+  bc0 = v_add( bc0, d0 );
+  bc1 = v_add( bc1, d1 );
+}
+#endif
+
 // For a W by H gradient magnitude map, find a W-7 by H-7 CV_32F matching score map
 // Please refer to my paper for definition of the variables used in this function
 Mat ObjectnessBING::FilterTIG::matchTemplate( const Mat &mag1u )
@@ -119,6 +141,10 @@ Mat ObjectnessBING::FilterTIG::matchTemplate( const Mat &mag1u )
   Mat_<BYTE> Row1 = Mat_<BYTE>::zeros( sz ), Row2 = Mat_<BYTE>::zeros( sz );
   Mat_<BYTE> Row4 = Mat_<BYTE>::zeros( sz ), Row8 = Mat_<BYTE>::zeros( sz );
   Mat_<float> scores( sz );
+  std::vector<TIG_TYPE> bc0Buf( W + 1 ), bc1Buf( W + 1 );
+#if CV_SIMD
+  const bool useSIMD = useOptimized();
+#endif
   for ( int y = 1; y <= H; y++ )
   {
     const BYTE* G = mag1u.ptr<BYTE>( y - 1 );
@@ -135,6 +161,8 @@ Mat ObjectnessBING::FilterTIG::matchTemplate( const Mat &mag1u )
     BYTE* R4 = Row4.ptr<BYTE>( y );
     BYTE* R8 = Row8.ptr<BYTE>( y );
     float *s = scores.ptr<float>( y );
+
+    // The row bits depend on the previous column, so build the TIGs first ...
     for ( int x = 1; x <= W; x++ )
     {
       BYTE g = G[x - 1];
@@ -146,8 +174,30 @@ Mat ObjectnessBING::FilterTIG::matchTemplate( const Mat &mag1u )
       T2[x] = ( Tu2[x] << 8 ) | R2[x];
       T4[x] = ( Tu4[x] << 8 ) | R4[x];
       T8[x] = ( Tu8[x] << 8 ) | R8[x];
-      s[x] = dot( T1[x], T2[x], T4[x], T8[x] );
     }
+
+    // ... and then score all windows of the row, which are independent of each other
+    int x = 1;
+#if CV_SIMD
+    // setUseOptimized(false) keeps the plain dot() path as a reference for the vectorized one
+    const int step = VTraits<v_uint64>::vlanes();
+    const v_uint64 mask0 = vx_setall_u64( (uint64)_bTIGs[0] ), mask1 = vx_setall_u64( (uint64)_bTIGs[1] );
+    for ( ; useSIMD && x <= W - step + 1; x += step )
+    {
+      v_int64 bc0 = vx_setzero_s64(), bc1 = vx_setzero_s64();
+      accumulateTIGbits( vx_load( (const uint64*) ( T1 + x ) ), mask0, mask1, bc0, bc1, 0 );
+      accumulateTIGbits( vx_load( (const uint64*) ( T2 + x ) ), mask0, mask1, bc0, bc1, 1 );
+      accumulateTIGbits( vx_load( (const uint64*) ( T4 + x ) ), mask0, mask1, bc0, bc1, 2 );
+      accumulateTIGbits( vx_load( (const uint64*) ( T8 + x ) ), mask0, mask1, bc0, bc1, 3 );
+      v_store( (int64*) &bc0Buf[x], bc0 );
+      v_store( (int64*) &bc1Buf[x], bc1 );
+    }
+    // the final combination stays scalar to give exactly the same scores as dot()
+    for ( int i = 1; i < x; i++ )
+      s[i] = _coeffs1[0] * bc0Buf[i] + _coeffs1[1] * bc1Buf[i];
+#endif
+    for ( ; x <= W; x++ )
+      s[x] = dot( T1[x], T2[x], T4[x], T8[x] );
   }
   Mat matchCost1f;
   scores( Rect( 8, 8, W - 7, H - 7 ) ).copyTo( matchCost1f );
@@ -40,6 +40,7 @@
  //M*/
 
 #include "../precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 #include "kyheader.hpp"
 #include "CmTimer.hpp"
@@ -129,6 +130,29 @@ void ObjectnessBING::predictBBoxSI( Mat &img3u, ValStructVec<float, Vec4i> &valB
   valBoxes.reserve( 10000 );
   sz.clear();
   sz.reserve( 10000 );
+
+  // The window sizes are independent, score them in parallel and collect the boxes in the original order
+  std::vector<ValStructVec<float, Point> > matchCosts( numSz );
+  parallel_for_( Range( 0, numSz ), [&]( const Range& range )
+  {
+    for ( int ir = range.start; ir < range.end; ir++ )
+    {
+      int r = _svmSzIdxs[ir];
+      int height = cvRound( pow( _base, r / _numT + _minT ) ), width = cvRound( pow( _base, r % _numT + _minT ) );
+      if( height > imgH * _base || width > imgW * _base )
+        continue;
+
+      height = min( height, imgH ), width = min( width, imgW );
+      Mat im3u, matchCost1f, mag1u;
+      resize( img3u, im3u, Size( cvRound( _W * imgW * 1.0 / width ), cvRound( _W * imgH * 1.0 / height ) ), 0, 0, INTER_LINEAR_EXACT );
+      gradientMag( im3u, mag1u );
+
+      matchCost1f = _tigF.matchTemplate( mag1u );
+
+      nonMaxSup( matchCost1f, matchCosts[ir], _NSS, NUM_WIN_PSZ, fast );
+    }
+  }, numSz );
+
   for ( int ir = numSz - 1; ir >= 0; ir-- )
   {
     int r = _svmSzIdxs[ir];
@@ -137,14 +161,7 @@ void ObjectnessBING::predictBBoxSI( Mat &img3u, ValStructVec<float, Vec4i> &valB
       continue;
 
     height = min( height, imgH ), width = min( width, imgW );
-    Mat im3u, matchCost1f, mag1u;
-    resize( img3u, im3u, Size( cvRound( _W * imgW * 1.0 / width ), cvRound( _W * imgH * 1.0 / height ) ), 0, 0, INTER_LINEAR_EXACT );
-    gradientMag( im3u, mag1u );
-
-    matchCost1f = _tigF.matchTemplate( mag1u );
-
-    ValStructVec<float, Point> matchCost;
-    nonMaxSup( matchCost1f, matchCost, _NSS, NUM_WIN_PSZ, fast );
+    const ValStructVec<float, Point> &matchCost = matchCosts[ir];
 
     // Find true locations and match values
     double ratioX = width / _W, ratioY = height / _W;
@@ -282,15 +299,17 @@ void ObjectnessBING::gradientRGB( Mat &bgr3u, Mat &mag1u )
   for ( int y = 0; y < H; y++ )
   {
     const Vec3b *dataP = bgr3u.ptr<Vec3b>( y );
+    int *ix = Ix.ptr<int>( y );
     for ( int x = 2; x < W; x++ )
-      Ix.at<int>( y, x - 1 ) = bgrMaxDist( dataP[x - 2], dataP[x] );  //  bgr3u.at<Vec3b>(y, x+1), bgr3u.at<Vec3b>(y, x-1));
+      ix[x - 1] = bgrMaxDist( dataP[x - 2], dataP[x] );  //  bgr3u.at<Vec3b>(y, x+1), bgr3u.at<Vec3b>(y, x-1));
   }
   for ( int y = 1; y < H - 1; y++ )
   {
     const Vec3b *tP = bgr3u.ptr<Vec3b>( y - 1 );
     const Vec3b *bP = bgr3u.ptr<Vec3b>( y + 1 );
+    int *iy = Iy.ptr<int>( y );
     for ( int x = 0; x < W; x++ )
-      Iy.at<int>( y, x ) = bgrMaxDist( tP[x], bP[x] );
+      iy[x] = bgrMaxDist( tP[x], bP[x] );
   }
   gradientXY( Ix, Iy, mag1u );
 }
@@ -318,11 +337,19 @@ void ObjectnessBING::gradientGray( Mat &bgr3u, Mat &mag1u )
 
   // Find the gradient for inner regions
   for ( int y = 0; y < H; y++ )
+  {
+    const BYTE *g = g1u.ptr<BYTE>( y );
+    int *ix = Ix.ptr<int>( y );
     for ( int x = 1; x < W - 1; x++ )
-      Ix.at<int>( y, x ) = abs( g1u.at<BYTE>( y, x + 1 ) - g1u.at<BYTE>( y, x - 1 ) );
+      ix[x] = abs( g[x + 1] - g[x - 1] );
+  }
   for ( int y = 1; y < H - 1; y++ )
+  {
+    const BYTE *tP = g1u.ptr<BYTE>( y - 1 ), *bP = g1u.ptr<BYTE>( y + 1 );
+    int *iy = Iy.ptr<int>( y );
     for ( int x = 0; x < W; x++ )
-      Iy.at<int>( y, x ) = abs( g1u.at<BYTE>( y + 1, x ) - g1u.at<BYTE>( y - 1, x ) );
+      iy[x] = abs( bP[x] - tP[x] );
+  }
 
   gradientXY( Ix, Iy, mag1u );
 }
@@ -350,11 +377,19 @@ void ObjectnessBING::gradientHSV( Mat &bgr3u, Mat &mag1u )
 
   // Find the gradient for inner regions
   for ( int y = 0; y < H; y++ )
+  {
+    const Vec3b *dataP = hsv3u.ptr<Vec3b>( y );
+    int *ix = Ix.ptr<int>( y );
     for ( int x = 1; x < W - 1; x++ )
-      Ix.at<int>( y, x ) = vecDist3b( hsv3u.at<Vec3b>( y, x + 1 ), hsv3u.at<Vec3b>( y, x - 1 ) ) / 2;
+      ix[x] = vecDist3b( dataP[x + 1], dataP[x - 1] ) / 2;
+  }
   for ( int y = 1; y < H - 1; y++ )
+  {
+    const Vec3b *tP = hsv3u.ptr<Vec3b>( y - 1 ), *bP = hsv3u.ptr<Vec3b>( y + 1 );
+    int *iy = Iy.ptr<int>( y );
     for ( int x = 0; x < W; x++ )
-      Iy.at<int>( y, x ) = vecDist3b( hsv3u.at<Vec3b>( y + 1, x ), hsv3u.at<Vec3b>( y - 1, x ) ) / 2;
+      iy[x] = vecDist3b( bP[x], tP[x] ) / 2;
+  }
 
   gradientXY( Ix, Iy, mag1u );
 }
@@ -363,11 +398,27 @@ void ObjectnessBING::gradientXY( Mat &x1i, Mat &y1i, Mat &mag1u )
 {
   const int H = x1i.rows, W = x1i.cols;
   mag1u.create( H, W, CV_8U );
+#if CV_SIMD
+  const bool useSIMD = useOptimized();
+#endif
   for ( int r = 0; r < H; r++ )
   {
     const int *x = x1i.ptr<int>( r ), *y = y1i.ptr<int>( r );
     BYTE* m = mag1u.ptr<BYTE>( r );
-    for ( int c = 0; c < W; c++ )
+    int c = 0;
+#if CV_SIMD
+    // the gradients are non-negative, so saturating packs implement min(x + y, 255)
+    const int step = VTraits<v_uint8>::vlanes();
+    for ( ; useSIMD && c <= W - step; c += step )
+    {
+      const int q = VTraits<v_int32>::vlanes();
+      v_uint16 m0 = v_pack_u( v_add( vx_load( x + c ), vx_load( y + c ) ), v_add( vx_load( x + c + q ), vx_load( y + c + q ) ) );
+      v_uint16 m1 = v_pack_u( v_add( vx_load( x + c + 2 * q ), vx_load( y + c + 2 * q ) ),
+                              v_add( vx_load( x + c + 3 * q ), vx_load( y + c + 3 * q ) ) );
+      v_store( m + c, v_pack( m0, m1 ) );
+    }
+#endif
+    for ( ; c < W; c++ )
       m[c] = (BYTE) min( x[c] + y[c], 255 );   //((int)sqrt(sqr(x[c]) + sqr(y[c])), 255);
   }
 }
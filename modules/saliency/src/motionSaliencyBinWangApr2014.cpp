@@ -41,6 +41,7 @@
 
 #include <limits>
 #include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 #define thetaA_VAL 200
 #define thetaL_VAL 250
@@ -89,15 +90,15 @@ bool MotionSaliencyBinWangApr2014::init()
   Size imgSize( imageWidth, imageHeight );
   epslonPixelsValue = Mat( imgSize.height, imgSize.width, CV_32F, Scalar( epslonGeneric ) );
   potentialBackground = Mat( imgSize.height, imgSize.width, CV_8UC2, Scalar( 0, 0 ) );
-  backgroundModel.resize( K + 1 );
+  backgroundModelB.resize( K + 1 );
+  backgroundModelC.resize( K + 1 );
 
   for ( int i = 0; i < K + 1; i++ )
   {
-    Mat* tmpm = new Mat;
-    tmpm->create( imgSize.height, imgSize.width, CV_32FC2 );
-    tmpm->setTo( Scalar( std::numeric_limits<float>::quiet_NaN(), 0 ) );
-    Ptr<Mat> tmp = Ptr<Mat>( tmpm );
-    backgroundModel[i] = tmp;
+    backgroundModelB[i].create( imgSize.height, imgSize.width, CV_32F );
+    backgroundModelB[i].setTo( Scalar( std::numeric_limits<float>::quiet_NaN() ) );
+    backgroundModelC[i].create( imgSize.height, imgSize.width, CV_32F );
+    backgroundModelC[i].setTo( Scalar( 0 ) );
   }
 
   noisePixelMask.create( imgSize.height, imgSize.width, CV_8U );
@@ -115,128 +116,176 @@ MotionSaliencyBinWangApr2014::~MotionSaliencyBinWangApr2014()
 }
 
 // classification (and adaptation) functions
-bool MotionSaliencyBinWangApr2014::fullResolutionDetection( const Mat& image2, Mat& highResBFMask )
+bool MotionSaliencyBinWangApr2014::fullResolutionDetection( const Mat& image, Mat& highResBFMask )
 {
-  Mat image = image2.clone();
-
-  uchar currentPixelValue;
-  float currentEpslonValue;
-  bool backgFlag = false;
+  const int numTemplates = (int) backgroundModelB.size();
+  CV_Assert( numTemplates <= 16 );
 
   // Initially, all pixels are considered as foreground and then we evaluate with the background model
   highResBFMask.create( image.rows, image.cols, CV_8U );
   highResBFMask.setTo( 1 );
 
-  uchar* pImage;
-  float* pEpslon;
-  uchar* pMask;
-
-  // Scan all pixels of image
-  for ( int i = 0; i < image.rows; i++ )
+  // Every pixel only reads and updates its own templates, so the rows are independent
+  parallel_for_( Range( 0, image.rows ), [&]( const Range& range )
   {
-
-    pImage = image.ptr<uchar>( i );
-    pEpslon = epslonPixelsValue.ptr<float>( i );
-    pMask = highResBFMask.ptr<uchar>( i );
-    for ( int j = 0; j < image.cols; j++ )
+    float* pB[16];
+    float* pC[16];
+    for ( int i = range.start; i < range.end; i++ )
     {
-      /*    Pixels with activity greater than Bth are eliminated from the detection result. In this way,
-       continuously blinking noise-pixels will be eliminated from the detection results,
-       preventing the generation of false positives.*/
-      if( activityPixelsValue.at<uchar>( i, j ) < Bth )
+      const uchar* pImage = image.ptr<uchar>( i );
+      const uchar* pActivity = activityPixelsValue.ptr<uchar>( i );
+      const float* pEpslon = epslonPixelsValue.ptr<float>( i );
+      uchar* pMask = highResBFMask.ptr<uchar>( i );
+      for ( int z = 0; z < numTemplates; z++ )
       {
-        backgFlag = false;
-        currentPixelValue = pImage[j];
-        currentEpslonValue = pEpslon[j];
+        pB[z] = backgroundModelB[z].ptr<float>( i );
+        pC[z] = backgroundModelC[z].ptr<float>( i );
+      }
 
-        int counter = 0;
-        for ( size_t z = 0; z < backgroundModel.size(); z++ )
+      int j = 0;
+#if CV_SIMD
+      // Same decisions as the scalar loop below, with the template scan done on masks
+      const int step = VTraits<v_float32>::vlanes();
+      const v_float32 vZero = vx_setzero_f32(), vOne = vx_setall_f32( 1.f );
+      const v_float32 vAlpha = vx_setall_f32( alpha ), vOneMinusAlpha = vx_setall_f32( 1 - alpha );
+      const v_float32 vL0 = vx_setall_f32( (float) L0 ), vL1 = vx_setall_f32( (float) L1 ), vBth = vx_setall_f32( (float) Bth );
+      float maskBuf[VTraits<v_float32>::max_nlanes];
+      for ( ; j <= image.cols - step; j += step )
+      {
+        v_float32 pix = v_cvt_f32( v_reinterpret_as_s32( vx_load_expand_q( pImage + j ) ) );
+        v_float32 activity = v_cvt_f32( v_reinterpret_as_s32( vx_load_expand_q( pActivity + j ) ) );
+        v_float32 epslon = vx_load( pEpslon + j );
+
+        // at least one template has to be activated / initialized
+        v_float32 initialized = vZero;
+        for ( int z = 0; z < numTemplates; z++ )
+          initialized = v_or( initialized, v_ge( vx_load( pC[z] + j ), vOne ) );
+
+        v_float32 process = v_and( v_lt( activity, vBth ), initialized );
+        v_float32 found = vZero;
+        for ( int z = 0; z < numTemplates; z++ )
         {
-
-          counter += (int) backgroundModel[z]->ptr<Vec2f>( i )[j][1];
-          if( counter != 0 )
-            break;
+          v_float32 b = vx_load( pB[z] + j ), c = vx_load( pC[z] + j );
+          v_float32 active = v_and( process, v_gt( c, vZero ) );
+          v_float32 match = v_and( v_and( active, v_lt( v_abs( v_sub( pix, b ) ), epslon ) ), v_not( found ) );
+          v_float32 inc = z == 0 ? v_and( match, v_lt( c, vL0 ) ) : z == 1 ? v_and( match, v_lt( c, vL1 ) ) : match;
+          v_float32 dec = v_and( active, v_not( match ) );
+
+          v_store( pC[z] + j, v_sub( v_add( c, v_and( inc, vOne ) ), v_and( dec, vOne ) ) );
+          v_store( pB[z] + j, v_select( match, v_add( v_mul( vOneMinusAlpha, b ), v_mul( vAlpha, pix ) ), b ) );
+          found = v_or( found, match );
         }
 
-        if( counter != 0 )  //if at least the first template is activated / initialized
+        // foreground unless matched, blinking pixels (activity >= Bth) are background
+        v_store( maskBuf, v_and( v_and( v_lt( activity, vBth ), v_not( found ) ), vOne ) );
+        for ( int l = 0; l < step; l++ )
+          pMask[j + l] = (uchar) maskBuf[l];
+      }
+#endif
+      for ( ; j < image.cols; j++ )
+      {
+        /*    Pixels with activity greater than Bth are eliminated from the detection result. In this way,
+         continuously blinking noise-pixels will be eliminated from the detection results,
+         preventing the generation of false positives.*/
+        if( pActivity[j] < Bth )
         {
+          bool backgFlag = false;
+          uchar currentPixelValue = pImage[j];
+          float currentEpslonValue = pEpslon[j];
 
-          // scan background model vector
-          for ( size_t z = 0; z < backgroundModel.size(); z++ )
+          int counter = 0;
+          for ( int z = 0; z < numTemplates; z++ )
           {
-            float* currentB;
-            float* currentC;
-            currentB = & ( backgroundModel[z]->ptr<Vec2f>( i )[j][0] );
-            currentC = & ( backgroundModel[z]->ptr<Vec2f>( i )[j][1] );
 
-            //continue;
-            if( ( *currentC ) > 0 )  //The current template is active
+            counter += (int) pC[z][j];
+            if( counter != 0 )
+              break;
+          }
+
+          if( counter != 0 )  //if at least the first template is activated / initialized
+          {
+
+            // scan background model vector
+            for ( int z = 0; z < numTemplates; z++ )
             {
-              // If there is a match with a current background template
-              if( abs( currentPixelValue - ( *currentB ) ) < currentEpslonValue && !backgFlag )
+              float* currentB = &pB[z][j];
+              float* currentC = &pC[z][j];
+
+              if( ( *currentC ) > 0 )  //The current template is active
               {
-                // The correspondence pixel in the  BF mask is set as background ( 0 value)
-                pMask[j] = 0;
-                if( ( *currentC < L0 && z == 0 ) || ( *currentC < L1 && z == 1 ) || ( z > 1 ) )
+                // If there is a match with a current background template
+                if( abs( currentPixelValue - ( *currentB ) ) < currentEpslonValue && !backgFlag )
+                {
+                  // The correspondence pixel in the  BF mask is set as background ( 0 value)
+                  pMask[j] = 0;
+                  if( ( *currentC < L0 && z == 0 ) || ( *currentC < L1 && z == 1 ) || ( z > 1 ) )
+                  {
+                    *currentC += 1;  // increment the efficacy of this template
+                  }
+
+                  *currentB = ( ( 1 - alpha ) * ( *currentB ) ) + ( alpha * currentPixelValue );  // Update the template value
+                  backgFlag = true;
+                }
+                else
                 {
-                  *currentC += 1;  // increment the efficacy of this template
+                  *currentC -= 1;  // decrement the efficacy of this template
                 }
 
-                *currentB = ( ( 1 - alpha ) * ( *currentB ) ) + ( alpha * currentPixelValue );  // Update the template value
-                backgFlag = true;
-              }
-              else
-              {
-                *currentC -= 1;  // decrement the efficacy of this template
               }
 
-            }
-
-          }  // end "for" cicle of template vector
+            }  // end "for" cicle of template vector
 
+          }
+          else
+          {
+            pMask[j] = 1;  //if the model of the current pixel is not yet initialized, we mark the pixels as foreground
+          }
         }
         else
         {
-          pMask[j] = 1;  //if the model of the current pixel is not yet initialized, we mark the pixels as foreground
+          pMask[j] = 0;
         }
-      }
-      else
-      {
-        pMask[j] = 0;
-      }
 
+      }
     }
-  }  // end "for" cicle of all image's pixels
+  } );  // end "for" cicle of all image's pixels
 
   return true;
 }
 
-bool MotionSaliencyBinWangApr2014::lowResolutionDetection( const Mat& image, Mat& lowResBFMask )
+// Mean of a block, summed in double like cv::mean
+template<typename T>
+static inline float blockMean( const Mat& m, const Rect& roi )
 {
-  std::vector<Mat> mv;
-  split( *backgroundModel[0], mv );
+  double s = 0;
+  for ( int y = roi.y; y < roi.y + roi.height; y++ )
+  {
+    const T* p = m.ptr<T>( y );
+    for ( int x = roi.x; x < roi.x + roi.width; x++ )
+      s += p[x];
+  }
+  return (float) ( s * ( 1. / roi.area() ) );
+}
 
+bool MotionSaliencyBinWangApr2014::lowResolutionDetection( const Mat& image, Mat& lowResBFMask )
+{
   //if at least the first template is activated / initialized for all pixels
-  if( countNonZero( mv[1] ) > ( mv[1].cols * mv[1].rows ) / 2 )
+  if( countNonZero( backgroundModelC[0] ) > ( backgroundModelC[0].cols * backgroundModelC[0].rows ) / 2 )
   {
-    float currentPixelValue;
-    float currentEpslonValue;
-    float currentB;
-    float currentC;
-
     // Create a mask to select ROI in the original Image and Backgound model and at the same time compute the mean
 
     Rect roi( Point( 0, 0 ), Size( N, N ) );
-    Scalar imageROImean;
-    Scalar backGModelROImean;
-    Mat currentModel;
 
     // Initially, all pixels are considered as foreground and then we evaluate with the background model
     lowResBFMask.create( image.rows, image.cols, CV_8U );
     lowResBFMask.setTo( 1 );
 
-    // Scan all the ROI of original matrices
-    for ( int i = 0; i < (int)ceil( (float) image.rows / N ); i++ )
+    const int blockRows = (int)ceil( (float) image.rows / N ), blockCols = (int)ceil( (float) image.cols / N );
+
+    // Walk the ROI over the blocks first, the scan of the blocks themselves is then independent for each block row
+    std::vector<Rect> rois( blockRows * blockCols );
+    std::vector<uchar> evaluate( blockRows * blockCols );
+    for ( int i = 0; i < blockRows; i++ )
     {
       if( ( roi.y + ( N - 1 ) ) <= ( image.rows - 1 ) )
       {
@@ -244,40 +293,16 @@ bool MotionSaliencyBinWangApr2014::lowResolutionDetection( const Mat& image, Mat
         roi = Rect( Point( roi.x, roi.y ), Size( N, N ) );
       }
 
-      for ( int j = 0; j < (int)ceil( (float) image.cols / N ); j++ )
+      for ( int j = 0; j < blockCols; j++ )
       {
+        rois[i * blockCols + j] = roi;
+
         /* Pixels with activity greater than Bth are eliminated from the detection result. In this way,
          continuously blinking noise-pixels will be eliminated from the detection results,
          preventing the generation of false positives.*/
-        if( activityPixelsValue.at<uchar>( i, j ) < Bth )
+        evaluate[i * blockCols + j] = activityPixelsValue.at<uchar>( i, j ) < Bth;
+        if( evaluate[i * blockCols + j] )
         {
-
-          // Compute the mean of image's block and epslonMatrix's block based on ROI
-          Mat roiImage = image( roi );
-          Mat roiEpslon = epslonPixelsValue( roi );
-          currentPixelValue = (float) mean( roiImage ).val[0];
-          currentEpslonValue = (float) mean( roiEpslon ).val[0];
-
-          // scan background model vector
-          for ( int z = 0; z < N_DS; z++ )
-          {
-            // Select the current template 2 channel matrix, select ROI and compute the mean for each channel separately
-            Mat roiTemplate = ( * ( backgroundModel[z] ) )( roi );
-            Scalar templateMean = mean( roiTemplate );
-            currentB = (float) templateMean[0];
-            currentC = (float) templateMean[1];
-
-            if( ( currentC ) > 0 )  //The current template is active
-            {
-              // If there is a match with a current background template
-              if( abs( currentPixelValue - ( currentB ) ) < currentEpslonValue )
-              {
-                // The correspondence pixel in the  BF mask is set as background ( 0 value)
-                rectangle( lowResBFMask, roi, Scalar( 0 ), FILLED );
-                break;
-              }
-            }
-          }
           // Shift the ROI from left to right follow the block dimension
           roi = roi + Point( N, 0 );
           if( ( roi.x + ( roi.width - 1 ) ) > ( image.cols - 1 ) && ( roi.y + ( N - 1 ) ) <= ( image.rows - 1 ) )
@@ -289,11 +314,6 @@ bool MotionSaliencyBinWangApr2014::lowResolutionDetection( const Mat& image, Mat
             roi = Rect( Point( roi.x, roi.y ), Size( abs( ( image.cols - 1 ) - roi.x ) + 1, abs( ( image.rows - 1 ) - roi.y ) + 1 ) );
           }
         }
-        else
-        {
-          // The correspondence pixel in the  BF mask is set as background ( 0 value)
-          rectangle( lowResBFMask, roi, Scalar( 0 ), FILLED );
-        }
       }
       //Shift the ROI from up to down follow the block dimension, also bringing it back to beginning of row
       roi.x = 0;
@@ -302,8 +322,49 @@ bool MotionSaliencyBinWangApr2014::lowResolutionDetection( const Mat& image, Mat
       {
         roi = Rect( Point( roi.x, roi.y ), Size( N, abs( ( image.rows - 1 ) - roi.y ) + 1 ) );
       }
-
     }
+
+    // Scan all the ROI of original matrices
+    parallel_for_( Range( 0, blockRows ), [&]( const Range& range )
+    {
+      for ( int i = range.start; i < range.end; i++ )
+      {
+        for ( int j = 0; j < blockCols; j++ )
+        {
+          const Rect& blockRoi = rois[i * blockCols + j];
+          if( evaluate[i * blockCols + j] )
+          {
+            // Compute the mean of image's block and epslonMatrix's block based on ROI
+            float currentPixelValue = blockMean<uchar>( image, blockRoi );
+            float currentEpslonValue = blockMean<float>( epslonPixelsValue, blockRoi );
+
+            // scan background model vector
+            for ( int z = 0; z < N_DS; z++ )
+            {
+              // Select the current template, select ROI and compute the mean of B and C
+              float currentB = blockMean<float>( backgroundModelB[z], blockRoi );
+              float currentC = blockMean<float>( backgroundModelC[z], blockRoi );
+
+              if( ( currentC ) > 0 )  //The current template is active
+              {
+                // If there is a match with a current background template
+                if( abs( currentPixelValue - ( currentB ) ) < currentEpslonValue )
+                {
+                  // The correspondence pixel in the  BF mask is set as background ( 0 value)
+                  rectangle( lowResBFMask, blockRoi, Scalar( 0 ), FILLED );
+                  break;
+                }
+              }
+            }
+          }
+          else
+          {
+            // The correspondence pixel in the  BF mask is set as background ( 0 value)
+            rectangle( lowResBFMask, blockRoi, Scalar( 0 ), FILLED );
+          }
+        }
+      }
+    } );
     return true;
   }
   else
@@ -315,84 +376,98 @@ bool MotionSaliencyBinWangApr2014::lowResolutionDetection( const Mat& image, Mat
 
 }
 
-bool inline pairCompare( std::pair<float, float> t, std::pair<float, float> t_plusOne )
-{
-
-  return ( t.second > t_plusOne.second );
-
-}
-
 bool MotionSaliencyBinWangApr2014::templateOrdering()
 {
+  const int backGroundModelSize = (int) backgroundModelB.size();
+  CV_Assert( backGroundModelSize <= 16 && backGroundModelSize >= 2 );
+  const float thetaLf = (float) thetaL;
 
-  Mat dstMask, tempMat, dstMask2, dstMask3;
-  Mat convertMat1, convertMat2;
-  int backGroundModelSize = (int)backgroundModel.size();
-
-  std::vector<std::vector<Mat> > channelSplit( backGroundModelSize );
-  for ( int i = 0; i < backGroundModelSize; i++ )
-  {
-    split( *backgroundModel[i], channelSplit[i] );
-
-  }
-
-  //Bubble sort : Template T1 - Tk
-  for ( int i = 1; i < backGroundModelSize - 1; i++ )
+  // The ordering is done for each pixel separately
+  parallel_for_( Range( 0, backgroundModelB[0].rows ), [&]( const Range& range )
   {
-    // compare and order the i-th template with the others
-    for ( int j = i + 1; j < backGroundModelSize; j++ )
+    float* pB[16];
+    float* pC[16];
+    const int cols = backgroundModelB[0].cols;
+    for ( int r = range.start; r < range.end; r++ )
     {
+      for ( int z = 0; z < backGroundModelSize; z++ )
+      {
+        pB[z] = backgroundModelB[z].ptr<float>( r );
+        pC[z] = backgroundModelC[z].ptr<float>( r );
+      }
 
-      compare( channelSplit[j][1], channelSplit[i][1], dstMask, CMP_GT );
-
-      channelSplit[i][0].copyTo( tempMat );
-      channelSplit[j][0].copyTo( channelSplit[i][0], dstMask );
-      tempMat.copyTo( channelSplit[j][0], dstMask );
-
-      channelSplit[i][1].copyTo( tempMat );
-      channelSplit[j][1].copyTo( channelSplit[i][1], dstMask );
-      tempMat.copyTo( channelSplit[j][1], dstMask );
-    }
-  }
-
-  // SORT Template T0 and T1
-  Mat M_deltaL( backgroundModel[0]->rows, backgroundModel[0]->cols, CV_32F, Scalar( thetaL ) );
-
-  compare( channelSplit[1][1], M_deltaL, dstMask2, CMP_GT );
-  compare( M_deltaL, channelSplit[0][1], dstMask3, CMP_GT );
-
-  threshold( dstMask2, dstMask2, 0, 1, THRESH_BINARY );
-  threshold( dstMask3, dstMask3, 0, 1, THRESH_BINARY );
-
-  bitwise_and( dstMask2, dstMask3, dstMask );
+      int x = 0;
+#if CV_SIMD
+      const int step = VTraits<v_float32>::vlanes();
+      const v_float32 vThetaL = vx_setall_f32( thetaLf );
+      for ( ; x <= cols - step; x += step )
+      {
+        v_float32 b[16], c[16];
+        for ( int z = 0; z < backGroundModelSize; z++ )
+        {
+          b[z] = vx_load( pB[z] + x );
+          c[z] = vx_load( pC[z] + x );
+        }
 
-  //copy correct B element of T1 inside T0 and swap
-  channelSplit[0][0].copyTo( tempMat );
-  channelSplit[1][0].copyTo( channelSplit[0][0], dstMask );
-  tempMat.copyTo( channelSplit[1][0], dstMask );
+        //Bubble sort : Template T1 - Tk
+        for ( int i = 1; i < backGroundModelSize - 1; i++ )
+        {
+          for ( int j = i + 1; j < backGroundModelSize; j++ )
+          {
+            v_float32 m = v_gt( c[j], c[i] );
+            v_float32 bi = b[i], ci = c[i];
+            b[i] = v_select( m, b[j], bi ), b[j] = v_select( m, bi, b[j] );
+            c[i] = v_select( m, c[j], ci ), c[j] = v_select( m, ci, c[j] );
+          }
+        }
 
-  //copy correct C element of T0 inside T1
-  channelSplit[0][1].copyTo( channelSplit[1][1], dstMask );
+        // SORT Template T0 and T1
+        v_float32 m = v_and( v_gt( c[1], vThetaL ), v_gt( vThetaL, c[0] ) );
+        v_float32 b0 = b[0];
+        b[0] = v_select( m, b[1], b0 ), b[1] = v_select( m, b0, b[1] );
+        c[1] = v_select( m, c[0], c[1] );
+        c[0] = v_select( m, vThetaL, c[0] );
 
-  //set new C0 values as gamma * thetaL
-  M_deltaL.mul( gamma );
-  M_deltaL.copyTo( channelSplit[0][1], dstMask );
+        for ( int z = 0; z < backGroundModelSize; z++ )
+        {
+          v_store( pB[z] + x, b[z] );
+          v_store( pC[z] + x, c[z] );
+        }
+      }
+#endif
+      for ( ; x < cols; x++ )
+      {
+        //Bubble sort : Template T1 - Tk
+        for ( int i = 1; i < backGroundModelSize - 1; i++ )
+        {
+          for ( int j = i + 1; j < backGroundModelSize; j++ )
+          {
+            if( pC[j][x] > pC[i][x] )
+            {
+              std::swap( pB[i][x], pB[j][x] );
+              std::swap( pC[i][x], pC[j][x] );
+            }
+          }
+        }
 
-  for ( int i = 0; i < backGroundModelSize; i++ )
-  {
-    merge( channelSplit[i], *backgroundModel[i] );
-  }
+        // SORT Template T0 and T1: swap B, move C0 into T1 and set the new C0 to thetaL
+        if( pC[1][x] > thetaLf && thetaLf > pC[0][x] )
+        {
+          std::swap( pB[0][x], pB[1][x] );
+          pC[1][x] = pC[0][x];
+          pC[0][x] = thetaLf;
+        }
+      }
+    }
+  } );
 
   return true;
 }
 
 bool MotionSaliencyBinWangApr2014::templateReplacement( const Mat& finalBFMask, const Mat& image )
 {
-  std::vector<Mat> temp;
-  split( *backgroundModel[0], temp );
-
 //if at least the first template is activated / initialized for all pixels
-  if( countNonZero( temp[1] ) <= ( temp[1].cols * temp[1].rows ) / 2 )
+  if( countNonZero( backgroundModelC[0] ) <= ( backgroundModelC[0].cols * backgroundModelC[0].rows ) / 2 )
   {
     thetaA = 50;
     thetaL = 150;
@@ -408,191 +483,138 @@ bool MotionSaliencyBinWangApr2014::templateReplacement( const Mat& finalBFMask,
     neighborhoodCheck = true;
   }
 
-  int roiSize = 3;  // FIXED ROI SIZE, not change until you first appropriately adjust the following controls in the EVALUATION section!
-  int countNonZeroElements = 0;
-  std::vector<Mat> mv;
-  Mat replicateCurrentBAMat( roiSize, roiSize, CV_8U );
-  Mat backgroundModelROI( roiSize, roiSize, CV_32F );
-  Mat diffResult( roiSize, roiSize, CV_8U );
+  const int lastTemplate = (int) backgroundModelB.size() - 1;
+  Mat& lastB = backgroundModelB[lastTemplate];
+  Mat& lastC = backgroundModelC[lastTemplate];
+
+  // Pixels whose potential background has to be checked against the neighbourhood, per row
+  std::vector<std::vector<int> > candidates( finalBFMask.rows );
 
 // Scan all pixels of finalBFMask and all pixels of others models (the dimension are the same)
-  const uchar* finalBFMaskP;
-  Vec2b* pbgP;
-  const uchar* imageP;
-  float* epslonP;
-  for ( int i = 0; i < finalBFMask.rows; i++ )
+  parallel_for_( Range( 0, finalBFMask.rows ), [&]( const Range& range )
   {
-    finalBFMaskP = finalBFMask.ptr<uchar>( i );
-    pbgP = potentialBackground.ptr<Vec2b>( i );
-    imageP = image.ptr<uchar>( i );
-    epslonP = epslonPixelsValue.ptr<float>( i );
-    for ( int j = 0; j < finalBFMask.cols; j++ )
+    for ( int i = range.start; i < range.end; i++ )
     {
-      /////////////////// MAINTENANCE of potentialBackground model ///////////////////
-      if( finalBFMaskP[j] == 1 )  // i.e. the corresponding frame pixel has been market as foreground
+      const uchar* finalBFMaskP = finalBFMask.ptr<uchar>( i );
+      Vec2b* pbgP = potentialBackground.ptr<Vec2b>( i );
+      const uchar* imageP = image.ptr<uchar>( i );
+      const float* epslonP = epslonPixelsValue.ptr<float>( i );
+      float* lastBP = lastB.ptr<float>( i );
+      float* lastCP = lastC.ptr<float>( i );
+      for ( int j = 0; j < finalBFMask.cols; j++ )
       {
-        /* For the pixels with CA= 0, if the current frame pixel has been classified as foreground, its value
-         * will be loaded into BA and CA will be set to 1*/
-        if( pbgP[j][1] == 0 )
-        {
-          pbgP[j][0] = imageP[j];
-          pbgP[j][1] = 1;
-        }
-
-        /*the distance between this pixel value and BA is calculated, and if this distance is smaller than
-         the decision threshold epslon, then CA is increased by 1, otherwise is decreased by 1*/
-        else if( abs( (float) imageP[j] - pbgP[j][0] ) < epslonP[j] )
-        {
-          pbgP[j][1] += 1;
-        }
-        else
-        {
-          pbgP[j][1] -= 1;
-        }
-        /*}*/  /////////////////// END of potentialBackground model MAINTENANCE///////////////////
-        /////////////////// EVALUATION of potentialBackground values ///////////////////
-        if( pbgP[j][1] > thetaA )
+        /////////////////// MAINTENANCE of potentialBackground model ///////////////////
+        if( finalBFMaskP[j] == 1 )  // i.e. the corresponding frame pixel has been market as foreground
         {
-          if( neighborhoodCheck )
+          /* For the pixels with CA= 0, if the current frame pixel has been classified as foreground, its value
+           * will be loaded into BA and CA will be set to 1*/
+          if( pbgP[j][1] == 0 )
           {
-            // replicate currentBA value
-            replicateCurrentBAMat.setTo( pbgP[j][0] );
-
-            for ( size_t z = 0; z < backgroundModel.size(); z++ )
-            {
-              // Neighborhood of current pixel in the current background model template.
-              // The ROI is centered in the pixel coordinates
-
-              if( i > 0 && j > 0 && i < ( backgroundModel[z]->rows - 1 ) && j < ( backgroundModel[z]->cols - 1 ) )
-              {
-                split( *backgroundModel[z], mv );
-                backgroundModelROI = mv[0]( Rect( j - (int) floor((float) roiSize / 2 ), i - (int) floor((float) roiSize / 2 ), roiSize, roiSize ) );
-              }
-              else if( i == 0 && j == 0 )  // upper leftt
-              {
-                split( *backgroundModel[z], mv );
-                backgroundModelROI = mv[0]( Rect( j, i, (int) ceil((float) roiSize / 2 ), (int) ceil((float) roiSize / 2 ) ) );
-              }
-              else if( j == 0 && i > 0 && i < ( backgroundModel[z]->rows - 1 ) )  // middle left
-              {
-                split( *backgroundModel[z], mv );
-                backgroundModelROI = mv[0]( Rect( j, i - (int) floor((float) roiSize / 2 ), (int) ceil((float) roiSize / 2 ), roiSize ) );
-              }
-              else if( i == ( backgroundModel[z]->rows - 1 ) && j == 0 )  //down left
-              {
-                split( *backgroundModel[z], mv );
-                backgroundModelROI = mv[0]( Rect( j, i - (int) floor((float) roiSize / 2 ), (int) ceil((float) roiSize / 2 ), (int) ceil((float) roiSize / 2 ) ) );
-              }
-              else if( i == 0 && j > 0 && j < ( backgroundModel[z]->cols - 1 ) )  // upper - middle
-              {
-                split( *backgroundModel[z], mv );
-                backgroundModelROI = mv[0]( Rect( ( j - (int) floor((float) roiSize / 2 ) ), i, roiSize, (int) ceil((float) roiSize / 2 ) ) );
-              }
-              else if( i == ( backgroundModel[z]->rows - 1 ) && j > 0 && j < ( backgroundModel[z]->cols - 1 ) )  //down middle
-              {
-                split( *backgroundModel[z], mv );
-                backgroundModelROI = mv[0](
-                    Rect( j - (int) floor((float) roiSize / 2 ), i - (int) floor((float) roiSize / 2 ), roiSize, (int) ceil((float) roiSize / 2 ) ) );
-              }
-              else if( i == 0 && j == ( backgroundModel[z]->cols - 1 ) )  // upper right
-              {
-                split( *backgroundModel[z], mv );
-                backgroundModelROI = mv[0]( Rect( j - (int) floor((float) roiSize / 2 ), i, (int) ceil((float) roiSize / 2 ), (int) ceil((float) roiSize / 2 ) ) );
-              }
-              else if( j == ( backgroundModel[z]->cols - 1 ) && i > 0 && i < ( backgroundModel[z]->rows - 1 ) )  // middle - right
-              {
-                split( *backgroundModel[z], mv );
-                backgroundModelROI = mv[0](
-                    Rect( j - (int) floor((float) roiSize / 2 ), i - (int) floor((float) roiSize / 2 ), (int) ceil((float) roiSize / 2 ), roiSize ) );
-              }
-              else if( i == ( backgroundModel[z]->rows - 1 ) && j == ( backgroundModel[z]->cols - 1 ) )  // down right
-              {
-                split( *backgroundModel[z], mv );
-                backgroundModelROI = mv[0](
-                    Rect( j - (int) floor((float) roiSize / 2 ), i - (int) floor((float) roiSize / 2 ), (int) ceil((float) roiSize / 2 ), (int) ceil((float) roiSize / 2 ) ) );
-              }
-
-              /* Check if the value of current pixel BA in potentialBackground model is already contained in at least one of its neighbors'
-               * background model
-               */
-              resize( replicateCurrentBAMat, replicateCurrentBAMat, Size( backgroundModelROI.cols, backgroundModelROI.rows ), 0, 0, INTER_LINEAR_EXACT );
-              resize( diffResult, diffResult, Size( backgroundModelROI.cols, backgroundModelROI.rows ), 0, 0, INTER_LINEAR_EXACT );
-
-              backgroundModelROI.convertTo( backgroundModelROI, CV_8U );
-
-              absdiff( replicateCurrentBAMat, backgroundModelROI, diffResult );
-              threshold( diffResult, diffResult, epslonP[j], 255, THRESH_BINARY_INV );
-              countNonZeroElements = countNonZero( diffResult );
-
-              if( countNonZeroElements > 0 )
-              {
-                /////////////////// REPLACEMENT of backgroundModel template ///////////////////
-                //replace TA with current TK
-                backgroundModel[backgroundModel.size() - 1]->at<Vec2f>( i, j ) = potentialBackground.at<Vec2b>( i, j );
-                potentialBackground.at<Vec2b>( i, j )[0] = 0;
-                potentialBackground.at<Vec2b>( i, j )[1] = 0;
+            pbgP[j][0] = imageP[j];
+            pbgP[j][1] = 1;
+          }
 
-                break;
-              }
-            }  // end for backgroundModel size
+          /*the distance between this pixel value and BA is calculated, and if this distance is smaller than
+           the decision threshold epslon, then CA is increased by 1, otherwise is decreased by 1*/
+          else if( abs( (float) imageP[j] - pbgP[j][0] ) < epslonP[j] )
+          {
+            pbgP[j][1] += 1;
           }
           else
           {
-            backgroundModel[backgroundModel.size() - 1]->at<Vec2f>( i, j ) = potentialBackground.at<Vec2b>( i, j );
-            potentialBackground.at<Vec2b>( i, j )[0] = 0;
-            potentialBackground.at<Vec2b>( i, j )[1] = 0;
+            pbgP[j][1] -= 1;
           }
-        }  // close if of EVALUATION
-      }  // end of  if( finalBFMask.at<uchar>( i, j ) == 1 )  // i.e. the corresponding frame pixel has been market as foreground
-
-    }  // end of second for
-  }  // end of first for
-
-  return true;
-}
-
-bool MotionSaliencyBinWangApr2014::activityControl( const Mat& current_noisePixelsMask )
-{
-  Mat discordanceFramesNoise, not_current_noisePixelsMask;
-  Mat nonZeroIndexes, not_discordanceFramesNoise;  //u_current_noisePixelsMask;
-
-//current_noisePixelsMask.convertTo( u_current_noisePixelsMask, CV_8UC1 );
+          /////////////////// END of potentialBackground model MAINTENANCE///////////////////
+          /////////////////// EVALUATION of potentialBackground values ///////////////////
+          if( pbgP[j][1] > thetaA )
+          {
+            if( neighborhoodCheck )
+            {
+              // the neighbourhood may contain replaced templates of previous pixels, check it in raster order below
+              candidates[i].push_back( j );
+            }
+            else
+            {
+              lastBP[j] = pbgP[j][0];
+              lastCP[j] = pbgP[j][1];
+              pbgP[j] = Vec2b( 0, 0 );
+            }
+          }  // close if of EVALUATION
+        }  // end of  if( finalBFMask.at<uchar>( i, j ) == 1 )  // i.e. the corresponding frame pixel has been market as foreground
+      }  // end of second for
+    }  // end of first for
+  } );
+
+  const int roiSize = 3;  // FIXED ROI SIZE
+  const Rect imageRect( 0, 0, finalBFMask.cols, finalBFMask.rows );
+  for ( int i = 0; i < finalBFMask.rows; i++ )
+  {
+    for ( size_t c = 0; c < candidates[i].size(); c++ )
+    {
+      const int j = candidates[i][c];
+      Vec2b& pbg = potentialBackground.at<Vec2b>( i, j );
+      // threshold() of the 8-bit difference uses the floor of epslon
+      const int epslonThreshold = cvFloor( epslonPixelsValue.at<float>( i, j ) );
 
-// Derive the discrepancy between noise in the frame n-1 and frame n
-//threshold( u_current_noisePixelsMask, not_current_noisePixelsMask, 0.5, 1.0, THRESH_BINARY_INV );
-  threshold( current_noisePixelsMask, not_current_noisePixelsMask, 0.5, 1.0, THRESH_BINARY_INV );
-  bitwise_and( noisePixelMask, not_current_noisePixelsMask, discordanceFramesNoise );
+      // Neighborhood of current pixel, centered in the pixel coordinates and clipped to the image
+      const Rect roi = Rect( j - roiSize / 2, i - roiSize / 2, roiSize, roiSize ) & imageRect;
 
-// indices in which the pixel at frame n-1 was the noise (or not) and now no (or yes) (blinking pixels)
-  findNonZero( discordanceFramesNoise, nonZeroIndexes );
+      for ( int z = 0; z <= lastTemplate; z++ )
+      {
+        /* Check if the value of current pixel BA in potentialBackground model is already contained in at least one of its neighbors'
+         * background model
+         */
+        bool contained = false;
+        for ( int y = roi.y; y < roi.y + roi.height && !contained; y++ )
+        {
+          const float* bP = backgroundModelB[z].ptr<float>( y );
+          for ( int x = roi.x; x < roi.x + roi.width && !contained; x++ )
+            contained = abs( (int) pbg[0] - (int) saturate_cast<uchar>( bP[x] ) ) <= epslonThreshold;
+        }
 
-  Vec2i temp;
+        if( contained )
+        {
+          /////////////////// REPLACEMENT of backgroundModel template ///////////////////
+          //replace TA with current TK
+          lastB.at<float>( i, j ) = pbg[0];
+          lastC.at<float>( i, j ) = pbg[1];
+          pbg = Vec2b( 0, 0 );
 
-// we increase the activity value of these pixels
-  for ( int i = 0; i < nonZeroIndexes.rows; i++ )
-  {
-    //TODO check rows, cols inside at
-    temp = nonZeroIndexes.at<Vec2i>( i );
-    if( activityPixelsValue.at<uchar>( temp.val[1], temp.val[0] ) < Bmax )
-    {
-      activityPixelsValue.at<uchar>( temp.val[1], temp.val[0] ) += Ainc;
+          break;
+        }
+      }  // end for backgroundModel size
     }
   }
 
-// decrement other pixels that have not changed (not blinking)
-  threshold( discordanceFramesNoise, not_discordanceFramesNoise, 0.5, 1.0, THRESH_BINARY_INV );
-  findNonZero( not_discordanceFramesNoise, nonZeroIndexes );
-
-  Vec2i temp2;
+  return true;
+}
 
-  for ( int j = 0; j < nonZeroIndexes.rows; j++ )
+bool MotionSaliencyBinWangApr2014::activityControl( const Mat& current_noisePixelsMask )
+{
+  // Pixels which were noise in frame n-1 and are not in frame n are blinking: their activity is increased,
+  // the activity of the other pixels is decreased
+  parallel_for_( Range( 0, activityPixelsValue.rows ), [&]( const Range& range )
   {
-    temp2 = nonZeroIndexes.at<Vec2i>( j );
-    if( activityPixelsValue.at<uchar>( temp2.val[1], temp2.val[0] ) > 0 )
+    for ( int i = range.start; i < range.end; i++ )
     {
-      activityPixelsValue.at<uchar>( temp2.val[1], temp2.val[0] ) -= 1;
+      const uchar* prevNoise = noisePixelMask.ptr<uchar>( i );
+      const uchar* curNoise = current_noisePixelsMask.ptr<uchar>( i );
+      uchar* activity = activityPixelsValue.ptr<uchar>( i );
+      for ( int j = 0; j < activityPixelsValue.cols; j++ )
+      {
+        if( prevNoise[j] != 0 && curNoise[j] == 0 )
+        {
+          if( activity[j] < Bmax )
+            activity[j] += Ainc;
+        }
+        else if( activity[j] > 0 )
+        {
+          activity[j] -= 1;
+        }
+      }
     }
-  }
+  } );
+
 // update the noisePixelsMask
   current_noisePixelsMask.copyTo( noisePixelMask );
 
@@ -601,22 +623,25 @@ bool MotionSaliencyBinWangApr2014::activityControl( const Mat& current_noisePixe
 
 bool MotionSaliencyBinWangApr2014::decisionThresholdAdaptation()
 {
-
-  for ( int i = 0; i < activityPixelsValue.rows; i++ )
+  parallel_for_( Range( 0, activityPixelsValue.rows ), [&]( const Range& range )
   {
-    for ( int j = 0; j < activityPixelsValue.cols; j++ )
+    for ( int i = range.start; i < range.end; i++ )
     {
-      if( activityPixelsValue.at<uchar>( i, j ) > Binc && ( epslonPixelsValue.at<float>( i, j ) + deltaINC ) < epslonMAX )
-      {
-
-        epslonPixelsValue.at<float>( i, j ) += deltaINC;
-      }
-      else if( activityPixelsValue.at<uchar>( i, j ) < Bdec && ( epslonPixelsValue.at<float>( i, j ) - deltaDEC ) > epslonMIN )
+      const uchar* activity = activityPixelsValue.ptr<uchar>( i );
+      float* epslon = epslonPixelsValue.ptr<float>( i );
+      for ( int j = 0; j < activityPixelsValue.cols; j++ )
       {
-        epslonPixelsValue.at<float>( i, j ) -= deltaDEC;
+        if( activity[j] > Binc && ( epslon[j] + deltaINC ) < epslonMAX )
+        {
+          epslon[j] += deltaINC;
+        }
+        else if( activity[j] < Bdec && ( epslon[j] - deltaDEC ) > epslonMIN )
+        {
+          epslon[j] -= deltaDEC;
+        }
       }
     }
-  }
+  } );
 
   return true;
 }
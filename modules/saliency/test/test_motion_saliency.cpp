@@ -0,0 +1,337 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+/** Straightforward implementation of the BinWangApr2014 motion saliency, with the interleaved (B, C) templates
+ * and the serial pixel loops of the original code. It is the known-good output of the optimized implementation.
+ */
+class BinWangReference
+{
+public:
+    BinWangReference(int width, int height)
+        : N_DS(2), K(3), N(4), alpha(0.01f), L0(1000), L1(800), thetaL(250), thetaA(200),
+          neighborhoodCheck(true), Ainc(6), Bmax(80), Bth(20), Binc(15), Bdec(5), deltaINC(20), deltaDEC(0.125f),
+          epslonMIN(18), epslonMAX(80), activityControlFlag(false)
+    {
+        epslonPixelsValue = Mat(height, width, CV_32F, Scalar(20));
+        potentialBackground = Mat(height, width, CV_8UC2, Scalar(0, 0));
+        backgroundModel.resize(K + 1);
+        for (int i = 0; i < K + 1; i++)
+            backgroundModel[i] = Mat(height, width, CV_32FC2, Scalar(std::numeric_limits<float>::quiet_NaN(), 0));
+        noisePixelMask = Mat::zeros(height, width, CV_8U);
+        activityPixelsValue = Mat::zeros(height, width, CV_8U);
+    }
+
+    void compute(const Mat& image, Mat& saliencyMap)
+    {
+        Mat highResBFMask, lowResBFMask;
+        fullResolutionDetection(image, highResBFMask);
+        lowResolutionDetection(image, lowResBFMask);
+        bitwise_and(highResBFMask, lowResBFMask, saliencyMap);
+
+        if (activityControlFlag)
+        {
+            Mat not_lowResBFMask, current_noisePixelsMask;
+            threshold(lowResBFMask, not_lowResBFMask, 0.5, 1.0, THRESH_BINARY_INV);
+            bitwise_and(highResBFMask, not_lowResBFMask, current_noisePixelsMask);
+            activityControl(current_noisePixelsMask);
+            decisionThresholdAdaptation();
+        }
+
+        templateOrdering();
+        templateReplacement(saliencyMap, image);
+        templateOrdering();
+        activityControlFlag = true;
+    }
+
+private:
+    void fullResolutionDetection(const Mat& image, Mat& highResBFMask)
+    {
+        highResBFMask.create(image.rows, image.cols, CV_8U);
+        highResBFMask.setTo(1);
+        for (int i = 0; i < image.rows; i++)
+            for (int j = 0; j < image.cols; j++)
+            {
+                uchar& mask = highResBFMask.at<uchar>(i, j);
+                if (activityPixelsValue.at<uchar>(i, j) >= Bth)
+                {
+                    mask = 0;
+                    continue;
+                }
+                const uchar currentPixelValue = image.at<uchar>(i, j);
+                const float currentEpslonValue = epslonPixelsValue.at<float>(i, j);
+
+                int counter = 0;
+                for (size_t z = 0; z < backgroundModel.size(); z++)
+                {
+                    counter += (int)backgroundModel[z].at<Vec2f>(i, j)[1];
+                    if (counter != 0)
+                        break;
+                }
+                if (counter == 0)
+                    continue;
+
+                bool backgFlag = false;
+                for (size_t z = 0; z < backgroundModel.size(); z++)
+                {
+                    float& currentB = backgroundModel[z].at<Vec2f>(i, j)[0];
+                    float& currentC = backgroundModel[z].at<Vec2f>(i, j)[1];
+                    if (currentC <= 0)
+                        continue;
+                    if (std::abs(currentPixelValue - currentB) < currentEpslonValue && !backgFlag)
+                    {
+                        mask = 0;
+                        if ((currentC < L0 && z == 0) || (currentC < L1 && z == 1) || (z > 1))
+                            currentC += 1;
+                        currentB = ((1 - alpha) * currentB) + (alpha * currentPixelValue);
+                        backgFlag = true;
+                    }
+                    else
+                        currentC -= 1;
+                }
+            }
+    }
+
+    void lowResolutionDetection(const Mat& image, Mat& lowResBFMask)
+    {
+        lowResBFMask.create(image.rows, image.cols, CV_8U);
+        lowResBFMask.setTo(1);
+
+        std::vector<Mat> mv;
+        split(backgroundModel[0], mv);
+        if (countNonZero(mv[1]) <= (mv[1].cols * mv[1].rows) / 2)
+            return;
+
+        Rect roi(Point(0, 0), Size(N, N));
+        for (int i = 0; i < (int)ceil((float)image.rows / N); i++)
+        {
+            if ((roi.y + (N - 1)) <= (image.rows - 1))
+                roi = Rect(Point(roi.x, roi.y), Size(N, N));
+
+            for (int j = 0; j < (int)ceil((float)image.cols / N); j++)
+            {
+                if (activityPixelsValue.at<uchar>(i, j) < Bth)
+                {
+                    float currentPixelValue = (float)mean(image(roi)).val[0];
+                    float currentEpslonValue = (float)mean(epslonPixelsValue(roi)).val[0];
+                    for (int z = 0; z < N_DS; z++)
+                    {
+                        Scalar templateMean = mean(backgroundModel[z](roi));
+                        if ((float)templateMean[1] > 0 && std::abs(currentPixelValue - (float)templateMean[0]) < currentEpslonValue)
+                        {
+                            rectangle(lowResBFMask, roi, Scalar(0), FILLED);
+                            break;
+                        }
+                    }
+                    roi = roi + Point(N, 0);
+                    if ((roi.x + (roi.width - 1)) > (image.cols - 1) && (roi.y + (N - 1)) <= (image.rows - 1))
+                        roi = Rect(Point(roi.x, roi.y), Size(std::abs((image.cols - 1) - roi.x) + 1, N));
+                    else if ((roi.x + (roi.width - 1)) > (image.cols - 1) && (roi.y + (N - 1)) > (image.rows - 1))
+                        roi = Rect(Point(roi.x, roi.y), Size(std::abs((image.cols - 1) - roi.x) + 1, std::abs((image.rows - 1) - roi.y) + 1));
+                }
+                else
+                    rectangle(lowResBFMask, roi, Scalar(0), FILLED);
+            }
+            roi.x = 0;
+            roi.y += N;
+            if ((roi.y + (roi.height - 1)) > (image.rows - 1))
+                roi = Rect(Point(roi.x, roi.y), Size(N, std::abs((image.rows - 1) - roi.y) + 1));
+        }
+    }
+
+    void templateOrdering()
+    {
+        const int size = (int)backgroundModel.size();
+        std::vector<std::vector<Mat> > channelSplit(size);
+        for (int i = 0; i < size; i++)
+            split(backgroundModel[i], channelSplit[i]);
+
+        Mat dstMask, tempMat;
+        for (int i = 1; i < size - 1; i++)
+            for (int j = i + 1; j < size; j++)
+            {
+                compare(channelSplit[j][1], channelSplit[i][1], dstMask, CMP_GT);
+                for (int c = 0; c < 2; c++)
+                {
+                    channelSplit[i][c].copyTo(tempMat);
+                    channelSplit[j][c].copyTo(channelSplit[i][c], dstMask);
+                    tempMat.copyTo(channelSplit[j][c], dstMask);
+                }
+            }
+
+        Mat M_deltaL(backgroundModel[0].size(), CV_32F, Scalar(thetaL)), dstMask2, dstMask3;
+        compare(channelSplit[1][1], M_deltaL, dstMask2, CMP_GT);
+        compare(M_deltaL, channelSplit[0][1], dstMask3, CMP_GT);
+        bitwise_and(dstMask2, dstMask3, dstMask);
+
+        channelSplit[0][0].copyTo(tempMat);
+        channelSplit[1][0].copyTo(channelSplit[0][0], dstMask);
+        tempMat.copyTo(channelSplit[1][0], dstMask);
+        channelSplit[0][1].copyTo(channelSplit[1][1], dstMask);
+        // the original code discards M_deltaL.mul(gamma): the new C0 is thetaL
+        M_deltaL.copyTo(channelSplit[0][1], dstMask);
+
+        for (int i = 0; i < size; i++)
+            merge(channelSplit[i], backgroundModel[i]);
+    }
+
+    void templateReplacement(const Mat& finalBFMask, const Mat& image)
+    {
+        std::vector<Mat> mv;
+        split(backgroundModel[0], mv);
+        if (countNonZero(mv[1]) <= (mv[1].cols * mv[1].rows) / 2)
+        {
+            thetaA = 50;
+            thetaL = 150;
+            neighborhoodCheck = false;
+        }
+        else
+        {
+            thetaA = 200;
+            thetaL = 250;
+            neighborhoodCheck = true;
+        }
+
+        const Rect imageRect(0, 0, image.cols, image.rows);
+        for (int i = 0; i < finalBFMask.rows; i++)
+            for (int j = 0; j < finalBFMask.cols; j++)
+            {
+                if (finalBFMask.at<uchar>(i, j) != 1)
+                    continue;
+                Vec2b& pbg = potentialBackground.at<Vec2b>(i, j);
+                const float epslon = epslonPixelsValue.at<float>(i, j);
+                if (pbg[1] == 0)
+                {
+                    pbg[0] = image.at<uchar>(i, j);
+                    pbg[1] = 1;
+                }
+                else if (std::abs((float)image.at<uchar>(i, j) - pbg[0]) < epslon)
+                    pbg[1] += 1;
+                else
+                    pbg[1] -= 1;
+
+                if (pbg[1] <= thetaA)
+                    continue;
+
+                bool replace = !neighborhoodCheck;
+                for (size_t z = 0; z < backgroundModel.size() && !replace; z++)
+                {
+                    // 3x3 neighbourhood of the pixel clipped to the image, in the live template
+                    split(backgroundModel[z], mv);
+                    Mat neighbourhood;
+                    mv[0](Rect(j - 1, i - 1, 3, 3) & imageRect).convertTo(neighbourhood, CV_8U);
+                    Mat diffResult;
+                    absdiff(Mat(neighbourhood.size(), CV_8U, Scalar(pbg[0])), neighbourhood, diffResult);
+                    threshold(diffResult, diffResult, epslon, 255, THRESH_BINARY_INV);
+                    replace = countNonZero(diffResult) > 0;
+                }
+                if (replace)
+                {
+                    backgroundModel.back().at<Vec2f>(i, j) = pbg;
+                    pbg = Vec2b(0, 0);
+                }
+            }
+    }
+
+    void activityControl(const Mat& current_noisePixelsMask)
+    {
+        Mat not_current, discordance;
+        threshold(current_noisePixelsMask, not_current, 0.5, 1.0, THRESH_BINARY_INV);
+        bitwise_and(noisePixelMask, not_current, discordance);
+        for (int i = 0; i < discordance.rows; i++)
+            for (int j = 0; j < discordance.cols; j++)
+            {
+                uchar& activity = activityPixelsValue.at<uchar>(i, j);
+                if (discordance.at<uchar>(i, j))
+                {
+                    if (activity < Bmax)
+                        activity += Ainc;
+                }
+                else if (activity > 0)
+                    activity -= 1;
+            }
+        current_noisePixelsMask.copyTo(noisePixelMask);
+    }
+
+    void decisionThresholdAdaptation()
+    {
+        for (int i = 0; i < activityPixelsValue.rows; i++)
+            for (int j = 0; j < activityPixelsValue.cols; j++)
+            {
+                const uchar activity = activityPixelsValue.at<uchar>(i, j);
+                float& epslon = epslonPixelsValue.at<float>(i, j);
+                if (activity > Binc && (epslon + deltaINC) < epslonMAX)
+                    epslon += deltaINC;
+                else if (activity < Bdec && (epslon - deltaDEC) > epslonMIN)
+                    epslon -= deltaDEC;
+            }
+    }
+
+    int N_DS, K, N;
+    float alpha;
+    float L0, L1;
+    int thetaL, thetaA;
+    bool neighborhoodCheck;
+    int Ainc, Bmax, Bth, Binc, Bdec;
+    float deltaINC, deltaDEC;
+    int epslonMIN, epslonMAX;
+    bool activityControlFlag;
+
+    std::vector<Mat> backgroundModel;
+    Mat potentialBackground, epslonPixelsValue, noisePixelMask, activityPixelsValue;
+};
+
+TEST(MotionSaliencyBinWangApr2014, regression)
+{
+    // Not a multiple of the 4x4 low resolution blocks, to go through the clipped ROIs as well
+    const Size size(66, 50);
+    // Bright square, block aligned, that is part of the scene while the templates are learnt and then goes away
+    const Rect square(16, 16, 16, 16);
+    const Point center(square.x + square.width / 2, square.y + square.height / 2);
+    const int learningFrames = 170, framesCount = learningFrames + 210;
+
+    Ptr<MotionSaliencyBinWangApr2014> saliency = MotionSaliencyBinWangApr2014::create();
+    saliency->setImagesize(size.width, size.height);
+    ASSERT_TRUE(saliency->init());
+    BinWangReference reference(size.width, size.height);
+
+    RNG rng(0x2014);
+    Mat background(size, CV_8U);
+    for (int y = 0; y < size.height; y++)
+        for (int x = 0; x < size.width; x++)
+            background.at<uchar>(y, x) = (uchar)(60 + ((x + y) % 4) * 2);
+
+    bool squareRemoved = false;
+    for (int frame = 0; frame < framesCount; frame++)
+    {
+        Mat image = background.clone(), noise(size, CV_8U);
+        if (frame < learningFrames)
+            image(square).setTo(190);
+        rng.fill(noise, RNG::UNIFORM, 0, 3);
+        add(image, noise, image);
+        // Some blinking pixels for the activity control, away from the square and from the top left pixels
+        // whose activity is (mis)used by the low resolution detection
+        for (int i = 0; i < 10; i++)
+            image.at<uchar>(rng.uniform(0, size.height), rng.uniform(40, size.width)) = (uchar)rng.uniform(0, 256);
+
+        Mat mask, expected;
+        ASSERT_TRUE(saliency->computeSaliency(image, mask));
+        reference.compute(image, expected);
+        ASSERT_EQ(expected.type(), mask.type());
+        ASSERT_EQ(0., cvtest::norm(expected, mask, NORM_INF)) << "frame " << frame;
+
+        // The square turns into foreground once it is gone, until its new content is accepted as background
+        // by the neighbourhood check of the template replacement
+        if (frame == learningFrames + 100)
+            EXPECT_EQ(1, expected.at<uchar>(center));
+        if (frame == framesCount - 1)
+            squareRemoved = expected.at<uchar>(center) == 0;
+    }
+    EXPECT_TRUE(squareRemoved);
+}
+
+}} // namespace
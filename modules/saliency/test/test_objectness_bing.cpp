@@ -0,0 +1,81 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+struct BingResult
+{
+    std::vector<Vec4i> boxes;
+    std::vector<float> values;
+};
+
+static BingResult runBing(const Mat& image, int nthreads, bool optimized)
+{
+    const int prevThreads = getNumThreads();
+    const bool prevOptimized = useOptimized();
+    setNumThreads(nthreads);
+    setUseOptimized(optimized);
+
+    Ptr<ObjectnessBING> bing = ObjectnessBING::create();
+    bing->setTrainingPath(cvtest::findDataDirectory("cv/saliency/ObjectnessTrainedModel"));
+    bing->setBBResDir(cv::tempfile("bing") + "/");
+
+    BingResult result;
+    bool ok = bing->computeSaliency(image, result.boxes);
+    result.values = bing->getobjectnessValues();
+
+    setUseOptimized(prevOptimized);
+    setNumThreads(prevThreads);
+    EXPECT_TRUE(ok);
+    return result;
+}
+
+static void expectSameResult(const BingResult& ref, const BingResult& res)
+{
+    ASSERT_EQ(ref.boxes.size(), res.boxes.size());
+    ASSERT_EQ(ref.values.size(), res.values.size());
+    for (size_t i = 0; i < ref.boxes.size(); i++)
+    {
+        EXPECT_EQ(ref.boxes[i], res.boxes[i]) << "box " << i;
+        EXPECT_EQ(ref.values[i], res.values[i]) << "box " << i;
+    }
+}
+
+TEST(CV_ObjectnessBING, simd_same_as_scalar)
+{
+    Mat image = imread(cvtest::findDataFile("cv/shared/lena.png"));
+    ASSERT_FALSE(image.empty());
+
+    // setUseOptimized(false) scores the windows with the scalar TIG dot product and gradient
+    BingResult ref = runBing(image, 1, false);
+    ASSERT_FALSE(ref.boxes.empty());
+    expectSameResult(ref, runBing(image, 1, true));
+}
+
+TEST(CV_ObjectnessBING, parallel_same_as_sequential)
+{
+    Mat image = imread(cvtest::findDataFile("cv/shared/lena.png"));
+    ASSERT_FALSE(image.empty());
+
+    BingResult ref = runBing(image, 1, true);
+    ASSERT_FALSE(ref.boxes.empty());
+    expectSameResult(ref, runBing(image, std::max(getNumThreads(), 4), true));
+}
+
+TEST(CV_ObjectnessBING, odd_width_same_as_scalar)
+{
+    // widths that are not a multiple of the vector width exercise the scalar tail of the SIMD loops
+    RNG& rng = cvtest::TS::ptr()->get_rng();
+    Mat image(97, 131, CV_8UC3);
+    rng.fill(image, RNG::UNIFORM, 0, 256);
+    GaussianBlur(image, image, Size(5, 5), 0);
+
+    BingResult ref = runBing(image, 1, false);
+    ASSERT_FALSE(ref.boxes.empty());
+    expectSameResult(ref, runBing(image, std::max(getNumThreads(), 4), true));
+}
+
+}} // namespace
@@ -5,6 +5,7 @@
 #define __OPENCV_TEST_PRECOMP_HPP__
 
 #include "opencv2/ts.hpp"
+#include "opencv2/imgcodecs.hpp"
 #include "opencv2/saliency.hpp"
 
 namespace opencv_test {
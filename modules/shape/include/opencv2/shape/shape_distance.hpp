@@ -67,6 +67,28 @@ public:
     @param contour2 Contour defining second shape.
      */
     CV_WRAP virtual float computeDistance(InputArray contour1, InputArray contour2) = 0;
+
+    /** @brief Compute the shape distances between a query shape and a gallery of shapes.
+
+    @param query Contour defining the query shape.
+    @param gallery Contours defining the gallery shapes.
+    @param distances Output vector of float distances, one per gallery shape, in the order of gallery.
+
+    The default implementation calls computeDistance(query, gallery[i]) for each gallery shape.
+    ShapeContextDistanceExtractor caches the gallery geometry between calls and scores the gallery in
+    parallel. With a non-zero image appearance weight it calls computeDistance for each gallery shape.
+     */
+    CV_WRAP virtual void computeDistances(InputArray query, InputArrayOfArrays gallery, OutputArray distances)
+    {
+        std::vector<Mat> shapes;
+        gallery.getMatVector(shapes);
+
+        std::vector<float> result(shapes.size());
+        for (size_t i = 0; i < shapes.size(); ++i)
+            result[i] = computeDistance(query, shapes[i]);
+
+        Mat(result).copyTo(distances);
+    }
 };
 
 /***********************************************************************************/
@@ -0,0 +1,76 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+static Ptr<HistogramCostExtractor> createCostExtractor(const std::string& type)
+{
+    if (type == "NORM")
+        return createNormHistogramCostExtractor();
+    if (type == "EMD")
+        return createEMDHistogramCostExtractor();
+    if (type == "CHI")
+        return createChiHistogramCostExtractor();
+    return createEMDL1HistogramCostExtractor();
+}
+
+// noisy ellipse sampled with npoints points
+static Mat makeContour(RNG& rng, int npoints)
+{
+    Mat contour(1, npoints, CV_32FC2);
+    float a = rng.uniform(50.f, 150.f), b = rng.uniform(50.f, 150.f);
+    for (int i = 0; i < npoints; i++)
+    {
+        double t = 2 * CV_PI * i / npoints;
+        contour.at<Point2f>(0, i) = Point2f(float(a * std::cos(t)) + rng.uniform(-3.f, 3.f),
+                                            float(b * std::sin(t)) + rng.uniform(-3.f, 3.f));
+    }
+    return contour;
+}
+
+typedef TestBaseWithParam< tuple<std::string, int> > Shape_HistogramCost;
+
+PERF_TEST_P(Shape_HistogramCost, buildCostMatrix,
+            testing::Combine(testing::Values("NORM", "EMD", "CHI", "EMDL1"), testing::Values(100, 300)))
+{
+    const std::string type = get<0>(GetParam());
+    const int npoints = get<1>(GetParam());
+    if (type == "EMD" && npoints > 100)
+        throw SkipTestException("EMD on large descriptors is too slow");
+
+    // 12 angular x 4 radial bins, as in the default shape context descriptor
+    Mat descriptors1(npoints, 48, CV_32F), descriptors2(npoints, 48, CV_32F), costMatrix;
+    randu(descriptors1, 0, 10);
+    randu(descriptors2, 0, 10);
+
+    Ptr<HistogramCostExtractor> comparer = createCostExtractor(type);
+
+    TEST_CYCLE_N(3) comparer->buildCostMatrix(descriptors1, descriptors2, costMatrix);
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef TestBaseWithParam<int> Shape_SCD_Gallery;
+
+PERF_TEST_P(Shape_SCD_Gallery, computeDistances, testing::Values(16, 64))
+{
+    const int gallerySize = GetParam();
+    const int npoints = 100;
+
+    RNG& rng = theRNG();
+    Mat query = makeContour(rng, npoints);
+    std::vector<Mat> gallery;
+    for (int i = 0; i < gallerySize; i++)
+        gallery.push_back(makeContour(rng, npoints));
+
+    Ptr<ShapeContextDistanceExtractor> sd = createShapeContextDistanceExtractor();
+    std::vector<float> distances;
+
+    TEST_CYCLE_N(3) sd->computeDistances(query, gallery, distances);
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
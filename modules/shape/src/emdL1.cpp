@@ -59,17 +59,23 @@
 
 float EmdL1::getEMDL1(cv::Mat &sig1, cv::Mat &sig2)
 {
-    // Initialization
     CV_Assert((sig1.rows==sig2.rows) && (sig1.cols==sig2.cols) && (!sig1.empty()) && (!sig2.empty()));
-    if(!initBaseTrees(sig1.rows, 1))
-        return -1;
 
-    float *H1=new float[sig1.rows], *H2 = new float[sig2.rows];
+    m_H1.resize(sig1.rows);
+    m_H2.resize(sig2.rows);
     for (int ii=0; ii<sig1.rows; ii++)
     {
-        H1[ii]=sig1.at<float>(ii,0);
-        H2[ii]=sig2.at<float>(ii,0);
+        m_H1[ii]=sig1.at<float>(ii,0);
+        m_H2[ii]=sig2.at<float>(ii,0);
     }
+    return getEMDL1(&m_H1[0], &m_H2[0], sig1.rows);
+}
+
+float EmdL1::getEMDL1(const float *H1, const float *H2, int n)
+{
+    // Initialization
+    if(!initBaseTrees(n, 1))
+        return -1;
 
     fillBaseTrees(H1,H2); // Initialize histograms
     greedySolution(); // Construct an initial Basic Feasible solution
@@ -92,8 +98,6 @@ float EmdL1::getEMDL1(cv::Mat &sig1, cv::Mat &sig2)
             findNewSolution();
         ++m_nItr;
     }
-    delete [] H1;
-    delete [] H2;
     // Output the total flow
     return compuTotalFlow();
 }
@@ -129,6 +133,11 @@ bool EmdL1::initBaseTrees(int n1, int n2, int n3)
         m_auxQueue.resize(binsDim1*binsDim2+2);
         m_fromLoop.resize(binsDim1*binsDim2+2);
         m_toLoop.resize(binsDim1*binsDim2+2);
+        m_D.resize(binsDim1);
+        for(int i1=0; i1<binsDim1; i1++)
+            m_D[i1].resize(binsDim2);
+        m_d1s.resize(binsDim1);
+        m_d2s.resize(binsDim2);
     }
     else if(dimension==3)
     {
@@ -161,13 +170,13 @@ bool EmdL1::initBaseTrees(int n1, int n2, int n3)
     return true;
 }
 
-bool EmdL1::fillBaseTrees(float *H1, float *H2)
+bool EmdL1::fillBaseTrees(const float *H1, const float *H2)
 {
     //- Set global counters
     m_pRoot	= NULL;
     // Graph initialization
-    float *p1 = H1;
-    float *p2 = H2;
+    const float *p1 = H1;
+    const float *p2 = H2;
     if(dimension==2)
     {
         for(int c=0; c<binsDim2; c++)
@@ -253,14 +262,13 @@ bool EmdL1::greedySolution2()
 {
     //- Prepare auxiliary array, D=H1-H2
     int	c,r;
-    floatArray2D D(binsDim1);
+    floatArray2D& D = m_D;
     for(r=0; r<binsDim1; r++)
     {
-        D[r].resize(binsDim2);
         for(c=0; c<binsDim2; c++) D[r][c] = m_Nodes[r][c].d;
     }
     // compute integrated values along each dimension
-    std::vector<float> d2s(binsDim2);
+    floatArray& d2s = m_d2s;
     d2s[0] = 0;
     for(c=0; c<binsDim2-1; c++)
     {
@@ -268,7 +276,7 @@ bool EmdL1::greedySolution2()
         for(r=0; r<binsDim1; r++) d2s[c+1]-= D[r][c];
     }
 
-    std::vector<float> d1s(binsDim1);
+    floatArray& d1s = m_d1s;
     d1s[0] = 0;
     for(r=0; r<binsDim1-1; r++)
     {
@@ -105,12 +105,15 @@ public:
     }
 
     float getEMDL1(cv::Mat &sig1, cv::Mat &sig2);
+    // same as above for two 1D histograms of n bins; the trees and scratch buffers are
+    // kept between calls, so one object can be reused as a workspace for many pairs
+    float getEMDL1(const float *H1, const float *H2, int n);
     void setMaxIteration(int _nMaxIt);
 
 private:
     //-- SubFunctions called in the EMD algorithm
     bool initBaseTrees(int n1=0, int n2=0, int n3=0);
-    bool fillBaseTrees(float *H1, float *H2);
+    bool fillBaseTrees(const float *H1, const float *H2);
     bool greedySolution();
     bool greedySolution2();
     bool greedySolution3();
@@ -145,4 +148,8 @@ private:
     std::vector<cvPEmdEdge> m_toLoop;
     int	m_iFrom;
     int m_iTo;
+    // scratch buffers of the 2D greedy solution and of the cv::Mat interface
+    floatArray2D m_D;
+    floatArray m_d1s, m_d2s;
+    floatArray m_H1, m_H2;
 };
@@ -40,10 +40,37 @@
 //M*/
 
 #include "precomp.hpp"
+#include "emdL1_def.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv
 {
 
+// Half of the chi-squared distance between two normalized histograms //
+static float chiSquaredCost(const float* h1, const float* h2, int n)
+{
+    int k = 0;
+    float csum = 0;
+#if CV_SIMD
+    const int step = VTraits<v_float32>::vlanes();
+    v_float32 vsum = vx_setzero_f32(), veps = vx_setall_f32(FLT_EPSILON);
+    for (; k <= n - step; k += step)
+    {
+        v_float32 a = vx_load(h1 + k), b = vx_load(h2 + k);
+        v_float32 resta = v_sub(a, b), suma = v_add(a, b);
+        vsum = v_add(vsum, v_div(v_mul(resta, resta), v_add(veps, suma)));
+    }
+    csum = v_reduce_sum(vsum);
+#endif
+    for (; k < n; k++)
+    {
+        float resta = h1[k] - h2[k];
+        float suma = h1[k] + h2[k];
+        csum += resta*resta/(FLT_EPSILON+suma);
+    }
+    return csum/2;
+}
+
 /*!  */
 class NormHistogramCostExtractorImpl CV_FINAL : public NormHistogramCostExtractor
 {
@@ -150,21 +177,24 @@ void NormHistogramCostExtractorImpl::buildCostMatrix(InputArray _descriptors1, I
     }
 
     // Compute the Cost Matrix //
-    for(int i=0; i<costrows; i++)
+    parallel_for_(Range(0, costrows), [&](const Range& range)
     {
-        for(int j=0; j<costrows; j++)
+        for(int i=range.start; i<range.end; i++)
         {
-            if (i<scd1.rows && j<scd2.rows)
-            {
-                Mat columnDiff = scd1.row(i)-scd2.row(j);
-                costMatrix.at<float>(i,j)=(float)norm(columnDiff, flag);
-            }
-            else
+            float* costRow = costMatrix.ptr<float>(i);
+            for(int j=0; j<costrows; j++)
             {
-                costMatrix.at<float>(i,j)=defaultCost;
+                if (i<scd1.rows && j<scd2.rows)
+                {
+                    costRow[j]=(float)norm(scd1.row(i), scd2.row(j), flag);
+                }
+                else
+                {
+                    costRow[j]=defaultCost;
+                }
             }
         }
-    }
+    });
 }
 
 Ptr <HistogramCostExtractor> createNormHistogramCostExtractor(int flag, int nDummies, float defaultCost)
@@ -279,32 +309,38 @@ void EMDHistogramCostExtractorImpl::buildCostMatrix(InputArray _descriptors1, In
     }
 
     // Compute the Cost Matrix //
-    for(int i=0; i<costrows; i++)
+    parallel_for_(Range(0, costrows), [&](const Range& range)
     {
-        for(int j=0; j<costrows; j++)
+        // signatures are (weight, bin) rows, the bin column is shared by all the pairs //
+        cv::Mat sig1(scd1.cols,2,CV_32F), sig2(scd2.cols,2,CV_32F);
+        for (int k=0; k<sig1.rows; k++)
         {
-            if (i<scd1.rows && j<scd2.rows)
-            {
-                cv::Mat sig1(scd1.cols,2,CV_32F), sig2(scd2.cols,2,CV_32F);
+            sig1.at<float>(k,1)=float(k);
+        }
+        for (int k=0; k<sig2.rows; k++)
+        {
+            sig2.at<float>(k,1)=float(k);
+        }
+
+        for(int i=range.start; i<range.end; i++)
+        {
+            float* costRow = costMatrix.ptr<float>(i);
+            if (i<scd1.rows)
                 sig1.col(0)=scd1.row(i).t();
-                sig2.col(0)=scd2.row(j).t();
-                for (int k=0; k<sig1.rows; k++)
+            for(int j=0; j<costrows; j++)
+            {
+                if (i<scd1.rows && j<scd2.rows)
                 {
-                    sig1.at<float>(k,1)=float(k);
+                    sig2.col(0)=scd2.row(j).t();
+                    costRow[j] = cv::EMD(sig1, sig2, flag);
                 }
-                for (int k=0; k<sig2.rows; k++)
+                else
                 {
-                    sig2.at<float>(k,1)=float(k);
+                    costRow[j] = defaultCost;
                 }
-
-                costMatrix.at<float>(i,j) = cv::EMD(sig1, sig2, flag);
-            }
-            else
-            {
-                costMatrix.at<float>(i,j) = defaultCost;
             }
         }
-    }
+    });
 }
 
 Ptr <HistogramCostExtractor> createEMDHistogramCostExtractor(int flag, int nDummies, float defaultCost)
@@ -403,27 +439,24 @@ void ChiHistogramCostExtractorImpl::buildCostMatrix(InputArray _descriptors1, In
     }
 
     // Compute the Cost Matrix //
-    for(int i=0; i<costrows; i++)
+    parallel_for_(Range(0, costrows), [&](const Range& range)
     {
-        for(int j=0; j<costrows; j++)
+        for(int i=range.start; i<range.end; i++)
         {
-            if (i<scd1.rows && j<scd2.rows)
+            float* costRow = costMatrix.ptr<float>(i);
+            for(int j=0; j<costrows; j++)
             {
-                float csum = 0;
-                for(int k=0; k<scd2.cols; k++)
+                if (i<scd1.rows && j<scd2.rows)
                 {
-                    float resta=scd1.at<float>(i,k)-scd2.at<float>(j,k);
-                    float suma=scd1.at<float>(i,k)+scd2.at<float>(j,k);
-                    csum += resta*resta/(FLT_EPSILON+suma);
+                    costRow[j]=chiSquaredCost(scd1.ptr<float>(i), scd2.ptr<float>(j), scd2.cols);
+                }
+                else
+                {
+                    costRow[j]=defaultCost;
                 }
-                costMatrix.at<float>(i,j)=csum/2;
-            }
-            else
-            {
-                costMatrix.at<float>(i,j)=defaultCost;
             }
         }
-    }
+    });
 }
 
 Ptr <HistogramCostExtractor> createChiHistogramCostExtractor(int nDummies, float defaultCost)
@@ -522,23 +555,27 @@ void EMDL1HistogramCostExtractorImpl::buildCostMatrix(InputArray _descriptors1,
     }
 
     // Compute the Cost Matrix //
-    for(int i=0; i<costrows; i++)
+    CV_Assert(scd1.cols==scd2.cols);
+    parallel_for_(Range(0, costrows), [&](const Range& range)
     {
-        for(int j=0; j<costrows; j++)
+        // one EMD-L1 workspace per stripe, its trees are rebuilt in place for every pair //
+        EmdL1 emdl1;
+        for(int i=range.start; i<range.end; i++)
         {
-            if (i<scd1.rows && j<scd2.rows)
+            float* costRow = costMatrix.ptr<float>(i);
+            for(int j=0; j<costrows; j++)
             {
-                cv::Mat sig1(scd1.cols,1,CV_32F), sig2(scd2.cols,1,CV_32F);
-                sig1.col(0)=scd1.row(i).t();
-                sig2.col(0)=scd2.row(j).t();
-                costMatrix.at<float>(i,j) = cv::EMDL1(sig1, sig2);
-            }
-            else
-            {
-                costMatrix.at<float>(i,j) = defaultCost;
+                if (i<scd1.rows && j<scd2.rows)
+                {
+                    costRow[j] = emdl1.getEMDL1(scd1.ptr<float>(i), scd2.ptr<float>(j), scd1.cols);
+                }
+                else
+                {
+                    costRow[j] = defaultCost;
+                }
             }
         }
-    }
+    });
 }
 
 Ptr <HistogramCostExtractor> createEMDL1HistogramCostExtractor(int nDummies, float defaultCost)
@@ -49,9 +49,35 @@
 #include "opencv2/core.hpp"
 #include "scd_def.hpp"
 #include <limits>
+#include <cstring>
 
 namespace cv
 {
+// Converts a contour to a row of CV_32FC2 points //
+static Mat prepareContour(const Mat& contour)
+{
+    Mat set;
+    contour.convertTo(set, CV_32F);
+    CV_Assert((set.channels()==2) && (set.cols>0));
+
+    // Force vectors column-based
+    if (set.dims > 1)
+        set = set.reshape(2, 1);
+    return set;
+}
+
+// New instance of the built-in transformers with the same settings, empty otherwise //
+static Ptr<ShapeTransformer> cloneTransformer(const Ptr<ShapeTransformer>& transformer)
+{
+    Ptr<ThinPlateSplineShapeTransformer> tps = transformer.dynamicCast<ThinPlateSplineShapeTransformer>();
+    if (!tps.empty())
+        return createThinPlateSplineShapeTransformer(tps->getRegularizationParameter());
+    Ptr<AffineTransformer> affine = transformer.dynamicCast<AffineTransformer>();
+    if (!affine.empty())
+        return createAffineTransformer(affine->getFullAffine());
+    return Ptr<ShapeTransformer>();
+}
+
 class ShapeContextDistanceExtractorImpl : public ShapeContextDistanceExtractor
 {
 public:
@@ -83,6 +109,12 @@ public:
     //! the main operator
     virtual float computeDistance(InputArray contour1, InputArray contour2) CV_OVERRIDE;
 
+    //! the batch operator
+    virtual void computeDistances(InputArray query, InputArrayOfArrays gallery, OutputArray distances) CV_OVERRIDE;
+
+    //! drops the cached gallery geometry
+    virtual void clear() CV_OVERRIDE { galleryCache.clear(); }
+
     //! Setters/Getters
     virtual void setAngularBins(int _nAngularBins) CV_OVERRIDE { CV_Assert(_nAngularBins>0); nAngularBins=_nAngularBins; }
     virtual int getAngularBins() const CV_OVERRIDE { return nAngularBins; }
@@ -183,38 +215,18 @@ protected:
     float shapeContextWeight;
     float sigma;
     String name_;
-};
-
-float ShapeContextDistanceExtractorImpl::computeDistance(InputArray contour1, InputArray contour2)
-{
-    CV_INSTRUMENT_REGION();
+    std::vector<SCDShapeCache> galleryCache;
 
-    // Checking //
-    Mat sset1=contour1.getMat(), sset2=contour2.getMat(), set1, set2;
-    if (set1.type() != CV_32F)
-        sset1.convertTo(set1, CV_32F);
-    else
-        sset1.copyTo(set1);
-
-    if (set2.type() != CV_32F)
-        sset2.convertTo(set2, CV_32F);
-    else
-        sset2.copyTo(set2);
+    void updateGalleryCache(const std::vector<Mat>& shapes);
 
-    CV_Assert((set1.channels()==2) && (set1.cols>0));
-    CV_Assert((set2.channels()==2) && (set2.cols>0));
-
-    // Force vectors column-based
-    if (set1.dims > 1)
-        set1 = set1.reshape(2, 1);
-    if (set2.dims > 1)
-        set2 = set2.reshape(2, 1);
-
-    if (imageAppearanceWeight!=0)
-    {
-        CV_Assert((!image1.empty()) && (!image2.empty()));
-    }
+    // aligns set1 to the target, returns the matching cost and accumulates the bending energy //
+    float matchShapes(Mat& set1, const SCDShapeCache& target, const Ptr<ShapeTransformer>& _transformer,
+                      Ptr<HistogramCostExtractor> _comparer, float& bEnergy, Mat* warpedImage) const;
+};
 
+float ShapeContextDistanceExtractorImpl::matchShapes(Mat& set1, const SCDShapeCache& target, const Ptr<ShapeTransformer>& _transformer,
+                                                     Ptr<HistogramCostExtractor> _comparer, float& bEnergy, Mat* warpedImage) const
+{
     // Initializing Extractor, Descriptor structures and Matcher //
     SCD set1SCE(nAngularBins, nRadialBins, innerRadius, outerRadius, rotationInvariant);
     Mat set1SCD;
@@ -222,58 +234,80 @@ float ShapeContextDistanceExtractorImpl::computeDistance(InputArray contour1, In
     Mat set2SCD;
     SCDMatcher matcher;
     std::vector<DMatch> matches;
-
-    // Distance components (The output is a linear combination of these 3) //
-    float sDistance=0, bEnergy=0, iAppearance=0;
     float beta;
 
     // Initializing some variables //
     std::vector<int> inliers1, inliers2;
 
-    Ptr<ThinPlateSplineShapeTransformer> transDown = transformer.dynamicCast<ThinPlateSplineShapeTransformer>();
-
-    Mat warpedImage;
-    int ii, jj, pt;
+    Ptr<ThinPlateSplineShapeTransformer> transDown = _transformer.dynamicCast<ThinPlateSplineShapeTransformer>();
 
-    for (ii=0; ii<iterations; ii++)
+    for (int ii=0; ii<iterations; ii++)
     {
         // Extract SCD descriptor in the set1 //
         set1SCE.extractSCD(set1, set1SCD, inliers1);
 
         // Extract SCD descriptor of the set2 (TARGET) //
-        set2SCE.extractSCD(set2, set2SCD, inliers2, set1SCE.getMeanDistance());
+        set2SCE.extractSCD(target, set2SCD, set1SCE.getMeanDistance());
 
         // regularization parameter with annealing rate annRate //
         beta=set1SCE.getMeanDistance();
         beta *= beta;
 
         // match //
-        matcher.matchDescriptors(set1SCD, set2SCD, matches, comparer, inliers1, inliers2);
+        matcher.matchDescriptors(set1SCD, set2SCD, matches, _comparer, inliers1, inliers2);
 
         // apply TPS transform //
         if ( !transDown.empty() )
             transDown->setRegularizationParameter(beta);
-        transformer->estimateTransformation(set1, set2, matches);
-        bEnergy += transformer->applyTransformation(set1, set1);
+        _transformer->estimateTransformation(set1, target.contour, matches);
+        bEnergy += _transformer->applyTransformation(set1, set1);
 
         // Image appearance //
-        if (imageAppearanceWeight!=0)
+        if (warpedImage)
         {
             // Have to accumulate the transformation along all the iterations
             if (ii==0)
             {
                 if ( !transDown.empty() )
                 {
-                    image2.copyTo(warpedImage);
+                    image2.copyTo(*warpedImage);
                 }
                 else
                 {
-                    image1.copyTo(warpedImage);
+                    image1.copyTo(*warpedImage);
                 }
             }
-            transformer->warpImage(warpedImage, warpedImage);
+            _transformer->warpImage(*warpedImage, *warpedImage);
         }
     }
+    return matcher.getMatchingCost();
+}
+
+float ShapeContextDistanceExtractorImpl::computeDistance(InputArray contour1, InputArray contour2)
+{
+    CV_INSTRUMENT_REGION();
+
+    // Checking //
+    Mat sset1=contour1.getMat();
+    Mat set1=prepareContour(sset1), set2=prepareContour(contour2.getMat());
+
+    if (imageAppearanceWeight!=0)
+    {
+        CV_Assert((!image1.empty()) && (!image2.empty()));
+    }
+
+    SCDShapeCache target;
+    SCD(nAngularBins, nRadialBins, innerRadius, outerRadius, rotationInvariant).buildShapeCache(set2, target);
+
+    // Distance components (The output is a linear combination of these 3) //
+    float sDistance=0, bEnergy=0, iAppearance=0;
+
+    Ptr<ThinPlateSplineShapeTransformer> transDown = transformer.dynamicCast<ThinPlateSplineShapeTransformer>();
+
+    Mat warpedImage;
+    int ii, jj, pt;
+
+    sDistance = matchShapes(set1, target, transformer, comparer, bEnergy, imageAppearanceWeight!=0 ? &warpedImage : 0);
 
     Mat gaussWindow, diffIm;
     if (imageAppearanceWeight!=0)
@@ -317,11 +351,75 @@ float ShapeContextDistanceExtractorImpl::computeDistance(InputArray contour1, In
         }
         iAppearance = float(cv::sum(appIm)[0]/sset1.cols);
     }
-    sDistance = matcher.getMatchingCost();
 
     return (sDistance*shapeContextWeight+bEnergy*bendingEnergyWeight+iAppearance*imageAppearanceWeight);
 }
 
+void ShapeContextDistanceExtractorImpl::updateGalleryCache(const std::vector<Mat>& shapes)
+{
+    galleryCache.resize(shapes.size());
+
+    SCD scd(nAngularBins, nRadialBins, innerRadius, outerRadius, rotationInvariant);
+    parallel_for_(Range(0, (int)shapes.size()), [&](const Range& range)
+    {
+        for (int i=range.start; i<range.end; i++)
+        {
+            Mat contour = prepareContour(shapes[i]);
+            SCDShapeCache& entry = galleryCache[i];
+
+            // the cached geometry does not depend on the radial bins, only on the points and the angular bins //
+            if (entry.nAngularBins==nAngularBins && entry.rotationInvariant==rotationInvariant &&
+                entry.contour.size()==contour.size() &&
+                std::memcmp(entry.contour.ptr(), contour.ptr(), contour.total()*contour.elemSize())==0)
+                continue;
+            scd.buildShapeCache(contour, entry);
+        }
+    });
+}
+
+void ShapeContextDistanceExtractorImpl::computeDistances(InputArray query, InputArrayOfArrays gallery, OutputArray distances)
+{
+    CV_INSTRUMENT_REGION();
+
+    std::vector<Mat> shapes;
+    gallery.getMatVector(shapes);
+
+    // The appearance term warps the image pair through the shared state, those matches are scored one by one //
+    if (imageAppearanceWeight!=0)
+    {
+        std::vector<float> result(shapes.size());
+        for (size_t i=0; i<shapes.size(); i++)
+            result[i] = computeDistance(query, shapes[i]);
+        Mat(result).copyTo(distances);
+        return;
+    }
+
+    Mat set1=prepareContour(query.getMat());
+    updateGalleryCache(shapes);
+
+    // The transformer keeps the alignment state, so every task works on its own copy.
+    // Transformers that cannot be copied are shared, and the gallery is scored serially.
+    const bool parallel = !cloneTransformer(transformer).empty();
+    std::vector<float> result(shapes.size());
+    auto scoreGallery = [&](const Range& range)
+    {
+        Ptr<ShapeTransformer> taskTransformer = parallel ? cloneTransformer(transformer) : transformer;
+        for (int i=range.start; i<range.end; i++)
+        {
+            Mat warpedSet = set1.clone();
+            float bEnergy=0;
+            float sDistance = matchShapes(warpedSet, galleryCache[i], taskTransformer, comparer, bEnergy, 0);
+            result[i] = sDistance*shapeContextWeight+bEnergy*bendingEnergyWeight;
+        }
+    };
+    if (parallel)
+        parallel_for_(Range(0, (int)shapes.size()), scoreGallery);
+    else
+        scoreGallery(Range(0, (int)shapes.size()));
+
+    Mat(result).copyTo(distances);
+}
+
 Ptr <ShapeContextDistanceExtractor> createShapeContextDistanceExtractor(int nAngularBins, int nRadialBins, float innerRadius, float outerRadius, int iterations,
                                                                         const Ptr<HistogramCostExtractor> &comparer, const Ptr<ShapeTransformer> &transformer)
 {
@@ -381,6 +479,85 @@ void SCD::extractSCD(cv::Mat &contour, cv::Mat &descriptors, const std::vector<i
     }
 }
 
+void SCD::buildShapeCache(const cv::Mat &contour, SCDShapeCache &cache) const
+{
+    const int npoints = contour.cols;
+    cache.contour = contour;
+    cache.nAngularBins = nAngularBins;
+    cache.rotationInvariant = rotationInvariant;
+    cache.distances.create(npoints, npoints, CV_32F);
+    cache.angleBins.create(npoints, npoints, CV_32S);
+
+    cv::Mat angleMatrix = cv::Mat::zeros(npoints, npoints, CV_32F);
+    buildAngleMatrix(contour, angleMatrix);
+
+    std::vector<double> angspaces;
+    angularSpaces(angspaces);
+
+    const cv::Point2f* points = contour.ptr<cv::Point2f>();
+    for (int i=0; i<npoints; i++)
+    {
+        const float* angleRow = angleMatrix.ptr<float>(i);
+        float* disRow = cache.distances.ptr<float>(i);
+        int* binRow = cache.angleBins.ptr<int>(i);
+        for (int j=0; j<npoints; j++)
+        {
+            cv::Point2f dif = points[i] - points[j];
+            disRow[j] = (float)std::sqrt((double)dif.x*dif.x + (double)dif.y*dif.y);
+
+            int angidx=-1;
+            if (i!=j)
+            {
+                for (int k=0; k<nAngularBins; k++)
+                {
+                    if (angleRow[j]<angspaces[k])
+                    {
+                        angidx=k;
+                        break;
+                    }
+                }
+            }
+            binRow[j] = angidx;
+        }
+    }
+}
+
+void SCD::extractSCD(const SCDShapeCache &cache, cv::Mat &descriptors, const float _meanDistance)
+{
+    CV_Assert(cache.nAngularBins==nAngularBins && cache.rotationInvariant==rotationInvariant);
+    CV_Assert(_meanDistance>=0);
+
+    std::vector<double> logspaces;
+    logarithmicSpaces(logspaces);
+
+    meanDistance=_meanDistance;
+    cv::Mat disMatrix = cache.distances/(meanDistance+FLT_EPSILON);
+
+    // Now, build the descriptor matrix (each row is a point) //
+    const int npoints = cache.contour.cols;
+    descriptors = cv::Mat::zeros(npoints, descriptorSize(), CV_32F);
+
+    for (int ptidx=0; ptidx<npoints; ptidx++)
+    {
+        const float* disRow = disMatrix.ptr<float>(ptidx);
+        const int* binRow = cache.angleBins.ptr<int>(ptidx);
+        float* descRow = descriptors.ptr<float>(ptidx);
+        for (int cmp=0; cmp<npoints; cmp++)
+        {
+            int angidx = binRow[cmp];
+            if (angidx<0) continue;
+            for (int i=0; i<nRadialBins; i++)
+            {
+                if (disRow[cmp]<logspaces[i])
+                {
+                    descRow[angidx+i*nAngularBins]++;
+                    break;
+                }
+            }
+        }
+    }
+}
+
 void SCD::logarithmicSpaces(std::vector<double> &vecSpaces) const
 {
     double logmin=log10(innerRadius);
@@ -443,7 +620,7 @@ void SCD::buildNormalizedDistanceMatrix(cv::Mat &contour, cv::Mat &disMatrix, co
     disMatrix/=meanDistance+FLT_EPSILON;
 }
 
-void SCD::buildAngleMatrix(cv::Mat &contour, cv::Mat &angleMatrix) const
+void SCD::buildAngleMatrix(const cv::Mat &contour, cv::Mat &angleMatrix) const
 {
     cv::Mat contourMat = contour;
 
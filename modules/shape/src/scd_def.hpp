@@ -46,6 +46,20 @@
 
 namespace cv
 {
+/*
+ * Query-independent geometry of a target shape, cached between matches
+ */
+struct SCDShapeCache
+{
+    cv::Mat contour;    // CV_32FC2 points, one row
+    cv::Mat distances;  // euclidean distance of every point pair, not normalized
+    cv::Mat angleBins;  // angular bin of every point pair, -1 where the pair is not binned
+    int nAngularBins;
+    bool rotationInvariant;
+
+    SCDShapeCache() : nAngularBins(0), rotationInvariant(false) {}
+};
+
 /*
  * ShapeContextDescriptor class
  */
@@ -68,6 +82,12 @@ public:
                     const std::vector<int>& queryInliers=std::vector<int>(),
                     const float _meanDistance=-1);
 
+    // builds the cached geometry of a target shape
+    void buildShapeCache(const cv::Mat& contour, SCDShapeCache& cache) const;
+
+    // same as extractSCD without inliers, taking the point pair geometry from the cache
+    void extractSCD(const SCDShapeCache& cache, cv::Mat& descriptors, const float _meanDistance);
+
     int descriptorSize() {return nAngularBins*nRadialBins;}
     void setAngularBins(int angularBins) { nAngularBins=angularBins; }
     void setRadialBins(int radialBins) { nRadialBins=radialBins; }
@@ -97,7 +117,7 @@ protected:
                           cv::Mat& disMatrix, const std::vector<int> &queryInliers,
                           const float _meanDistance=-1);
 
-    void buildAngleMatrix(cv::Mat& contour,
+    void buildAngleMatrix(const cv::Mat& contour,
                               cv::Mat& angleMatrix) const;
 };
 
@@ -321,4 +321,85 @@ TEST(computeDistance, regression_4976)
     EXPECT_NEAR(d2, 0.25804194808, 1e-3) << "ShapeContextDistanceExtractor";
 }
 
+TEST(computeDistances, matches_computeDistance)
+{
+    Mat a = imread(cvtest::findDataFile("shape/samples/1.png"), 0);
+    Mat b = imread(cvtest::findDataFile("shape/samples/2.png"), 0);
+
+    vector<vector<Point> > ca,cb;
+    findContours(a, ca, cv::RETR_CCOMP, cv::CHAIN_APPROX_TC89_KCOS);
+    findContours(b, cb, cv::RETR_CCOMP, cv::CHAIN_APPROX_TC89_KCOS);
+    vector<vector<Point> > gallery;
+    gallery.push_back(cb[0]);
+    gallery.push_back(ca[0]);
+    gallery.push_back(cb[0]);
+
+    Ptr<ShapeContextDistanceExtractor> sd = createShapeContextDistanceExtractor();
+    vector<float> distances;
+    sd->computeDistances(ca[0], gallery, distances);
+    ASSERT_EQ(gallery.size(), distances.size());
+    for (size_t i = 0; i < gallery.size(); i++)
+        EXPECT_NEAR(sd->computeDistance(ca[0], gallery[i]), distances[i], 1e-5) << "shape " << i;
+
+    // second query reuses the cached gallery
+    vector<float> distances2;
+    sd->computeDistances(cb[0], gallery, distances2);
+    ASSERT_EQ(gallery.size(), distances2.size());
+    for (size_t i = 0; i < gallery.size(); i++)
+        EXPECT_NEAR(sd->computeDistance(cb[0], gallery[i]), distances2[i], 1e-5) << "shape " << i;
+}
+
+TEST(computeDistances, parameter_change_rebuilds_gallery)
+{
+    Mat a = imread(cvtest::findDataFile("shape/samples/1.png"), 0);
+    Mat b = imread(cvtest::findDataFile("shape/samples/2.png"), 0);
+
+    vector<vector<Point> > ca,cb;
+    findContours(a, ca, cv::RETR_CCOMP, cv::CHAIN_APPROX_TC89_KCOS);
+    findContours(b, cb, cv::RETR_CCOMP, cv::CHAIN_APPROX_TC89_KCOS);
+    vector<vector<Point> > gallery;
+    gallery.push_back(cb[0]);
+    gallery.push_back(ca[0]);
+
+    Ptr<ShapeContextDistanceExtractor> sd = createShapeContextDistanceExtractor();
+    vector<float> distances;
+    sd->computeDistances(ca[0], gallery, distances);
+
+    // the cached gallery was built with 12 angular bins
+    sd->setAngularBins(8);
+    sd->computeDistances(ca[0], gallery, distances);
+
+    Ptr<ShapeContextDistanceExtractor> fresh = createShapeContextDistanceExtractor(8);
+    vector<float> expected;
+    fresh->computeDistances(ca[0], gallery, expected);
+    ASSERT_EQ(gallery.size(), distances.size());
+    for (size_t i = 0; i < gallery.size(); i++)
+    {
+        EXPECT_NEAR(expected[i], distances[i], 1e-5) << "shape " << i;
+        EXPECT_NEAR(fresh->computeDistance(ca[0], gallery[i]), distances[i], 1e-5) << "shape " << i;
+    }
+}
+
+TEST(computeDistances, image_appearance)
+{
+    Mat a = imread(cvtest::findDataFile("shape/samples/1.png"), 0);
+    Mat b = imread(cvtest::findDataFile("shape/samples/2.png"), 0);
+
+    vector<vector<Point> > ca,cb;
+    findContours(a, ca, cv::RETR_CCOMP, cv::CHAIN_APPROX_TC89_KCOS);
+    findContours(b, cb, cv::RETR_CCOMP, cv::CHAIN_APPROX_TC89_KCOS);
+    vector<vector<Point> > gallery;
+    gallery.push_back(cb[0]);
+    gallery.push_back(ca[0]);
+
+    Ptr<ShapeContextDistanceExtractor> sd = createShapeContextDistanceExtractor();
+    sd->setImages(a, b);
+    sd->setImageAppearanceWeight(0.5f);
+    vector<float> distances;
+    ASSERT_NO_THROW(sd->computeDistances(ca[0], gallery, distances));
+    ASSERT_EQ(gallery.size(), distances.size());
+    for (size_t i = 0; i < gallery.size(); i++)
+        EXPECT_NEAR(sd->computeDistance(ca[0], gallery[i]), distances[i], 1e-5) << "shape " << i;
+}
+
 }} // namespace
@@ -146,6 +146,12 @@ namespace
 
 #endif
 
+    void upscaleMotion(const Mat& lowResMotion, Mat& highResMotion, int scale)
+    {
+        resize(lowResMotion, highResMotion, Size(), scale, scale, INTER_CUBIC);
+        multiply(highResMotion, Scalar::all(scale), highResMotion);
+    }
+
     void upscaleMotions(InputArrayOfArrays _lowResMotions, OutputArrayOfArrays _highResMotions, int scale)
     {
         CV_OCL_RUN(_lowResMotions.isUMatVector() && _highResMotions.isUMatVector(),
@@ -157,10 +163,7 @@ namespace
         highResMotions.resize(lowResMotions.size());
 
         for (size_t i = 0; i < lowResMotions.size(); ++i)
-        {
-            resize(lowResMotions[i], highResMotions[i], Size(), scale, scale, INTER_CUBIC);
-            multiply(highResMotions[i], Scalar::all(scale), highResMotions[i]);
-        }
+            upscaleMotion(lowResMotions[i], highResMotions[i], scale);
     }
 
 #ifdef HAVE_OPENCL
@@ -205,21 +208,24 @@ namespace
 
         Mat forwardMap = _forwardMap.getMat(), backwardMap = _backwardMap.getMat();
 
-        for (int y = 0; y < forwardMotion.rows; ++y)
+        parallel_for_(Range(0, forwardMotion.rows), [&](const Range& range)
         {
-            const Point2f* forwardMotionRow = forwardMotion.ptr<Point2f>(y);
-            const Point2f* backwardMotionRow = backwardMotion.ptr<Point2f>(y);
-            Point2f* forwardMapRow = forwardMap.ptr<Point2f>(y);
-            Point2f* backwardMapRow = backwardMap.ptr<Point2f>(y);
-
-            for (int x = 0; x < forwardMotion.cols; ++x)
+            for (int y = range.start; y < range.end; ++y)
             {
-                Point2f base(static_cast<float>(x), static_cast<float>(y));
+                const Point2f* forwardMotionRow = forwardMotion.ptr<Point2f>(y);
+                const Point2f* backwardMotionRow = backwardMotion.ptr<Point2f>(y);
+                Point2f* forwardMapRow = forwardMap.ptr<Point2f>(y);
+                Point2f* backwardMapRow = backwardMap.ptr<Point2f>(y);
+
+                for (int x = 0; x < forwardMotion.cols; ++x)
+                {
+                    Point2f base(static_cast<float>(x), static_cast<float>(y));
 
-                forwardMapRow[x] = base + backwardMotionRow[x];
-                backwardMapRow[x] = base + forwardMotionRow[x];
+                    forwardMapRow[x] = base + backwardMotionRow[x];
+                    backwardMapRow[x] = base + forwardMotionRow[x];
+                }
             }
-        }
+        });
     }
 
     template <typename T>
@@ -230,14 +236,17 @@ namespace
         _dst.setTo(Scalar::all(0));
         Mat dst = _dst.getMat();
 
-        for (int y = 0, Y = 0; y < src.rows; ++y, Y += scale)
+        parallel_for_(Range(0, src.rows), [&](const Range& range)
         {
-            const T * const srcRow = src.ptr<T>(y);
-            T * const dstRow = dst.ptr<T>(Y);
+            for (int y = range.start; y < range.end; ++y)
+            {
+                const T * const srcRow = src.ptr<T>(y);
+                T * const dstRow = dst.ptr<T>(y * scale);
 
-            for (int x = 0, X = 0; x < src.cols; ++x, X += scale)
-                dstRow[X] = srcRow[x];
-        }
+                for (int x = 0, X = 0; x < src.cols; ++x, X += scale)
+                    dstRow[X] = srcRow[x];
+            }
+        });
     }
 
 #ifdef HAVE_OPENCL
@@ -333,15 +342,18 @@ namespace
 
         const int count = src1.cols * src1.channels();
 
-        for (int y = 0; y < src1.rows; ++y)
+        parallel_for_(Range(0, src1.rows), [&](const Range& range)
         {
-            const float * const src1Ptr = src1.ptr<float>(y);
-            const float * const src2Ptr = src2.ptr<float>(y);
-            float* dstPtr = dst.ptr<float>(y);
+            for (int y = range.start; y < range.end; ++y)
+            {
+                const float * const src1Ptr = src1.ptr<float>(y);
+                const float * const src2Ptr = src2.ptr<float>(y);
+                float* dstPtr = dst.ptr<float>(y);
 
-            for (int x = 0; x < count; ++x)
-                dstPtr[x] = diffSign(src1Ptr[x], src2Ptr[x]);
-        }
+                for (int x = 0; x < count; ++x)
+                    dstPtr[x] = diffSign(src1Ptr[x], src2Ptr[x]);
+            }
+        });
     }
 
     void calcBtvWeights(int btvKernelSize, double alpha, std::vector<float>& btvWeights)
@@ -467,8 +479,9 @@ namespace
     public:
         BTVL1_Base();
 
+        // upscaledMotions: the motions are already at the output resolution, see BTVL1::processFrame
         void process(InputArrayOfArrays src, OutputArray dst, InputArrayOfArrays forwardMotions,
-                     InputArrayOfArrays backwardMotions, int baseIdx);
+                     InputArrayOfArrays backwardMotions, int baseIdx, bool upscaledMotions = false);
 
         void collectGarbage() CV_OVERRIDE;
 
@@ -668,7 +681,7 @@ namespace
 #endif
 
     void BTVL1_Base::process(InputArrayOfArrays _src, OutputArray _dst, InputArrayOfArrays _forwardMotions,
-                             InputArrayOfArrays _backwardMotions, int baseIdx)
+                             InputArrayOfArrays _backwardMotions, int baseIdx, bool upscaledMotions)
     {
         CV_INSTRUMENT_REGION();
 
@@ -704,11 +717,22 @@ namespace
             curAlpha_ = alpha_;
         }
 
+        const Size lowResSize = src[0].size();
+        const Size highResSize(lowResSize.width * scale_, lowResSize.height * scale_);
+
         // calc high res motions
-        calcRelativeMotions(forwardMotions, backwardMotions, lowResForwardMotions_, lowResBackwardMotions_, baseIdx, src[0].size());
+        if (upscaledMotions)
+        {
+            // upscaling is linear, so the relative motions can be accumulated directly at high resolution
+            calcRelativeMotions(forwardMotions, backwardMotions, highResForwardMotions_, highResBackwardMotions_, baseIdx, highResSize);
+        }
+        else
+        {
+            calcRelativeMotions(forwardMotions, backwardMotions, lowResForwardMotions_, lowResBackwardMotions_, baseIdx, lowResSize);
 
-        upscaleMotions(lowResForwardMotions_, highResForwardMotions_, scale_);
-        upscaleMotions(lowResBackwardMotions_, highResBackwardMotions_, scale_);
+            upscaleMotions(lowResForwardMotions_, highResForwardMotions_, scale_);
+            upscaleMotions(lowResBackwardMotions_, highResBackwardMotions_, scale_);
+        }
 
         forwardMaps_.resize(highResForwardMotions_.size());
         backwardMaps_.resize(highResForwardMotions_.size());
@@ -716,8 +740,6 @@ namespace
             buildMotionMaps(highResForwardMotions_[i], highResBackwardMotions_[i], forwardMaps_[i], backwardMaps_[i]);
 
         // initial estimation
-        const Size lowResSize = src[0].size();
-        const Size highResSize(lowResSize.width * scale_, lowResSize.height * scale_);
 
         resize(src[baseIdx], highRes_, highResSize, 0, 0, INTER_CUBIC);
 
@@ -829,6 +851,8 @@ namespace
         void processFrame(int idx);
         bool ocl_processFrame(int idx);
 
+        const Mat& upscaledMotion(const Mat& motion, Mat& upscaled) const;
+
         int storePos_;
         int procPos_;
         int outPos_;
@@ -842,6 +866,11 @@ namespace
         std::vector<Mat> backwardMotions_;
         std::vector<Mat> outputs_;
 
+        // motions of each cached frame upscaled to the output resolution,
+        // computed once per frame instead of once per window it belongs to
+        std::vector<Mat> upscaledForwardMotions_;
+        std::vector<Mat> upscaledBackwardMotions_;
+
         std::vector<Mat> srcFrames_;
         std::vector<Mat> srcForwardMotions_;
         std::vector<Mat> srcBackwardMotions_;
@@ -882,6 +911,9 @@ namespace
         backwardMotions_.clear();
         outputs_.clear();
 
+        upscaledForwardMotions_.clear();
+        upscaledBackwardMotions_.clear();
+
         srcFrames_.clear();
         srcForwardMotions_.clear();
         srcBackwardMotions_.clear();
@@ -942,6 +974,11 @@ namespace
         backwardMotions_.resize(cacheSize);
         outputs_.resize(cacheSize);
 
+        upscaledForwardMotions_.clear();
+        upscaledForwardMotions_.resize(cacheSize);
+        upscaledBackwardMotions_.clear();
+        upscaledBackwardMotions_.resize(cacheSize);
+
         CV_OCL_RUN(isUmat_,
                    ocl_initImpl(frameSource))
 
@@ -1043,6 +1080,10 @@ namespace
         {
             opticalFlow_->calc(prevFrame_, curFrame_, at(storePos_ - 1, forwardMotions_));
             opticalFlow_->calc(curFrame_, prevFrame_, at(storePos_, backwardMotions_));
+
+            // the slots now hold new motions, upscale them again on next use
+            at(storePos_ - 1, upscaledForwardMotions_).release();
+            at(storePos_, upscaledBackwardMotions_).release();
         }
 
         curFrame_.copyTo(prevFrame_);
@@ -1111,12 +1152,20 @@ namespace
             srcFrames_[k] = at(i, frames_);
 
             if (i < endIdx)
-                srcForwardMotions_[k] = at(i, forwardMotions_);
+                srcForwardMotions_[k] = upscaledMotion(at(i, forwardMotions_), at(i, upscaledForwardMotions_));
             if (i > startIdx)
-                srcBackwardMotions_[k] = at(i, backwardMotions_);
+                srcBackwardMotions_[k] = upscaledMotion(at(i, backwardMotions_), at(i, upscaledBackwardMotions_));
         }
 
-        process(srcFrames_, at(idx, outputs_), srcForwardMotions_, srcBackwardMotions_, baseIdx);
+        process(srcFrames_, at(idx, outputs_), srcForwardMotions_, srcBackwardMotions_, baseIdx, true);
+    }
+
+    const Mat& BTVL1::upscaledMotion(const Mat& motion, Mat& upscaled) const
+    {
+        // the size check also catches a scale change in the middle of the stream
+        if (upscaled.empty() || upscaled.size() != Size(motion.cols * scale_, motion.rows * scale_))
+            upscaleMotion(motion, upscaled, scale_);
+        return upscaled;
     }
 }
 
@@ -170,8 +170,7 @@ namespace
         for (int i = 0; i < 6; ++i)
             ubuf_[i].release();
         uflow_.release();
-        uflows_[0].release();
-        uflows_[1].release();
+        uflows_.clear();
     }
 }
 
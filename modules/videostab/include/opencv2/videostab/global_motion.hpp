@@ -92,6 +92,23 @@ CV_EXPORTS Mat estimateGlobalMotionRansac(
         const RansacParams &params = RansacParams::default2dMotion(MM_AFFINE),
         float *rmse = 0, int *ninliers = 0);
 
+/** @brief Estimates best global motion between two 2D point clouds robustly (using PROSAC method).
+
+Same as estimateGlobalMotionRansac, but the subsets are drawn from a growing set of the first
+correspondences, so the points must be sorted by decreasing quality (e.g. keypoint response).
+
+@param points0 Source set of 2D points (32F).
+@param points1 Destination set of 2D points (32F).
+@param model Motion model. See cv::videostab::MotionModel.
+@param params RANSAC method parameters. See videostab::RansacParams.
+@param rmse Final root-mean-square error.
+@param ninliers Final number of inliers.
+ */
+CV_EXPORTS Mat estimateGlobalMotionProsac(
+        InputArray points0, InputArray points1, int model = MM_AFFINE,
+        const RansacParams &params = RansacParams::default2dMotion(MM_AFFINE),
+        float *rmse = 0, int *ninliers = 0);
+
 /** @brief Base class for all global motion estimation methods.
  */
 class CV_EXPORTS MotionEstimatorBase
@@ -139,11 +156,18 @@ public:
     void setMinInlierRatio(float val) { minInlierRatio_ = val; }
     float minInlierRatio() const { return minInlierRatio_; }
 
+    /** @brief Enables PROSAC sampling, the points passed to estimate() must be sorted by decreasing
+    quality. KeypointBasedMotionEstimator sorts the keypoints by response when it is enabled.
+     */
+    void setUseProsac(bool val) { useProsac_ = val; }
+    bool useProsac() const { return useProsac_; }
+
     virtual Mat estimate(InputArray points0, InputArray points1, bool *ok = 0) CV_OVERRIDE;
 
 private:
     RansacParams ransacParams_;
     float minInlierRatio_;
+    bool useProsac_;
 };
 
 /** @brief Describes a global 2D motion estimation method which minimizes L1 error.
@@ -158,6 +182,9 @@ public:
     virtual Mat estimate(InputArray points0, InputArray points1, bool *ok = 0) CV_OVERRIDE;
 
 private:
+    struct LpWorkspace;
+    Ptr<LpWorkspace> lp_;
+
     std::vector<double> obj_, collb_, colub_;
     std::vector<double> elems_, rowlb_, rowub_;
     std::vector<int> rows_, cols_;
@@ -98,6 +98,16 @@ public:
     void setInpainter(Ptr<InpainterBase> val) { inpainter_ = val; }
     Ptr<InpainterBase> inpainter() const { return inpainter_; }
 
+    /** @brief Enables the pipelined execution.
+
+    The next frame is read from the frame source and its motion is estimated while the current frame
+    is warped, deblurred and inpainted; in the first pass of TwoPassStabilizer the frame reading and
+    the motion estimators run concurrently. The output does not change. The frame source and the
+    motion estimators must not be shared with other threads while the stabilizer runs.
+     */
+    void setPipelined(bool val) { pipelined_ = val; }
+    bool pipelined() const { return pipelined_; }
+
 protected:
     StabilizerBase();
 
@@ -108,6 +118,8 @@ protected:
     virtual Mat estimateMotion() = 0;
     virtual Mat estimateStabilizationMotion() = 0;
     void stabilizeFrame();
+    virtual void prefetchFrame();
+    Mat nextSourceFrame();
     virtual Mat postProcessFrame(const Mat &frame);
     void logProcessingTime();
 
@@ -121,6 +133,7 @@ protected:
     float trimRatio_;
     bool doCorrectionForInclusion_;
     int borderMode_;
+    bool pipelined_;
 
     Size frameSize_;
     Mat frameMask_;
@@ -137,6 +150,8 @@ protected:
     std::vector<Mat> stabilizedFrames_;
     std::vector<Mat> stabilizedMasks_;
     std::vector<Mat> stabilizationMotions_;
+    bool isFramePrefetched_;
+    Mat prefetchedFrame_;
     clock_t processingStartTime_;
 };
 
@@ -156,8 +171,10 @@ protected:
     virtual Mat estimateMotion() CV_OVERRIDE;
     virtual Mat estimateStabilizationMotion() CV_OVERRIDE;
     virtual Mat postProcessFrame(const Mat &frame) CV_OVERRIDE;
+    virtual void prefetchFrame() CV_OVERRIDE;
 
     Ptr<MotionFilterBase> motionFilter_;
+    Mat prefetchedMotion_;
 };
 
 class CV_EXPORTS TwoPassStabilizer : public StabilizerBase, public IFrameSource
@@ -79,40 +79,47 @@ float FastMarchingMethod::solve(int x1, int y1, int x2, int y2) const
 }
 
 
+// the sifts move the element into a hole instead of swapping it at every level, this writes
+// the heap and the index map once per level and keeps the same order as the swapping version
 void FastMarchingMethod::heapUp(int idx)
 {
+    DXY dxy = narrowBand_[idx];
     int p = (idx-1)/2;
-    while (idx > 0 && narrowBand_[idx] < narrowBand_[p])
+    while (idx > 0 && dxy < narrowBand_[p])
     {
-        std::swap(indexOf(narrowBand_[p]), indexOf(narrowBand_[idx]));
-        std::swap(narrowBand_[p], narrowBand_[idx]);
+        narrowBand_[idx] = narrowBand_[p];
+        indexOf(narrowBand_[idx]) = idx;
         idx = p;
         p = (idx-1)/2;
     }
+    narrowBand_[idx] = dxy;
+    indexOf(dxy) = idx;
 }
 
 
 void FastMarchingMethod::heapDown(int idx)
 {
+    DXY dxy = narrowBand_[idx];
     int l, r, smallest;
     for(;;)
     {
         l = 2*idx+1;
         r = 2*idx+2;
         smallest = idx;
+        const DXY *smallestDxy = &dxy;
 
-        if (l < size_ && narrowBand_[l] < narrowBand_[smallest]) smallest = l;
-        if (r < size_ && narrowBand_[r] < narrowBand_[smallest]) smallest = r;
+        if (l < size_ && narrowBand_[l] < *smallestDxy) { smallest = l; smallestDxy = &narrowBand_[l]; }
+        if (r < size_ && narrowBand_[r] < *smallestDxy) smallest = r;
 
         if (smallest == idx)
             break;
-        else
-        {
-            std::swap(indexOf(narrowBand_[idx]), indexOf(narrowBand_[smallest]));
-            std::swap(narrowBand_[idx], narrowBand_[smallest]);
-            idx = smallest;
-        }
+
+        narrowBand_[idx] = narrowBand_[smallest];
+        indexOf(narrowBand_[idx]) = idx;
+        idx = smallest;
     }
+    narrowBand_[idx] = dxy;
+    indexOf(dxy) = idx;
 }
 
 
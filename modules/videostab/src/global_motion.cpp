@@ -45,6 +45,7 @@
 #include "opencv2/videostab/ring_buffer.hpp"
 #include "opencv2/videostab/outlier_rejection.hpp"
 #include "opencv2/opencv_modules.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 #include "clp.hpp"
 
 #include "opencv2/core/private.cuda.hpp"
@@ -378,9 +379,121 @@ Mat estimateGlobalMotionLeastSquares(
 }
 
 
-Mat estimateGlobalMotionRansac(
+namespace
+{
+
+// draws the subsets of the hypotheses, either uniformly (RANSAC) or from a growing set of the best
+// correspondences (PROSAC, the points are sorted by decreasing quality)
+class SubsetSampler
+{
+public:
+    SubsetSampler(int npoints, int size, int niters, bool prosac)
+        : rng_(0), npoints_(npoints), size_(size), prosac_(prosac), n_(size), t_(0), Tn_(niters), TnPrime_(1)
+    {
+        for (int i = 0; i < size_; ++i)
+            Tn_ *= static_cast<double>(size_ - i) / (npoints_ - i);
+    }
+
+    void next(int *indices)
+    {
+        if (!prosac_)
+        {
+            draw(indices, size_, npoints_);
+            return;
+        }
+
+        // grow the sampling set according to the PROSAC schedule
+        ++t_;
+        if (t_ > TnPrime_ && n_ < npoints_)
+        {
+            double Tn1 = Tn_ * (n_ + 1) / (n_ + 1 - size_);
+            TnPrime_ += std::ceil(Tn1 - Tn_);
+            Tn_ = Tn1;
+            ++n_;
+        }
+
+        if (TnPrime_ < t_)
+            draw(indices, size_, n_);
+        else
+        {
+            // the newest point of the sampling set is always a member of the subset
+            draw(indices, size_ - 1, n_ - 1);
+            indices[size_ - 1] = n_ - 1;
+        }
+    }
+
+private:
+    // draws count distinct indices from [0, range)
+    void draw(int *indices, int count, int range)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            bool ok = false;
+            while (!ok)
+            {
+                ok = true;
+                indices[i] = static_cast<unsigned>(rng_) % range;
+                for (int j = 0; j < i; ++j)
+                    if (indices[i] == indices[j])
+                        { ok = false; break; }
+            }
+        }
+    }
+
+    RNG rng_;
+    int npoints_, size_;
+    bool prosac_;
+    int n_, t_;
+    double Tn_, TnPrime_;
+};
+
+int countInliers(const Mat_<float> &M, int npoints, const Point2f *points0, const Point2f *points1, float thresh2)
+{
+    const float m00 = M(0,0), m01 = M(0,1), m02 = M(0,2);
+    const float m10 = M(1,0), m11 = M(1,1), m12 = M(1,2);
+
+    int i = 0, ninliers = 0;
+
+#if CV_SIMD128
+    const v_float32x4 vm00 = v_setall_f32(m00), vm01 = v_setall_f32(m01), vm02 = v_setall_f32(m02);
+    const v_float32x4 vm10 = v_setall_f32(m10), vm11 = v_setall_f32(m11), vm12 = v_setall_f32(m12);
+    const v_float32x4 vthresh2 = v_setall_f32(thresh2);
+    v_int32x4 vcount = v_setzero_s32();
+
+    for (; i <= npoints - 4; i += 4)
+    {
+        v_float32x4 x0, y0, x1, y1;
+        v_load_deinterleave(reinterpret_cast<const float*>(points0 + i), x0, y0);
+        v_load_deinterleave(reinterpret_cast<const float*>(points1 + i), x1, y1);
+
+        v_float32x4 dx = v_sub(v_add(v_add(v_mul(vm00, x0), v_mul(vm01, y0)), vm02), x1);
+        v_float32x4 dy = v_sub(v_add(v_add(v_mul(vm10, x0), v_mul(vm11, y0)), vm12), y1);
+
+        // the mask lanes are -1 for the inliers
+        vcount = v_sub(vcount, v_reinterpret_as_s32(v_lt(v_add(v_mul(dx, dx), v_mul(dy, dy)), vthresh2)));
+    }
+    ninliers = v_reduce_sum(vcount);
+#endif
+
+    for (; i < npoints; ++i)
+    {
+        const Point2f p0 = points0[i];
+        const Point2f p1 = points1[i];
+        const float x = m00*p0.x + m01*p0.y + m02;
+        const float y = m10*p0.x + m11*p0.y + m12;
+        if (sqr(x - p1.x) + sqr(y - p1.y) < thresh2)
+            ninliers++;
+    }
+
+    return ninliers;
+}
+
+// number of hypotheses generated and scored at once, the termination criterion is checked between batches
+const int RANSAC_BATCH_SIZE = 16;
+
+Mat estimateGlobalMotionRobust(
         InputArray points0, InputArray points1, int model, const RansacParams &params,
-        float *rmse, int *ninliers)
+        float *rmse, int *ninliers, bool prosac)
 {
     CV_INSTRUMENT_REGION();
 
@@ -394,60 +507,80 @@ Mat estimateGlobalMotionRansac(
 
     const Point2f *points0_ = points0.getMat().ptr<Point2f>();
     const Point2f *points1_ = points1.getMat().ptr<Point2f>();
-    const int niters = params.niters();
+    const float thresh2 = params.thresh * params.thresh;
+    int niters = params.niters();
 
-    // current hypothesis
-    std::vector<int> indices(params.size);
     std::vector<Point2f> subset0(params.size);
     std::vector<Point2f> subset1(params.size);
 
+    // hypotheses of the current batch
+    std::vector<int> indices(RANSAC_BATCH_SIZE * params.size);
+    std::vector<Mat_<float> > hypotheses(RANSAC_BATCH_SIZE);
+    std::vector<int> counts(RANSAC_BATCH_SIZE);
+
     // best hypothesis
     std::vector<int> bestIndices(params.size);
 
     Mat bestM;
     int ninliersMax = -1;
 
-    RNG rng(0);
+    SubsetSampler sampler(npoints, params.size, niters, prosac);
     Point2f p0, p1;
     float x, y;
 
-    for (int iter = 0; iter < niters; ++iter)
+    for (int iter = 0; iter < niters; iter += RANSAC_BATCH_SIZE)
     {
-        for (int i = 0; i < params.size; ++i)
+        const int nhypotheses = std::min(RANSAC_BATCH_SIZE, niters - iter);
+
+        // subsets are drawn serially, so the hypotheses do not depend on the number of threads
+        for (int k = 0; k < nhypotheses; ++k)
+            sampler.next(&indices[k * params.size]);
+
+        auto scoreHypotheses = [&](const Range &range)
         {
-            bool ok = false;
-            while (!ok)
+            std::vector<Point2f> hypothesisSubset0(params.size);
+            std::vector<Point2f> hypothesisSubset1(params.size);
+
+            for (int k = range.start; k < range.end; ++k)
             {
-                ok = true;
-                indices[i] = static_cast<unsigned>(rng) % npoints;
-                for (int j = 0; j < i; ++j)
-                    if (indices[i] == indices[j])
-                        { ok = false; break; }
+                for (int i = 0; i < params.size; ++i)
+                {
+                    hypothesisSubset0[i] = points0_[indices[k * params.size + i]];
+                    hypothesisSubset1[i] = points1_[indices[k * params.size + i]];
+                }
+
+                hypotheses[k] = estimateGlobalMotionLeastSquares(hypothesisSubset0, hypothesisSubset1, model, 0);
+                counts[k] = countInliers(hypotheses[k], npoints, points0_, points1_, thresh2);
             }
-        }
-        for (int i = 0; i < params.size; ++i)
-        {
-            subset0[i] = points0_[indices[i]];
-            subset1[i] = points1_[indices[i]];
-        }
+        };
 
-        Mat_<float> M = estimateGlobalMotionLeastSquares(subset0, subset1, model, 0);
+        // scoring a few dozens of points is cheaper than waking the workers up
+        if (npoints >= 256)
+            parallel_for_(Range(0, nhypotheses), scoreHypotheses);
+        else
+            scoreHypotheses(Range(0, nhypotheses));
 
-        int numinliers = 0;
-        for (int i = 0; i < npoints; ++i)
+        for (int k = 0; k < nhypotheses; ++k)
         {
-            p0 = points0_[i];
-            p1 = points1_[i];
-            x = M(0,0)*p0.x + M(0,1)*p0.y + M(0,2);
-            y = M(1,0)*p0.x + M(1,1)*p0.y + M(1,2);
-            if (sqr(x - p1.x) + sqr(y - p1.y) < params.thresh * params.thresh)
-                numinliers++;
+            if (counts[k] >= ninliersMax)
+            {
+                bestM = hypotheses[k];
+                ninliersMax = counts[k];
+                std::copy(indices.begin() + k * params.size, indices.begin() + (k + 1) * params.size,
+                          bestIndices.begin());
+            }
         }
-        if (numinliers >= ninliersMax)
+
+        // early termination: the number of iterations sufficient for the observed inliers ratio
+        if (ninliersMax > 0)
         {
-            bestM = M;
-            ninliersMax = numinliers;
-            bestIndices.swap(indices);
+            const double outlierSubsetProb =
+                    1 - std::pow(static_cast<double>(ninliersMax) / npoints, params.size);
+            if (outlierSubsetProb <= DBL_EPSILON)
+                break;
+            const double needed = std::ceil(std::log(1 - params.prob) / std::log(outlierSubsetProb));
+            if (needed < niters)
+                niters = std::max(static_cast<int>(needed), 1);
         }
     }
 
@@ -465,7 +598,8 @@ Mat estimateGlobalMotionRansac(
     {
         subset0.resize(ninliersMax);
         subset1.resize(ninliersMax);
-        for (int i = 0, j = 0; i < npoints && j < ninliersMax ; ++i)
+        int j = 0;
+        for (int i = 0; i < npoints && j < ninliersMax ; ++i)
         {
             p0 = points0_[i];
             p1 = points1_[i];
@@ -478,6 +612,9 @@ Mat estimateGlobalMotionRansac(
                 j++;
             }
         }
+        // the vectorized scoring may round differently at the threshold
+        subset0.resize(j);
+        subset1.resize(j);
         bestM = estimateGlobalMotionLeastSquares(subset0, subset1, model, rmse);
     }
 
@@ -487,12 +624,31 @@ Mat estimateGlobalMotionRansac(
     return bestM;
 }
 
+} // namespace
+
+
+Mat estimateGlobalMotionRansac(
+        InputArray points0, InputArray points1, int model, const RansacParams &params,
+        float *rmse, int *ninliers)
+{
+    return estimateGlobalMotionRobust(points0, points1, model, params, rmse, ninliers, false);
+}
+
+
+Mat estimateGlobalMotionProsac(
+        InputArray points0, InputArray points1, int model, const RansacParams &params,
+        float *rmse, int *ninliers)
+{
+    return estimateGlobalMotionRobust(points0, points1, model, params, rmse, ninliers, true);
+}
+
 
 MotionEstimatorRansacL2::MotionEstimatorRansacL2(MotionModel model)
     : MotionEstimatorBase(model)
 {
     setRansacParams(RansacParams::default2dMotion(model));
     setMinInlierRatio(0.1f);
+    setUseProsac(false);
 }
 
 
@@ -508,8 +664,9 @@ Mat MotionEstimatorRansacL2::estimate(InputArray points0, InputArray points1, bo
     Mat M;
 
     if (motionModel() != MM_HOMOGRAPHY)
-        M = estimateGlobalMotionRansac(
-                points0, points1, motionModel(), ransacParams_, 0, &ninliers);
+        M = useProsac_
+            ? estimateGlobalMotionProsac(points0, points1, motionModel(), ransacParams_, 0, &ninliers)
+            : estimateGlobalMotionRansac(points0, points1, motionModel(), ransacParams_, 0, &ninliers);
     else
     {
         std::vector<uchar> mask;
@@ -531,6 +688,21 @@ Mat MotionEstimatorRansacL2::estimate(InputArray points0, InputArray points1, bo
 }
 
 
+#ifdef HAVE_CLP
+// The solver and the column-ordered copy of the constraint matrix are kept between frames,
+// the matrix buffers only grow when more points are tracked
+struct MotionEstimatorL1::LpWorkspace
+{
+    LpWorkspace() : model(false) {}
+
+    std::vector<CoinBigIndex> starts;
+    std::vector<int> index;
+    std::vector<double> value;
+    ClpSimplex model;
+};
+#endif
+
+
 MotionEstimatorL1::MotionEstimatorL1(MotionModel model)
     : MotionEstimatorBase(model)
 {
@@ -571,9 +743,14 @@ Mat MotionEstimatorL1::estimate(InputArray points0, InputArray points1, bool *ok
     else if (motionModel() == MM_TRANSLATION)
         nrows += 4;
 
+    // the LP arrays are members, so their capacity is kept from frame to frame
+    const size_t nelems = 16*npoints + 4;
     rows_.clear();
     cols_.clear();
     elems_.clear();
+    rows_.reserve(nelems);
+    cols_.reserve(nelems);
+    elems_.reserve(nelems);
     obj_.assign(ncols, 0);
     collb_.assign(ncols, -INF);
     colub_.assign(ncols, INF);
@@ -589,7 +766,6 @@ Mat MotionEstimatorL1::estimate(InputArray points0, InputArray points1, bool *ok
         collb_[c+1] = 0;
     }
 
-    elems_.clear();
     rowlb_.assign(nrows, -INF);
     rowub_.assign(nrows, INF);
 
@@ -635,11 +811,33 @@ Mat MotionEstimatorL1::estimate(InputArray points0, InputArray points1, bool *ok
 
     // solve
 
-    CoinPackedMatrix A(true, &rows_[0], &cols_[0], &elems_[0], elems_.size());
-    A.setDimensions(nrows, ncols);
+    if (!lp_)
+        lp_ = makePtr<LpWorkspace>();
+
+    // convert the triplets to column-ordered storage with a counting sort, rows stay ascending in each column
+    std::vector<CoinBigIndex> &starts = lp_->starts;
+    std::vector<int> &index = lp_->index;
+    std::vector<double> &value = lp_->value;
+    starts.assign(ncols + 1, 0);
+    for (size_t i = 0; i < cols_.size(); ++i)
+        ++starts[cols_[i] + 1];
+    for (int j = 0; j < ncols; ++j)
+        starts[j+1] += starts[j];
+    index.resize(elems_.size());
+    value.resize(elems_.size());
+    for (size_t i = 0; i < elems_.size(); ++i)
+    {
+        const CoinBigIndex k = starts[cols_[i]]++;
+        index[k] = rows_[i];
+        value[k] = elems_[i];
+    }
+    for (int j = ncols; j > 0; --j)
+        starts[j] = starts[j-1];
+    starts[0] = 0;
 
-    ClpSimplex model(false);
-    model.loadProblem(A, &collb_[0], &colub_[0], &obj_[0], &rowlb_[0], &rowub_[0]);
+    ClpSimplex &model = lp_->model;
+    model.loadProblem(ncols, nrows, &starts[0], &index[0], &value[0],
+                      &collb_[0], &colub_[0], &obj_[0], &rowlb_[0], &rowub_[0]);
 
     ClpDualRowSteepest dualSteep(1);
     model.setDualRowPivotAlgorithm(dualSteep);
@@ -730,6 +928,14 @@ Mat KeypointBasedMotionEstimator::estimate(InputArray frame0, InputArray frame1,
     if (keypointsPrev_.empty())
         return Mat::eye(3, 3, CV_32F);
 
+    // PROSAC draws the strongest keypoints first, the filtering below keeps the order
+    MotionEstimatorRansacL2 *ransac = dynamic_cast<MotionEstimatorRansacL2*>(motionEstimator_.get());
+    if (ransac && ransac->useProsac())
+    {
+        std::stable_sort(keypointsPrev_.begin(), keypointsPrev_.end(),
+                         [](const KeyPoint &a, const KeyPoint &b) { return a.response > b.response; });
+    }
+
     // extract points from keypoints
     pointsPrev_.resize(keypointsPrev_.size());
     for (size_t i = 0; i < keypointsPrev_.size(); ++i)
@@ -136,67 +136,80 @@ void ConsistentMosaicInpainter::inpaint(int idx, Mat &frame, Mat &mask)
     for (int i = -radius_; i <= radius_; ++i)
         vmotions[radius_ + i] = getMotion(idx, idx + i, *motions_) * invS;
 
-    int n;
-    float mean, var;
-    std::vector<Pixel3> pixels(2*radius_ + 1);
+    // the headers are made once, creating them per pixel would contend on the reference counters
+    std::vector<Mat_<Point3_<uchar> > > vframes(2*radius_ + 1);
+    for (int i = -radius_; i <= radius_; ++i)
+        vframes[radius_ + i] = at(idx + i, *frames_);
 
     Mat_<Point3_<uchar> > frame_(frame);
     Mat_<uchar> mask_(mask);
 
-    for (int y = 0; y < mask.rows; ++y)
+    // every pixel reads the neighbour frames only and writes itself, so rows are independent
+    parallel_for_(Range(0, mask.rows), [&](const Range &range)
     {
-        for (int x = 0; x < mask.cols; ++x)
+        int n;
+        float mean, var;
+        std::vector<Pixel3> pixels(2*radius_ + 1);
+
+        for (int y = range.start; y < range.end; ++y)
         {
-            if (!mask_(y, x))
-            {
-                n = 0;
-                mean = 0;
-                var = 0;
+            uchar *maskRow = mask_[y];
+            Point3_<uchar> *frameRow = frame_[y];
 
-                for (int i = -radius_; i <= radius_; ++i)
+            for (int x = 0; x < mask.cols; ++x)
+            {
+                if (!maskRow[x])
                 {
-                    const Mat_<Point3_<uchar> > &framei = at(idx + i, *frames_);
-                    const Mat_<float> &Mi = vmotions[radius_ + i];
-                    int xi = cvRound(Mi(0,0)*x + Mi(0,1)*y + Mi(0,2));
-                    int yi = cvRound(Mi(1,0)*x + Mi(1,1)*y + Mi(1,2));
-                    if (xi >= 0 && xi < framei.cols && yi >= 0 && yi < framei.rows)
+                    n = 0;
+                    mean = 0;
+                    var = 0;
+
+                    for (int i = -radius_; i <= radius_; ++i)
                     {
-                        pixels[n].color = framei(yi, xi);
-                        mean += pixels[n].intens = intensity(pixels[n].color);
-                        n++;
+                        const Mat_<Point3_<uchar> > &framei = vframes[radius_ + i];
+                        const Mat_<float> &Mi = vmotions[radius_ + i];
+                        int xi = cvRound(Mi(0,0)*x + Mi(0,1)*y + Mi(0,2));
+                        int yi = cvRound(Mi(1,0)*x + Mi(1,1)*y + Mi(1,2));
+                        if (xi >= 0 && xi < framei.cols && yi >= 0 && yi < framei.rows)
+                        {
+                            pixels[n].color = framei(yi, xi);
+                            mean += pixels[n].intens = intensity(pixels[n].color);
+                            n++;
+                        }
                     }
-                }
-
-                if (n > 0)
-                {
-                    mean /= n;
-                    for (int i = 0; i < n; ++i)
-                        var += sqr(pixels[i].intens - mean);
-                    var /= std::max(n - 1, 1);
 
-                    if (var < stdevThresh_ * stdevThresh_)
+                    if (n > 0)
                     {
-                        std::sort(pixels.begin(), pixels.begin() + n);
-                        int nh = (n-1)/2;
-                        int c1 = pixels[nh].color.x;
-                        int c2 = pixels[nh].color.y;
-                        int c3 = pixels[nh].color.z;
-                        if (n-2*nh)
+                        mean /= n;
+                        for (int i = 0; i < n; ++i)
+                            var += sqr(pixels[i].intens - mean);
+                        var /= std::max(n - 1, 1);
+
+                        if (var < stdevThresh_ * stdevThresh_)
                         {
-                            c1 = (c1 + pixels[nh].color.x) / 2;
-                            c2 = (c2 + pixels[nh].color.y) / 2;
-                            c3 = (c3 + pixels[nh].color.z) / 2;
+                            // only the median is needed, not the full order
+                            int nh = (n-1)/2;
+                            std::nth_element(pixels.begin(), pixels.begin() + nh, pixels.begin() + n);
+                            int c1 = pixels[nh].color.x;
+                            int c2 = pixels[nh].color.y;
+                            int c3 = pixels[nh].color.z;
+                            if (n-2*nh)
+                            {
+                                c1 = (c1 + pixels[nh].color.x) / 2;
+                                c2 = (c2 + pixels[nh].color.y) / 2;
+                                c3 = (c3 + pixels[nh].color.z) / 2;
+                            }
+                            frameRow[x] = Point3_<uchar>(
+                                    static_cast<uchar>(c1),
+                                    static_cast<uchar>(c2),
+                                    static_cast<uchar>(c3));
+                            maskRow[x] = 255;
                         }
-                        frame_(y, x) = Point3_<uchar>(
-                                static_cast<uchar>(c1),
-                                static_cast<uchar>(c2),
-                                static_cast<uchar>(c3));
-                        mask_(y, x) = 255;
                     }
                 }
             }
         }
-    }
+    });
 }
 
 
@@ -210,23 +223,33 @@ static float alignementError(
 
     Mat_<uchar> mask0_(mask0);
     Mat_<float> M_(M);
-    float err = 0;
 
-    for (int y0 = 0; y0 < frame0.rows; ++y0)
+    // per-row errors are summed in order, so the result does not depend on the number of threads
+    std::vector<float> rowErrors(frame0.rows, 0.f);
+
+    parallel_for_(Range(0, frame0.rows), [&](const Range &range)
     {
-        for (int x0 = 0; x0 < frame0.cols; ++x0)
+        for (int y0 = range.start; y0 < range.end; ++y0)
         {
-            if (mask0_(y0,x0))
+            float err = 0;
+            for (int x0 = 0; x0 < frame0.cols; ++x0)
             {
-                int x1 = cvRound(M_(0,0)*x0 + M_(0,1)*y0 + M_(0,2));
-                int y1 = cvRound(M_(1,0)*x0 + M_(1,1)*y0 + M_(1,2));
-                if (y1 >= 0 && y1 < frame1.rows && x1 >= 0 && x1 < frame1.cols)
-                    err += std::abs(intensity(frame1.at<Point3_<uchar> >(y1,x1)) -
-                                    intensity(frame0.at<Point3_<uchar> >(y0,x0)));
+                if (mask0_(y0,x0))
+                {
+                    int x1 = cvRound(M_(0,0)*x0 + M_(0,1)*y0 + M_(0,2));
+                    int y1 = cvRound(M_(1,0)*x0 + M_(1,1)*y0 + M_(1,2));
+                    if (y1 >= 0 && y1 < frame1.rows && x1 >= 0 && x1 < frame1.cols)
+                        err += std::abs(intensity(frame1.at<Point3_<uchar> >(y1,x1)) -
+                                        intensity(frame0.at<Point3_<uchar> >(y0,x0)));
+                }
             }
+            rowErrors[y0] = err;
         }
-    }
+    });
 
+    float err = 0;
+    for (size_t i = 0; i < rowErrors.size(); ++i)
+        err += rowErrors[i];
     return err;
 }
 
@@ -502,20 +525,23 @@ void calcFlowMask(
     flowMask.setTo(0);
     Mat_<uchar> flowMask_(flowMask);
 
-    for (int y0 = 0; y0 < flowMask_.rows; ++y0)
+    parallel_for_(Range(0, flowMask_.rows), [&](const Range &range)
     {
-        for (int x0 = 0; x0 < flowMask_.cols; ++x0)
+        for (int y0 = range.start; y0 < range.end; ++y0)
         {
-            if (mask0_(y0,x0) && errors_(y0,x0) < maxError)
+            for (int x0 = 0; x0 < flowMask_.cols; ++x0)
             {
-                int x1 = cvRound(x0 + flowX_(y0,x0));
-                int y1 = cvRound(y0 + flowY_(y0,x0));
+                if (mask0_(y0,x0) && errors_(y0,x0) < maxError)
+                {
+                    int x1 = cvRound(x0 + flowX_(y0,x0));
+                    int y1 = cvRound(y0 + flowY_(y0,x0));
 
-                if (x1 >= 0 && x1 < mask1_.cols && y1 >= 0 && y1 < mask1_.rows && mask1_(y1,x1))
-                    flowMask_(y0,x0) = 255;
+                    if (x1 >= 0 && x1 < mask1_.cols && y1 >= 0 && y1 < mask1_.rows && mask1_(y1,x1))
+                        flowMask_(y0,x0) = 255;
+                }
             }
         }
-    }
+    });
 }
 
 
@@ -536,24 +562,28 @@ void completeFrameAccordingToFlow(
     Mat_<uchar> flowMask_(flowMask), mask1_(mask1), mask0_(mask0);
     Mat_<float> flowX_(flowX), flowY_(flowY);
 
-    for (int y0 = 0; y0 < frame0.rows; ++y0)
+    // frame0 and mask0 are written at the current pixel only, frame1 and mask1 are read only
+    parallel_for_(Range(0, frame0.rows), [&](const Range &range)
     {
-        for (int x0 = 0; x0 < frame0.cols; ++x0)
+        for (int y0 = range.start; y0 < range.end; ++y0)
         {
-            if (!mask0_(y0,x0) && flowMask_(y0,x0))
+            for (int x0 = 0; x0 < frame0.cols; ++x0)
             {
-                int x1 = cvRound(x0 + flowX_(y0,x0));
-                int y1 = cvRound(y0 + flowY_(y0,x0));
-
-                if (x1 >= 0 && x1 < frame1.cols && y1 >= 0 && y1 < frame1.rows && mask1_(y1,x1)
-                    && sqr(flowX_(y0,x0)) + sqr(flowY_(y0,x0)) < sqr(distThresh))
+                if (!mask0_(y0,x0) && flowMask_(y0,x0))
                 {
-                    frame0.at<Point3_<uchar> >(y0,x0) = frame1.at<Point3_<uchar> >(y1,x1);
-                    mask0_(y0,x0) = 255;
+                    int x1 = cvRound(x0 + flowX_(y0,x0));
+                    int y1 = cvRound(y0 + flowY_(y0,x0));
+
+                    if (x1 >= 0 && x1 < frame1.cols && y1 >= 0 && y1 < frame1.rows && mask1_(y1,x1)
+                        && sqr(flowX_(y0,x0)) + sqr(flowY_(y0,x0)) < sqr(distThresh))
+                    {
+                        frame0.at<Point3_<uchar> >(y0,x0) = frame1.at<Point3_<uchar> >(y1,x1);
+                        mask0_(y0,x0) = 255;
+                    }
                 }
             }
         }
-    }
+    });
 }
 
 } // namespace videostab
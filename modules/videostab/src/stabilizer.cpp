@@ -43,6 +43,7 @@
 #include "precomp.hpp"
 #include "opencv2/videostab/stabilizer.hpp"
 #include "opencv2/videostab/ring_buffer.hpp"
+#include <functional>
 
 // for debug purposes
 #define SAVE_MOTIONS 0
@@ -52,6 +53,24 @@ namespace cv
 namespace videostab
 {
 
+// runs independent stages of the pipeline, concurrently if requested
+static void runStages(const std::vector<std::function<void()> > &stages, bool concurrently)
+{
+    if (!concurrently)
+    {
+        for (size_t i = 0; i < stages.size(); ++i)
+            stages[i]();
+        return;
+    }
+
+    parallel_for_(Range(0, static_cast<int>(stages.size())), [&](const Range &range)
+    {
+        for (int i = range.start; i < range.end; ++i)
+            stages[i]();
+    }, static_cast<double>(stages.size()));
+}
+
+
 StabilizerBase::StabilizerBase()
 {
     setLog(makePtr<LogToStdout>());
@@ -63,10 +82,12 @@ StabilizerBase::StabilizerBase()
     setTrimRatio(0);
     setCorrectionForInclusion(false);
     setBorderMode(BORDER_REPLICATE);
+    setPipelined(false);
     curPos_ = -1;
     curStabilizedPos_ = -1;
     doDeblurring_ = false;
     doInpainting_ = false;
+    isFramePrefetched_ = false;
     processingStartTime_ = 0;
 }
 
@@ -87,6 +108,8 @@ void StabilizerBase::reset()
     stabilizedFrames_.clear();
     stabilizedMasks_.clear();
     stabilizationMotions_.clear();
+    isFramePrefetched_ = false;
+    prefetchedFrame_ = Mat();
     processingStartTime_ = 0;
 }
 
@@ -117,7 +140,7 @@ Mat StabilizerBase::nextStabilizedFrame()
 
 bool StabilizerBase::doOneIteration()
 {
-    Mat frame = frameSource_->nextFrame();
+    Mat frame = nextSourceFrame();
     if (!frame.empty())
     {
         curPos_++;
@@ -134,7 +157,14 @@ bool StabilizerBase::doOneIteration()
             if (curPos_ >= radius_)
             {
                 curStabilizedPos_ = curPos_ - radius_;
-                stabilizeFrame();
+
+                // the next frame is stored aside until the current one is stabilized, as its
+                // ring buffer slot may still be read by the deblurer and the inpainter
+                std::vector<std::function<void()> > stages;
+                stages.push_back([this]() { stabilizeFrame(); });
+                if (pipelined_)
+                    stages.push_back([this]() { prefetchFrame(); });
+                runStages(stages, pipelined_);
             }
         }
         else
@@ -157,6 +187,25 @@ bool StabilizerBase::doOneIteration()
 }
 
 
+void StabilizerBase::prefetchFrame()
+{
+    prefetchedFrame_ = frameSource_->nextFrame();
+    isFramePrefetched_ = true;
+}
+
+
+Mat StabilizerBase::nextSourceFrame()
+{
+    if (!isFramePrefetched_)
+        return frameSource_->nextFrame();
+
+    Mat frame = prefetchedFrame_;
+    prefetchedFrame_ = Mat();
+    isFramePrefetched_ = false;
+    return frame;
+}
+
+
 void StabilizerBase::setUp(const Mat &firstFrame)
 {
     InpainterBase *inpaint = inpainter_.get();
@@ -263,6 +312,7 @@ OnePassStabilizer::OnePassStabilizer()
 void OnePassStabilizer::reset()
 {
     StabilizerBase::reset();
+    prefetchedMotion_ = Mat();
 }
 
 
@@ -293,10 +343,26 @@ void OnePassStabilizer::setUp(const Mat &firstFrame)
 
 Mat OnePassStabilizer::estimateMotion()
 {
+    if (!prefetchedMotion_.empty())
+    {
+        Mat motion = prefetchedMotion_;
+        prefetchedMotion_ = Mat();
+        return motion;
+    }
     return motionEstimator_->estimate(at(curPos_ - 1, frames_), at(curPos_, frames_));
 }
 
 
+void OnePassStabilizer::prefetchFrame()
+{
+    StabilizerBase::prefetchFrame();
+
+    // the motion to the next frame only needs the current frame, which is not modified by the stabilization
+    if (!prefetchedFrame_.empty())
+        prefetchedMotion_ = motionEstimator_->estimate(at(curPos_, frames_), prefetchedFrame_);
+}
+
+
 Mat OnePassStabilizer::estimateStabilizationMotion()
 {
     return motionFilter_->stabilize(curStabilizedPos_, motions_, Range(0, curPos_));
@@ -382,23 +448,50 @@ void TwoPassStabilizer::runPrePassIfNecessary()
         clock_t startTime = clock();
         log_->print("first pass: estimating motions");
 
-        Mat prevFrame, frame;
+        // the wobble suppressor may reuse the main estimator, which cannot run concurrently with itself
+        const bool isEstimatorShared = wobbleSuppressor_->motionEstimator() == motionEstimator_;
+
+        Mat prevFrame, frame = frameSource_->nextFrame(), nextFrame;
+        bool isNextFrameRead = false;
         bool ok = true, ok2 = true;
 
-        while (!(frame = frameSource_->nextFrame()).empty())
+        while (!frame.empty())
         {
             if (frameCount_ > 0)
             {
                 if (maskSource_)
                     motionEstimator_->setFrameMask(maskSource_->nextFrame());
 
-                motions_.push_back(motionEstimator_->estimate(prevFrame, frame, &ok));
+                // the next frame is read while the motions to the current one are estimated
+                Mat M, M2;
+                const auto estimateWobbleMotion = [&]()
+                {
+                    M2 = wobbleSuppressor_->motionEstimator()->estimate(prevFrame, frame, &ok2);
+                };
+                std::vector<std::function<void()> > stages;
+                stages.push_back([&]()
+                {
+                    M = motionEstimator_->estimate(prevFrame, frame, &ok);
+                    if (doWobbleSuppression_ && isEstimatorShared)
+                        estimateWobbleMotion();
+                });
+                if (doWobbleSuppression_ && !isEstimatorShared)
+                    stages.push_back(estimateWobbleMotion);
+                if (pipelined_)
+                {
+                    stages.push_back([&]()
+                    {
+                        nextFrame = frameSource_->nextFrame();
+                        isNextFrameRead = true;
+                    });
+                }
+                runStages(stages, pipelined_);
 
+                motions_.push_back(M);
                 if (doWobbleSuppression_)
                 {
-                    Mat M = wobbleSuppressor_->motionEstimator()->estimate(prevFrame, frame, &ok2);
                     if (ok2)
-                        motions2_.push_back(M);
+                        motions2_.push_back(M2);
                     else
                         motions2_.push_back(motions_.back());
                 }
@@ -418,6 +511,9 @@ void TwoPassStabilizer::runPrePassIfNecessary()
             }
 
             prevFrame = frame;
+            frame = isNextFrameRead ? nextFrame : frameSource_->nextFrame();
+            nextFrame = Mat();
+            isNextFrameRead = false;
             frameCount_++;
         }
 
@@ -0,0 +1,56 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+using namespace ::cv::videostab;
+
+struct CountingInpaintBody
+{
+    CountingInpaintBody() : count(0) {}
+    void operator ()(int /*x*/, int /*y*/) { count++; }
+    int count;
+};
+
+TEST(FastMarchingMethod, distanceFromPoint)
+{
+    const int size = 41, c = size / 2;
+    Mat mask(size, size, CV_8U, Scalar::all(0));
+    mask.at<uchar>(c, c) = 255;
+
+    FastMarchingMethod fmm;
+    CountingInpaintBody body = fmm.run(mask, CountingInpaintBody());
+
+    // every unknown pixel is inpainted exactly once
+    EXPECT_EQ(size * size - 1, body.count);
+
+    // the arrival time approximates the euclidean distance
+    Mat_<float> dist = fmm.distanceMap();
+    for (int y = 0; y < size; ++y)
+    {
+        for (int x = 0; x < size; ++x)
+        {
+            const float expected = std::sqrt(static_cast<float>((x - c) * (x - c) + (y - c) * (y - c)));
+            EXPECT_NEAR(expected, dist(y, x), 0.1f * expected + 1.f) << "x=" << x << " y=" << y;
+        }
+    }
+}
+
+TEST(ColorAverageInpainter, fillsHole)
+{
+    Mat frame(32, 32, CV_8UC3, Scalar(10, 20, 30));
+    Mat mask(frame.size(), CV_8U, Scalar::all(255));
+    mask(Rect(8, 8, 16, 16)).setTo(0);
+    frame(Rect(8, 8, 16, 16)).setTo(Scalar::all(0));
+
+    ColorAverageInpainter inpainter;
+    inpainter.inpaint(0, frame, mask);
+
+    EXPECT_EQ(0, countNonZero(mask == 0));
+    EXPECT_EQ(0, cvtest::norm(frame, Mat(frame.size(), CV_8UC3, Scalar(10, 20, 30)), NORM_INF));
+}
+
+}} // namespace
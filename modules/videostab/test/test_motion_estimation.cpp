@@ -172,4 +172,56 @@ TEST(Regression, MM_AFFINE)
     EXPECT_LT(testUtil::performTest(cv::videostab::MM_AFFINE, 6), 9.f);
 }
 
+TEST(Regression, MM_AFFINE_PROSAC)
+{
+    // six hypotheses are far too few for 75% of outliers, unless the inliers are drawn first
+    const cv::videostab::RansacParams params(3, 3.f*testUtil::sigma, 0.5f, 0.5f);
+    ASSERT_EQ(6, params.niters());
+
+    const int attempts = 1000;
+    double disparity = 0.;
+    int ransacFailures = 0;
+
+    for(int attempt = 0; attempt < attempts; attempt++)
+    {
+        const cv::Mat transform = testUtil::generateTransform(cv::videostab::MM_AFFINE);
+
+        const int inliersNumber = testUtil::rng.uniform(20, 40);
+        const int pointsNumber = 4 * inliersNumber;
+
+        cv::Mat points(3, pointsNumber, CV_32F);
+
+        testUtil::generatePoints(points);
+
+        cv::Mat transformedPoints = transform * points;
+
+        testUtil::addNoise(transformedPoints);
+
+        // the correspondences are sorted by decreasing quality: the inliers come first, then the outliers
+        testUtil::generatePoints(transformedPoints.colRange(inliersNumber, pointsNumber));
+
+        const cv::Mat src = points.rowRange(0,2).t();
+        const cv::Mat dst = transformedPoints.rowRange(0,2).t();
+        const cv::Mat inlierPoints = points.colRange(0, inliersNumber);
+        const cv::Mat inlierTransformedPoints = transformedPoints.colRange(0, inliersNumber);
+
+        int ninliers = 0;
+        const cv::Mat estTransform = cv::videostab::estimateGlobalMotionProsac(
+                src.reshape(2), dst.reshape(2), cv::videostab::MM_AFFINE, params, 0, &ninliers);
+        EXPECT_GE(ninliers, inliersNumber / 2);
+
+        const double norm = cv::norm(estTransform * inlierPoints, inlierTransformedPoints, cv::NORM_INF);
+        disparity = std::max(disparity, norm);
+
+        const cv::Mat ransacTransform = cv::videostab::estimateGlobalMotionRansac(
+                src.reshape(2), dst.reshape(2), cv::videostab::MM_AFFINE, params);
+        if (cv::norm(ransacTransform * inlierPoints, inlierTransformedPoints, cv::NORM_INF) >= 9.)
+            ransacFailures++;
+    }
+
+    EXPECT_LT(disparity, 9.);
+    // with the same budget, uniform sampling misses the inliers most of the time
+    EXPECT_GT(ransacFailures, attempts / 2);
+}
+
 }} // namespace
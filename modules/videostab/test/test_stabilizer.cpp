@@ -33,6 +33,53 @@ private:
     Mat frame_;
 };
 
+class ShiftedFramesTestSource : public IFrameSource
+{
+public:
+    ShiftedFramesTestSource(int count)
+    {
+        frameNumber_ = 0;
+        count_ = count;
+        texture_.create(96, 96, CV_8UC3);
+        RNG rng(0);
+        rng.fill(texture_, RNG::UNIFORM, Scalar::all(0), Scalar::all(255));
+        GaussianBlur(texture_, texture_, Size(5, 5), 1.5);
+    }
+
+    virtual void reset() CV_OVERRIDE
+    {
+        frameNumber_ = 0;
+    }
+
+    virtual Mat nextFrame() CV_OVERRIDE
+    {
+        if (frameNumber_ >= count_)
+            return Mat();
+        // shake the camera back and forth
+        const int shift = (frameNumber_++ % 4) * 2;
+        return texture_(Rect(shift, shift / 2, 64, 64)).clone();
+    }
+
+private:
+    int frameNumber_;
+    int count_;
+    Mat texture_;
+};
+
+template <typename Stabilizer>
+static std::vector<Mat> stabilizeAll(Stabilizer &stabilizer, bool pipelined)
+{
+    stabilizer.setRadius(3);
+    stabilizer.setPipelined(pipelined);
+    stabilizer.setLog(makePtr<NullLog>());
+    stabilizer.setFrameSource(makePtr<ShiftedFramesTestSource>(12));
+
+    std::vector<Mat> frames;
+    for (Mat frame = stabilizer.nextFrame(); !frame.empty(); frame = stabilizer.nextFrame())
+        frames.push_back(frame.clone());
+    return frames;
+}
+
 TEST(OnePassStabilizer, oneFrame)
 {
     Mat frame(2, 3, CV_8UC3);
@@ -79,4 +126,28 @@ TEST(TwoPassStabilizer, oneFrame)
     EXPECT_TRUE(stabilizer.nextFrame().empty());
 }
 
+TEST(OnePassStabilizer, pipelined)
+{
+    OnePassStabilizer serial, pipelined;
+    std::vector<Mat> expected = stabilizeAll(serial, false);
+    std::vector<Mat> actual = stabilizeAll(pipelined, true);
+
+    ASSERT_EQ(12u, expected.size());
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+        EXPECT_MAT_NEAR(expected[i], actual[i], 0);
+}
+
+TEST(TwoPassStabilizer, pipelined)
+{
+    TwoPassStabilizer serial, pipelined;
+    std::vector<Mat> expected = stabilizeAll(serial, false);
+    std::vector<Mat> actual = stabilizeAll(pipelined, true);
+
+    ASSERT_EQ(12u, expected.size());
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+        EXPECT_MAT_NEAR(expected[i], actual[i], 0);
+}
+
 }} // namespace
@@ -98,6 +98,19 @@ public:
      */
     CV_WRAP virtual void iterate(InputArray img, int num_iterations=4) = 0;
 
+    /** @brief Refines the superpixel segmentation of the previous call on a new image.
+
+    @param img Input image, with the same requirements as in iterate().
+
+    @param num_iterations Number of pixel level iterations.
+
+    Instead of starting again from a grid, the superpixels computed by the last call to iterate() or
+    iterateWarmStart() are used as initialization and only the pixel level updates are run. This is
+    much faster and keeps the labels consistent between consecutive frames of a video. If no
+    segmentation has been computed yet, this is the same as iterate().
+     */
+    CV_WRAP virtual void iterateWarmStart(InputArray img, int num_iterations=2) = 0;
+
     /** @brief Returns the segmentation labeling of the image.
 
     Each label represents a superpixel, and each pixel is assigned to one superpixel label.
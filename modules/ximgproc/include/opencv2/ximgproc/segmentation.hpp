@@ -59,6 +59,14 @@ namespace cv {
 
                             CV_WRAP virtual void setMinSize(int min_size) = 0;
                             CV_WRAP virtual int getMinSize() = 0;
+
+                            /** @brief Enable or disable the streaming mode
+                                @param streaming If true, the internal buffers (filtered image, graph edges, sets of points) are kept
+                                between calls to processImage and reused for frames of the same size. Buffers are kept per thread,
+                                so processImage may still be called concurrently on the same instance.
+                            */
+                            CV_WRAP virtual void setStreamingMode(bool streaming) = 0;
+                            CV_WRAP virtual bool getStreamingMode() = 0;
                     };
 
                     /** @brief Creates a graph based segmentor
@@ -235,6 +243,11 @@ namespace cv {
 
                             /** @brief Based on all images, graph segmentations and stragies, computes all possible rects and return them
                                 @param rects The list of rects. The first ones are more relevents than the lasts ones.
+
+                                The built-in graph segmentations of the different images are computed in parallel, in both
+                                normal and streaming modes; user-defined graph segmentations are run sequentially. Each
+                                (segmentation, strategy) combination is then processed in parallel on a fresh copy of the
+                                built-in strategies; user-defined strategies are run sequentially.
                             */
                             CV_WRAP virtual void process(CV_OUT std::vector<Rect>& rects) = 0;
                     };
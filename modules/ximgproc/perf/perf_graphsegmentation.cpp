@@ -0,0 +1,37 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+typedef tuple<Size, int, bool> GraphSegmentationTestParam;
+typedef TestBaseWithParam<GraphSegmentationTestParam> GraphSegmentationTest;
+
+PERF_TEST_P(GraphSegmentationTest, processImage,
+    Combine(
+    Values(szVGA, sz1080p),
+    Values(1, 3),                   //channels
+    Bool()                          //streaming mode
+    )
+)
+{
+    Size sz = get<0>(GetParam());
+    int channels = get<1>(GetParam());
+    bool streaming = get<2>(GetParam());
+
+    Mat src = imread(getDataPath("cv/shared/lena.png"), channels == 1 ? IMREAD_GRAYSCALE : IMREAD_COLOR);
+    ASSERT_FALSE(src.empty());
+    resize(src, src, sz);
+
+    Ptr<segmentation::GraphSegmentation> gs = segmentation::createGraphSegmentation();
+    gs->setStreamingMode(streaming);
+
+    Mat dst;
+    declare.in(src).out(dst);
+    TEST_CYCLE() gs->processImage(src, dst);
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
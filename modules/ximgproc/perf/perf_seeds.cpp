@@ -0,0 +1,43 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+typedef tuple<Size, bool> SEEDSTestParam;
+typedef TestBaseWithParam<SEEDSTestParam> SEEDSTest;
+
+PERF_TEST_P(SEEDSTest, iterate,
+    Combine(
+    Values(szVGA, sz1080p),
+    Bool()                          //warm start
+    )
+)
+{
+    Size sz = get<0>(GetParam());
+    bool warm_start = get<1>(GetParam());
+
+    Mat src = imread(getDataPath("cv/shared/lena.png"), IMREAD_COLOR);
+    ASSERT_FALSE(src.empty());
+    resize(src, src, sz);
+    cvtColor(src, src, COLOR_BGR2HSV);
+
+    Ptr<SuperpixelSEEDS> seeds = createSuperpixelSEEDS(sz.width, sz.height, src.channels(), 400, 4);
+    seeds->iterate(src);
+
+    Mat labels;
+    declare.in(src);
+    TEST_CYCLE()
+    {
+        if (warm_start)
+            seeds->iterateWarmStart(src);
+        else
+            seeds->iterate(src);
+        seeds->getLabels(labels);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
@@ -0,0 +1,39 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+typedef tuple<Size, bool> SelectiveSearchTestParam;
+typedef TestBaseWithParam<SelectiveSearchTestParam> SelectiveSearchTest;
+
+PERF_TEST_P(SelectiveSearchTest, process,
+    Combine(
+    Values(szQVGA, szVGA),
+    Bool()                          //quality mode
+    )
+)
+{
+    Size sz = get<0>(GetParam());
+    bool quality = get<1>(GetParam());
+
+    Mat src = imread(getDataPath("cv/shared/lena.png"), IMREAD_COLOR);
+    ASSERT_FALSE(src.empty());
+    resize(src, src, sz);
+
+    Ptr<segmentation::SelectiveSearchSegmentation> ss = segmentation::createSelectiveSearchSegmentation();
+    ss->setBaseImage(src);
+    if (quality)
+        ss->switchToSelectiveSearchQuality();
+    else
+        ss->switchToSelectiveSearchFast();
+
+    std::vector<Rect> rects;
+    declare.in(src).time(60);
+    TEST_CYCLE() ss->process(rects);
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
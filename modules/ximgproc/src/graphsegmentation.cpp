@@ -38,8 +38,10 @@ the use of this software, even if advised of the possibility of such damage.
 * Author: Maximilien Cuony / LTS2 / EPFL / 2015                               *
 *******************************************************************************/
 
+
 #include "precomp.hpp"
 #include "opencv2/ximgproc/segmentation.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 #include <iostream>
 
@@ -78,11 +80,14 @@ namespace cv {
             // An object to manage set of points, who can be fusionned
             class PointSet {
                 public:
+                    PointSet() : nb_elements(0) { }
                     PointSet(int nb_elements_);
-                    ~PointSet();
 
                     int nb_elements;
 
+                    // Map all the points to themselves, reusing the storage if possible
+                    void reset(int nb_elements_);
+
                     // Return the main point of the point's set
                     int getBasePoint(int p);
 
@@ -93,8 +98,18 @@ namespace cv {
                     int size(unsigned int p) { return mapping[p].size; }
 
                 private:
-                    PointSetElement* mapping;
+                    std::vector<PointSetElement> mapping;
+
+            };
 
+            // Working buffers of a segmentation, kept between calls (one set per thread) in streaming mode
+            struct GraphSegmentationBuffers {
+                Mat img_converted;
+                Mat img_filtered;
+                std::vector<Edge> edges;
+                std::vector<Edge> edges_tmp;
+                std::vector<float> thresholds;
+                PointSet es;
             };
 
             class GraphSegmentationImpl : public GraphSegmentation {
@@ -103,6 +118,7 @@ namespace cv {
                         sigma = 0.5;
                         k = 300;
                         min_size = 100;
+                        streaming = false;
                         name_ = "GraphSegmentation";
                     }
 
@@ -120,6 +136,9 @@ namespace cv {
                     virtual void setMinSize(int min_size_) CV_OVERRIDE { min_size = min_size_; }
                     virtual int getMinSize() CV_OVERRIDE { return min_size; }
 
+                    virtual void setStreamingMode(bool streaming_) CV_OVERRIDE { streaming = streaming_; if (!streaming) { stream_buffers.cleanup(); } }
+                    virtual bool getStreamingMode() CV_OVERRIDE { return streaming; }
+
                     virtual void write(FileStorage& fs) const CV_OVERRIDE {
                         fs << "name" << name_
                         << "sigma" << sigma
@@ -139,27 +158,33 @@ namespace cv {
                     double sigma;
                     float k;
                     int min_size;
+                    bool streaming;
                     String name_;
 
+                    // Buffers reused between frames in streaming mode. They are per thread, so processImage can still
+                    // be called concurrently (e.g. by SelectiveSearchSegmentation).
+                    TLSData<GraphSegmentationBuffers> stream_buffers;
+
                     // Pre-filter the image
-                    void filter(const Mat &img, Mat &img_filtered);
+                    void filter(const Mat &img, Mat &img_converted, Mat &img_filtered);
 
                     // Build the graph between each pixels
-                    void buildGraph(Edge **edges, int &nb_edges, const Mat &img_filtered);
+                    void buildGraph(std::vector<Edge> &edges, const Mat &img_filtered);
+
+                    // Sort the edges by weight
+                    void sortEdges(std::vector<Edge> &edges, std::vector<Edge> &edges_tmp);
 
                     // Segment the graph
-                    void segmentGraph(Edge * edges, const int &nb_edges, const Mat & img_filtered, PointSet **es);
+                    void segmentGraph(std::vector<Edge> &edges, int total_points, std::vector<float> &thresholds, PointSet &es);
 
                     // Remove areas too small
-                    void filterSmallAreas(Edge *edges, const int &nb_edges, PointSet *es);
+                    void filterSmallAreas(const std::vector<Edge> &edges, PointSet &es);
 
                     // Map the segemented graph to a Mat with uniques, sequentials ids
-                    void finalMapping(PointSet *es, Mat &output);
+                    void finalMapping(PointSet &es, Mat &output);
             };
 
-            void GraphSegmentationImpl::filter(const Mat &img, Mat &img_filtered) {
-
-                Mat img_converted;
+            void GraphSegmentationImpl::filter(const Mat &img, Mat &img_converted, Mat &img_filtered) {
 
                 // Switch to float
                 img.convertTo(img_converted, CV_32F);
@@ -168,97 +193,198 @@ namespace cv {
                 GaussianBlur(img_converted, img_filtered, Size(0, 0), sigma, sigma);
             }
 
-            void GraphSegmentationImpl::buildGraph(Edge **edges, int &nb_edges, const Mat &img_filtered) {
+            // Compute the distance between the pixels src1[j] and src2[j], for j in [0, len)
+            static void computeWeights(const float* src1, const float* src2, int len, int nb_channels, float* weights) {
 
-                *edges = new Edge[img_filtered.rows * img_filtered.cols * 4];
+                int j = 0;
 
-                nb_edges = 0;
+#if CV_SIMD
+                const int vlanes = VTraits<v_float32>::vlanes();
 
-                int nb_channels = img_filtered.channels();
+                if (nb_channels == 1) {
+                    for (; j <= len - vlanes; j += vlanes) {
+                        v_float32 d = v_sub(vx_load(src1 + j), vx_load(src2 + j));
+                        v_store(weights + j, v_sqrt(v_mul(d, d)));
+                    }
+                } else if (nb_channels == 3) {
+                    for (; j <= len - vlanes; j += vlanes) {
+                        v_float32 a0, a1, a2, b0, b1, b2;
+                        v_load_deinterleave(src1 + j * 3, a0, a1, a2);
+                        v_load_deinterleave(src2 + j * 3, b0, b1, b2);
+
+                        v_float32 d0 = v_sub(a0, b0), d1 = v_sub(a1, b1), d2 = v_sub(a2, b2);
+                        v_store(weights + j, v_sqrt(v_add(v_add(v_mul(d0, d0), v_mul(d1, d1)), v_mul(d2, d2))));
+                    }
+                }
+#endif
 
-                for (int i = 0; i < (int)img_filtered.rows; i++) {
-                    const float* p = img_filtered.ptr<float>(i);
+                for (; j < len; j++) {
+                    float tmp_total = 0;
 
-                    for (int j = 0; j < (int)img_filtered.cols; j++) {
+                    for (int channel = 0; channel < nb_channels; channel++) {
+                        float tmp_diff = src1[j * nb_channels + channel] - src2[j * nb_channels + channel];
+                        tmp_total += tmp_diff * tmp_diff;
+                    }
 
-                        //Take the right, left, top and down pixel
-                        for (int delta = -1; delta <= 1; delta += 2) {
-                            for (int delta_j = 0, delta_i = 1; delta_j <= 1; delta_j++ || delta_i--) {
+                    weights[j] = sqrt(tmp_total);
+                }
+            }
+
+            void GraphSegmentationImpl::buildGraph(std::vector<Edge> &edges, const Mat &img_filtered) {
 
-                                int i2 = i + delta * delta_i;
-                                int j2 = j + delta * delta_j;
+                const int rows = img_filtered.rows;
+                const int cols = img_filtered.cols;
+                const int nb_channels = img_filtered.channels();
 
-                                if (i2 >= 0 && i2 < img_filtered.rows && j2 >= 0 && j2 < img_filtered.cols) {
-                                    const float* p2 = img_filtered.ptr<float>(i2);
+                // Each pixel is linked to its right and bottom neighbours. Right edges are stored first, then bottom
+                // ones, both in raster order, so each row can be filled independently.
+                const int nb_right_edges = rows * (cols - 1);
+                edges.resize(nb_right_edges + (rows - 1) * cols);
 
-                                    float tmp_total = 0;
+                parallel_for_(Range(0, rows), [&](const Range& range) {
+                    AutoBuffer<float> weights(cols);
 
-                                    for ( int channel = 0; channel < nb_channels; channel++) {
-                                        float tmp_diff = p[j * nb_channels + channel] - p2[j2 * nb_channels + channel];
-                                        tmp_total += tmp_diff * tmp_diff;
-                                    }
+                    for (int i = range.start; i < range.end; i++) {
+                        const float* p = img_filtered.ptr<float>(i);
 
-                                    float diff = 0;
-                                    diff = sqrt(tmp_total);
+                        Edge* right = edges.data() + i * (cols - 1);
+                        computeWeights(p, p + nb_channels, cols - 1, nb_channels, weights.data());
+
+                        for (int j = 0; j < cols - 1; j++) {
+                            right[j].from = i * cols + j;
+                            right[j].to = i * cols + j + 1;
+                            right[j].weight = weights[j];
+                        }
 
-                                    (*edges)[nb_edges].weight = diff;
-                                    (*edges)[nb_edges].from = i * img_filtered.cols +  j;
-                                    (*edges)[nb_edges].to = i2 * img_filtered.cols + j2;
+                        if (i + 1 < rows) {
+                            Edge* bottom = edges.data() + nb_right_edges + i * cols;
+                            computeWeights(p, img_filtered.ptr<float>(i + 1), cols, nb_channels, weights.data());
 
-                                    nb_edges++;
-                                }
+                            for (int j = 0; j < cols; j++) {
+                                bottom[j].from = i * cols + j;
+                                bottom[j].to = (i + 1) * cols + j;
+                                bottom[j].weight = weights[j];
                             }
                         }
                     }
-                }
+                });
+            }
+
+            // Weights are positive, so their binary representations are sorted as the values
+            static inline unsigned edgeKey(const Edge& e) {
+                Cv32suf key;
+                key.f = e.weight;
+                return key.u;
             }
 
-            void GraphSegmentationImpl::segmentGraph(Edge *edges, const int &nb_edges, const Mat &img_filtered, PointSet **es) {
+            void GraphSegmentationImpl::sortEdges(std::vector<Edge> &edges, std::vector<Edge> &edges_tmp) {
+
+                const int nb_edges = (int)edges.size();
+
+                if (nb_edges == 0)
+                    return;
+
+                edges_tmp.resize(nb_edges);
+
+                // Stable LSD radix sort on 8 bits digits. Each chunk of edges is counted and scattered by a single
+                // task, so the result does not depend on the number of threads.
+                const int nb_chunks = std::max(1, std::min(getNumThreads(), nb_edges >> 16));
+                const int chunk_size = (nb_edges + nb_chunks - 1) / nb_chunks;
+
+                std::vector<int> offsets(nb_chunks * 256);
+
+                Edge* src = &edges[0];
+                Edge* dst = &edges_tmp[0];
+
+                for (int shift = 0; shift < 32; shift += 8) {
+
+                    parallel_for_(Range(0, nb_chunks), [&](const Range& range) {
+                        for (int c = range.start; c < range.end; c++) {
+                            int* count = &offsets[c * 256];
+                            std::fill(count, count + 256, 0);
 
-                int total_points = ( int)(img_filtered.rows * img_filtered.cols);
+                            const int end = std::min(nb_edges, (c + 1) * chunk_size);
+                            for (int e = c * chunk_size; e < end; e++)
+                                count[(edgeKey(src[e]) >> shift) & 255]++;
+                        }
+                    });
+
+                    // Turn the counts into the first destination of each (digit, chunk)
+                    bool single_digit = false;
+                    int offset = 0;
+
+                    for (int d = 0; d < 256; d++) {
+                        for (int c = 0; c < nb_chunks; c++) {
+                            int count = offsets[c * 256 + d];
+                            offsets[c * 256 + d] = offset;
+                            offset += count;
+                        }
+
+                        if (offset == nb_edges && offsets[d] == 0)
+                            single_digit = true;
+                    }
+
+                    // All the edges have the same digit, this pass would not move anything
+                    if (single_digit)
+                        continue;
+
+                    parallel_for_(Range(0, nb_chunks), [&](const Range& range) {
+                        for (int c = range.start; c < range.end; c++) {
+                            int* position = &offsets[c * 256];
 
-                // Sort edges
-                std::sort(edges, edges + nb_edges);
+                            const int end = std::min(nb_edges, (c + 1) * chunk_size);
+                            for (int e = c * chunk_size; e < end; e++)
+                                dst[position[(edgeKey(src[e]) >> shift) & 255]++] = src[e];
+                        }
+                    });
+
+                    std::swap(src, dst);
+                }
+
+                if (src != &edges[0])
+                    edges.swap(edges_tmp);
+            }
+
+            void GraphSegmentationImpl::segmentGraph(std::vector<Edge> &edges, int total_points, std::vector<float> &thresholds, PointSet &es) {
+
+                const int nb_edges = (int)edges.size();
 
                 // Create a set with all point (by default mapped to themselves)
-                *es = new PointSet(img_filtered.cols * img_filtered.rows);
+                es.reset(total_points);
 
                 // Thresholds
-                float* thresholds = new float[total_points];
-
-                for (int i = 0; i < total_points; i++)
-                    thresholds[i] = k;
+                thresholds.assign(total_points, k);
 
                 for ( int i = 0; i < nb_edges; i++) {
 
-                    int p_a = (*es)->getBasePoint(edges[i].from);
-                    int p_b = (*es)->getBasePoint(edges[i].to);
+                    int p_a = es.getBasePoint(edges[i].from);
+                    int p_b = es.getBasePoint(edges[i].to);
 
                     if (p_a != p_b) {
                         if (edges[i].weight <= thresholds[p_a] && edges[i].weight <= thresholds[p_b]) {
-                            (*es)->joinPoints(p_a, p_b);
-                            p_a = (*es)->getBasePoint(p_a);
-                            thresholds[p_a] = edges[i].weight + k / (*es)->size(p_a);
+                            es.joinPoints(p_a, p_b);
+                            p_a = es.getBasePoint(p_a);
+                            thresholds[p_a] = edges[i].weight + k / es.size(p_a);
 
                             edges[i].weight = 0;
                         }
                     }
                 }
-
-                delete [] thresholds;
             }
 
-            void GraphSegmentationImpl::filterSmallAreas(Edge *edges, const int &nb_edges, PointSet *es) {
+            void GraphSegmentationImpl::filterSmallAreas(const std::vector<Edge> &edges, PointSet &es) {
+
+                const int nb_edges = (int)edges.size();
 
                 for ( int i = 0; i < nb_edges; i++) {
 
                     if (edges[i].weight > 0) {
 
-                        int p_a = es->getBasePoint(edges[i].from);
-                        int p_b = es->getBasePoint(edges[i].to);
+                        int p_a = es.getBasePoint(edges[i].from);
+                        int p_b = es.getBasePoint(edges[i].to);
 
-                        if (p_a != p_b && (es->size(p_a) < min_size || es->size(p_b) < min_size)) {
-                            es->joinPoints(p_a, p_b);
+                        if (p_a != p_b && (es.size(p_a) < min_size || es.size(p_b) < min_size)) {
+                            es.joinPoints(p_a, p_b);
 
                         }
                     }
@@ -266,15 +392,12 @@ namespace cv {
 
             }
 
-            void GraphSegmentationImpl::finalMapping(PointSet *es, Mat &output) {
+            void GraphSegmentationImpl::finalMapping(PointSet &es, Mat &output) {
 
                 int maximum_size = ( int)(output.rows * output.cols);
 
                 int last_id = 0;
-                int * mapped_id = new int[maximum_size];
-
-                for ( int i = 0; i < maximum_size; i++)
-                    mapped_id[i] = -1;
+                std::vector<int> mapped_id(maximum_size, -1);
 
                 int rows = output.rows;
                 int cols = output.cols;
@@ -290,7 +413,7 @@ namespace cv {
 
                     for (int j = 0; j < cols; j++) {
 
-                        int point = es->getBasePoint(i * cols + j);
+                        int point = es.getBasePoint(i * cols + j);
 
                         if (mapped_id[point] == -1) {
                             mapped_id[point] = last_id;
@@ -300,8 +423,6 @@ namespace cv {
                         p[j] = mapped_id[point];
                     }
                 }
-
-                delete [] mapped_id;
             }
 
             void GraphSegmentationImpl::processImage(InputArray src, OutputArray dst) {
@@ -310,31 +431,26 @@ namespace cv {
 
                 dst.create(img.rows, img.cols, CV_32SC1);
                 Mat output = dst.getMat();
-                output.setTo(0);
+
+                // Buffers are either local or owned by the calling thread, so the instance can be used from several threads
+                GraphSegmentationBuffers local_buffers;
+                GraphSegmentationBuffers& buffers = streaming ? stream_buffers.getRef() : local_buffers;
 
                 // Filter graph
-                Mat img_filtered;
-                filter(img, img_filtered);
+                filter(img, buffers.img_converted, buffers.img_filtered);
 
                 // Build graph
-                Edge *edges;
-                int nb_edges;
-
-                buildGraph(&edges, nb_edges, img_filtered);
+                buildGraph(buffers.edges, buffers.img_filtered);
+                sortEdges(buffers.edges, buffers.edges_tmp);
 
                 // Segment graph
-                PointSet *es;
-
-                segmentGraph(edges, nb_edges, img_filtered, &es);
+                segmentGraph(buffers.edges, img.rows * img.cols, buffers.thresholds, buffers.es);
 
                 // Remove small areas
-                filterSmallAreas(edges, nb_edges, es);
+                filterSmallAreas(buffers.edges, buffers.es);
 
                 // Map to final output
-                finalMapping(es, output);
-
-                delete [] edges;
-                delete es;
+                finalMapping(buffers.es, output);
 
             }
 
@@ -349,20 +465,24 @@ namespace cv {
                 return graphseg;
             }
 
+            bool isGraphSegmentationImpl(const Ptr<GraphSegmentation>& gs) {
+                return !gs.dynamicCast<GraphSegmentationImpl>().empty();
+            }
+
             PointSet::PointSet(int nb_elements_) {
+                reset(nb_elements_);
+            }
+
+            void PointSet::reset(int nb_elements_) {
                 nb_elements = nb_elements_;
 
-                mapping = new PointSetElement[nb_elements];
+                mapping.resize(nb_elements);
 
                 for ( int i = 0; i < nb_elements; i++) {
                     mapping[i] = PointSetElement(i);
                 }
             }
 
-            PointSet::~PointSet() {
-                delete [] mapping;
-            }
-
             int PointSet::getBasePoint( int p) {
 
                  int base_p = p;
@@ -40,6 +40,7 @@
 //M*/
 
 #include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 /******************************************************************************\
 *                            SEEDS Superpixels                                *
@@ -54,8 +55,6 @@
 #include <cstdlib>
 using namespace std;
 
-
-
 //required confidence when double_step is used
 #define REQ_CONF 0.1f
 
@@ -82,6 +81,7 @@ public:
     virtual int getNumberOfSuperpixels() CV_OVERRIDE { return nrLabels(seeds_top_level); }
 
     virtual void iterate(InputArray img, int num_iterations = 4) CV_OVERRIDE;
+    virtual void iterateWarmStart(InputArray img, int num_iterations = 2) CV_OVERRIDE;
 
 
     virtual void getLabels(OutputArray labels_out) CV_OVERRIDE;
@@ -91,6 +91,7 @@ private:
     /* initialization */
     void initialize(int num_superpixels, int num_levels);
     void initImage(InputArray img);
+    void initImageBins(InputArray img);
     void assignLabels();
     void computeHistograms(int until_level = -1);
     template<typename _Tp>
@@ -109,6 +110,8 @@ private:
     inline void updateLabels();
     // main loop for pixel updating
     void updatePixels();
+    void updatePixelsHorizontal(int x0, int x1, int y0, int y1);
+    void updatePixelsVertical(int x0, int x1, int y0, int y1);
 
 
     /* block operations */
@@ -122,6 +125,15 @@ private:
 
     //main loop for block updates
     void updateBlocks(int level, float req_confidence = 0.0f);
+    void updateBlocksHorizontal(int level, float req_confidence, int x0, int x1, int y0, int y1);
+    void updateBlocksVertical(int level, float req_confidence, int x0, int x1, int y0, int y1);
+
+    /* checkerboard scheduling of the updates */
+    //split a grid of top level labels in tiles bigger than any superpixel
+    void computeTiling(const int* grid, int grid_w, int grid_h, int& nr_tiles_w, int& nr_tiles_h);
+    //call fn(x0, x1, y0, y1) on all the tiles, tiles of the same checkerboard color in parallel
+    template<typename Fn>
+    void runCheckerboard(int grid_w, int grid_h, int nr_tiles_w, int nr_tiles_h, const Fn& fn);
 
     /* go to next block level */
     int goDownOneLevel();
@@ -147,6 +159,7 @@ private:
     int nr_bins; //number of histogram bins per channel
     int nr_channels; //number of image channels
     bool forwardbackward;
+    bool labels_computed; //true once iterate() has been called, for iterateWarmStart()
 
     int seeds_nr_levels;
     int seeds_top_level; // == seeds_nr_levels-1 (const)
@@ -201,6 +214,7 @@ SuperpixelSEEDSImpl::SuperpixelSEEDSImpl(int image_width, int image_height, int
     nr_channels = image_channels;
     seeds_double_step = double_step;
     seeds_prior = std::min(prior, 5);
+    labels_computed = false;
 
     histogram_size = nr_bins;
     for (int i = 1; i < nr_channels; ++i)
@@ -233,6 +247,31 @@ void SuperpixelSEEDSImpl::iterate(InputArray img, int num_iterations)
 
     for (int i = 0; i < num_iterations; ++i)
         updatePixels();
+
+    labels_computed = true;
+}
+
+void SuperpixelSEEDSImpl::iterateWarmStart(InputArray img, int num_iterations)
+{
+    if( !labels_computed )
+    {
+        iterate(img, num_iterations);
+        return;
+    }
+
+    initImageBins(img);
+
+    // rebuild the histograms of the current superpixels from the new image
+    int nr_labels = nrLabels(seeds_top_level);
+    memset(histogram[seeds_top_level], 0,
+            sizeof(HISTN) * histogram_size_aligned * nr_labels);
+    memset(T[seeds_top_level], 0, sizeof(HISTN) * nr_labels);
+
+    for (int i = 0; i < width * height; ++i)
+        addPixel(seeds_top_level, labels[i], i);
+
+    for (int i = 0; i < num_iterations; ++i)
+        updatePixels();
 }
 void SuperpixelSEEDSImpl::getLabels(OutputArray labels_out)
 {
@@ -374,6 +413,18 @@ void SuperpixelSEEDSImpl::initImageBins<float>(const Mat& img, int)
 }
 
 void SuperpixelSEEDSImpl::initImage(InputArray img)
+{
+    seeds_current_level = seeds_nr_levels - 2;
+    forwardbackward = true;
+
+    assignLabels();
+
+    initImageBins(img);
+
+    computeHistograms();
+}
+
+void SuperpixelSEEDSImpl::initImageBins(InputArray img)
 {
     Mat src;
 
@@ -401,10 +452,6 @@ void SuperpixelSEEDSImpl::initImage(InputArray img)
       CV_Error( Error::StsInternal, "Invalid InputArray." );
 
     int depth = src.depth();
-    seeds_current_level = seeds_nr_levels - 2;
-    forwardbackward = true;
-
-    assignLabels();
 
     CV_Assert(src.size().width == width && src.size().height == height);
     CV_Assert(depth == CV_8U || depth == CV_16U || depth == CV_32F);
@@ -423,8 +470,6 @@ void SuperpixelSEEDSImpl::initImage(InputArray img)
         initImageBins<float>(src, 1);
         break;
     }
-
-    computeHistograms();
 }
 
 // adds labeling to all the blocks at all levels and sets the correct parents
@@ -471,18 +516,101 @@ void SuperpixelSEEDSImpl::computeHistograms(int until_level)
     }
 }
 
+/* The block and pixel updates only modify the histograms of the superpixels found around the
+ * updated cells. The grid is split in tiles larger than the bounding box of any superpixel, plus
+ * the 2 cells read around an update and the growth of a superpixel during the horizontal and
+ * vertical passes (1 cell on each side for each pass). Tiles of the same checkerboard color are
+ * then at least one tile apart and never access the same superpixel, so they can be updated in
+ * parallel. The result does not depend on the number of threads, and a single tile is the
+ * sequential scan. */
+void SuperpixelSEEDSImpl::computeTiling(const int* grid, int grid_w, int grid_h,
+        int& nr_tiles_w, int& nr_tiles_h)
+{
+    int nr_labels = nrLabels(seeds_top_level);
+    vector<int> min_x(nr_labels, grid_w), max_x(nr_labels, -1);
+    vector<int> min_y(nr_labels, grid_h), max_y(nr_labels, -1);
+
+    for (int y = 0; y < grid_h; y++)
+    {
+        const int* row = grid + y * grid_w;
+        for (int x = 0; x < grid_w; x++)
+        {
+            int label = row[x];
+            min_x[label] = std::min(min_x[label], x);
+            max_x[label] = std::max(max_x[label], x);
+            min_y[label] = std::min(min_y[label], y);
+            max_y[label] = y;
+        }
+    }
+
+    int extent_w = 0, extent_h = 0;
+    for (int label = 0; label < nr_labels; label++)
+    {
+        if( max_x[label] < 0 )
+            continue;
+        extent_w = std::max(extent_w, max_x[label] - min_x[label] + 1);
+        extent_h = std::max(extent_h, max_y[label] - min_y[label] + 1);
+    }
+
+    const int margin = 8;
+    nr_tiles_w = std::max(1, grid_w / (extent_w + margin));
+    nr_tiles_h = std::max(1, grid_h / (extent_h + margin));
+}
+
+template<typename Fn>
+void SuperpixelSEEDSImpl::runCheckerboard(int grid_w, int grid_h, int nr_tiles_w, int nr_tiles_h,
+        const Fn& fn)
+{
+    for (int color = 0; color < 4; color++)
+    {
+        int first_tx = color & 1;
+        int first_ty = color >> 1;
+        int nr_color_w = (nr_tiles_w - first_tx + 1) / 2;
+        int nr_color_h = (nr_tiles_h - first_ty + 1) / 2;
+
+        parallel_for_(Range(0, nr_color_w * nr_color_h), [&](const Range& range) {
+            for (int t = range.start; t < range.end; t++)
+            {
+                int tx = first_tx + 2 * (t % nr_color_w);
+                int ty = first_ty + 2 * (t / nr_color_w);
+                fn(tx * grid_w / nr_tiles_w, (tx + 1) * grid_w / nr_tiles_w,
+                        ty * grid_h / nr_tiles_h, (ty + 1) * grid_h / nr_tiles_h);
+            }
+        });
+    }
+}
+
 void SuperpixelSEEDSImpl::updateBlocks(int level, float req_confidence)
+{
+    int nr_w = nr_wh[2 * level];
+    int nr_h = nr_wh[2 * level + 1];
+    int nr_tiles_w, nr_tiles_h;
+    computeTiling(parent[level], nr_w, nr_h, nr_tiles_w, nr_tiles_h);
+
+    // horizontal bidirectional block updating
+    runCheckerboard(nr_w, nr_h, nr_tiles_w, nr_tiles_h, [&](int x0, int x1, int y0, int y1) {
+        updateBlocksHorizontal(level, req_confidence, x0, x1, y0, y1);
+    });
+
+    // vertical bidirectional
+    runCheckerboard(nr_w, nr_h, nr_tiles_w, nr_tiles_h, [&](int x0, int x1, int y0, int y1) {
+        updateBlocksVertical(level, req_confidence, x0, x1, y0, y1);
+    });
+}
+
+void SuperpixelSEEDSImpl::updateBlocksHorizontal(int level, float req_confidence, int x0, int x1, int y0, int y1)
 {
     int labelA;
     int labelB;
     int sublabel;
     bool done;
     int step = nr_wh[2 * level];
+    int y_end = std::min(y1, nr_wh[2 * level + 1] - 1);
+    int x_end = std::min(x1, nr_wh[2 * level] - 2);
 
-    // horizontal bidirectional block updating
-    for (int y = 1; y < nr_wh[2 * level + 1] - 1; y++)
+    for (int y = std::max(y0, 1); y < y_end; y++)
     {
-        for (int x = 1; x < nr_wh[2 * level] - 2; x++)
+        for (int x = std::max(x0, 1); x < x_end; x++)
         {
             // choose a label at the current level
             sublabel = y * step + x;
@@ -541,11 +669,21 @@ void SuperpixelSEEDSImpl::updateBlocks(int level, float req_confidence)
             }
         }
     }
+}
 
-    // vertical bidirectional
-    for (int x = 1; x < nr_wh[2 * level] - 1; x++)
+void SuperpixelSEEDSImpl::updateBlocksVertical(int level, float req_confidence, int x0, int x1, int y0, int y1)
+{
+    int labelA;
+    int labelB;
+    int sublabel;
+    bool done;
+    int step = nr_wh[2 * level];
+    int x_end = std::min(x1, nr_wh[2 * level] - 1);
+    int y_end = std::min(y1, nr_wh[2 * level + 1] - 2);
+
+    for (int x = std::max(x0, 1); x < x_end; x++)
     {
-        for (int y = 1; y < nr_wh[2 * level + 1] - 2; y++)
+        for (int y = std::max(y0, 1); y < y_end; y++)
         {
             // choose a label at the current level
             sublabel = y * step + x;
@@ -636,15 +774,59 @@ int SuperpixelSEEDSImpl::goDownOneLevel()
 }
 
 void SuperpixelSEEDSImpl::updatePixels()
+{
+    int labelA;
+    int labelB;
+    int nr_tiles_w, nr_tiles_h;
+    computeTiling(labels, width, height, nr_tiles_w, nr_tiles_h);
+
+    runCheckerboard(width, height, nr_tiles_w, nr_tiles_h, [&](int x0, int x1, int y0, int y1) {
+        updatePixelsHorizontal(x0, x1, y0, y1);
+    });
+
+    runCheckerboard(width, height, nr_tiles_w, nr_tiles_h, [&](int x0, int x1, int y0, int y1) {
+        updatePixelsVertical(x0, x1, y0, y1);
+    });
+
+    forwardbackward = !forwardbackward;
+
+    // update border pixels
+    for (int x = 0; x < width; x++)
+    {
+        labelA = labels[x];
+        labelB = labels[width + x];
+        if( labelA != labelB )
+            update(labelB, x, labelA);
+        labelA = labels[(height - 1) * width + x];
+        labelB = labels[(height - 2) * width + x];
+        if( labelA != labelB )
+            update(labelB, (height - 1) * width + x, labelA);
+    }
+    for (int y = 0; y < height; y++)
+    {
+        labelA = labels[y * width];
+        labelB = labels[y * width + 1];
+        if( labelA != labelB )
+            update(labelB, y * width, labelA);
+        labelA = labels[y * width + width - 1];
+        labelB = labels[y * width + width - 2];
+        if( labelA != labelB )
+            update(labelB, y * width + width - 1, labelA);
+    }
+}
+
+void SuperpixelSEEDSImpl::updatePixelsHorizontal(int x0, int x1, int y0, int y1)
 {
     int labelA;
     int labelB;
     int priorA = 0;
     int priorB = 0;
+    int y_end = std::min(y1, height - 1);
+    int x_end = std::min(x1, width - 2);
 
-    for (int y = 1; y < height - 1; y++)
+    for (int y = std::max(y0, 1); y < y_end; y++)
     {
-        for (int x = 1; x < width - 2; x++)
+        for (int x = std::max(x0, 1); x < x_end; x++)
         {
 
             labelA = labels[(y) * width + (x)];
@@ -733,10 +915,20 @@ void SuperpixelSEEDSImpl::updatePixels()
             } // labelA != labelB
         } // for x
     } // for y
+}
 
-    for (int x = 1; x < width - 1; x++)
+void SuperpixelSEEDSImpl::updatePixelsVertical(int x0, int x1, int y0, int y1)
+{
+    int labelA;
+    int labelB;
+    int priorA = 0;
+    int priorB = 0;
+    int x_end = std::min(x1, width - 1);
+    int y_end = std::min(y1, height - 2);
+
+    for (int x = std::max(x0, 1); x < x_end; x++)
     {
-        for (int y = 1; y < height - 2; y++)
+        for (int y = std::max(y0, 1); y < y_end; y++)
         {
 
             labelA = labels[(y) * width + (x)];
@@ -825,31 +1017,6 @@ void SuperpixelSEEDSImpl::updatePixels()
             } // labelA != labelB
         } // for y
     } // for x
-    forwardbackward = !forwardbackward;
-
-    // update border pixels
-    for (int x = 0; x < width; x++)
-    {
-        labelA = labels[x];
-        labelB = labels[width + x];
-        if( labelA != labelB )
-            update(labelB, x, labelA);
-        labelA = labels[(height - 1) * width + x];
-        labelB = labels[(height - 2) * width + x];
-        if( labelA != labelB )
-            update(labelB, (height - 1) * width + x, labelA);
-    }
-    for (int y = 0; y < height; y++)
-    {
-        labelA = labels[y * width];
-        labelB = labels[y * width + 1];
-        if( labelA != labelB )
-            update(labelB, y * width, labelA);
-        labelA = labels[y * width + width - 1];
-        labelB = labels[y * width + width - 2];
-        if( labelA != labelB )
-            update(labelB, y * width + width - 1, labelA);
-    }
 }
 
 void SuperpixelSEEDSImpl::update(int label_new, int image_idx, int label_old)
@@ -882,16 +1049,10 @@ void SuperpixelSEEDSImpl::addBlock(int level, int label, int sublevel,
 
     //add the (sublevel, sublabel) block to the block (level, label)
     int n = 0;
-#if CV_SSSE3
-    const int loop_end = histogram_size - 3;
-    for (; n < loop_end; n += 4)
-    {
-        //this does exactly the same as the loop peeling below, but 4 elements at a time
-        __m128 h_labelp = _mm_load_ps(h_label + n);
-        __m128 h_sublabelp = _mm_load_ps(h_sublabel + n);
-        h_labelp = _mm_add_ps(h_labelp, h_sublabelp);
-        _mm_store_ps(h_label + n, h_labelp);
-    }
+#if CV_SIMD
+    const int vlanes = VTraits<v_float32>::vlanes();
+    for (; n <= histogram_size - vlanes; n += vlanes)
+        v_store(h_label + n, v_add(vx_load(h_label + n), vx_load(h_sublabel + n)));
 #endif
 
     //loop peeling
@@ -914,16 +1075,10 @@ void SuperpixelSEEDSImpl::deleteBlockToplevel(int label, int sublevel, int subla
 
     //do the reverse operation of add_block_toplevel
     int n = 0;
-#if CV_SSSE3
-    const int loop_end = histogram_size - 3;
-    for (; n < loop_end; n += 4)
-    {
-        //this does exactly the same as the loop peeling below, but 4 elements at a time
-        __m128 h_labelp = _mm_load_ps(h_label + n);
-        __m128 h_sublabelp = _mm_load_ps(h_sublabel + n);
-        h_labelp = _mm_sub_ps(h_labelp, h_sublabelp);
-        _mm_store_ps(h_label + n, h_labelp);
-    }
+#if CV_SIMD
+    const int vlanes = VTraits<v_float32>::vlanes();
+    for (; n <= histogram_size - vlanes; n += vlanes)
+        v_store(h_label + n, v_sub(vx_load(h_label + n), vx_load(h_sublabel + n)));
 #endif
 
     //loop peeling
@@ -988,28 +1143,17 @@ int SuperpixelSEEDSImpl::threebyfour(int x, int y, int label)
      * x x x x
      */
 
-#if CV_SSSE3
-    __m128i addp = _mm_set1_epi32(1);
-    __m128i addp_middle = _mm_set_epi32(1, 0, 0, 1);
-    __m128i labelp = _mm_set1_epi32(label);
+#if CV_SIMD128
+    v_int32x4 addp = v_setall_s32(1);
+    v_int32x4 addp_middle(1, 0, 0, 1);
+    v_int32x4 labelp = v_setall_s32(label);
     /* 1. row */
-    __m128i data1 = _mm_loadu_si128((__m128i*) (labels + (y-1)*width + x -1));
-    __m128i mask1 = _mm_cmpeq_epi32(data1, labelp);
-    __m128i countp = _mm_and_si128(mask1, addp);
+    v_int32x4 countp = v_and(v_eq(v_load(labels + (y-1)*width + x - 1), labelp), addp);
     /* 2. row */
-    __m128i data2 = _mm_loadu_si128((__m128i*) (labels + y*width + x -1));
-    __m128i mask2 = _mm_cmpeq_epi32(data2, labelp);
-    __m128i count1 = _mm_and_si128(mask2, addp_middle);
-    countp = _mm_add_epi32(countp, count1);
+    countp = v_add(countp, v_and(v_eq(v_load(labels + y*width + x - 1), labelp), addp_middle));
     /* 3. row */
-    __m128i data3 = _mm_loadu_si128((__m128i*) (labels + (y+1)*width + x -1));
-    __m128i mask3 = _mm_cmpeq_epi32(data3, labelp);
-    __m128i count3 = _mm_and_si128(mask3, addp);
-    countp = _mm_add_epi32(count3, countp);
-
-    countp = _mm_hadd_epi32(countp, countp);
-    countp = _mm_hadd_epi32(countp, countp);
-    return _mm_cvtsi128_si32(countp);
+    countp = v_add(countp, v_and(v_eq(v_load(labels + (y+1)*width + x - 1), labelp), addp));
+    return v_reduce_sum(countp);
 #else
     int count = 0;
     count += (labels[(y - 1) * width + x - 1] == label);
@@ -1039,33 +1183,19 @@ int SuperpixelSEEDSImpl::fourbythree(int x, int y, int label)
      * x x x o
      */
 
-#if CV_SSSE3
-    __m128i addp_border = _mm_set_epi32(0, 1, 1, 1);
-    __m128i addp_middle = _mm_set_epi32(1, 0, 0, 1);
-    __m128i labelp = _mm_set1_epi32(label);
+#if CV_SIMD128
+    v_int32x4 addp_border(1, 1, 1, 0);
+    v_int32x4 addp_middle(1, 0, 0, 1);
+    v_int32x4 labelp = v_setall_s32(label);
     /* 1. row */
-    __m128i data1 = _mm_loadu_si128((__m128i*) (labels + (y-1)*width + x -1));
-    __m128i mask1 = _mm_cmpeq_epi32(data1, labelp);
-    __m128i countp = _mm_and_si128(mask1, addp_border);
+    v_int32x4 countp = v_and(v_eq(v_load(labels + (y-1)*width + x - 1), labelp), addp_border);
     /* 2. row */
-    __m128i data2 = _mm_loadu_si128((__m128i*) (labels + y*width + x -1));
-    __m128i mask2 = _mm_cmpeq_epi32(data2, labelp);
-    __m128i count1 = _mm_and_si128(mask2, addp_middle);
-    countp = _mm_add_epi32(countp, count1);
+    countp = v_add(countp, v_and(v_eq(v_load(labels + y*width + x - 1), labelp), addp_middle));
     /* 3. row */
-    __m128i data3 = _mm_loadu_si128((__m128i*) (labels + (y+1)*width + x -1));
-    __m128i mask3 = _mm_cmpeq_epi32(data3, labelp);
-    __m128i count3 = _mm_and_si128(mask3, addp_middle);
-    countp = _mm_add_epi32(count3, countp);
+    countp = v_add(countp, v_and(v_eq(v_load(labels + (y+1)*width + x - 1), labelp), addp_middle));
     /* 4. row */
-    __m128i data4 = _mm_loadu_si128((__m128i*) (labels + (y+2)*width + x -1));
-    __m128i mask4 = _mm_cmpeq_epi32(data4, labelp);
-    __m128i count4 = _mm_and_si128(mask4, addp_border);
-    countp = _mm_add_epi32(countp, count4);
-
-    countp = _mm_hadd_epi32(countp, countp);
-    countp = _mm_hadd_epi32(countp, countp);
-    return _mm_cvtsi128_si32(countp);
+    countp = v_add(countp, v_and(v_eq(v_load(labels + (y+2)*width + x - 1), labelp), addp_border));
+    return v_reduce_sum(countp);
 #else
     int count = 0;
     count += (labels[(y - 1) * width + x - 1] == label);
@@ -1109,54 +1239,30 @@ float SuperpixelSEEDSImpl::intersectConf(int level1, int label1A, int label1B,
      */
 
     int n = 0;
-#if CV_SSSE3
-    __m128 count1Ap = _mm_set1_ps(count1A);
-    __m128 count2p = _mm_set1_ps(count2);
-    __m128 count1Bp = _mm_set1_ps(count1B);
-    __m128 sumAp = _mm_set1_ps(0.0f);
-    __m128 sumBp = _mm_set1_ps(0.0f);
-
-    const int loop_end = histogram_size - 3;
-    for(; n < loop_end; n += 4)
+#if CV_SIMD
+    const int vlanes = VTraits<v_float32>::vlanes();
+    v_float32 count1Ap = vx_setall_f32(count1A);
+    v_float32 count2p = vx_setall_f32(count2);
+    v_float32 count1Bp = vx_setall_f32(count1B);
+    v_float32 sumAp = vx_setzero_f32();
+    v_float32 sumBp = vx_setzero_f32();
+
+    for (; n <= histogram_size - vlanes; n += vlanes)
     {
-        //this does exactly the same as the loop peeling below, but 4 elements at a time
+        //this does exactly the same as the loop peeling below, but vlanes elements at a time
+        v_float32 h1Ap = vx_load(h1A + n);
+        v_float32 h1Bp = vx_load(h1B + n);
+        v_float32 h2p = vx_load(h2 + n);
 
         // normal
-        __m128 h1Ap = _mm_load_ps(h1A + n);
-        __m128 h1Bp = _mm_load_ps(h1B + n);
-        __m128 h2p = _mm_load_ps(h2 + n);
-
-        __m128 h1ApC2 = _mm_mul_ps(h1Ap, count2p);
-        __m128 h2pC1A = _mm_mul_ps(h2p, count1Ap);
-        __m128 maskA = _mm_cmple_ps(h1ApC2, h2pC1A);
-        __m128 sum1AddA = _mm_and_ps(maskA, h1ApC2);
-        __m128 sum2AddA = _mm_andnot_ps(maskA, h2pC1A);
-        sumAp = _mm_add_ps(sumAp, sum1AddA);
-        sumAp = _mm_add_ps(sumAp, sum2AddA);
+        sumAp = v_add(sumAp, v_min(v_mul(h1Ap, count2p), v_mul(h2p, count1Ap)));
 
         // del
-        __m128 diffp = _mm_sub_ps(h1Bp, h2p);
-        __m128 h1BpC2 = _mm_mul_ps(diffp, count2p);
-        __m128 h2pC1B = _mm_mul_ps(h2p, count1Bp);
-        __m128 maskB = _mm_cmple_ps(h1BpC2, h2pC1B);
-        __m128 sum1AddB = _mm_and_ps(maskB, h1BpC2);
-        __m128 sum2AddB = _mm_andnot_ps(maskB, h2pC1B);
-        sumBp = _mm_add_ps(sumBp, sum1AddB);
-        sumBp = _mm_add_ps(sumBp, sum2AddB);
+        sumBp = v_add(sumBp, v_min(v_mul(v_sub(h1Bp, h2p), count2p), v_mul(h2p, count1Bp)));
     }
-    // merge results (quite expensive)
-    float sum1Asse;
-    sumAp = _mm_hadd_ps(sumAp, sumAp);
-    sumAp = _mm_hadd_ps(sumAp, sumAp);
-    _mm_store_ss(&sum1Asse, sumAp);
-
-    float sum1Bsse;
-    sumBp = _mm_hadd_ps(sumBp, sumBp);
-    sumBp = _mm_hadd_ps(sumBp, sumBp);
-    _mm_store_ss(&sum1Bsse, sumBp);
-
-    sumA += sum1Asse;
-    sumB += sum1Bsse;
+
+    sumA += v_reduce_sum(sumAp);
+    sumB += v_reduce_sum(sumBp);
 #endif
 
     //loop peeling
@@ -42,6 +42,8 @@ the use of this software, even if advised of the possibility of such damage.
 #include "opencv2/ximgproc/segmentation.hpp"
 
 #include <iostream>
+#include <iterator>
+#include <queue>
 
 namespace cv {
     namespace ximgproc {
@@ -49,6 +51,10 @@ namespace cv {
 
             // Helpers
 
+            // True for the segmentations created by createGraphSegmentation(), which can process several images at
+            // once (defined in graphsegmentation.cpp)
+            bool isGraphSegmentationImpl(const Ptr<GraphSegmentation>& gs);
+
             // Represent a regsion
             class Region {
                 public:
@@ -107,10 +113,65 @@ namespace cv {
                     friend std::ostream& operator<<(std::ostream& os, const Neighbour& n);
 
                     bool operator <(const Neighbour& n) const {
-                        return similarity < n.similarity;
+                        if (similarity != n.similarity) {
+                            return similarity < n.similarity;
+                        }
+                        // Ties are broken on ids so the merge order does not depend on the queue implementation
+                        if (from != n.from) {
+                            return from > n.from;
+                        }
+                        return to > n.to;
                     }
             };
 
+            // Initial segmentation of an image, shared by all the strategies run on it
+            struct InitialSegmentation {
+                Mat img_regions;
+                Mat_<int> sizes;
+                int nb_segs;
+                std::vector<Rect> bounding_rects;
+                // Sorted neighbours of region i are neighbours[neighbours_offsets[i]] to neighbours[neighbours_offsets[i + 1] - 1]
+                std::vector<int> neighbours_offsets;
+                std::vector<int> neighbours;
+            };
+
+            // Compute the bounding rect (and optionally the size) of each region in a single pass
+            static void computeRegionsBoundingRects(const Mat& regions, int nb_segs, std::vector<Rect>& bounding_rects, Mat_<int>* sizes = NULL) {
+                std::vector<Point> tl(nb_segs, Point(INT_MAX, INT_MAX));
+                std::vector<Point> br(nb_segs, Point(-1, -1));
+
+                if (sizes) {
+                    *sizes = Mat_<int>::zeros(nb_segs, 1);
+                }
+
+                for (int i = 0; i < regions.rows; i++) {
+                    const int* p = regions.ptr<int>(i);
+
+                    for (int j = 0; j < regions.cols; j++) {
+                        const int r = p[j];
+
+                        tl[r].x = std::min(tl[r].x, j);
+                        tl[r].y = std::min(tl[r].y, i);
+                        br[r].x = std::max(br[r].x, j);
+                        br[r].y = i;
+                    }
+
+                    if (sizes) {
+                        int* s = sizes->ptr<int>(0);
+
+                        for (int j = 0; j < regions.cols; j++) {
+                            s[p[j]]++;
+                        }
+                    }
+                }
+
+                bounding_rects.resize(nb_segs);
+
+                for (int seg = 0; seg < nb_segs; seg++) {
+                    bounding_rects[seg] = br[seg].x < 0 ? Rect() : Rect(tl[seg], br[seg] + Point(1, 1));
+                }
+            }
+
             /****************************************
              * Stragegy / Color
              ***************************************/
@@ -146,14 +207,8 @@ namespace cv {
 
                 if (image_id == -1 || last_image_id != image_id) {
 
-                    std::vector<Mat> img_planes;
-                    split(img, img_planes);
-
                     int histogram_bins_size = 25;
 
-                    float range[] = {0, 256};
-                    const float* histogram_ranges = {range};
-
                     double min, max;
                     minMaxLoc(regions, &min, &max);
                     int nb_segs = (int)max + 1;
@@ -162,38 +217,79 @@ namespace cv {
 
                     histograms = Mat_<float>(nb_segs, histogram_size);
 
-                    for (int r = 0; r < nb_segs; r++) {
-
-                        // Generate mask
-                        Mat mask = regions == r;
+                    if (img.depth() == CV_8U) {
+                        // Accumulate the histograms of all the regions in a single pass over the image.
+                        // The bins are the same as calcHist ones with a [0, 256) range.
+                        const int channels = img.channels();
+                        Mat_<int> counts = Mat_<int>::zeros(nb_segs, histogram_size);
 
-                        // Compute histogram for each channels
-                        float tt = 0;
+                        for (int i = 0; i < img.rows; i++) {
+                            const uchar* p = img.ptr<uchar>(i);
+                            const int* r = regions.ptr<int>(i);
 
-                        Mat tmp_hists = Mat(histogram_size, 1, CV_32F);
-                        float *tmp_histogram = tmp_hists.ptr<float>(0);
-                        int h_pos = 0;
-                        Mat tmp_hist;
+                            for (int j = 0; j < img.cols; j++, p += channels) {
+                                int* count = counts.ptr<int>(r[j]);
 
-                        for (int p = 0; p < img.channels(); p++) {
+                                for (int c = 0; c < channels; c++) {
+                                    count[c * histogram_bins_size + ((p[c] * histogram_bins_size) >> 8)]++;
+                                }
+                            }
+                        }
 
-                            calcHist(&img_planes[p], 1, 0, mask, tmp_hist, 1, &histogram_bins_size, &histogram_ranges);
+                        // Normalize historgrams
+                        for (int r = 0; r < nb_segs; r++) {
+                            const int* count = counts.ptr<int>(r);
+                            float* histogram = histograms.ptr<float>(r);
 
-                            float *tmp_hist_ = tmp_hist.ptr<float>(0);
+                            int tt = 0;
+                            for (int h_pos = 0; h_pos < histogram_size; h_pos++) {
+                                tt += count[h_pos];
+                            }
 
-                            // Copy local histogram to global histogram
-                            for (int pos = 0; pos < histogram_bins_size; pos++) {
-                                tmp_histogram[pos + h_pos] = tmp_hist_[pos];
-                                tt += tmp_histogram[pos + h_pos];
+                            for (int h_pos = 0; h_pos < histogram_size; h_pos++) {
+                                histogram[h_pos] = (float)count[h_pos] / (float)tt;
                             }
-                            h_pos += histogram_bins_size;
                         }
+                    } else {
+                        std::vector<Mat> img_planes;
+                        split(img, img_planes);
 
-                        // Normalize historgrams
-                        float* histogram = histograms.ptr<float>(r);
+                        float range[] = {0, 256};
+                        const float* histogram_ranges = {range};
 
-                        for (int h_pos2 = 0; h_pos2 < histogram_size; h_pos2++) {
-                            histogram[h_pos2] = tmp_histogram[h_pos2] / tt;
+                        for (int r = 0; r < nb_segs; r++) {
+
+                            // Generate mask
+                            Mat mask = regions == r;
+
+                            // Compute histogram for each channels
+                            float tt = 0;
+
+                            Mat tmp_hists = Mat(histogram_size, 1, CV_32F);
+                            float *tmp_histogram = tmp_hists.ptr<float>(0);
+                            int h_pos = 0;
+                            Mat tmp_hist;
+
+                            for (int p = 0; p < img.channels(); p++) {
+
+                                calcHist(&img_planes[p], 1, 0, mask, tmp_hist, 1, &histogram_bins_size, &histogram_ranges);
+
+                                float *tmp_hist_ = tmp_hist.ptr<float>(0);
+
+                                // Copy local histogram to global histogram
+                                for (int pos = 0; pos < histogram_bins_size; pos++) {
+                                    tmp_histogram[pos + h_pos] = tmp_hist_[pos];
+                                    tt += tmp_histogram[pos + h_pos];
+                                }
+                                h_pos += histogram_bins_size;
+                            }
+
+                            // Normalize historgrams
+                            float* histogram = histograms.ptr<float>(r);
+
+                            for (int h_pos2 = 0; h_pos2 < histogram_size; h_pos2++) {
+                                histogram[h_pos2] = tmp_histogram[h_pos2] / tt;
+                            }
                         }
                     }
 
@@ -258,6 +354,9 @@ namespace cv {
                     virtual void addStrategy(Ptr<SelectiveSearchSegmentationStrategy> g, float weight) CV_OVERRIDE;
                     virtual void clearStrategies() CV_OVERRIDE;
 
+                    // Empty if one of the sub-strategies can't be cloned
+                    Ptr<SelectiveSearchSegmentationStrategy> clone() const;
+
                 private:
                     String name_;
                     std::vector<Ptr<SelectiveSearchSegmentationStrategy> > strategies;
@@ -265,6 +364,24 @@ namespace cv {
                     float weights_total;
             };
 
+            static Ptr<SelectiveSearchSegmentationStrategy> cloneStrategy(const Ptr<SelectiveSearchSegmentationStrategy>& s);
+
+            Ptr<SelectiveSearchSegmentationStrategy> SelectiveSearchSegmentationStrategyMultipleImpl::clone() const {
+                Ptr<SelectiveSearchSegmentationStrategyMultipleImpl> c = makePtr<SelectiveSearchSegmentationStrategyMultipleImpl>();
+
+                for (unsigned int i = 0; i < strategies.size(); i++) {
+                    Ptr<SelectiveSearchSegmentationStrategy> s = cloneStrategy(strategies[i]);
+
+                    if (s.empty()) {
+                        return Ptr<SelectiveSearchSegmentationStrategy>();
+                    }
+
+                    c->addStrategy(s, weights[i]);
+                }
+
+                return c;
+            }
+
             void SelectiveSearchSegmentationStrategyMultipleImpl::addStrategy(Ptr<SelectiveSearchSegmentationStrategy> g, float weight) {
                 strategies.push_back(g);
                 weights.push_back(weight);
@@ -427,25 +544,7 @@ namespace cv {
 
                 int nb_segs = (int)max + 1;
 
-                // Build a list of points for each regions
-                std::vector<std::vector<cv::Point> > points;
-
-                points.resize(nb_segs);
-
-                for (int i = 0; i < (int)regions.rows; i++) {
-                    const int* p = regions.ptr<int>(i);
-
-                    for (int j = 0; j < (int)regions.cols; j++) {
-                        points[p[j]].push_back(cv::Point(j, i));
-                    }
-                }
-
-                // Compute bounding rects for each regions
-                bounding_rects.resize(nb_segs);
-
-                for(int seg = 0; seg < nb_segs; seg++) {
-                    bounding_rects[seg] = cv::boundingRect(points[seg]);
-                }
+                computeRegionsBoundingRects(regions, nb_segs, bounding_rects);
             }
 
             float SelectiveSearchSegmentationStrategyFillImpl::get(int r1, int r2) {
@@ -686,6 +785,30 @@ namespace cv {
                 return s;
             }
 
+            // Create a fresh instance of a built-in strategy, so it can be run concurrently with the original one.
+            // Returns an empty pointer for strategies implemented outside of this module.
+            static Ptr<SelectiveSearchSegmentationStrategy> cloneStrategy(const Ptr<SelectiveSearchSegmentationStrategy>& s) {
+                SelectiveSearchSegmentationStrategy* p = s.get();
+
+                if (dynamic_cast<SelectiveSearchSegmentationStrategyColorImpl*>(p)) {
+                    return createSelectiveSearchSegmentationStrategyColor();
+                }
+                if (dynamic_cast<SelectiveSearchSegmentationStrategySizeImpl*>(p)) {
+                    return createSelectiveSearchSegmentationStrategySize();
+                }
+                if (dynamic_cast<SelectiveSearchSegmentationStrategyFillImpl*>(p)) {
+                    return createSelectiveSearchSegmentationStrategyFill();
+                }
+                if (dynamic_cast<SelectiveSearchSegmentationStrategyTextureImpl*>(p)) {
+                    return createSelectiveSearchSegmentationStrategyTexture();
+                }
+                if (SelectiveSearchSegmentationStrategyMultipleImpl* m = dynamic_cast<SelectiveSearchSegmentationStrategyMultipleImpl*>(p)) {
+                    return m->clone();
+                }
+
+                return Ptr<SelectiveSearchSegmentationStrategy>();
+            }
+
             // Core
 
             class SelectiveSearchSegmentationImpl CV_FINAL : public SelectiveSearchSegmentation {
@@ -731,7 +854,7 @@ namespace cv {
                     std::vector<Ptr<GraphSegmentation> > segmentations;
                     std::vector<Ptr<SelectiveSearchSegmentationStrategy> > strategies;
 
-                    void hierarchicalGrouping(const Mat& img, Ptr<SelectiveSearchSegmentationStrategy>& s, const Mat& img_regions, const Mat_<char>& is_neighbour, const Mat_<int>& sizes, int& nb_segs, const std::vector<Rect>& bounding_rects, std::vector<Region>& regions, int region_id);
+                    void hierarchicalGrouping(const Mat& img, Ptr<SelectiveSearchSegmentationStrategy>& s, const InitialSegmentation& seg, std::vector<Region>& regions, int image_id);
             };
 
             void SelectiveSearchSegmentationImpl::setBaseImage(InputArray img) {
@@ -884,76 +1007,131 @@ namespace cv {
                 addStrategy(size3);
             }
 
-            void SelectiveSearchSegmentationImpl::process(std::vector<Rect>& rects) {
+            // Compute the initial segmentation of an image, with the size, bounding rect and neighbours of each region
+            static void computeInitialSegmentation(const Mat& image, const Ptr<GraphSegmentation>& gs, InitialSegmentation& seg) {
 
-                std::vector<Region> all_regions;
+                gs->processImage(image, seg.img_regions);
 
-                int image_id = 0;
+                // Get number of regions
+                double min, max;
+                minMaxLoc(seg.img_regions, &min, &max);
+                seg.nb_segs = (int)max + 1;
 
-                for(std::vector<Mat>::iterator image = images.begin(); image != images.end(); ++image) {
-                    for(std::vector<Ptr<GraphSegmentation> >::iterator gs = segmentations.begin(); gs != segmentations.end(); ++gs) {
+                computeRegionsBoundingRects(seg.img_regions, seg.nb_segs, seg.bounding_rects, &seg.sizes);
 
-                        Mat img_regions;
-                        Mat_<char> is_neighbour;
-                        Mat_<int> sizes;
+                // Collect the pairs of touching regions, smallest label first
+                std::vector<std::pair<int, int> > pairs;
 
-                        // Compute initial segmentation
-                        (*gs)->processImage(*image, img_regions);
+                for (int i = 1; i < seg.img_regions.rows; i++) {
+                    const int* p = seg.img_regions.ptr<int>(i);
+                    const int* previous_p = seg.img_regions.ptr<int>(i - 1);
 
-                        // Get number of regions
-                        double min, max;
-                        minMaxLoc(img_regions, &min, &max);
-                        int nb_segs = (int)max + 1;
+                    for (int j = 1; j < seg.img_regions.cols; j++) {
+                        const int others[3] = {p[j - 1], previous_p[j], previous_p[j - 1]};
 
-                        // Compute bouding rects and neighbours
-                        std::vector<Rect> bounding_rects;
-                        bounding_rects.resize(nb_segs);
+                        for (int n = 0; n < 3; n++) {
+                            if (others[n] != p[j]) {
+                                std::pair<int, int> pair(std::min(p[j], others[n]), std::max(p[j], others[n]));
 
-                        std::vector<std::vector<cv::Point> > points;
+                                if (pairs.empty() || pairs.back() != pair) {
+                                    pairs.push_back(pair);
+                                }
+                            }
+                        }
+                    }
+                }
+
+                std::sort(pairs.begin(), pairs.end());
+                pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
 
-                        points.resize(nb_segs);
+                // Store them as sorted adjacency lists. As pairs are sorted, the neighbours with a smaller label are
+                // inserted in each list before the ones with a bigger label.
+                seg.neighbours_offsets.assign(seg.nb_segs + 1, 0);
+                seg.neighbours.resize(2 * pairs.size());
 
-                        is_neighbour = Mat::zeros(nb_segs, nb_segs, CV_8UC1);
-                        sizes = Mat::zeros(nb_segs, 1, CV_32SC1);
+                for (size_t n = 0; n < pairs.size(); n++) {
+                    seg.neighbours_offsets[pairs[n].first + 1]++;
+                    seg.neighbours_offsets[pairs[n].second + 1]++;
+                }
 
-                        const int* previous_p = NULL;
+                for (int r = 0; r < seg.nb_segs; r++) {
+                    seg.neighbours_offsets[r + 1] += seg.neighbours_offsets[r];
+                }
 
-                        for (int i = 0; i < (int)img_regions.rows; i++) {
-                            const int* p = img_regions.ptr<int>(i);
+                std::vector<int> positions(seg.neighbours_offsets.begin(), seg.neighbours_offsets.end() - 1);
 
-                            for (int j = 0; j < (int)img_regions.cols; j++) {
+                for (size_t n = 0; n < pairs.size(); n++) {
+                    seg.neighbours[positions[pairs[n].first]++] = pairs[n].second;
+                    seg.neighbours[positions[pairs[n].second]++] = pairs[n].first;
+                }
+            }
 
-                                points[p[j]].push_back(cv::Point(j, i));
-                                sizes.at<int>(p[j], 0) = sizes.at<int>(p[j], 0) + 1;
+            void SelectiveSearchSegmentationImpl::process(std::vector<Rect>& rects) {
 
-                                if (i > 0 && j > 0) {
+                const int nb_segmentations = (int)segmentations.size();
+                const int nb_strategies = (int)strategies.size();
+                const int nb_initial_segmentations = (int)images.size() * nb_segmentations;
 
-                                    is_neighbour.at<char>(p[j], p[j - 1]) = 1;
-                                    is_neighbour.at<char>(p[j], previous_p[j]) = 1;
-                                    is_neighbour.at<char>(p[j], previous_p[j - 1]) = 1;
+                // Compute initial segmentations, for each image and graph segmentation. Built-in graph segmentations
+                // are run concurrently; other ones may not be thread safe, so they are run sequentially.
+                std::vector<InitialSegmentation> initial_segmentations(nb_initial_segmentations);
+                std::vector<char> concurrent(nb_segmentations);
 
-                                    is_neighbour.at<char>(p[j - 1], p[j]) = 1;
-                                    is_neighbour.at<char>(previous_p[j], p[j]) = 1;
-                                    is_neighbour.at<char>(previous_p[j - 1], p[j]) = 1;
-                                }
-                            }
-                            previous_p = p;
-                        }
+                for (int g = 0; g < nb_segmentations; g++) {
+                    concurrent[g] = isGraphSegmentationImpl(segmentations[g]);
+                }
 
-                        for(int seg = 0; seg < nb_segs; seg++) {
-                            bounding_rects[seg] = cv::boundingRect(points[seg]);
+                parallel_for_(Range(0, nb_initial_segmentations), [&](const Range& range) {
+                    for (int i = range.start; i < range.end; i++) {
+                        if (concurrent[i % nb_segmentations]) {
+                            computeInitialSegmentation(images[i / nb_segmentations], segmentations[i % nb_segmentations], initial_segmentations[i]);
                         }
+                    }
+                });
 
-                        for(std::vector<Ptr<SelectiveSearchSegmentationStrategy> >::iterator strategy = strategies.begin(); strategy != strategies.end(); ++strategy) {
-                            std::vector<Region> regions;
-                            hierarchicalGrouping(*image, *strategy, img_regions, is_neighbour, sizes, nb_segs, bounding_rects, regions, image_id);
+                for (int i = 0; i < nb_initial_segmentations; i++) {
+                    if (!concurrent[i % nb_segmentations]) {
+                        computeInitialSegmentation(images[i / nb_segmentations], segmentations[i % nb_segmentations], initial_segmentations[i]);
+                    }
+                }
 
-                            for(std::vector<Region>::iterator region = regions.begin(); region != regions.end(); ++region) {
-                                all_regions.push_back(*region);
-                            }
+                // Group regions for each initial segmentation and strategy. Built-in strategies are cloned, so all
+                // combinations can run concurrently; other strategies are run sequentially on the given instance.
+                std::vector<std::vector<Region> > grouped_regions(nb_initial_segmentations * nb_strategies);
+                std::vector<char> cloneable(nb_strategies);
+
+                for (int k = 0; k < nb_strategies; k++) {
+                    cloneable[k] = !cloneStrategy(strategies[k]).empty();
+                }
+
+                parallel_for_(Range(0, (int)grouped_regions.size()), [&](const Range& range) {
+                    for (int c = range.start; c < range.end; c++) {
+                        const int i = c / nb_strategies, k = c % nb_strategies;
+
+                        if (cloneable[k]) {
+                            Ptr<SelectiveSearchSegmentationStrategy> strategy = cloneStrategy(strategies[k]);
+                            hierarchicalGrouping(images[i / nb_segmentations], strategy, initial_segmentations[i], grouped_regions[c], i);
                         }
+                    }
+                });
+
+                for (int c = 0; c < (int)grouped_regions.size(); c++) {
+                    const int i = c / nb_strategies, k = c % nb_strategies;
 
-                        image_id++;
+                    if (!cloneable[k]) {
+                        hierarchicalGrouping(images[i / nb_segmentations], strategies[k], initial_segmentations[i], grouped_regions[c], i);
+                    }
+                }
+
+                // Compute regions' rank. This is done sequentially, in the same order as the grouping, so the result
+                // only depends on the random seed.
+                std::vector<Region> all_regions;
+
+                for (size_t c = 0; c < grouped_regions.size(); c++) {
+                    for(std::vector<Region>::iterator region = grouped_regions[c].begin(); region != grouped_regions[c].end(); ++region) {
+                        // Note: this is inverted from the paper, but we keep the lover region first so it's works
+                        (*region).rank = ((double) rand() / (RAND_MAX)) * ((*region).level);
+                        all_regions.push_back(*region);
                     }
                 }
 
@@ -973,16 +1151,24 @@ namespace cv {
 
             }
 
-            void SelectiveSearchSegmentationImpl::hierarchicalGrouping(const Mat& img, Ptr<SelectiveSearchSegmentationStrategy>& s, const Mat& img_regions, const Mat_<char>& is_neighbour, const Mat_<int>& sizes_, int& nb_segs, const std::vector<Rect>& bounding_rects, std::vector<Region>& regions, int image_id) {
+            void SelectiveSearchSegmentationImpl::hierarchicalGrouping(const Mat& img, Ptr<SelectiveSearchSegmentationStrategy>& s, const InitialSegmentation& seg, std::vector<Region>& regions, int image_id) {
+
+                const int nb_segs = seg.nb_segs;
+                Mat sizes = seg.sizes.clone();
 
-                Mat sizes = sizes_.clone();
+                // Similarities are never removed from the queue: the ones involving an already merged region are skipped
+                std::priority_queue<Neighbour> similarities;
+
+                // Sorted neighbours of each (non merged) region
+                std::vector<std::vector<int> > neighbours(nb_segs);
 
-                std::vector<Neighbour> similarities;
                 regions.clear();
+                regions.reserve(2 * nb_segs);
+                neighbours.reserve(2 * nb_segs);
 
                 /////////////////////////////////////////
 
-                s->setImage(img, img_regions, sizes, image_id);
+                s->setImage(img, seg.img_regions, sizes, image_id);
 
                 // Compute initial similarities
                 for (int i = 0; i < nb_segs; i++) {
@@ -991,32 +1177,36 @@ namespace cv {
                     r.id = i;
                     r.level = 1;
                     r.merged_to = -1;
-                    r.bounding_box = bounding_rects[i];
+                    r.bounding_box = seg.bounding_rects[i];
 
                     regions.push_back(r);
 
-                    for (int j = i + 1; j < nb_segs; j++) {
-                        if (is_neighbour.at<char>(i, j)) {
-                            Neighbour n;
-                            n.from = i;
-                            n.to = j;
-                            n.similarity = s->get(i, j);
+                    neighbours[i].assign(seg.neighbours.begin() + seg.neighbours_offsets[i], seg.neighbours.begin() + seg.neighbours_offsets[i + 1]);
+
+                    for (size_t n = 0; n < neighbours[i].size(); n++) {
+                        const int j = neighbours[i][n];
 
-                            similarities.push_back(n);
+                        if (j > i) {
+                            Neighbour nb;
+                            nb.from = i;
+                            nb.to = j;
+                            nb.similarity = s->get(i, j);
+
+                            similarities.push(nb);
                         }
                     }
                 }
 
-                while(similarities.size() > 0) {
+                std::vector<int> local_neighbours;
 
-                    std::sort(similarities.begin(), similarities.end());
+                while(!similarities.empty()) {
 
-                    // for(std::vector<Neighbour>::iterator similarity = similarities.begin(); similarity != similarities.end(); ++similarity) {
-                    //     std::cout << *similarity << std::endl;
-                    // }
+                    Neighbour p = similarities.top();
+                    similarities.pop();
 
-                    Neighbour p = similarities.back();
-                    similarities.pop_back();
+                    if (regions[p.from].merged_to != -1 || regions[p.to].merged_to != -1) {
+                        continue;
+                    }
 
                     Region region_from = regions[p.from];
                     Region region_to = regions[p.to];
@@ -1029,8 +1219,10 @@ namespace cv {
 
                     regions.push_back(new_r);
 
-                    regions[p.from].merged_to = (int)regions.size() - 1;
-                    regions[p.to].merged_to = (int)regions.size() - 1;
+                    const int new_index = (int)regions.size() - 1;
+
+                    regions[p.from].merged_to = new_index;
+                    regions[p.to].merged_to = new_index;
 
                     // Merge
                     s->merge(region_from.id, region_to.id);
@@ -1039,51 +1231,30 @@ namespace cv {
                     sizes.at<int>(region_from.id, 0) += sizes.at<int>(region_to.id, 0);
                     sizes.at<int>(region_to.id, 0) = sizes.at<int>(region_from.id, 0);
 
-                    std::vector<int> local_neighbours;
-
-                    for(std::vector<Neighbour>::iterator similarity = similarities.begin(); similarity != similarities.end();) {
-                        if ((*similarity).from == p.from || (*similarity).to == p.from || (*similarity).from == p.to || (*similarity).to == p.to) {
-                            int from = 0;
-
-                            if ((*similarity).from == p.from || (*similarity).from == p.to) {
-                                from = (*similarity).to;
-                            } else {
-                                from = (*similarity).from;
-                            }
-
-                            bool already_neighboor = false;
-
-                            for(std::vector<int>::iterator local_neighbour = local_neighbours.begin(); local_neighbour != local_neighbours.end(); local_neighbour++) {
-                                if (*local_neighbour == from) {
-                                    already_neighboor = true;
-                                }
-                            }
-
-                            if (!already_neighboor) {
-                                local_neighbours.push_back(from);
-                            }
+                    // Neighbours of the new region are the union of both lists, without the merged regions
+                    local_neighbours.clear();
+                    std::set_union(neighbours[p.from].begin(), neighbours[p.from].end(), neighbours[p.to].begin(), neighbours[p.to].end(), std::back_inserter(local_neighbours));
+                    local_neighbours.erase(std::remove_if(local_neighbours.begin(), local_neighbours.end(), [&](int r) { return r == p.from || r == p.to; }), local_neighbours.end());
 
-                            similarity = similarities.erase(similarity);
-                        } else {
-                            similarity++;
-                        }
-                    }
+                    std::vector<int>().swap(neighbours[p.from]);
+                    std::vector<int>().swap(neighbours[p.to]);
 
                     for(std::vector<int>::iterator local_neighbour = local_neighbours.begin(); local_neighbour != local_neighbours.end(); local_neighbour++) {
 
+                        // The new region has the highest index, so the list stays sorted
+                        std::vector<int>& l = neighbours[*local_neighbour];
+                        l.erase(std::remove_if(l.begin(), l.end(), [&](int r) { return r == p.from || r == p.to; }), l.end());
+                        l.push_back(new_index);
+
                         Neighbour n;
-                        n.from = (int)regions.size() - 1;
+                        n.from = new_index;
                         n.to = *local_neighbour;
                         n.similarity = s->get(regions[n.from].id, regions[n.to].id);
 
-                        similarities.push_back(n);
+                        similarities.push(n);
                     }
-                }
 
-                // Compute regions' rank
-                for(std::vector<Region>::iterator region = regions.begin(); region != regions.end(); ++region) {
-                    // Note: this is inverted from the paper, but we keep the lover region first so it's works
-                    (*region).rank = ((double) rand() / (RAND_MAX)) * ((*region).level);
+                    neighbours.push_back(local_neighbours);
                 }
 
             }
@@ -0,0 +1,150 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+using namespace cv::ximgproc::segmentation;
+
+struct RefEdge
+{
+    int from, to;
+    float weight;
+};
+
+static bool refEdgeLess(const RefEdge& a, const RefEdge& b) { return a.weight < b.weight; }
+
+static int refFind(std::vector<int>& parent, int p)
+{
+    int base = p;
+    while (parent[base] != base)
+        base = parent[base];
+    parent[p] = base;
+    return base;
+}
+
+static int refJoin(std::vector<int>& parent, std::vector<int>& size, int a, int b)
+{
+    if (size[a] < size[b])
+        std::swap(a, b);
+    parent[b] = a;
+    size[a] += size[b];
+    return a;
+}
+
+// Felzenszwalb segmentation of a single channel image, with the edges sorted by std::stable_sort
+static Mat refGraphSegmentation(const Mat& img, double sigma, float k, int min_size)
+{
+    CV_Assert(img.channels() == 1);
+
+    Mat img_converted, img_filtered;
+    img.convertTo(img_converted, CV_32F);
+    GaussianBlur(img_converted, img_filtered, Size(0, 0), sigma, sigma);
+
+    // Same order as GraphSegmentationImpl::buildGraph: right edges first, then bottom ones, in raster order
+    const int rows = img.rows, cols = img.cols;
+    std::vector<RefEdge> edges;
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols - 1; j++)
+        {
+            float d = img_filtered.at<float>(i, j) - img_filtered.at<float>(i, j + 1);
+            RefEdge e = { i * cols + j, i * cols + j + 1, std::sqrt(d * d) };
+            edges.push_back(e);
+        }
+    for (int i = 0; i < rows - 1; i++)
+        for (int j = 0; j < cols; j++)
+        {
+            float d = img_filtered.at<float>(i, j) - img_filtered.at<float>(i + 1, j);
+            RefEdge e = { i * cols + j, (i + 1) * cols + j, std::sqrt(d * d) };
+            edges.push_back(e);
+        }
+
+    std::stable_sort(edges.begin(), edges.end(), refEdgeLess);
+
+    const int total = rows * cols;
+    std::vector<int> parent(total), size(total, 1);
+    for (int p = 0; p < total; p++)
+        parent[p] = p;
+    std::vector<float> thresholds(total, k);
+
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+        int a = refFind(parent, edges[i].from), b = refFind(parent, edges[i].to);
+        if (a != b && edges[i].weight <= thresholds[a] && edges[i].weight <= thresholds[b])
+        {
+            a = refJoin(parent, size, a, b);
+            thresholds[a] = edges[i].weight + k / size[a];
+            edges[i].weight = 0;
+        }
+    }
+
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+        if (edges[i].weight > 0)
+        {
+            int a = refFind(parent, edges[i].from), b = refFind(parent, edges[i].to);
+            if (a != b && (size[a] < min_size || size[b] < min_size))
+                refJoin(parent, size, a, b);
+        }
+    }
+
+    Mat labels(rows, cols, CV_32SC1);
+    std::vector<int> mapped_id(total, -1);
+    int last_id = 0;
+    for (int p = 0; p < total; p++)
+    {
+        int base = refFind(parent, p);
+        if (mapped_id[base] == -1)
+            mapped_id[base] = last_id++;
+        labels.at<int>(p / cols, p % cols) = mapped_id[base];
+    }
+    return labels;
+}
+
+TEST(ximgproc_GraphSegmentation, same_as_stable_sort)
+{
+    Mat img = imread(cvtest::findDataFile("cv/shared/lena.png"), IMREAD_GRAYSCALE);
+    ASSERT_FALSE(img.empty());
+    // big enough for the radix sort to be split in several chunks
+    resize(img, img, Size(), 0.75, 0.75, INTER_AREA);
+
+    Ptr<GraphSegmentation> gs = createGraphSegmentation(0.5, 300, 100);
+
+    Mat labels;
+    gs->processImage(img, labels);
+
+    EXPECT_EQ(0, cvtest::norm(labels, refGraphSegmentation(img, 0.5, 300, 100), NORM_INF));
+}
+
+TEST(ximgproc_GraphSegmentation, streaming_same_as_single_shot)
+{
+    Mat lena = imread(cvtest::findDataFile("cv/shared/lena.png"), IMREAD_COLOR);
+    ASSERT_FALSE(lena.empty());
+
+    // a few frames of the same size, then a smaller one and back to the first size
+    std::vector<Mat> frames;
+    frames.push_back(lena(Rect(0, 0, 320, 240)));
+    frames.push_back(lena(Rect(8, 4, 320, 240)));
+    frames.push_back(lena(Rect(16, 8, 320, 240)));
+    frames.push_back(lena(Rect(100, 100, 160, 200)));
+    frames.push_back(lena(Rect(24, 12, 320, 240)));
+
+    Ptr<GraphSegmentation> single = createGraphSegmentation();
+    Ptr<GraphSegmentation> streaming = createGraphSegmentation();
+    streaming->setStreamingMode(true);
+    ASSERT_TRUE(streaming->getStreamingMode());
+
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        Mat ref, res;
+        single->processImage(frames[i], ref);
+        streaming->processImage(frames[i], res);
+
+        ASSERT_EQ(ref.size(), res.size()) << "frame " << i;
+        EXPECT_EQ(0, cvtest::norm(ref, res, NORM_INF)) << "frame " << i;
+    }
+}
+
+}} // namespace
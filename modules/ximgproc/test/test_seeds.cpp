@@ -0,0 +1,69 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+static Mat loadLab(const Rect& roi)
+{
+    Mat img = imread(cvtest::findDataFile("cv/shared/lena.png"), IMREAD_COLOR);
+    CV_Assert(!img.empty());
+    Mat labImg;
+    cvtColor(img(roi), labImg, COLOR_BGR2Lab);
+    return labImg;
+}
+
+static Ptr<SuperpixelSEEDS> createSeeds(const Mat& img, bool double_step)
+{
+    return createSuperpixelSEEDS(img.cols, img.rows, img.channels(), 400, 4, 2, 5, double_step);
+}
+
+TEST(ximgproc_SuperpixelSEEDS, warm_start_without_previous_iterate)
+{
+    Mat img = loadLab(Rect(0, 0, 512, 512));
+
+    Ptr<SuperpixelSEEDS> ref = createSeeds(img, false);
+    Ptr<SuperpixelSEEDS> warm = createSeeds(img, false);
+    ref->iterate(img, 4);
+    warm->iterateWarmStart(img, 4);
+
+    Mat refLabels, warmLabels;
+    ref->getLabels(refLabels);
+    warm->getLabels(warmLabels);
+
+    EXPECT_EQ(ref->getNumberOfSuperpixels(), warm->getNumberOfSuperpixels());
+    EXPECT_EQ(0, cvtest::norm(refLabels, warmLabels, NORM_INF));
+}
+
+typedef testing::TestWithParam<bool> SuperpixelSEEDS_Threads;
+
+TEST_P(SuperpixelSEEDS_Threads, labels_do_not_depend_on_thread_count)
+{
+    const bool double_step = GetParam();
+    Mat frame0 = loadLab(Rect(0, 0, 480, 400));
+    Mat frame1 = loadLab(Rect(12, 6, 480, 400));
+
+    const int nthreads = getNumThreads();
+    Mat labels[2][2];
+    for (int run = 0; run < 2; run++)
+    {
+        // the first run is the sequential scan, the second one uses at least 4 threads
+        setNumThreads(run == 0 ? 1 : std::max(nthreads, 4));
+
+        Ptr<SuperpixelSEEDS> seeds = createSeeds(frame0, double_step);
+        seeds->iterate(frame0, 4);
+        seeds->getLabels(labels[run][0]);
+        seeds->iterateWarmStart(frame1, 2);
+        seeds->getLabels(labels[run][1]);
+    }
+    setNumThreads(nthreads);
+
+    EXPECT_EQ(0, cvtest::norm(labels[0][0], labels[1][0], NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(labels[0][1], labels[1][1], NORM_INF));
+}
+
+INSTANTIATE_TEST_CASE_P(ximgproc, SuperpixelSEEDS_Threads, testing::Bool());
+
+}} // namespace
@@ -0,0 +1,131 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+using namespace cv::ximgproc::segmentation;
+
+// A user-defined graph segmentation, which process() runs sequentially
+class WrappedGraphSegmentation : public GraphSegmentation
+{
+public:
+    WrappedGraphSegmentation(const Ptr<GraphSegmentation>& gs_) : gs(gs_) {}
+
+    void processImage(InputArray src, OutputArray dst) CV_OVERRIDE { gs->processImage(src, dst); }
+    void setSigma(double sigma) CV_OVERRIDE { gs->setSigma(sigma); }
+    double getSigma() CV_OVERRIDE { return gs->getSigma(); }
+    void setK(float k) CV_OVERRIDE { gs->setK(k); }
+    float getK() CV_OVERRIDE { return gs->getK(); }
+    void setMinSize(int min_size) CV_OVERRIDE { gs->setMinSize(min_size); }
+    int getMinSize() CV_OVERRIDE { return gs->getMinSize(); }
+    void setStreamingMode(bool streaming) CV_OVERRIDE { gs->setStreamingMode(streaming); }
+    bool getStreamingMode() CV_OVERRIDE { return gs->getStreamingMode(); }
+
+private:
+    Ptr<GraphSegmentation> gs;
+};
+
+static bool rectLess(const Rect& a, const Rect& b)
+{
+    if (a.y != b.y) return a.y < b.y;
+    if (a.x != b.x) return a.x < b.x;
+    if (a.height != b.height) return a.height < b.height;
+    return a.width < b.width;
+}
+
+static std::vector<Rect> processSorted(const Ptr<SelectiveSearchSegmentation>& ss)
+{
+    std::vector<Rect> rects;
+    ss->process(rects);
+    std::sort(rects.begin(), rects.end(), rectLess);
+    return rects;
+}
+
+TEST(ximgproc_SelectiveSearchSegmentation, quadrants)
+{
+    // Four uniform quadrants: the graph segmentation finds them exactly, and as they all have the same
+    // size, the size strategy sees six equal similarities. The tie-break on the region ids merges
+    // the top quadrants first, then the bottom ones, then both halves.
+    Mat img(128, 128, CV_8UC3);
+    img(Rect(0, 0, 64, 64)).setTo(Scalar(0, 0, 0));
+    img(Rect(64, 0, 64, 64)).setTo(Scalar(255, 0, 0));
+    img(Rect(0, 64, 64, 64)).setTo(Scalar(0, 255, 0));
+    img(Rect(64, 64, 64, 64)).setTo(Scalar(0, 0, 255));
+
+    Ptr<SelectiveSearchSegmentation> ss = createSelectiveSearchSegmentation();
+    ss->addImage(img);
+    ss->addGraphSegmentation(createGraphSegmentation(0.001, 300, 100));
+    ss->addStrategy(createSelectiveSearchSegmentationStrategySize());
+
+    std::vector<Rect> golden;
+    golden.push_back(Rect(0, 0, 64, 64));
+    golden.push_back(Rect(64, 0, 64, 64));
+    golden.push_back(Rect(0, 64, 64, 64));
+    golden.push_back(Rect(64, 64, 64, 64));
+    golden.push_back(Rect(0, 0, 128, 64));
+    golden.push_back(Rect(0, 64, 128, 64));
+    golden.push_back(Rect(0, 0, 128, 128));
+    std::sort(golden.begin(), golden.end(), rectLess);
+
+    std::vector<Rect> rects = processSorted(ss);
+    ASSERT_EQ(golden.size(), rects.size());
+    for (size_t i = 0; i < golden.size(); i++)
+        EXPECT_EQ(golden[i], rects[i]) << "rect " << i;
+}
+
+TEST(ximgproc_SelectiveSearchSegmentation, user_segmentation_same_as_builtin)
+{
+    Mat img = imread(cvtest::findDataFile("cv/shared/lena.png"), IMREAD_COLOR);
+    ASSERT_FALSE(img.empty());
+    resize(img, img, Size(128, 128), 0, 0, INTER_AREA);
+    Mat lab;
+    cvtColor(img, lab, COLOR_BGR2Lab);
+
+    Ptr<SelectiveSearchSegmentation> builtin = createSelectiveSearchSegmentation();
+    Ptr<SelectiveSearchSegmentation> user = createSelectiveSearchSegmentation();
+
+    for (int k = 150; k <= 450; k += 150)
+    {
+        builtin->addGraphSegmentation(createGraphSegmentation(0.8, (float)k, 100));
+        user->addGraphSegmentation(makePtr<WrappedGraphSegmentation>(createGraphSegmentation(0.8, (float)k, 100)));
+    }
+
+    Ptr<SelectiveSearchSegmentation> ss[2] = { builtin, user };
+    for (int i = 0; i < 2; i++)
+    {
+        ss[i]->addImage(img);
+        ss[i]->addImage(lab);
+        ss[i]->addStrategy(createSelectiveSearchSegmentationStrategyMultiple(
+                createSelectiveSearchSegmentationStrategyColor(), createSelectiveSearchSegmentationStrategyFill(),
+                createSelectiveSearchSegmentationStrategyTexture(), createSelectiveSearchSegmentationStrategySize()));
+        ss[i]->addStrategy(createSelectiveSearchSegmentationStrategySize());
+    }
+
+    // the ranks are drawn with rand(), so the same seed gives the same order
+    std::vector<Rect> ref, res;
+    srand(0);
+    builtin->process(ref);
+    srand(0);
+    user->process(res);
+
+    ASSERT_FALSE(ref.empty());
+    ASSERT_EQ(ref.size(), res.size());
+    for (size_t i = 0; i < ref.size(); i++)
+        EXPECT_EQ(ref[i], res[i]) << "rect " << i;
+
+    // and the result does not depend on the number of threads
+    const int nthreads = getNumThreads();
+    setNumThreads(1);
+    srand(0);
+    builtin->process(res);
+    setNumThreads(nthreads);
+
+    ASSERT_EQ(ref.size(), res.size());
+    for (size_t i = 0; i < ref.size(); i++)
+        EXPECT_EQ(ref[i], res[i]) << "rect " << i;
+}
+
+}} // namespace
@@ -179,6 +179,94 @@ namespace cv
             int normType = cv::NORM_L2,
             int step = cv::xphoto::BM3D_STEPALL,
             int transformType = cv::xphoto::HAAR);
+
+        /** @brief BM3D denoiser intended for video streams.
+
+        The denoiser keeps its working buffers and the 2D transforms of the blocks between calls, so
+        consecutive frames of the same size are processed without reallocations. If temporalWindowSize
+        is positive, the denoiser works in VBM3D mode: similar blocks are also searched in the given
+        number of previously processed frames (in the same search window), which yields larger 3D groups
+        and better denoising of video at the cost of proportionally slower block matching.
+
+        With temporalWindowSize equal to 0 the result of denoise() is the same as the result of
+        bm3dDenoising() with the same parameters. Only Haar transform is supported.
+
+        When it pays off, the transformed blocks of the stored frames are cached between the steps and
+        the frames, within a budget of 256 MB. Larger frames are transformed block by block.
+
+        @sa
+        bm3dDenoising
+        */
+        class CV_EXPORTS_W Bm3dDenoiser : public Algorithm
+        {
+        public:
+            /** @brief Denoises the next frame of the stream.
+
+            @param src Input 8-bit or 16-bit 1-channel image. Frames of the stream are expected to have
+            the same size and type, otherwise the stored frames are discarded.
+            @param dst Output image with the same size and type as src. Contains the result of the
+            first step if the step is BM3D_STEP1 and the result of the second step otherwise.
+             */
+            CV_WRAP virtual void denoise(InputArray src, OutputArray dst) = 0;
+
+            /** @brief Discards the stored frames, so that the next frame starts a new stream. */
+            CV_WRAP virtual void reset() = 0;
+
+            CV_WRAP virtual float getH() const = 0;
+            CV_WRAP virtual void setH(float h) = 0;
+            CV_WRAP virtual int getTemplateWindowSize() const = 0;
+            CV_WRAP virtual void setTemplateWindowSize(int templateWindowSize) = 0;
+            CV_WRAP virtual int getSearchWindowSize() const = 0;
+            CV_WRAP virtual void setSearchWindowSize(int searchWindowSize) = 0;
+            CV_WRAP virtual int getBlockMatchingStep1() const = 0;
+            CV_WRAP virtual void setBlockMatchingStep1(int blockMatchingStep1) = 0;
+            CV_WRAP virtual int getBlockMatchingStep2() const = 0;
+            CV_WRAP virtual void setBlockMatchingStep2(int blockMatchingStep2) = 0;
+            CV_WRAP virtual int getGroupSize() const = 0;
+            CV_WRAP virtual void setGroupSize(int groupSize) = 0;
+            CV_WRAP virtual int getSlidingStep() const = 0;
+            CV_WRAP virtual void setSlidingStep(int slidingStep) = 0;
+            CV_WRAP virtual float getBeta() const = 0;
+            CV_WRAP virtual void setBeta(float beta) = 0;
+            CV_WRAP virtual int getNormType() const = 0;
+            CV_WRAP virtual void setNormType(int normType) = 0;
+            /** @brief Step of BM3D to be executed. Allowed are only BM3D_STEP1 and BM3D_STEPALL. */
+            CV_WRAP virtual int getStep() const = 0;
+            CV_WRAP virtual void setStep(int step) = 0;
+            /** @brief Number of previous frames searched for similar blocks. 0 disables the temporal search. */
+            CV_WRAP virtual int getTemporalWindowSize() const = 0;
+            CV_WRAP virtual void setTemporalWindowSize(int temporalWindowSize) = 0;
+        };
+
+        /** @brief Creates an instance of Bm3dDenoiser
+
+        @param h Parameter regulating filter strength.
+        @param templateWindowSize Size in pixels of the template patch that is used for block-matching.
+        @param searchWindowSize Size in pixels of the window that is used to perform block-matching.
+        @param blockMatchingStep1 Block matching threshold for the first step of BM3D (hard thresholding).
+        @param blockMatchingStep2 Block matching threshold for the second step of BM3D (Wiener filtering).
+        @param groupSize Maximum size of the 3D group for collaborative filtering.
+        @param slidingStep Sliding step to process every next reference block.
+        @param beta Kaiser window parameter.
+        @param normType Norm used to calculate distance between blocks.
+        @param step Step of BM3D to be executed. Allowed are only BM3D_STEP1 and BM3D_STEPALL.
+        @param temporalWindowSize Number of previous frames searched for similar blocks (VBM3D mode).
+        0 means that every frame is denoised independently.
+
+        See bm3dDenoising for the detailed description of the parameters.
+        */
+        CV_EXPORTS_W Ptr<Bm3dDenoiser> createBm3dDenoiser(
+            float h = 1,
+            int templateWindowSize = 4,
+            int searchWindowSize = 16,
+            int blockMatchingStep1 = 2500,
+            int blockMatchingStep2 = 400,
+            int groupSize = 8,
+            int slidingStep = 1,
+            float beta = 2.0f,
+            int normType = cv::NORM_L2,
+            int step = cv::xphoto::BM3D_STEPALL,
+            int temporalWindowSize = 0);
         //! @}
     }
 }
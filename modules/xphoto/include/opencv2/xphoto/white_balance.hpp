@@ -184,6 +184,25 @@ class CV_EXPORTS_W LearningBasedWB : public WhiteBalancer
     */
     CV_WRAP virtual void extractSimpleFeatures(InputArray src, OutputArray dst) = 0;
 
+    /** @brief Estimates illuminants of a batch of images.
+
+    Features of the images are extracted in parallel and the regression tree ensemble is evaluated for
+    the whole batch at once.
+
+    @param src Input three-channel images (BGR color space is assumed).
+    @param dst Output array of (r,g) chromaticity tuples of the illuminants, one per input image.
+    */
+    CV_WRAP virtual void estimateIlluminants(InputArrayOfArrays src, OutputArray dst) = 0;
+
+    /** @brief Applies white balancing to a batch of images.
+
+    Gives the same results as balanceWhite called for every image, but processes the images in parallel.
+
+    @param src Input three-channel images (BGR color space is assumed).
+    @param dst White balancing results, one per input image.
+    */
+    CV_WRAP virtual void balanceWhiteBatch(InputArrayOfArrays src, OutputArrayOfArrays dst) = 0;
+
     /** @brief Maximum possible value of the input image (e.g. 255 for 8 bit images,
                4095 for 12 bit images)
     @see setRangeMaxVal */
@@ -0,0 +1,54 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+#ifdef OPENCV_ENABLE_NONFREE
+
+namespace opencv_test { namespace {
+
+typedef tuple<Size, int> Size_TemporalWindow_t;
+typedef perf::TestBaseWithParam<Size_TemporalWindow_t> Size_TemporalWindow;
+
+PERF_TEST_P( Size_TemporalWindow, bm3d_Bm3dDenoiser,
+    testing::Combine(
+        testing::Values( szVGA, sz720p ),
+        testing::Values( 0, 2 )
+    )
+)
+{
+    Size size = get<0>(GetParam());
+    int temporalWindowSize = get<1>(GetParam());
+
+    Mat original = imread(getDataPath("cv/shared/lena.png"), IMREAD_GRAYSCALE);
+    ASSERT_FALSE(original.empty());
+    resize(original, original, size);
+
+    // Stream of noisy frames of a static scene
+    const int numFrames = temporalWindowSize + 1;
+    RNG rng(0);
+    std::vector<Mat> frames(numFrames);
+    for (int i = 0; i < numFrames; ++i)
+    {
+        Mat noise(size, CV_16S);
+        rng.fill(noise, RNG::NORMAL, 0, 10);
+        add(original, noise, frames[i], noArray(), CV_8U);
+    }
+
+    Ptr<xphoto::Bm3dDenoiser> denoiser = xphoto::createBm3dDenoiser(10);
+    denoiser->setTemporalWindowSize(temporalWindowSize);
+
+    // Fill the temporal window
+    Mat result;
+    for (int i = 0; i < numFrames - 1; ++i)
+        denoiser->denoise(frames[i], result);
+
+    declare.in(frames.back()).out(result).time(60);
+    TEST_CYCLE_N(1) denoiser->denoise(frames.back(), result);
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
+
+#endif
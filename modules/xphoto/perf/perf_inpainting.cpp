@@ -0,0 +1,66 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+typedef tuple<Size, double> Size_HoleRatio_t;
+typedef perf::TestBaseWithParam<Size_HoleRatio_t> Size_HoleRatio;
+
+PERF_TEST_P( Size_HoleRatio, inpaint_SHIFTMAP,
+    testing::Combine(
+        testing::Values( szODD, Size(1920, 1080) ),
+        testing::Values( 0.1, 0.25 )
+    )
+)
+{
+    Size size = get<0>(GetParam());
+    double holeRatio = get<1>(GetParam());
+
+    Mat original = imread(getDataPath("cv/shared/lena.png"), IMREAD_COLOR);
+    ASSERT_FALSE(original.empty());
+    resize(original, original, size, 0, 0, INTER_AREA);
+
+    // single rectangular hole covering holeRatio of the image, mask is zero in the hole
+    Size holeSize(cvRound(size.width*std::sqrt(holeRatio)), cvRound(size.height*std::sqrt(holeRatio)));
+    Rect hole(Point((size.width - holeSize.width)/2, (size.height - holeSize.height)/2), holeSize);
+    Mat mask(size, CV_8UC1, Scalar::all(255));
+    mask(hole).setTo(0);
+
+    Mat src(size, original.type(), Scalar::all(0)), dst;
+    original.copyTo(src, mask);
+
+    TEST_CYCLE_N(1) xphoto::inpaint(src, mask, dst, xphoto::INPAINT_SHIFTMAP);
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P( Size_HoleRatio, inpaint_FSR_FAST,
+    testing::Combine(
+        testing::Values( Size(512, 512) ),
+        testing::Values( 0.1, 0.25 )
+    )
+)
+{
+    Size size = get<0>(GetParam());
+    double holeRatio = get<1>(GetParam());
+
+    Mat original = imread(getDataPath("cv/shared/lena.png"), IMREAD_COLOR);
+    ASSERT_FALSE(original.empty());
+    resize(original, original, size, 0, 0, INTER_AREA);
+
+    Size holeSize(cvRound(size.width*std::sqrt(holeRatio)), cvRound(size.height*std::sqrt(holeRatio)));
+    Rect hole(Point((size.width - holeSize.width)/2, (size.height - holeSize.height)/2), holeSize);
+    Mat mask(size, CV_8UC1, Scalar::all(255));
+    mask(hole).setTo(0);
+
+    Mat src(size, original.type(), Scalar::all(0)), dst;
+    original.copyTo(src, mask);
+
+    TEST_CYCLE_N(1) xphoto::inpaint(src, mask, dst, xphoto::INPAINT_FSR_FAST);
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
@@ -36,5 +36,28 @@ PERF_TEST_P(learningBasedWBPerfTest, perf, Combine(SZ_ALL_HD, Values(CV_8UC3, CV
     SANITY_CHECK_NOTHING();
 }
 
+typedef tuple<Size, int> learningBasedWBBatchParams;
+typedef perf::TestBaseWithParam<learningBasedWBBatchParams> learningBasedWBBatchPerfTest;
+
+PERF_TEST_P(learningBasedWBBatchPerfTest, batch, Combine(Values(szVGA, sz1080p), Values(16)))
+{
+    Size size = get<0>(GetParam());
+    int batch_size = get<1>(GetParam());
+
+    RNG rng(1234);
+    vector<Mat> src(batch_size), dst;
+    for (int i = 0; i < batch_size; i++)
+    {
+        Mat src_dscl(Size(size.width / 16, size.height / 16), CV_8UC3);
+        rng.fill(src_dscl, RNG::UNIFORM, 0, 255);
+        resize(src_dscl, src[i], size, 0, 0, INTER_LINEAR_EXACT);
+    }
+    Ptr<xphoto::LearningBasedWB> wb = xphoto::createLearningBasedWB();
+
+    TEST_CYCLE() wb->balanceWhiteBatch(src, dst);
+
+    SANITY_CHECK_NOTHING();
+}
+
 
 }} // namespace
@@ -98,7 +98,7 @@ private:
     void operator =(const KDTree <Tp, cn> &) const {};
 
 public:
-    void updateDist(const int leaf, const int &idx0, int &bestIdx, double &dist);
+    void updateDist(const int leaf, const int &idx0, int &bestIdx, double &dist) const;
 
     KDTree(const cv::Mat &data, const int leafNumber = 8, const int zeroThresh = 16);
     ~KDTree(){};
@@ -131,6 +131,7 @@ KDTree(const cv::Mat &img, const int _leafNumber, const int _zeroThresh)
     int imgch = img.channels();
     CV_Assert( img.isContinuous() && imgch <= cn);
 
+    data.reserve(img.total());
     for(size_t i = 0; i < img.total(); i++)
     {
         cv::Vec<Tp, cn> v = cv::Vec<Tp, cn>::all((Tp)0);
@@ -149,6 +150,9 @@ KDTree(const cv::Mat &img, const int _leafNumber, const int _zeroThresh)
     left.push( 0 );
     right.push( int(idx.size()) );
 
+    // the comparator reads idx, so every node is partitioned in a copy of its range
+    std::vector <int> _idx;
+
     while ( !left.empty() )
     {
         int  _left = left.top();   left.pop();
@@ -166,13 +170,13 @@ KDTree(const cv::Mat &img, const int _leafNumber, const int _zeroThresh)
         int dimIdx = getMaxSpreadN(_left, _right);
         KDTreeComparator comp( this, dimIdx );
 
-        std::vector<int> _idx(idx.begin(), idx.end());
+        _idx.assign(idx.begin() + _left, idx.begin() + _right);
         std::nth_element(/**/
-            _idx.begin() +  _left,
-            _idx.begin() +    nth,
-            _idx.begin() + _right, comp
+            _idx.begin(),
+            _idx.begin() + (nth - _left),
+            _idx.end(), comp
                          /**/);
-        idx = _idx;
+        std::copy(_idx.begin(), _idx.end(), idx.begin() + _left);
 
           left.push(_left); right.push(nth + 1);
         left.push(nth + 1);  right.push(_right);
@@ -180,7 +184,7 @@ KDTree(const cv::Mat &img, const int _leafNumber, const int _zeroThresh)
 }
 
 template <typename Tp, int cn> void KDTree <Tp, cn>::
-updateDist(const int leaf, const int &idx0, int &bestIdx, double &dist)
+updateDist(const int leaf, const int &idx0, int &bestIdx, double &dist) const
 {
     for (int k = nodes[leaf].x; k < nodes[leaf].y; ++k)
     {
@@ -234,23 +238,47 @@ static void dominantTransforms(const cv::Mat &img, std::vector <cv::Point2i> &tr
 
     /** Propagation-assisted kd-tree search **/
 
-    for (int i = 0; i < whs.rows; ++i)
-        for (int j = 0; j < whs.cols; ++j)
+    // Every pixel propagates from its top and left neighbours, so the tiles
+    // are visited in anti-diagonal waves: the tiles of one wave only depend
+    // on the previous waves and are searched in parallel, with the same
+    // result as a raster scan.
+    const int tileSize = 32;
+    const int tilesY = (whs.rows + tileSize - 1)/tileSize,
+              tilesX = (whs.cols + tileSize - 1)/tileSize;
+
+    for (int wave = 0; wave < tilesY + tilesX - 1; ++wave)
+    {
+        const int firstTileY = std::max(0, wave - tilesX + 1),
+                   lastTileY = std::min(wave, tilesY - 1);
+
+        cv::parallel_for_(cv::Range(firstTileY, lastTileY + 1), [&](const cv::Range &range)
         {
-            double dist = std::numeric_limits <double>::max();
-            int current = i*whs.cols + j;
-
-            int dy[] = {0, 1, 0}, dx[] = {0, 0, 1};
-            for (int k = 0; k < int( sizeof(dy)/sizeof(int) ); ++k)
-                if ( i - dy[k] >= 0 && j - dx[k] >= 0 )
-                {
-                    int neighbor = (i - dy[k])*whs.cols + (j - dx[k]);
-                    int leafIdx = (dx[k] == 0 && dy[k] == 0)
-                        ? neighbor : annf[neighbor] + dy[k]*whs.cols + dx[k];
-                    kdTree.updateDist(leafIdx, current,
-                                annf[i*whs.cols + j], dist);
-                }
-        }
+            for (int ty = range.start; ty < range.end; ++ty)
+            {
+                const int tx = wave - ty;
+                const int iEnd = std::min((ty + 1)*tileSize, whs.rows),
+                          jEnd = std::min((tx + 1)*tileSize, whs.cols);
+
+                for (int i = ty*tileSize; i < iEnd; ++i)
+                    for (int j = tx*tileSize; j < jEnd; ++j)
+                    {
+                        double dist = std::numeric_limits <double>::max();
+                        int current = i*whs.cols + j;
+
+                        int dy[] = {0, 1, 0}, dx[] = {0, 0, 1};
+                        for (int k = 0; k < int( sizeof(dy)/sizeof(int) ); ++k)
+                            if ( i - dy[k] >= 0 && j - dx[k] >= 0 )
+                            {
+                                int neighbor = (i - dy[k])*whs.cols + (j - dx[k]);
+                                int leafIdx = (dx[k] == 0 && dy[k] == 0)
+                                    ? neighbor : annf[neighbor] + dy[k]*whs.cols + dx[k];
+                                kdTree.updateDist(leafIdx, current,
+                                            annf[i*whs.cols + j], dist);
+                            }
+                    }
+            }
+        });
+    }
 
     /** Local maxima extraction **/
 
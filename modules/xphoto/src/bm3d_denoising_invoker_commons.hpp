@@ -158,6 +158,31 @@ inline static int WienerFiltering(BlockMatch<T, DT, CT> *zSrc, BlockMatch<T, DT,
     return wienerCoeffs;
 }
 
+// Precomputes 2D transforms of all the blocks of the extended image, so that every block is
+// transformed once instead of once per 3D group it belongs to.
+template <typename T, typename TT, typename TC>
+inline static void calcTransformCache(const Mat &srcExtended, Mat &cache, const int &blockSize)
+{
+    CV_Assert(srcExtended.isContinuous());
+
+    const int blockSizeSq = blockSize * blockSize;
+    const int rows = srcExtended.rows - blockSize + 1;
+    const int cols = srcExtended.cols - blockSize + 1;
+    const int step = srcExtended.cols;
+
+    cache.create(rows, cols * blockSizeSq, DataType<TT>::depth);
+
+    parallel_for_(Range(0, rows), [&](const Range& range)
+    {
+        for (int y = range.start; y < range.end; ++y)
+        {
+            const T *s = srcExtended.ptr<T>(y);
+            TT *d = cache.ptr<TT>(y);
+            for (int x = 0; x < cols; ++x, d += blockSizeSq)
+                TC::forwardTransform2D(s + x, d, step, blockSize);
+        }
+    });
+}
 
 }  // namespace xphoto
 }  // namespace cv
@@ -55,10 +55,14 @@ template <typename T, typename D, typename WT, typename TT, typename TC>
 struct Bm3dDenoisingInvokerStep2 : public ParallelLoopBody
 {
 public:
+    // frames[0] is the frame being denoised, frames[1..numFrames-1] are the neighbouring
+    // frames searched for similar blocks (VBM3D). All frames must have srcExtended and
+    // basicExtended set.
     Bm3dDenoisingInvokerStep2(
-        const Mat& src,
-        const Mat& basic,
+        const Bm3dFrame *frames,
+        const int &numFrames,
         Mat& dst,
+        TLSData<Bm3dWorkspace<TT, WT> >& workspaces,
         const int &templateWindowSize,
         const int &searchWindowSize,
         const float &h,
@@ -76,6 +80,7 @@ private:
 
     void calcDistSumsForFirstElementInRow(
         int i,
+        int frame,
         Array2d<int>& distSums,
         Array3d<int>& colDistSums,
         Array3d<int>& lastColDistSums,
@@ -85,6 +90,18 @@ private:
     void calcDistSumsForAllElementsInFirstRow(
         int i,
         int j,
+        int frame,
+        int firstColNum,
+        Array2d<int>& distSums,
+        Array3d<int>& colDistSums,
+        Array3d<int>& lastColDistSums,
+        BlockMatch<TT, int, TT> *bm,
+        int &elementSize) const;
+
+    void calcDistSumsForElement(
+        int i,
+        int j,
+        int frame,
         int firstColNum,
         Array2d<int>& distSums,
         Array3d<int>& colDistSums,
@@ -93,11 +110,17 @@ private:
         int &elementSize) const;
 
     // Image containers
-    const Mat& src_;
-    const Mat& basic_;
+    const Bm3dFrame *frames_;
+    const int numFrames_;
+    const Mat& srcExtended_;
+    const Mat& basicExtended_;
     Mat& dst_;
-    Mat srcExtended_;
-    Mat basicExtended_;
+
+    // Per-thread buffers
+    TLSData<Bm3dWorkspace<TT, WT> >& workspaces_;
+
+    // Use precomputed 2D transforms of the blocks
+    bool useCache_;
 
     // Border size of the extended src and basic images
     int borderSize_;
@@ -132,9 +155,10 @@ private:
 
 template <typename T, typename D, typename WT, typename TT, typename TC>
 Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::Bm3dDenoisingInvokerStep2(
-    const Mat& src,
-    const Mat& basic,
+    const Bm3dFrame *frames,
+    const int &numFrames,
     Mat& dst,
+    TLSData<Bm3dWorkspace<TT, WT> >& workspaces,
     const int &templateWindowSize,
     const int &searchWindowSize,
     const float &h,
@@ -142,10 +166,13 @@ Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::Bm3dDenoisingInvokerStep2(
     const int &groupSize,
     const int &slidingStep,
     const float &beta) :
-    src_(src), basic_(basic), dst_(dst), groupSize_(groupSize), slidingStep_(slidingStep), thrMap_(NULL), kaiser_(NULL)
+    frames_(frames), numFrames_(numFrames), srcExtended_(frames[0].srcExtended),
+    basicExtended_(frames[0].basicExtended), dst_(dst), workspaces_(workspaces),
+    groupSize_(groupSize), slidingStep_(slidingStep), thrMap_(NULL), kaiser_(NULL)
 {
     groupSize_ = getLargestPowerOf2SmallerThan(groupSize);
     CV_Assert(groupSize > 0);
+    CV_Assert(numFrames > 0);
 
     halfTemplateWindowSize_ = templateWindowSize >> 1;
     halfSearchWindowSize_ = searchWindowSize >> 1;
@@ -154,10 +181,13 @@ Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::Bm3dDenoisingInvokerStep2(
     templateWindowSizeSq_ = templateWindowSize_ * templateWindowSize_;
     searchWindowSizeSq_ = searchWindowSize_ * searchWindowSize_;
 
-    // Extend image to avoid border problem
+    // Images are extended by the caller to avoid border problem
     borderSize_ = halfSearchWindowSize_ + halfTemplateWindowSize_;
-    copyMakeBorder(src_, srcExtended_, borderSize_, borderSize_, borderSize_, borderSize_, BORDER_DEFAULT);
-    copyMakeBorder(basic_, basicExtended_, borderSize_, borderSize_, borderSize_, borderSize_, BORDER_DEFAULT);
+    CV_Assert(srcExtended_.rows == dst_.rows + 2 * borderSize_ && srcExtended_.cols == dst_.cols + 2 * borderSize_);
+    CV_Assert(srcExtended_.isContinuous() && basicExtended_.isContinuous());
+    CV_Assert(basicExtended_.size() == srcExtended_.size());
+
+    useCache_ = !frames_[0].srcCache.empty() && !frames_[0].basicCache.empty();
 
     // Calculate block matching threshold
     hBM_ = D::template calcBlockMatchingThreshold<int>(hBM, templateWindowSizeSq_);
@@ -183,8 +213,6 @@ template <typename T, typename D, typename WT, typename TT, typename TC>
 void Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::operator() (const Range& range) const
 {
     const int size = (range.size() + 2 * borderSize_) * srcExtended_.cols;
-    std::vector<WT> weightedSum(size, 0.0);
-    std::vector<WT> weights(size, 0.0);
     int row_from = range.start;
     int row_to = range.end - 1;
 
@@ -195,8 +223,9 @@ void Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::operator() (const Range& range
     const int searchWindowSize = searchWindowSize_;
     const int searchWindowSizeSq = searchWindowSizeSq_;
     const TT halfSearchWindowSize = (TT)halfSearchWindowSize_;
-    const int hBM = hBM_;
     const int groupSize = groupSize_;
+    const int numFrames = numFrames_;
+    const int cols = dst_.cols;
 
     const int step = srcExtended_.cols;
     const int dstStep = srcExtended_.cols;
@@ -204,96 +233,60 @@ void Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::operator() (const Range& range
     const int dstcstep = dstStep - blockSize;
     const int weicstep = weiStep - blockSize;
 
+    Bm3dWorkspace<TT, WT>& ws = workspaces_.getRef();
+    ws.create(numFrames, blockSize, searchWindowSize, cols, size, 2);
+
     // Buffer to store 3D group
-    BlockMatch<TT, int, TT> *bmBasic = new BlockMatch<TT, int, TT>[searchWindowSizeSq];
-    BlockMatch<TT, int, TT> *bmSrc = new BlockMatch<TT, int, TT>[searchWindowSizeSq];
-    for (int i = 0; i < searchWindowSizeSq; ++i)
-    {
-        bmBasic[i].init(blockSizeSq);
-        bmSrc[i].init(blockSizeSq);
-    }
+    BlockMatch<TT, int, TT> *bmBasic = ws.groups[0].data();
+    BlockMatch<TT, int, TT> *bmSrc = ws.groups[1].data();
 
     // First element in a group is always the reference patch. Hence distance is 0.
     bmBasic[0](0, halfSearchWindowSize, halfSearchWindowSize);
     bmSrc[0](0, halfSearchWindowSize, halfSearchWindowSize);
 
-    // Sums of columns and rows for current pixel
-    Array2d<int> distSums(searchWindowSize, searchWindowSize);
-
-    // Sums of columns for current pixel (for lazy calc optimization)
-    Array3d<int> colDistSums(blockSize, searchWindowSize, searchWindowSize);
-
-    // Last elements of column sum (for each element in a row)
-    Array3d<int> lastColDistSums(src_.cols, searchWindowSize, searchWindowSize);
-
     int firstColNum = -1;
     for (int j = row_from, jj = 0; j <= row_to; j += slidingStep_, jj += slidingStep_)
     {
-        for (int i = 0; i < src_.cols; i += slidingStep_)
+        for (int i = 0; i < cols; i += slidingStep_)
         {
-            const T *currentPixelSrc = srcExtended_.ptr<T>(0) + step*j + i;
-            const T *currentPixelBasic = basicExtended_.ptr<T>(0) + step*j + i;
-
             int elementSize = 1;
 
-            // Calculate distSums using moving average filter approach.
-            if (i == 0)
+            // Calculate distSums using moving average filter approach, separately for every frame.
+            for (int f = 0; f < numFrames; ++f)
             {
-                // Calculate distSums for the first element in a row
-                calcDistSumsForFirstElementInRow(j, distSums, colDistSums, lastColDistSums, bmBasic, elementSize);
-                firstColNum = 0;
-            }
-            else
-            {
-                if (j == row_from)
+                // Sums of columns and rows for current pixel
+                Array2d<int> distSums(ws.distSums.data() + f * searchWindowSizeSq, searchWindowSize, searchWindowSize);
+
+                // Sums of columns for current pixel (for lazy calc optimization)
+                Array3d<int> colDistSums(
+                    ws.colDistSums.data() + f * blockSize * searchWindowSizeSq, blockSize, searchWindowSize, searchWindowSize);
+
+                // Last elements of column sum (for each element in a row)
+                Array3d<int> lastColDistSums(
+                    ws.lastColDistSums.data() + (size_t)f * cols * searchWindowSizeSq, cols, searchWindowSize, searchWindowSize);
+
+                if (i == 0)
+                {
+                    // Calculate distSums for the first element in a row
+                    calcDistSumsForFirstElementInRow(j, f, distSums, colDistSums, lastColDistSums, bmBasic, elementSize);
+                }
+                else if (j == row_from)
                 {
                     // Calculate distSums for all elements in the first row
                     calcDistSumsForAllElementsInFirstRow(
-                        j, i, firstColNum, distSums, colDistSums, lastColDistSums, bmBasic, elementSize);
+                        j, i, f, firstColNum, distSums, colDistSums, lastColDistSums, bmBasic, elementSize);
                 }
                 else
                 {
-                    const int start_bx = blockSize + i - 1;
-                    const int start_by = j - 1;
-                    const int ax = halfSearchWindowSize + start_bx;
-                    const int ay = halfSearchWindowSize + start_by;
-
-                    const T a_up = basicExtended_.at<T>(ay, ax);
-                    const T a_down = basicExtended_.at<T>(ay + blockSize, ax);
-
-                    for (TT y = 0; y < searchWindowSize; y++)
-                    {
-                        int *distSumsRow = distSums.row_ptr(y);
-                        int *colDistSumsRow = colDistSums.row_ptr(firstColNum, y);
-                        int *lastColDistSumsRow = lastColDistSums.row_ptr(i, y);
-
-                        const T *b_up_ptr = basicExtended_.ptr<T>(start_by + y);
-                        const T *b_down_ptr = basicExtended_.ptr<T>(start_by + y + blockSize);
-
-                        for (TT x = 0; x < searchWindowSize; x++)
-                        {
-                            // Remove from current pixel sum column sum with index "firstColNum"
-                            distSumsRow[x] -= colDistSumsRow[x];
-
-                            const int bx = start_bx + x;
-                            colDistSumsRow[x] = lastColDistSumsRow[x] +
-                                D::template calcUpDownDist<T>(a_up, a_down, b_up_ptr[bx], b_down_ptr[bx]);
-
-                            distSumsRow[x] += colDistSumsRow[x];
-                            lastColDistSumsRow[x] = colDistSumsRow[x];
-
-                            if (x == halfSearchWindowSize && y == halfSearchWindowSize)
-                                continue;
-
-                            // Save the distance, coordinate and increase the counter
-                            if (distSumsRow[x] < hBM)
-                                bmBasic[elementSize++](distSumsRow[x], x, y);
-                        }
-                    }
+                    calcDistSumsForElement(
+                        j, i, f, firstColNum, distSums, colDistSums, lastColDistSums, bmBasic, elementSize);
                 }
+            }
 
+            if (i == 0)
+                firstColNum = 0;
+            else
                 firstColNum = (firstColNum + 1) % blockSize;
-            }
 
             // Sort bmBasic by distance (first element is already sorted)
             std::sort(bmBasic + 1, bmBasic + elementSize);
@@ -306,10 +299,20 @@ void Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::operator() (const Range& range
             // Transform 2D patches
             for (int n = 0; n < elementSize; ++n)
             {
-                const T *candidatePatchSrc = currentPixelSrc + step * bmBasic[n].coord_y + bmBasic[n].coord_x;
-                const T *candidatePatchBasic = currentPixelBasic + step * bmBasic[n].coord_y + bmBasic[n].coord_x;
-                TC::forwardTransform2D(candidatePatchSrc, bmSrc[n].data(), step, blockSize);
-                TC::forwardTransform2D(candidatePatchBasic, bmBasic[n].data(), step, blockSize);
+                const Bm3dFrame& frame = frames_[bmBasic[n].frame];
+                const int y = j + bmBasic[n].coord_y;
+                const int x = i + bmBasic[n].coord_x;
+
+                if (useCache_)
+                {
+                    std::memcpy(bmSrc[n].data(), frame.srcCache.ptr<TT>(y) + x * blockSizeSq, blockSizeSq * sizeof(TT));
+                    std::memcpy(bmBasic[n].data(), frame.basicCache.ptr<TT>(y) + x * blockSizeSq, blockSizeSq * sizeof(TT));
+                }
+                else
+                {
+                    TC::forwardTransform2D(frame.srcExtended.ptr<T>(y) + x, bmSrc[n].data(), step, blockSize);
+                    TC::forwardTransform2D(frame.basicExtended.ptr<T>(y) + x, bmBasic[n].data(), step, blockSize);
+                }
             }
 
             // Transform and shrink 1D columns
@@ -369,10 +372,6 @@ void Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::operator() (const Range& range
                 }
             }
 
-            // Inverse 2D transform
-            for (int n = 0; n < elementSize; ++n)
-                TC::inverseTransform2D(bmBasic[n].data(), blockSize);
-
             // Aggregate the results (increase sumNonZero to avoid division by zero)
             float weight = 1.0f / (float)(++wienerCoefficients);
 
@@ -380,14 +379,22 @@ void Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::operator() (const Range& range
             weight *= elementSize;
             weight /= groupSize;
 
-            // Put patches back to their original positions
-            WT *dstPtr = weightedSum.data() + jj * dstStep + i;
-            WT *weiPtr = weights.data() + jj * dstStep + i;
+            // Put patches back to their original positions. Only the blocks of the
+            // denoised frame are aggregated, blocks of the neighbouring frames only
+            // contribute to the collaborative filtering.
+            WT *dstPtr = ws.weightedSum.data() + jj * dstStep + i;
+            WT *weiPtr = ws.weights.data() + jj * dstStep + i;
             const float *kaiser = kaiser_;
 
             for (int l = 0; l < elementSize; ++l)
             {
-                const TT *block = bmBasic[l].data();
+                if (bmBasic[l].frame != 0)
+                    continue;
+
+                // Inverse 2D transform
+                TT *block = bmBasic[l].data();
+                TC::inverseTransform2D(block, blockSize);
+
                 int offset = bmBasic[l].coord_y * dstStep + bmBasic[l].coord_x;
                 WT *d = dstPtr + offset;
                 WT *dw = weiPtr + offset;
@@ -408,31 +415,21 @@ void Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::operator() (const Range& range
         } // i
     } // j
 
-    // Cleanup
-    for (int i = 0; i < searchWindowSizeSq; ++i)
-    {
-        bmBasic[i].release();
-        bmSrc[i].release();
-    }
-
-    delete[] bmSrc;
-    delete[] bmBasic;
-
     // Divide accumulation buffer by the corresponding weights
     for (int i = row_from, ii = 0; i <= row_to; ++i, ++ii)
     {
         T *d = dst_.ptr<T>(i);
-        float *dE = weightedSum.data() + (ii + halfSearchWindowSize + halfBlockSize) * dstStep + halfSearchWindowSize;
-        float *dw = weights.data() + (ii + halfSearchWindowSize + halfBlockSize) * dstStep + halfSearchWindowSize;
+        float *dE = ws.weightedSum.data() + (ii + halfSearchWindowSize + halfBlockSize) * dstStep + halfSearchWindowSize;
+        float *dw = ws.weights.data() + (ii + halfSearchWindowSize + halfBlockSize) * dstStep + halfSearchWindowSize;
         for (int j = 0; j < dst_.cols; ++j)
             d[j] = cv::saturate_cast<T>(dE[j + halfBlockSize] / dw[j + halfBlockSize]);
     }
 }
 
-
 template <typename T, typename D, typename WT, typename TT, typename TC>
 inline void Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::calcDistSumsForFirstElementInRow(
     int i,
+    int frame,
     Array2d<int>& distSums,
     Array3d<int>& colDistSums,
     Array3d<int>& lastColDistSums,
@@ -446,6 +443,7 @@ inline void Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::calcDistSumsForFirstEle
     const TT halfSearchWindowSize = (TT)halfSearchWindowSize_;
     const int ay = halfSearchWindowSize + i;
     const int ax = halfSearchWindowSize + j;
+    const Mat& candExtended = frames_[frame].basicExtended;
 
     for (TT y = 0; y < searchWindowSize; ++y)
     {
@@ -463,11 +461,8 @@ inline void Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::calcDistSumsForFirstEle
                 for (int tx = 0; tx < blockSize; tx++)
                 {
                     int dist = D::template calcDist<T>(
-                        basicExtended_,
-                        ay + ty,
-                        ax + tx,
-                        start_y + ty,
-                        start_x + tx);
+                        basicExtended_.at<T>(ay + ty, ax + tx),
+                        candExtended.at<T>(start_y + ty, start_x + tx));
 
                     distSums[y][x] += dist;
                     colDistSums[tx][y][x] += dist;
@@ -475,11 +470,11 @@ inline void Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::calcDistSumsForFirstEle
 
             lastColDistSums[j][y][x] = colDistSums[blockSize - 1][y][x];
 
-            if (x == halfSearchWindowSize && y == halfSearchWindowSize)
+            if (frame == 0 && x == halfSearchWindowSize && y == halfSearchWindowSize)
                 continue;
 
             if (distSums[y][x] < hBM)
-                bm[elementSize++](distSums[y][x], x, y);
+                bm[elementSize++](distSums[y][x], x, y, (TT)frame);
         }
     }
 }
@@ -488,6 +483,7 @@ template <typename T, typename D, typename WT, typename TT, typename TC>
 inline void Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::calcDistSumsForAllElementsInFirstRow(
     int i,
     int j,
+    int frame,
     int firstColNum,
     Array2d<int>& distSums,
     Array3d<int>& colDistSums,
@@ -499,6 +495,7 @@ inline void Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::calcDistSumsForAllEleme
     const int blockSize = templateWindowSize_;
     const int searchWindowSize = searchWindowSize_;
     const TT halfSearchWindowSize = (TT)halfSearchWindowSize_;
+    const Mat& candExtended = frames_[frame].basicExtended;
 
     const int bx_start = blockSize - 1 + j;
     const int ax = halfSearchWindowSize + bx_start;
@@ -516,20 +513,74 @@ inline void Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::calcDistSumsForAllEleme
 
             for (int ty = 0; ty < blockSize; ty++)
                 colDistSums[firstColNum][y][x] += D::template calcDist<T>(
-                    basicExtended_,
-                    ay + ty,
-                    ax,
-                    by + ty,
-                    bx);
+                    basicExtended_.at<T>(ay + ty, ax),
+                    candExtended.at<T>(by + ty, bx));
 
             distSums[y][x] += colDistSums[firstColNum][y][x];
             lastColDistSums[j][y][x] = colDistSums[firstColNum][y][x];
 
-            if (x == halfSearchWindowSize && y == halfSearchWindowSize)
+            if (frame == 0 && x == halfSearchWindowSize && y == halfSearchWindowSize)
                 continue;
 
             if (distSums[y][x] < hBM)
-                bm[elementSize++](distSums[y][x], x, y);
+                bm[elementSize++](distSums[y][x], x, y, (TT)frame);
+        }
+    }
+}
+
+template <typename T, typename D, typename WT, typename TT, typename TC>
+inline void Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::calcDistSumsForElement(
+    int i,
+    int j,
+    int frame,
+    int firstColNum,
+    Array2d<int>& distSums,
+    Array3d<int>& colDistSums,
+    Array3d<int>& lastColDistSums,
+    BlockMatch<TT, int, TT> *bm,
+    int &elementSize) const
+{
+    const int hBM = hBM_;
+    const int blockSize = templateWindowSize_;
+    const int searchWindowSize = searchWindowSize_;
+    const TT halfSearchWindowSize = (TT)halfSearchWindowSize_;
+    const Mat& candExtended = frames_[frame].basicExtended;
+
+    const int start_bx = blockSize + j - 1;
+    const int start_by = i - 1;
+    const int ax = halfSearchWindowSize + start_bx;
+    const int ay = halfSearchWindowSize + start_by;
+
+    const T a_up = basicExtended_.at<T>(ay, ax);
+    const T a_down = basicExtended_.at<T>(ay + blockSize, ax);
+
+    for (TT y = 0; y < searchWindowSize; y++)
+    {
+        int *distSumsRow = distSums.row_ptr(y);
+        int *colDistSumsRow = colDistSums.row_ptr(firstColNum, y);
+        int *lastColDistSumsRow = lastColDistSums.row_ptr(j, y);
+
+        const T *b_up_ptr = candExtended.ptr<T>(start_by + y);
+        const T *b_down_ptr = candExtended.ptr<T>(start_by + y + blockSize);
+
+        for (TT x = 0; x < searchWindowSize; x++)
+        {
+            // Remove from current pixel sum column sum with index "firstColNum"
+            distSumsRow[x] -= colDistSumsRow[x];
+
+            const int bx = start_bx + x;
+            colDistSumsRow[x] = lastColDistSumsRow[x] +
+                D::template calcUpDownDist<T>(a_up, a_down, b_up_ptr[bx], b_down_ptr[bx]);
+
+            distSumsRow[x] += colDistSumsRow[x];
+            lastColDistSumsRow[x] = colDistSumsRow[x];
+
+            if (frame == 0 && x == halfSearchWindowSize && y == halfSearchWindowSize)
+                continue;
+
+            // Save the distance, coordinate and increase the counter
+            if (distSumsRow[x] < hBM)
+                bm[elementSize++](distSumsRow[x], x, y, (TT)frame);
         }
     }
 }
@@ -69,6 +69,12 @@ public:
         data_ = new T[blockSizeSq];
     }
 
+    // Use externally owned memory for data (must not be released)
+    void init(T *data)
+    {
+        data_ = data;
+    }
+
     // Release data memory
     void release()
     {
@@ -76,11 +82,12 @@ public:
     }
 
     // Overloaded operator for convenient assignment
-    void operator()(const DT &_dist, const CT &_coord_x, const CT &_coord_y)
+    void operator()(const DT &_dist, const CT &_coord_x, const CT &_coord_y, const CT &_frame = 0)
     {
         dist = _dist;
         coord_x = _coord_x;
         coord_y = _coord_y;
+        frame = _frame;
     }
 
     // Overloaded array subscript operator
@@ -108,6 +115,9 @@ public:
     CT coord_x;
     CT coord_y;
 
+    // Index of the frame the block belongs to (0 is the frame being denoised)
+    CT frame;
+
 private:
     // Pointer to the pixel values of the block
     T *data_;
@@ -360,6 +370,66 @@ struct Array3d
     }
 };
 
+// Frame of the BM3D pipeline. Holds the images extended by the border and, optionally,
+// the 2D transforms of all the blocks of these images (block with top-left corner at (y, x)
+// starts at cache.ptr<TT>(y) + x * blockSizeSq).
+struct Bm3dFrame
+{
+    Mat srcExtended;
+    Mat basicExtended;
+    Mat srcCache;
+    Mat basicCache;
+};
+
+// Per-thread buffers of the BM3D invokers. Kept in TLSData and reused between the calls.
+template <typename TT, typename WT>
+struct Bm3dWorkspace
+{
+    void create(
+        int numFrames,
+        int blockSize,
+        int searchWindowSize,
+        int cols,
+        int accumulatorSize,
+        int numGroups)
+    {
+        CV_Assert(numGroups > 0 && numGroups <= 2);
+
+        const int blockSizeSq = blockSize * blockSize;
+        const int searchWindowSizeSq = searchWindowSize * searchWindowSize;
+        const int capacity = numFrames * searchWindowSizeSq;
+
+        blockData.resize((size_t)numGroups * capacity * blockSizeSq);
+        for (int g = 0; g < numGroups; ++g)
+        {
+            groups[g].resize(capacity);
+            TT *data = blockData.data() + (size_t)g * capacity * blockSizeSq;
+            for (int i = 0; i < capacity; ++i)
+                groups[g][i].init(data + (size_t)i * blockSizeSq);
+        }
+
+        distSums.resize((size_t)numFrames * searchWindowSizeSq);
+        colDistSums.resize((size_t)numFrames * blockSize * searchWindowSizeSq);
+        lastColDistSums.resize((size_t)numFrames * cols * searchWindowSizeSq);
+
+        weightedSum.assign(accumulatorSize, 0);
+        weights.assign(accumulatorSize, 0);
+    }
+
+    // Storage of the 3D groups
+    std::vector<TT> blockData;
+    std::vector<BlockMatch<TT, int, TT> > groups[2];
+
+    // Block matching sums, one set per searched frame
+    std::vector<int> distSums;
+    std::vector<int> colDistSums;
+    std::vector<int> lastColDistSums;
+
+    // Aggregation buffers
+    std::vector<WT> weightedSum;
+    std::vector<WT> weights;
+};
+
 }  // namespace xphoto
 }  // namespace cv
 
@@ -57,60 +57,173 @@ namespace xphoto
 
 #ifdef OPENCV_ENABLE_NONFREE
 
+struct Bm3dParams
+{
+    float h;
+    int templateWindowSize;
+    int searchWindowSize;
+    int blockMatchingStep1;
+    int blockMatchingStep2;
+    int groupSize;
+    int slidingStep;
+    float beta;
+    int normType;
+    int step;
+    int transformType;
+    int temporalWindowSize;
+};
+
+// State shared by the consecutive BM3D calls: the frames (the current one first) and the
+// per-thread buffers of the invokers
+struct Bm3dContext
+{
+    Bm3dContext() : numFrames(0), useCache(false) {}
+
+    TLSData<Bm3dWorkspace<short, float> >& workspaces(short) { return workspaces16; }
+    TLSData<Bm3dWorkspace<int, float> >& workspaces(int) { return workspaces32; }
+
+    std::vector<Bm3dFrame> frames;
+    int numFrames;
+    bool useCache;
+
+    TLSData<Bm3dWorkspace<short, float> > workspaces16;
+    TLSData<Bm3dWorkspace<int, float> > workspaces32;
+};
+
+// Memory budget for the transformed blocks of all the frames kept by a Bm3dDenoiser
+static const size_t kMaxTransformCacheSize = (size_t)256 << 20;
+
+static void checkParams(int type, const Bm3dParams& params)
+{
+    CV_Assert(1 == CV_MAT_CN(type));
+    CV_Assert(HAAR == params.transformType);
+    CV_Assert(params.searchWindowSize > params.templateWindowSize);
+    CV_Assert(params.slidingStep > 0 && params.slidingStep < params.templateWindowSize);
+    CV_Assert(params.temporalWindowSize >= 0);
+}
+
+static int getBorderSize(const Bm3dParams& params)
+{
+    return (params.searchWindowSize >> 1) + (params.templateWindowSize >> 1);
+}
+
+// Block transforms are cached when every block is expected to be transformed more than once,
+// i.e. when reference blocks overlap enough or when blocks are reused by the next frames.
+static bool useTransformCache(const Size& size, int depth, const Bm3dParams& params, int capacity)
+{
+    const int blockSize = params.templateWindowSize;
+    const int extendedWidth = size.width + 2 * getBorderSize(params);
+    const int extendedHeight = size.height + 2 * getBorderSize(params);
+    const size_t elemSize = depth == CV_8U ? sizeof(short) : sizeof(int);
+    const size_t cacheSize = (size_t)(extendedWidth - blockSize + 1) * (extendedHeight - blockSize + 1) *
+        blockSize * blockSize * elemSize;
+
+    if (cacheSize * 2 * capacity > kMaxTransformCacheSize)
+        return false;
+
+    return capacity > 1 || params.slidingStep * params.slidingStep < params.groupSize;
+}
+
 template<typename ST, typename D, typename TT>
 static void bm3dDenoising_(
-    const Mat& src,
+    Bm3dContext& context,
     Mat& basic,
     Mat& dst,
-    const float& h,
-    const int &templateWindowSize,
-    const int &searchWindowSize,
-    const int &hBMStep1,
-    const int &hBMStep2,
-    const int &groupSize,
-    const int &slidingStep,
-    const float &beta,
-    const int &step)
+    const Bm3dParams& params)
 {
-    double granularity = (double)std::max(1., (double)src.total() / (1 << 16));
-
-    switch (CV_MAT_CN(src.type())) {
-    case 1:
-        if (step == BM3D_STEP1 || step == BM3D_STEPALL)
-        {
-            parallel_for_(cv::Range(0, src.rows),
-                Bm3dDenoisingInvokerStep1<ST, D, float, TT, HaarTransform<ST, TT> >(
-                    src,
-                    basic,
-                    templateWindowSize,
-                    searchWindowSize,
-                    h,
-                    hBMStep1,
-                    groupSize,
-                    slidingStep,
-                    beta),
-                granularity);
+    typedef HaarTransform<ST, TT> TC;
+
+    const int borderSize = getBorderSize(params);
+    double granularity = (double)std::max(1., (double)basic.total() / (1 << 16));
+    TLSData<Bm3dWorkspace<TT, float> >& workspaces = context.workspaces(TT());
+    Bm3dFrame& frame = context.frames[0];
+
+    TC::RegisterTransforms2D(params.templateWindowSize);
+
+    // The transforms of the source blocks are shared by both steps and by the next frames
+    if (context.useCache)
+        calcTransformCache<ST, TT, TC>(frame.srcExtended, frame.srcCache, params.templateWindowSize);
+    else
+        frame.srcCache.release();
+
+    if (params.step == BM3D_STEP1 || params.step == BM3D_STEPALL)
+    {
+        parallel_for_(cv::Range(0, basic.rows),
+            Bm3dDenoisingInvokerStep1<ST, D, float, TT, TC>(
+                &context.frames[0],
+                context.numFrames,
+                basic,
+                workspaces,
+                params.templateWindowSize,
+                params.searchWindowSize,
+                params.h,
+                params.blockMatchingStep1,
+                params.groupSize,
+                params.slidingStep,
+                params.beta),
+            granularity);
+    }
+    if (params.step == BM3D_STEP2 || params.step == BM3D_STEPALL)
+    {
+        copyMakeBorder(basic, frame.basicExtended, borderSize, borderSize, borderSize, borderSize, BORDER_DEFAULT);
+        if (context.useCache)
+            calcTransformCache<ST, TT, TC>(frame.basicExtended, frame.basicCache, params.templateWindowSize);
+        else
+            frame.basicCache.release();
+
+        parallel_for_(cv::Range(0, basic.rows),
+            Bm3dDenoisingInvokerStep2<ST, D, float, TT, TC>(
+                &context.frames[0],
+                context.numFrames,
+                dst,
+                workspaces,
+                params.templateWindowSize,
+                params.searchWindowSize,
+                params.h,
+                params.blockMatchingStep2,
+                params.groupSize,
+                params.slidingStep,
+                params.beta),
+            granularity);
+    }
+}
+
+// Denoises context.frames[0], which must have the source image extended by the border
+static void bm3dDenoisingFrame(
+    Bm3dContext& context,
+    Mat& basic,
+    Mat& dst,
+    const Bm3dParams& params)
+{
+    const int depth = context.frames[0].srcExtended.depth();
+
+    switch (params.normType) {
+    case cv::NORM_L2:
+        switch (depth) {
+        case CV_8U:
+            bm3dDenoising_<uchar, DistSquared, short>(context, basic, dst, params);
+            break;
+        default:
+            CV_Error(Error::StsBadArg,
+                "Unsupported depth! Only CV_8U is supported for NORM_L2");
         }
-        if (step == BM3D_STEP2 || step == BM3D_STEPALL)
-        {
-            parallel_for_(cv::Range(0, src.rows),
-                Bm3dDenoisingInvokerStep2<ST, D, float, TT, HaarTransform<ST, TT> >(
-                    src,
-                    basic,
-                    dst,
-                    templateWindowSize,
-                    searchWindowSize,
-                    h,
-                    hBMStep2,
-                    groupSize,
-                    slidingStep,
-                    beta),
-                granularity);
+        break;
+    case cv::NORM_L1:
+        switch (depth) {
+        case CV_8U:
+            bm3dDenoising_<uchar, DistAbs, short>(context, basic, dst, params);
+            break;
+        case CV_16U:
+            bm3dDenoising_<ushort, DistAbs, int>(context, basic, dst, params);
+            break;
+        default:
+            CV_Error(Error::StsBadArg,
+                "Unsupported depth! Only CV_8U and CV_16U are supported for NORM_L1");
         }
         break;
     default:
         CV_Error(Error::StsBadArg,
-            "Unsupported number of channels! Only 1 channel is supported at the moment.");
+            "Unsupported norm type! Only NORM_L2 and NORM_L1 are supported");
     }
 }
 
@@ -130,11 +243,12 @@ void bm3dDenoising(
     int step,
     int transformType)
 {
-    int type = _src.type(), depth = CV_MAT_DEPTH(type), cn = CV_MAT_CN(type);
-    CV_Assert(1 == cn);
-    CV_Assert(HAAR == transformType);
-    CV_Assert(searchWindowSize > templateWindowSize);
-    CV_Assert(slidingStep > 0 && slidingStep < templateWindowSize);
+    const Bm3dParams params = {
+        h, templateWindowSize, searchWindowSize, blockMatchingStep1, blockMatchingStep2,
+        groupSize, slidingStep, beta, normType, step, transformType, 0 };
+
+    int type = _src.type();
+    checkParams(type, params);
 
     Size srcSize = _src.size();
 
@@ -160,70 +274,17 @@ void bm3dDenoising(
     Mat basic = _basic.getMat().empty() ? Mat(srcSize, type) : _basic.getMat();
     Mat dst = _dst.getMat();
 
-    switch (normType) {
-    case cv::NORM_L2:
-        switch (depth) {
-        case CV_8U:
-            bm3dDenoising_<uchar, DistSquared, short>(
-                src,
-                basic,
-                dst,
-                h,
-                templateWindowSize,
-                searchWindowSize,
-                blockMatchingStep1,
-                blockMatchingStep2,
-                groupSize,
-                slidingStep,
-                beta,
-                step);
-            break;
-        default:
-            CV_Error(Error::StsBadArg,
-                "Unsupported depth! Only CV_8U is supported for NORM_L2");
-        }
-        break;
-    case cv::NORM_L1:
-        switch (depth) {
-        case CV_8U:
-            bm3dDenoising_<uchar, DistAbs, short>(
-                src,
-                basic,
-                dst,
-                h,
-                templateWindowSize,
-                searchWindowSize,
-                blockMatchingStep1,
-                blockMatchingStep2,
-                groupSize,
-                slidingStep,
-                beta,
-                step);
-            break;
-        case CV_16U:
-            bm3dDenoising_<ushort, DistAbs, int>(
-                src,
-                basic,
-                dst,
-                h,
-                templateWindowSize,
-                searchWindowSize,
-                blockMatchingStep1,
-                blockMatchingStep2,
-                groupSize,
-                slidingStep,
-                beta,
-                step);
-            break;
-        default:
-            CV_Error(Error::StsBadArg,
-                "Unsupported depth! Only CV_8U and CV_16U are supported for NORM_L1");
-        }
-        break;
-    default:
-        CV_Error(Error::StsBadArg,
-            "Unsupported norm type! Only NORM_L2 and NORM_L1 are supported");
-    }
+    const int borderSize = getBorderSize(params);
+
+    Bm3dContext context;
+    context.frames.resize(1);
+    context.numFrames = 1;
+    // the one-shot call keeps the memory footprint of the block-by-block transforms,
+    // only the persistent Bm3dDenoiser caches them
+    context.useCache = false;
+    copyMakeBorder(src, context.frames[0].srcExtended, borderSize, borderSize, borderSize, borderSize, BORDER_DEFAULT);
+
+    bm3dDenoisingFrame(context, basic, dst, params);
 }
 
 void bm3dDenoising(
@@ -267,6 +328,105 @@ void bm3dDenoising(
         _dst.assign(basic);
 }
 
+class Bm3dDenoiserImpl CV_FINAL : public Bm3dDenoiser
+{
+public:
+    Bm3dDenoiserImpl(const Bm3dParams& params) : params_(params) {}
+
+    void denoise(InputArray src, OutputArray dst) CV_OVERRIDE;
+    void reset() CV_OVERRIDE { context_.numFrames = 0; }
+
+    float getH() const CV_OVERRIDE { return params_.h; }
+    void setH(float h) CV_OVERRIDE { params_.h = h; reset(); }
+    int getTemplateWindowSize() const CV_OVERRIDE { return params_.templateWindowSize; }
+    void setTemplateWindowSize(int size) CV_OVERRIDE { params_.templateWindowSize = size; reset(); }
+    int getSearchWindowSize() const CV_OVERRIDE { return params_.searchWindowSize; }
+    void setSearchWindowSize(int size) CV_OVERRIDE { params_.searchWindowSize = size; reset(); }
+    int getBlockMatchingStep1() const CV_OVERRIDE { return params_.blockMatchingStep1; }
+    void setBlockMatchingStep1(int val) CV_OVERRIDE { params_.blockMatchingStep1 = val; reset(); }
+    int getBlockMatchingStep2() const CV_OVERRIDE { return params_.blockMatchingStep2; }
+    void setBlockMatchingStep2(int val) CV_OVERRIDE { params_.blockMatchingStep2 = val; reset(); }
+    int getGroupSize() const CV_OVERRIDE { return params_.groupSize; }
+    void setGroupSize(int val) CV_OVERRIDE { params_.groupSize = val; reset(); }
+    int getSlidingStep() const CV_OVERRIDE { return params_.slidingStep; }
+    void setSlidingStep(int val) CV_OVERRIDE { params_.slidingStep = val; reset(); }
+    float getBeta() const CV_OVERRIDE { return params_.beta; }
+    void setBeta(float val) CV_OVERRIDE { params_.beta = val; reset(); }
+    int getNormType() const CV_OVERRIDE { return params_.normType; }
+    void setNormType(int val) CV_OVERRIDE { params_.normType = val; reset(); }
+    int getStep() const CV_OVERRIDE { return params_.step; }
+    void setStep(int val) CV_OVERRIDE { params_.step = val; reset(); }
+    int getTemporalWindowSize() const CV_OVERRIDE { return params_.temporalWindowSize; }
+    void setTemporalWindowSize(int val) CV_OVERRIDE { params_.temporalWindowSize = val; reset(); }
+
+private:
+    Bm3dParams params_;
+    Bm3dContext context_;
+    Mat basic_;
+};
+
+void Bm3dDenoiserImpl::denoise(InputArray _src, OutputArray _dst)
+{
+    int type = _src.type();
+    checkParams(type, params_);
+    CV_Assert(params_.step == BM3D_STEP1 || params_.step == BM3D_STEPALL);
+
+    Mat src = _src.getMat();
+    const int borderSize = getBorderSize(params_);
+    const Size extendedSize(src.cols + 2 * borderSize, src.rows + 2 * borderSize);
+
+    // Frames of another size or type can not be used for block matching
+    if (context_.numFrames > 0 &&
+        (context_.frames[0].srcExtended.size() != extendedSize || context_.frames[0].srcExtended.type() != type))
+        reset();
+
+    // The oldest frame buffer is reused for the new frame
+    const int capacity = params_.temporalWindowSize + 1;
+    if ((int)context_.frames.size() != capacity)
+    {
+        context_.frames.resize(capacity);
+        context_.numFrames = std::min(context_.numFrames, capacity - 1);
+    }
+    std::rotate(context_.frames.begin(), context_.frames.end() - 1, context_.frames.end());
+    context_.numFrames = std::min(context_.numFrames + 1, capacity);
+    context_.useCache = useTransformCache(src.size(), src.depth(), params_, capacity);
+
+    copyMakeBorder(src, context_.frames[0].srcExtended, borderSize, borderSize, borderSize, borderSize, BORDER_DEFAULT);
+
+    _dst.create(src.size(), type);
+    Mat dst = _dst.getMat();
+
+    if (params_.step == BM3D_STEP1)
+    {
+        bm3dDenoisingFrame(context_, dst, dst, params_);
+    }
+    else
+    {
+        basic_.create(src.size(), type);
+        bm3dDenoisingFrame(context_, basic_, dst, params_);
+    }
+}
+
+Ptr<Bm3dDenoiser> createBm3dDenoiser(
+    float h,
+    int templateWindowSize,
+    int searchWindowSize,
+    int blockMatchingStep1,
+    int blockMatchingStep2,
+    int groupSize,
+    int slidingStep,
+    float beta,
+    int normType,
+    int step,
+    int temporalWindowSize)
+{
+    const Bm3dParams params = {
+        h, templateWindowSize, searchWindowSize, blockMatchingStep1, blockMatchingStep2,
+        groupSize, slidingStep, beta, normType, step, HAAR, temporalWindowSize };
+
+    return makePtr<Bm3dDenoiserImpl>(params);
+}
+
 #else
 
 void bm3dDenoising(
@@ -343,6 +503,38 @@ void bm3dDenoising(
         "Set OPENCV_ENABLE_NONFREE CMake option and rebuild the library");
 }
 
+Ptr<Bm3dDenoiser> createBm3dDenoiser(
+    float h,
+    int templateWindowSize,
+    int searchWindowSize,
+    int blockMatchingStep1,
+    int blockMatchingStep2,
+    int groupSize,
+    int slidingStep,
+    float beta,
+    int normType,
+    int step,
+    int temporalWindowSize)
+{
+    // Empty implementation
+
+    CV_UNUSED(h);
+    CV_UNUSED(templateWindowSize);
+    CV_UNUSED(searchWindowSize);
+    CV_UNUSED(blockMatchingStep1);
+    CV_UNUSED(blockMatchingStep2);
+    CV_UNUSED(groupSize);
+    CV_UNUSED(slidingStep);
+    CV_UNUSED(beta);
+    CV_UNUSED(normType);
+    CV_UNUSED(step);
+    CV_UNUSED(temporalWindowSize);
+
+    CV_Error(Error::StsNotImplemented,
+        "This algorithm is patented and is excluded in this configuration;"
+        "Set OPENCV_ENABLE_NONFREE CMake option and rebuild the library");
+}
+
 #endif
 
 }  // namespace xphoto
@@ -97,6 +97,9 @@ GCGraph<TWeight>::~GCGraph()
 template <class TWeight>
 void GCGraph<TWeight>::create( unsigned int vtxCount, unsigned int edgeCount )
 {
+    // drop the previous graph but keep the storage, so a graph object can be reused
+    vtcs.clear();
+    edges.clear();
     vtcs.reserve( vtxCount );
     edges.reserve( edgeCount + 2 );
     flow = 0;
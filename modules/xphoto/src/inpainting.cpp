@@ -57,11 +57,13 @@
 #include <functional>
 #include <string>
 #include <tuple>
+#include <map>
 
 #include "opencv2/xphoto.hpp"
 #include "opencv2/imgproc.hpp"
 #include "opencv2/core.hpp"
 #include "opencv2/core/types.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 #include "photomontage.hpp"
 #include "annf.hpp"
 #include "advanced_types.hpp"
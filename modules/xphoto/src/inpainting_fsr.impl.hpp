@@ -92,34 +92,31 @@ icvStandardDeviation(const Mat& distorted_block_2d, const Mat& error_mask_2d) {
     return sigma_n;
 }
 
+// Distance weighting of the fft window for an MxN block: rho to the power of the distance to the block centre.
+// It only depends on the block geometry, so it is computed once per block size and reused for every block.
 static void
-icvExtrapolateBlock(Mat& distorted_block, Mat& error_mask, fsr_parameters& fsr_params, double rho, double normedStdDev, Mat& extrapolated_block)
+icvBlockDecayWindow(int M, int N, const fsr_parameters& fsr_params, double rho, Mat& decay)
 {
     double fft_size = fsr_params.fft_size;
-    double orthogonality_correction = fsr_params.orthogonality_correction;
-    int M = distorted_block.rows;
-    int N = distorted_block.cols;
     int fft_x_offset = cvFloor((fft_size - N) / 2);
     int fft_y_offset = cvFloor((fft_size - M) / 2);
 
-    // weighting function
-    Mat w = Mat::zeros(fsr_params.fft_size, fsr_params.fft_size, CV_64F);
-    error_mask.copyTo(w(Range(fft_y_offset, fft_y_offset + M), Range(fft_x_offset, fft_x_offset + N)));
+    decay.create(fsr_params.fft_size, fsr_params.fft_size, CV_64F);
     for (int u = 0; u < fft_size; ++u)
     {
+        double* decay_row = decay.ptr<double>(u);
         for (int v = 0; v < fft_size; ++v)
         {
-            w.at<double>(u, v) *= std::pow(rho, std::sqrt(std::pow(u + 0.5 - (fft_y_offset + M / 2), 2) + std::pow(v + 0.5 - (fft_x_offset + N / 2), 2)));
+            decay_row[v] = std::pow(rho, std::sqrt(std::pow(u + 0.5 - (fft_y_offset + M / 2), 2) + std::pow(v + 0.5 - (fft_x_offset + N / 2), 2)));
         }
     }
-    Mat W;
-    dft(w, W, DFT_COMPLEX_OUTPUT);
-    Mat W_padded;
-    hconcat(W, W, W_padded);
-    vconcat(W_padded, W_padded, W_padded);
+}
 
-    // frequency weighting
-    Mat frequency_weighting = Mat::ones(fsr_params.fft_size, fsr_params.fft_size / 2 + 1, CV_64F);
+static void
+icvFrequencyWeighting(const fsr_parameters& fsr_params, Mat& frequency_weighting)
+{
+    double fft_size = fsr_params.fft_size;
+    frequency_weighting.create(fsr_params.fft_size, fsr_params.fft_size / 2 + 1, CV_64F);
     for (int y = 0; y < fft_size; ++y)
     {
         for (int x = 0; x < (fft_size / 2 + 1); ++x)
@@ -129,6 +126,108 @@ icvExtrapolateBlock(Mat& distorted_block, Mat& error_mask, fsr_parameters& fsr_p
             frequency_weighting.at<double>(y, x) = 1 - std::sqrt(x2*x2 + y2 * y2)*std::sqrt(2) / fft_size;
         }
     }
+}
+
+// projection_distances = |Rw| .* frequency_weighting, returns the maximum
+static double
+icvProjectionDistances(const Mat& Rw, const Mat& frequency_weighting, Mat& projection_distances)
+{
+    double maxVal = -DBL_MAX;
+    for (int y = 0; y < Rw.rows; ++y)
+    {
+        const double* rw = Rw.ptr<double>(y);
+        const double* fw = frequency_weighting.ptr<double>(y);
+        double* pd = projection_distances.ptr<double>(y);
+        int x = 0;
+#if CV_SIMD_64F
+        const int step = VTraits<v_float64>::vlanes();
+        for (; x <= Rw.cols - step; x += step)
+        {
+            v_float64 re, im;
+            v_load_deinterleave(rw + 2*x, re, im);
+            v_float64 mag = v_sqrt(v_add(v_mul(re, re), v_mul(im, im)));
+            v_store(pd + x, v_mul(mag, vx_load(fw + x)));
+        }
+#endif
+        for (; x < Rw.cols; ++x)
+        {
+            double re = rw[2*x], im = rw[2*x + 1];
+            pd[x] = std::sqrt(re*re + im*im) * fw[x];
+        }
+        for (x = 0; x < Rw.cols; ++x)
+            maxVal = std::max(maxVal, pd[x]);
+    }
+    return maxVal;
+}
+
+// Rw -= c1*W1 (+ c2*W2), complex element-wise, same arithmetic as mulSpectrums with a constant spectrum
+static void
+icvUpdateResidual(Mat& Rw, const Mat& W1, std::complex<double> c1, const Mat* W2, std::complex<double> c2)
+{
+    const double c1r = c1.real(), c1i = c1.imag(), c2r = c2.real(), c2i = c2.imag();
+    for (int y = 0; y < Rw.rows; ++y)
+    {
+        double* rw = Rw.ptr<double>(y);
+        const double* w1 = W1.ptr<double>(y);
+        const double* w2 = W2 ? W2->ptr<double>(y) : 0;
+        int x = 0;
+#if CV_SIMD_64F
+        const int step = VTraits<v_float64>::vlanes();
+        v_float64 vc1r = vx_setall_f64(c1r), vc1i = vx_setall_f64(c1i);
+        v_float64 vc2r = vx_setall_f64(c2r), vc2i = vx_setall_f64(c2i);
+        for (; x <= Rw.cols - step; x += step)
+        {
+            v_float64 rre, rim, are, aim;
+            v_load_deinterleave(rw + 2*x, rre, rim);
+            v_load_deinterleave(w1 + 2*x, are, aim);
+            v_float64 re = v_sub(v_mul(vc1r, are), v_mul(vc1i, aim));
+            v_float64 im = v_add(v_mul(vc1i, are), v_mul(vc1r, aim));
+            if (w2)
+            {
+                v_float64 bre, bim;
+                v_load_deinterleave(w2 + 2*x, bre, bim);
+                re = v_add(re, v_sub(v_mul(vc2r, bre), v_mul(vc2i, bim)));
+                im = v_add(im, v_add(v_mul(vc2i, bre), v_mul(vc2r, bim)));
+            }
+            v_store_interleave(rw + 2*x, v_sub(rre, re), v_sub(rim, im));
+        }
+#endif
+        for (; x < Rw.cols; ++x)
+        {
+            double re = c1r*w1[2*x] - c1i*w1[2*x + 1];
+            double im = c1i*w1[2*x] + c1r*w1[2*x + 1];
+            if (w2)
+            {
+                re = re + (c2r*w2[2*x] - c2i*w2[2*x + 1]);
+                im = im + (c2i*w2[2*x] + c2r*w2[2*x + 1]);
+            }
+            rw[2*x] -= re;
+            rw[2*x + 1] -= im;
+        }
+    }
+}
+
+static void
+icvExtrapolateBlock(Mat& distorted_block, Mat& error_mask, const fsr_parameters& fsr_params, const Mat& decay_window,
+                    const Mat& frequency_weighting, double normedStdDev, Mat& extrapolated_block)
+{
+    double fft_size = fsr_params.fft_size;
+    double orthogonality_correction = fsr_params.orthogonality_correction;
+    int M = distorted_block.rows;
+    int N = distorted_block.cols;
+    int fft_x_offset = cvFloor((fft_size - N) / 2);
+    int fft_y_offset = cvFloor((fft_size - M) / 2);
+
+    // weighting function
+    Mat w = Mat::zeros(fsr_params.fft_size, fsr_params.fft_size, CV_64F);
+    error_mask.copyTo(w(Range(fft_y_offset, fft_y_offset + M), Range(fft_x_offset, fft_x_offset + N)));
+    w = w.mul(decay_window);
+    Mat W;
+    dft(w, W, DFT_COMPLEX_OUTPUT);
+    Mat W_padded;
+    hconcat(W, W, W_padded);
+    vconcat(W_padded, W_padded, W_padded);
+
     // pad image to fft window size
     Mat f(Size(fsr_params.fft_size, fsr_params.fft_size), CV_64F, Scalar::all(0));
     distorted_block.copyTo(f(Range(fft_y_offset, fft_y_offset + M), Range(fft_x_offset, fft_x_offset + N)));
@@ -154,20 +253,13 @@ icvExtrapolateBlock(Mat& distorted_block, Mat& error_mask, fsr_parameters& fsr_p
         num_iters = fsr_params.max_iter;
     }
 
+    Mat projection_distances(Rw.size(), CV_64F);
     int iter_counter = 0;
     while (iter_counter < num_iters)
     { // Spectral Constrained FSE (GenserIWSSIP2018)
-        Mat projection_distances(Rw.size(), CV_64F);
-        Mat Rw_mag = Mat(Rw.size(), CV_64F);
-        std::vector<Mat> channels(2);
-        split(Rw, channels);
-        magnitude(channels[0], channels[1], Rw_mag);
-        projection_distances = Rw_mag.mul(frequency_weighting);
-
-        double minVal, maxVal;
+        double maxVal = icvProjectionDistances(Rw, frequency_weighting, projection_distances);
         int maxLocx = -1;
         int maxLocy = -1;
-        minMaxLoc(projection_distances, &minVal, &maxVal);
 
         for (int y = 0; y < projection_distances.rows; ++y)
         { // assure that first appearance of max Value is selected
@@ -245,15 +337,9 @@ icvExtrapolateBlock(Mat& distorted_block, Mat& error_mask, fsr_parameters& fsr_p
             G.at< std::complex<double> >(u, v) += fft_size * fft_size * expansion_coefficient;
             G.at< std::complex<double> >(u_cj, v_cj) = std::conj(G.at< std::complex<double> >(u, v));
 
-            Mat expansion_mat(Rw.size(), CV_64FC2, Scalar(expansion_coefficient.real(), expansion_coefficient.imag()));
             Mat W_tmp1 = W_padded(Range(fsr_params.fft_size - u, fsr_params.fft_size - u + Rw.rows), Range(fsr_params.fft_size - v, fsr_params.fft_size - v + Rw.cols));
             Mat W_tmp2 = W_padded(Range(fsr_params.fft_size - u_cj, fsr_params.fft_size - u_cj + Rw.rows), Range(fsr_params.fft_size - v_cj, fsr_params.fft_size - v_cj + Rw.cols));
-            Mat res_1(W_tmp1.size(), W_tmp1.type());
-            mulSpectrums(expansion_mat, W_tmp1, res_1, 0);
-            expansion_mat.setTo(Scalar(expansion_coefficient.real(), -expansion_coefficient.imag()));
-            Mat res_2(W_tmp1.size(), W_tmp1.type());
-            mulSpectrums(expansion_mat, W_tmp2, res_2, 0);
-            Rw -= res_1 + res_2;
+            icvUpdateResidual(Rw, W_tmp1, expansion_coefficient, &W_tmp2, std::conj(expansion_coefficient));
 
             ++iter_counter; // ... as two basis functions were added
         }
@@ -261,11 +347,8 @@ icvExtrapolateBlock(Mat& distorted_block, Mat& error_mask, fsr_parameters& fsr_p
         {
             std::complex<double> expansion_coefficient = orthogonality_correction * Rw.at< std::complex<double> >(u, v) / W.at< std::complex<double> >(0, 0);
             G.at< std::complex<double> >(u, v) += fft_size * fft_size * expansion_coefficient;
-            Mat expansion_mat(Rw.size(), CV_64FC2, Scalar(expansion_coefficient.real(), expansion_coefficient.imag()));
             Mat W_tmp = W_padded(Range(fsr_params.fft_size - u, fsr_params.fft_size - u + Rw.rows), Range(fsr_params.fft_size - v, fsr_params.fft_size - v + Rw.cols));
-            Mat res_tmp(W_tmp.size(), W_tmp.type());
-            mulSpectrums(expansion_mat, W_tmp, res_tmp, 0);
-            Rw -= res_tmp;
+            icvUpdateResidual(Rw, W_tmp, expansion_coefficient, 0, std::complex<double>());
 
         }
         ++iter_counter;
@@ -389,6 +472,9 @@ icvDetermineProcessingOrder(
 
     _sampling_mask.convertTo(sampling_mask, CV_64F);
 
+    Mat frequency_weighting;
+    icvFrequencyWeighting(fsr_params, frequency_weighting);
+
     double threshold_stddev_LUT[3];
     if (channel == "Y")
     {
@@ -439,6 +525,8 @@ icvDetermineProcessingOrder(
         Mat proc_array = Mat::zeros(blocks_per_column, blocks_per_line, CV_64F);
         Mat sigma_n_array = Mat::zeros(blocks_per_column, blocks_per_line, CV_64F);
         Mat set_process_this_block_size = Mat::zeros(blocks_per_column, blocks_per_line, CV_64F);
+        Mat level_map(blocks_per_column, blocks_per_line, CV_32S, Scalar(-1));
+        std::map< std::pair<int, int>, Mat > decay_windows; // per block geometry, rho is fixed for a block size
         if (block_size > block_size_min)
         {
             if (block_size < block_size_max)
@@ -651,35 +739,89 @@ icvDetermineProcessingOrder(
                 all_blocks_finished = 1;
             }
             // blockwise extrapolation of all blocks that can be processed in parallel
+            // The extrapolation windows of a round overlap, and a block reads the pixels its predecessors
+            // in block_list have written. Every block gets a level one above the latest preceding block it
+            // interacts with (either block lies in the window of the other); blocks of one level are
+            // independent and are extrapolated in parallel, with the same result as the sequential order.
+            const int level_radius = (border_width + block_size - 1) / block_size;
+            std::vector< std::vector<int> > levels;
             for (bl_counter = 0; bl_counter < max_bl_counter; ++bl_counter)
             {
                 int yblock_counter = std::get<0>(block_list[bl_counter]);
                 int xblock_counter = std::get<1>(block_list[bl_counter]);
+                int level = 0;
+                for (int y = std::max(0, yblock_counter - level_radius); y <= std::min(blocks_per_column - 1, yblock_counter + level_radius); ++y)
+                {
+                    const int* level_row = level_map.ptr<int>(y);
+                    for (int x = std::max(0, xblock_counter - level_radius); x <= std::min(blocks_per_line - 1, xblock_counter + level_radius); ++x)
+                    {
+                        level = std::max(level, level_row[x] + 1);
+                    }
+                }
+                level_map.at<int>(yblock_counter, xblock_counter) = level;
+                if (level == (int)levels.size())
+                {
+                    levels.push_back(std::vector<int>());
+                }
+                levels[level].push_back(bl_counter);
 
-                // calculation of the extrapolation area's borders
-                int left_border = std::min(xblock_counter*block_size, border_width);
+                // distance weighting windows of the block geometries of this round
                 int top_border = std::min(yblock_counter*block_size, border_width);
-                int right_border = std::max(0, std::min(img_width - (xblock_counter + 1)*block_size, border_width));
                 int bottom_border = std::max(0, std::min(img_height - (yblock_counter + 1)*block_size, border_width));
+                int left_border = std::min(xblock_counter*block_size, border_width);
+                int right_border = std::max(0, std::min(img_width - (xblock_counter + 1)*block_size, border_width));
+                std::pair<int, int> geometry(std::min(img_height, yblock_counter*block_size + block_size + bottom_border) - (yblock_counter*block_size - top_border),
+                                             std::min(img_width, xblock_counter*block_size + block_size + right_border) - (xblock_counter*block_size - left_border));
+                if (decay_windows.find(geometry) == decay_windows.end())
+                {
+                    icvBlockDecayWindow(geometry.first, geometry.second, fsr_params, rho, decay_windows[geometry]);
+                }
+            }
 
-                // extract blocks from images
-                Mat distorted_block_2d = reconstructed_img(Range(yblock_counter*block_size - top_border, std::min(img_height, (yblock_counter*block_size + block_size + bottom_border))), Range(xblock_counter*block_size - left_border, std::min(img_width, (xblock_counter*block_size + block_size + right_border))));
-                Mat error_mask_2d = sampling_mask(Range(yblock_counter*block_size - top_border, std::min(img_height, (yblock_counter*block_size + block_size + bottom_border))), Range(xblock_counter*block_size - left_border, std::min(img_width, xblock_counter*block_size + block_size + right_border)));
-                // get actual stddev value as it is needed to estimate the
-                // best number of iterations
-                double sigma_n_a = sigma_n_array.at<double>(yblock_counter, xblock_counter);
-
-                // actual extrapolation
-                Mat extrapolated_block_2d;
-                icvExtrapolateBlock(distorted_block_2d, error_mask_2d, fsr_params, rho, sigma_n_a, extrapolated_block_2d);
-
-                // update image and mask
-                extrapolated_block_2d(Range(top_border, extrapolated_block_2d.rows - bottom_border), Range(left_border, extrapolated_block_2d.cols - right_border)).copyTo(reconstructed_img(Range(yblock_counter*block_size, std::min(img_height, (yblock_counter + 1)*block_size)), Range(xblock_counter*block_size, std::min(img_width, (xblock_counter + 1)*block_size))));
+            for (size_t level = 0; level < levels.size(); ++level)
+            {
+                const std::vector<int>& level_blocks = levels[level];
+                parallel_for_(Range(0, (int)level_blocks.size()), [&](const Range& range)
+                {
+                    for (int i = range.start; i < range.end; ++i)
+                    {
+                        int yblock_counter = std::get<0>(block_list[level_blocks[i]]);
+                        int xblock_counter = std::get<1>(block_list[level_blocks[i]]);
+
+                        // calculation of the extrapolation area's borders
+                        int left_border = std::min(xblock_counter*block_size, border_width);
+                        int top_border = std::min(yblock_counter*block_size, border_width);
+                        int right_border = std::max(0, std::min(img_width - (xblock_counter + 1)*block_size, border_width));
+                        int bottom_border = std::max(0, std::min(img_height - (yblock_counter + 1)*block_size, border_width));
+
+                        // extract blocks from images
+                        Mat distorted_block_2d = reconstructed_img(Range(yblock_counter*block_size - top_border, std::min(img_height, (yblock_counter*block_size + block_size + bottom_border))), Range(xblock_counter*block_size - left_border, std::min(img_width, (xblock_counter*block_size + block_size + right_border))));
+                        Mat error_mask_2d = sampling_mask(Range(yblock_counter*block_size - top_border, std::min(img_height, (yblock_counter*block_size + block_size + bottom_border))), Range(xblock_counter*block_size - left_border, std::min(img_width, xblock_counter*block_size + block_size + right_border)));
+                        // get actual stddev value as it is needed to estimate the
+                        // best number of iterations
+                        double sigma_n_a = sigma_n_array.at<double>(yblock_counter, xblock_counter);
+
+                        // actual extrapolation
+                        Mat extrapolated_block_2d;
+                        const Mat& decay_window = decay_windows.find(std::make_pair(distorted_block_2d.rows, distorted_block_2d.cols))->second;
+                        icvExtrapolateBlock(distorted_block_2d, error_mask_2d, fsr_params, decay_window, frequency_weighting, sigma_n_a, extrapolated_block_2d);
+
+                        // update image and mask
+                        extrapolated_block_2d(Range(top_border, extrapolated_block_2d.rows - bottom_border), Range(left_border, extrapolated_block_2d.cols - right_border)).copyTo(reconstructed_img(Range(yblock_counter*block_size, std::min(img_height, (yblock_counter + 1)*block_size)), Range(xblock_counter*block_size, std::min(img_width, (xblock_counter + 1)*block_size))));
+
+                        Mat signs;
+                        icvSgnMat(error_mask_2d(Range(top_border, error_mask_2d.rows - bottom_border), Range(left_border, error_mask_2d.cols - right_border)), signs);
+                        Mat tmp_mask = error_mask_2d(Range(top_border, error_mask_2d.rows - bottom_border), Range(left_border, error_mask_2d.cols - right_border)) + (1 - signs) *conc_weighting;
+                        tmp_mask.copyTo(sampling_mask(Range(yblock_counter*block_size, std::min(img_height, (yblock_counter + 1)*block_size)), Range(xblock_counter*block_size, std::min(img_width, (xblock_counter + 1)*block_size))));
+                    }
+                });
+            }
 
-                Mat signs;
-                icvSgnMat(error_mask_2d(Range(top_border, error_mask_2d.rows - bottom_border), Range(left_border, error_mask_2d.cols - right_border)), signs);
-                Mat tmp_mask = error_mask_2d(Range(top_border, error_mask_2d.rows - bottom_border), Range(left_border, error_mask_2d.cols - right_border)) + (1 - signs) *conc_weighting;
-                tmp_mask.copyTo(sampling_mask(Range(yblock_counter*block_size, std::min(img_height, (yblock_counter + 1)*block_size)), Range(xblock_counter*block_size, std::min(img_width, (xblock_counter + 1)*block_size))));
+            for (bl_counter = 0; bl_counter < max_bl_counter; ++bl_counter)
+            {
+                int yblock_counter = std::get<0>(block_list[bl_counter]);
+                int xblock_counter = std::get<1>(block_list[bl_counter]);
+                level_map.at<int>(yblock_counter, xblock_counter) = -1;
 
                 // update nen-array
                 nen_array.at<double>(yblock_counter, xblock_counter) = -1;
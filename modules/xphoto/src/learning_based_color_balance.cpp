@@ -66,6 +66,15 @@ struct hist_elem
 bool operator<(const hist_elem &a, const hist_elem &b);
 bool operator<(const hist_elem &a, const hist_elem &b) { return a.hist_val > b.hist_val; }
 
+/* Internal node of a regression tree. Nodes of every tree are stored in the heap order,
+ * so that the children of the node i are 2 * i + 1 and 2 * i + 2
+ */
+struct tree_node
+{
+    float thresh_val;
+    int feature_idx;
+};
+
 class LearningBasedWBImpl : public LearningBasedWB
 {
   private:
@@ -75,16 +84,32 @@ class LearningBasedWBImpl : public LearningBasedWB
     uchar *feature_idx;
     float *thresh_vals, *leaf_vals;
     Mat feature_idx_Mat, thresh_vals_Mat, leaf_vals_Mat;
-    Mat mask;
-    int src_max_val;
-
-    void preprocessing(Mat &src);
-    void getAverageAndBrightestColorChromaticity(Vec2f &average_chromaticity, Vec2f &brightest_chromaticity, Mat &src);
-    void getColorPaletteMode(Vec2f &dst, hist_elem *palette);
-    void getHistogramBasedFeatures(Vec2f &dominant_chromaticity, Vec2f &chromaticity_palette_mode, Mat &src);
 
-    float regressionTreePredict(Vec2f src, uchar *tree_feature_idx, float *tree_thresh_vals, float *tree_leaf_vals);
-    Vec2f predictIlluminant(vector<Vec2f> features);
+    /* the ensemble repacked for the prediction: for every tree, feature and
+     * chromaticity component num_tree_nodes - 1 internal nodes and num_tree_nodes leaves
+     */
+    vector<tree_node> tree_nodes;
+    vector<float> tree_leaves;
+
+    void preprocessing(Mat &mask, int &src_max_val, const Mat &src) const;
+    void getAverageAndBrightestColorChromaticity(Vec2f &average_chromaticity, Vec2f &brightest_chromaticity,
+                                                 const Mat &src, const Mat &mask) const;
+    void getColorPaletteMode(Vec2f &dst, const vector<hist_elem> &palette) const;
+    void getHistogramBasedFeatures(Vec2f &dominant_chromaticity, Vec2f &chromaticity_palette_mode, const Mat &src,
+                                   const Mat &mask, int src_max_val) const;
+    void computeFeatures(Vec2f *dst, const Mat &src) const;
+
+    void flattenModel();
+    float regressionTreePredict(const Vec2f &src, const tree_node *tree, const float *leaves) const;
+    Vec2f combinePredictions(const float *predictions) const;
+    void predictIlluminants(vector<Vec2f> &dst, const vector<Vec2f> &features) const;
+
+    static void checkInput(const Mat &src)
+    {
+        CV_Assert(!src.empty());
+        CV_Assert(src.isContinuous());
+        CV_Assert(src.type() == CV_8UC3 || src.type() == CV_16UC3);
+    }
 
   public:
     LearningBasedWBImpl(String path_to_model)
@@ -124,6 +149,7 @@ class LearningBasedWBImpl : public LearningBasedWB
             thresh_vals = _thresh_vals;
             leaf_vals = _leaf_vals;
         }
+        flattenModel();
     }
 
     int getRangeMaxVal() const CV_OVERRIDE { return range_max_val; }
@@ -137,41 +163,90 @@ class LearningBasedWBImpl : public LearningBasedWB
 
     void extractSimpleFeatures(InputArray _src, OutputArray _dst) CV_OVERRIDE
     {
-        CV_Assert(!_src.empty());
-        CV_Assert(_src.isContinuous());
-        CV_Assert(_src.type() == CV_8UC3 || _src.type() == CV_16UC3);
         Mat src = _src.getMat();
+        checkInput(src);
         vector<Vec2f> dst(num_features);
 
-        preprocessing(src);
-        getAverageAndBrightestColorChromaticity(dst[0], dst[1], src);
-        getHistogramBasedFeatures(dst[2], dst[3], src);
+        computeFeatures(&dst[0], src);
         Mat(dst).convertTo(_dst, CV_32F);
     }
 
+    void estimateIlluminants(InputArrayOfArrays _src, OutputArray _dst) CV_OVERRIDE
+    {
+        vector<Mat> src;
+        _src.getMatVector(src);
+        for (size_t i = 0; i < src.size(); i++)
+            checkInput(src[i]);
+
+        vector<Vec2f> features(src.size() * num_features);
+        parallel_for_(Range(0, (int)src.size()), [&](const Range &range) {
+            for (int i = range.start; i < range.end; i++)
+                computeFeatures(&features[(size_t)i * num_features], src[i]);
+        });
+
+        vector<Vec2f> illuminants;
+        predictIlluminants(illuminants, features);
+        Mat(illuminants).copyTo(_dst);
+    }
+
     void balanceWhite(InputArray _src, OutputArray _dst) CV_OVERRIDE
     {
-        CV_Assert(!_src.empty());
-        CV_Assert(_src.isContinuous());
-        CV_Assert(_src.type() == CV_8UC3 || _src.type() == CV_16UC3);
         Mat src = _src.getMat();
+        checkInput(src);
+
+        vector<Vec2f> features(num_features), illuminants;
+        computeFeatures(&features[0], src);
+        predictIlluminants(illuminants, features);
+
+        applyIlluminantGains(src, _dst, illuminants[0]);
+    }
 
-        vector<Vec2f> features;
-        extractSimpleFeatures(src, features);
-        Vec2f illuminant = predictIlluminant(features);
+    void balanceWhiteBatch(InputArrayOfArrays _src, OutputArrayOfArrays _dst) CV_OVERRIDE
+    {
+        vector<Mat> src;
+        _src.getMatVector(src);
+
+        vector<Vec2f> illuminants;
+        estimateIlluminants(src, illuminants);
+
+        _dst.create((int)src.size(), 1, 0, -1, true);
+        for (size_t i = 0; i < src.size(); i++)
+            _dst.create(src[i].size(), src[i].type(), (int)i, true);
+
+        parallel_for_(Range(0, (int)src.size()), [&](const Range &range) {
+            for (int i = range.start; i < range.end; i++)
+            {
+                Mat dst = _dst.getMat(i);
+                applyIlluminantGains(src[i], dst, illuminants[i]);
+            }
+        });
+    }
 
+  private:
+    static void applyIlluminantGains(const Mat &src, OutputArray dst, const Vec2f &illuminant)
+    {
         float denom = 1 - illuminant[0] - illuminant[1];
         float gainB = 1.0f;
         float gainG = denom / illuminant[1];
         float gainR = denom / illuminant[0];
-        applyChannelGains(src, _dst, gainB, gainG, gainR);
+        applyChannelGains(src, dst, gainB, gainG, gainR);
     }
 };
 
+void LearningBasedWBImpl::computeFeatures(Vec2f *dst, const Mat &src) const
+{
+    Mat mask;
+    int src_max_val;
+
+    preprocessing(mask, src_max_val, src);
+    getAverageAndBrightestColorChromaticity(dst[0], dst[1], src, mask);
+    getHistogramBasedFeatures(dst[2], dst[3], src, mask, src_max_val);
+}
+
 /* Computes a mask for non-saturated pixels and maximum pixel value
  * which are then used for feature computation
  */
-void LearningBasedWBImpl::preprocessing(Mat &src)
+void LearningBasedWBImpl::preprocessing(Mat &mask, int &src_max_val, const Mat &src) const
 {
     mask.create(src.size(), CV_8U);
     uchar *mask_ptr = mask.ptr<uchar>();
@@ -183,7 +258,7 @@ void LearningBasedWBImpl::preprocessing(Mat &src)
 
     if (src.type() == CV_8UC3)
     {
-        uchar *src_ptr = src.ptr<uchar>();
+        const uchar *src_ptr = src.ptr<uchar>();
 #if CV_SIMD128
         v_uint8x16 v_inB, v_inG, v_inR, v_local_max;
         v_uint8x16 v_global_max = v_setall_u8(0), v_mask, v_thresh = v_setall_u8((uchar)thresh);
@@ -216,7 +291,7 @@ void LearningBasedWBImpl::preprocessing(Mat &src)
     }
     else if (src.type() == CV_16UC3)
     {
-        ushort *src_ptr = src.ptr<ushort>();
+        const ushort *src_ptr = src.ptr<ushort>();
 #if CV_SIMD128
         v_uint16x8 v_inB, v_inG, v_inR, v_local_max;
         v_uint16x8 v_global_max = v_setall_u16(0), v_mask, v_thresh = v_setall_u16((ushort)thresh);
@@ -250,17 +325,18 @@ void LearningBasedWBImpl::preprocessing(Mat &src)
 }
 
 void LearningBasedWBImpl::getAverageAndBrightestColorChromaticity(Vec2f &average_chromaticity,
-                                                                  Vec2f &brightest_chromaticity, Mat &src)
+                                                                  Vec2f &brightest_chromaticity, const Mat &src,
+                                                                  const Mat &mask) const
 {
     int i = 0;
     int src_len = src.rows * src.cols;
-    uchar *mask_ptr = mask.ptr<uchar>();
+    const uchar *mask_ptr = mask.ptr<uchar>();
     uint brightestB = 0, brightestG = 0, brightestR = 0;
     uint max_sum = 0;
     if (src.type() == CV_8UC3)
     {
         uint sumB = 0, sumG = 0, sumR = 0;
-        uchar *src_ptr = src.ptr<uchar>();
+        const uchar *src_ptr = src.ptr<uchar>();
 #if CV_SIMD128
         v_uint16x8 v_max_sum = v_setall_u16(0), v_brightestR = v_setall_u16(0), v_brightestG = v_setall_u16(0), v_brightestB = v_setall_u16(0);
         v_uint32x4 v_SB = v_setzero_u32(), v_SG = v_setzero_u32(), v_SR = v_setzero_u32();
@@ -351,7 +427,7 @@ void LearningBasedWBImpl::getAverageAndBrightestColorChromaticity(Vec2f &average
     else if (src.type() == CV_16UC3)
     {
         uint64 sumB = 0, sumG = 0, sumR = 0;
-        ushort *src_ptr = src.ptr<ushort>();
+        const ushort *src_ptr = src.ptr<ushort>();
 #if CV_SIMD128
         const v_uint16x8 v_mask_lower = v_setall_u16(255);
         v_uint32x4 v_max_sum = v_setall_u32(0), v_brightestR = v_setall_u32(0), v_brightestG = v_setall_u32(0), v_brightestB = v_setall_u32(0);
@@ -450,33 +526,61 @@ void LearningBasedWBImpl::getAverageAndBrightestColorChromaticity(Vec2f &average
  * Uses a simplistic kernel density estimator with a Epanechnikov kernel and
  * fixed bandwidth.
  */
-void LearningBasedWBImpl::getColorPaletteMode(Vec2f &dst, hist_elem *palette)
+void LearningBasedWBImpl::getColorPaletteMode(Vec2f &dst, const vector<hist_elem> &palette) const
 {
+    const int n = (int)palette.size();
+    dst = Vec2f(0.0f, 0.0f);
+    if (n == 0)
+        return;
+
+    vector<float> palette_r(n), palette_g(n);
+    for (int i = 0; i < n; i++)
+    {
+        palette_r[i] = palette[i].r;
+        palette_g[i] = palette[i].g;
+    }
+
     float max_density = -1.0f;
     float denom = palette_bandwidth * palette_bandwidth;
-    for (int i = 0; i < palette_size; i++)
+#if CV_SIMD
+    const int vlanes = VTraits<v_float32>::vlanes();
+    const v_float32 v_denom = vx_setall_f32(denom), v_one = vx_setall_f32(1.0f), v_zero = vx_setzero_f32();
+#endif
+    for (int i = 0; i < n; i++)
     {
+        const float r = palette_r[i], g = palette_g[i];
         float cur_density = 0.0f;
-        float cur_dist_sq;
+        int j = 0;
 
-        for (int j = 0; j < palette_size; j++)
+#if CV_SIMD
+        const v_float32 v_r = vx_setall_f32(r), v_g = vx_setall_f32(g);
+        v_float32 v_density = vx_setzero_f32();
+        for (; j <= n - vlanes; j += vlanes)
         {
-            cur_dist_sq = (palette[i].r - palette[j].r) * (palette[i].r - palette[j].r) +
-                          (palette[i].g - palette[j].g) * (palette[i].g - palette[j].g);
+            v_float32 v_dr = v_sub(v_r, vx_load(palette_r.data() + j));
+            v_float32 v_dg = v_sub(v_g, vx_load(palette_g.data() + j));
+            v_float32 v_dist_sq = v_add(v_mul(v_dr, v_dr), v_mul(v_dg, v_dg));
+            v_density = v_add(v_density, v_max(v_sub(v_one, v_div(v_dist_sq, v_denom)), v_zero));
+        }
+        cur_density = v_reduce_sum(v_density);
+#endif
+        for (; j < n; j++)
+        {
+            float cur_dist_sq = (r - palette_r[j]) * (r - palette_r[j]) + (g - palette_g[j]) * (g - palette_g[j]);
             cur_density += max((1.0f - (cur_dist_sq / denom)), 0.0f);
         }
 
         if (cur_density > max_density)
         {
             max_density = cur_density;
-            dst[0] = palette[i].r;
-            dst[1] = palette[i].g;
+            dst[0] = r;
+            dst[1] = g;
         }
     }
 }
 
 void LearningBasedWBImpl::getHistogramBasedFeatures(Vec2f &dominant_chromaticity, Vec2f &chromaticity_palette_mode,
-                                                    Mat &src)
+                                                    const Mat &src, const Mat &mask, int src_max_val) const
 {
     MatND hist;
     int channels[] = {0, 1, 2};
@@ -485,38 +589,45 @@ void LearningBasedWBImpl::getHistogramBasedFeatures(Vec2f &dominant_chromaticity
     const float *ranges[] = {range, range, range};
     calcHist(&src, 1, channels, mask, hist, 3, histSize, ranges);
 
-    int dominant_B = 0, dominant_G = 0, dominant_R = 0;
-    double max_hist_val = 0;
-    float *hist_ptr = hist.ptr<float>();
-    for (int i = 0; i < hist_bin_num; i++)
-        for (int j = 0; j < hist_bin_num; j++)
-            for (int k = 0; k < hist_bin_num; k++)
-            {
-                if (*hist_ptr > max_hist_val)
-                {
-                    max_hist_val = *hist_ptr;
-                    dominant_B = i;
-                    dominant_G = j;
-                    dominant_R = k;
-                }
-                hist_ptr++;
-            }
-    getChromaticity(dominant_chromaticity, (float)dominant_R, (float)dominant_G, (float)dominant_B);
+    // Find the dominant color and extract top palette_size most common colors in a single pass
+    // over the histogram. Histogram is sparse, so the empty bins are skipped in blocks.
+    const float *hist_ptr = hist.ptr<float>();
+    const int hist_len = hist_bin_num * hist_bin_num * hist_bin_num;
+    const int plane_len = hist_bin_num * hist_bin_num;
+    int dominant_idx = 0;
+    float max_hist_val = 0;
 
     vector<hist_elem> palette;
     palette.reserve(palette_size);
-    hist_ptr = hist.ptr<float>();
-    // extract top palette_size most common colors and add them to the palette:
-    for (int i = 0; i < hist_bin_num; i++)
-        for (int j = 0; j < hist_bin_num; j++)
-            for (int k = 0; k < hist_bin_num; k++)
+
+#if CV_SIMD
+    const int block_len = VTraits<v_float32>::vlanes();
+    const v_float32 v_eps = vx_setall_f32(EPS);
+#else
+    const int block_len = 1;
+#endif
+    for (int block_start = 0; block_start < hist_len; block_start += block_len)
+    {
+        const int block_end = min(block_start + block_len, hist_len);
+#if CV_SIMD
+        if (block_end - block_start == block_len && !v_check_any(v_ge(vx_load(hist_ptr + block_start), v_eps)))
+            continue;
+#endif
+        for (int idx = block_start; idx < block_end; idx++)
+        {
+            float bin_count = hist_ptr[idx];
+            if (bin_count < EPS)
+                continue;
+
+            if (bin_count > max_hist_val)
             {
-                float bin_count = *hist_ptr;
-                if (bin_count < EPS)
-                {
-                    hist_ptr++;
-                    continue;
-                }
+                max_hist_val = bin_count;
+                dominant_idx = idx;
+            }
+
+            if (palette.size() < (uint)palette_size || bin_count > palette.front().hist_val)
+            {
+                int i = idx / plane_len, j = (idx / hist_bin_num) % hist_bin_num, k = idx % hist_bin_num;
                 Vec2f chromaticity;
                 getChromaticity(chromaticity, (float)k, (float)j, (float)i);
                 hist_elem el(bin_count, chromaticity);
@@ -527,53 +638,71 @@ void LearningBasedWBImpl::getHistogramBasedFeatures(Vec2f &dominant_chromaticity
                     if (palette.size() == (uint)palette_size)
                         make_heap(palette.begin(), palette.end());
                 }
-                else if (bin_count > palette.front().hist_val)
+                else
                 {
                     pop_heap(palette.begin(), palette.end());
                     palette.back() = el;
                     push_heap(palette.begin(), palette.end());
                 }
-                hist_ptr++;
             }
-    getColorPaletteMode(chromaticity_palette_mode, (hist_elem *)(&palette[0]));
+        }
+    }
+
+    int dominant_B = dominant_idx / plane_len;
+    int dominant_G = (dominant_idx / hist_bin_num) % hist_bin_num;
+    int dominant_R = dominant_idx % hist_bin_num;
+    getChromaticity(dominant_chromaticity, (float)dominant_R, (float)dominant_G, (float)dominant_B);
+
+    getColorPaletteMode(chromaticity_palette_mode, palette);
 }
 
-float LearningBasedWBImpl::regressionTreePredict(Vec2f src, uchar *tree_feature_idx, float *tree_thresh_vals,
-                                                 float *tree_leaf_vals)
+/* Repacks the model into an array of nodes with the threshold and the feature index side by side.
+ * The trees follow each other in the order of the model: for every tree of the ensemble, for
+ * every feature, the tree predicting r and then the tree predicting g.
+ */
+void LearningBasedWBImpl::flattenModel()
+{
+    CV_Assert(num_trees > 0 && num_tree_nodes > 1);
+    tree_depth = cvRound( (log(static_cast<float>(num_tree_nodes)) / log(2.0f)) );
+
+    const int num_models = num_trees * num_features * 2;
+    const int num_internal_nodes = num_tree_nodes - 1;
+    tree_nodes.resize((size_t)num_models * num_internal_nodes);
+    for (size_t i = 0; i < tree_nodes.size(); i++)
+    {
+        tree_nodes[i].thresh_val = thresh_vals[i];
+        tree_nodes[i].feature_idx = feature_idx[i];
+    }
+    tree_leaves.assign(leaf_vals, leaf_vals + (size_t)num_models * num_tree_nodes);
+}
+
+float LearningBasedWBImpl::regressionTreePredict(const Vec2f &src, const tree_node *tree, const float *leaves) const
 {
     int node_idx = 0;
     for (int i = 0; i < tree_depth; i++)
     {
-        if (src[tree_feature_idx[node_idx]] <= tree_thresh_vals[node_idx])
-            node_idx = 2 * node_idx + 1;
-        else
-            node_idx = 2 * node_idx + 2;
+        const tree_node &node = tree[node_idx];
+        node_idx = 2 * node_idx + 2 - (int)(src[node.feature_idx] <= node.thresh_val);
     }
-    return tree_leaf_vals[node_idx - num_tree_nodes + 1];
+    return leaves[node_idx - num_tree_nodes + 1];
 }
 
-Vec2f LearningBasedWBImpl::predictIlluminant(vector<Vec2f> features)
+/* Combines the (r,g) predictions of all the trees for one image:
+ * predictions[2 * (num_features * i + j) + c] is the prediction of the tree i for the feature j
+ */
+Vec2f LearningBasedWBImpl::combinePredictions(const float *predictions) const
 {
-    int feature_model_size = 2 * (num_tree_nodes - 1);
-    int local_model_size = num_features * feature_model_size;
-    int feature_model_size_leaf = 2 * num_tree_nodes;
-    int local_model_size_leaf = num_features * feature_model_size_leaf;
-    tree_depth = cvRound( (log(static_cast<float>(num_tree_nodes)) / log(2.0f)) );
-
     vector<float> consensus_r, consensus_g;
     vector<float> all_r, all_g;
+    all_r.reserve(num_trees * num_features);
+    all_g.reserve(num_trees * num_features);
     for (int i = 0; i < num_trees; i++)
     {
         Vec2f local_predictions[num_features];
         for (int j = 0; j < num_features; j++)
         {
-            float r = regressionTreePredict(features[j], feature_idx + local_model_size * i + feature_model_size * j,
-                                            thresh_vals + local_model_size * i + feature_model_size * j,
-                                            leaf_vals + local_model_size_leaf * i + feature_model_size_leaf * j);
-            float g = regressionTreePredict(
-              features[j], feature_idx + local_model_size * i + feature_model_size * j + feature_model_size / 2,
-              thresh_vals + local_model_size * i + feature_model_size * j + feature_model_size / 2,
-              leaf_vals + local_model_size_leaf * i + feature_model_size_leaf * j + feature_model_size_leaf / 2);
+            float r = predictions[2 * (num_features * i + j)];
+            float g = predictions[2 * (num_features * i + j) + 1];
             local_predictions[j] = Vec2f(r, g);
             all_r.push_back(r);
             all_g.push_back(g);
@@ -613,6 +742,32 @@ Vec2f LearningBasedWBImpl::predictIlluminant(vector<Vec2f> features)
     return Vec2f(illuminant_r, illuminant_g);
 }
 
+/* Predicts illuminants of a batch of images, features holds num_features features per image.
+ * The ensemble is evaluated tree by tree for all the images of a stripe, so that every tree
+ * is loaded once per stripe.
+ */
+void LearningBasedWBImpl::predictIlluminants(vector<Vec2f> &dst, const vector<Vec2f> &features) const
+{
+    const int num_images = (int)(features.size() / num_features);
+    const int num_models = num_trees * num_features * 2;
+    dst.resize(num_images);
+
+    parallel_for_(Range(0, num_images), [&](const Range &range) {
+        vector<float> predictions((size_t)range.size() * num_models);
+        for (int t = 0; t < num_models; t++)
+        {
+            const tree_node *tree = &tree_nodes[(size_t)t * (num_tree_nodes - 1)];
+            const float *leaves = &tree_leaves[(size_t)t * num_tree_nodes];
+            const int feature = (t / 2) % num_features;
+            for (int n = range.start; n < range.end; n++)
+                predictions[(size_t)(n - range.start) * num_models + t] =
+                    regressionTreePredict(features[(size_t)n * num_features + feature], tree, leaves);
+        }
+        for (int n = range.start; n < range.end; n++)
+            dst[n] = combinePredictions(&predictions[(size_t)(n - range.start) * num_models]);
+    });
+}
+
 Ptr<LearningBasedWB> createLearningBasedWB(const String& path_to_model)
 {
     Ptr<LearningBasedWB> inst = makePtr<LearningBasedWBImpl>(path_to_model);
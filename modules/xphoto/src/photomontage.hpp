@@ -83,11 +83,13 @@ private:
 
     const std::vector <std::vector <int> > &linkIdx;   // vector of neighbors for pointSeq
 
-    std::vector <std::vector <labelTp> > labelings;    // vector of labelings
+    std::vector <std::vector <labelTp> > labelings;    // labeling produced by each alpha-expansion
     std::vector <TWeight>  distances;                  // vector of max-flow costs for different labeling
 
     std::vector <labelTp> &labelSeq;                   // current best labeling
 
+    cv::TLSData <GCGraph <TWeight> > graphs;           // per-thread graphs, reused by all the expansions
+
     TWeight singleExpansion(const int alpha);          // single neighbor computing
 
     class ParallelExpansion : public cv::ParallelLoopBody
@@ -169,7 +171,8 @@ setWeights(GCGraph <TWeight> &graph, const int idx1, const int idx2,
 template <typename Tp> TWeight Photomontage <Tp>::
 singleExpansion(const int alpha)
 {
-    GCGraph <TWeight> graph( 3*int(pointSeq.size()), 4*int(pointSeq.size()) );
+    GCGraph <TWeight> &graph = *graphs.get();
+    graph.create( 3*int(pointSeq.size()), 8*int(pointSeq.size()) );
 
     /** Terminal links **/
     for (size_t i = 0; i < maskSeq.size(); ++i)
@@ -187,8 +190,9 @@ singleExpansion(const int alpha)
     TWeight result = graph.maxFlow();
 
     /** Writing results **/
+    std::vector <labelTp> &labeling = labelings[alpha];
     for (size_t i = 0; i < pointSeq.size(); ++i)
-        labelings[i][alpha] = graph.inSourceSegment(int(i)) ? labelSeq[i] : alpha;
+        labeling[i] = graph.inSourceSegment(int(i)) ? labelSeq[i] : alpha;
 
     return result;
 }
@@ -212,8 +216,7 @@ gradientDescent()
         if (num == -1)
             break;
 
-        for (size_t i = 0; i < labelSeq.size(); ++i)
-            labelSeq[i] = labelings[i][num];
+        labelSeq = labelings[num];
     }
 }
 
@@ -227,8 +230,8 @@ Photomontage( const std::vector <std::vector <Tp> > &_pointSeq,
     distances(pointSeq[0].size()), labelSeq(_labelSeq), parallelExpansion(this)
 {
     size_t lsize = pointSeq[0].size();
-    labelings.assign( pointSeq.size(),
-      std::vector <labelTp>( lsize ) );
+    labelings.assign( lsize,
+      std::vector <labelTp>( pointSeq.size() ) );
 }
 
 }
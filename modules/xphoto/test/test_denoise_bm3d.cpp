@@ -157,6 +157,66 @@ namespace opencv_test { namespace {
         ASSERT_LT(cvtest::norm(result, expected, cv::NORM_L2), 200);
     }
 
+    TEST(xphoto_DenoisingBm3dDenoiser, regression_same_as_function)
+    {
+        std::string folder = std::string(cvtest::TS::ptr()->get_data_path()) + "cv/xphoto/bm3d_image_denoising/";
+        std::string original_path = folder + "lena_noised_gaussian_sigma=10.png";
+
+        cv::Mat original = cv::imread(original_path, cv::IMREAD_GRAYSCALE);
+        ASSERT_FALSE(original.empty()) << "Could not load input image " << original_path;
+
+        cv::Mat expected;
+        cv::xphoto::bm3dDenoising(original, expected, 10, 4, 16, 2500, 400, 8, 1, 0.0f, cv::NORM_L2, cv::xphoto::BM3D_STEPALL);
+
+        cv::Ptr<cv::xphoto::Bm3dDenoiser> denoiser =
+            cv::xphoto::createBm3dDenoiser(10, 4, 16, 2500, 400, 8, 1, 0.0f, cv::NORM_L2, cv::xphoto::BM3D_STEPALL);
+
+        // Buffers are reused by the second call
+        for (int i = 0; i < 2; ++i)
+        {
+            cv::Mat result;
+            denoiser->denoise(original, result);
+            ASSERT_EQ(cvtest::norm(result, expected, cv::NORM_INF), 0);
+        }
+    }
+
+    TEST(xphoto_DenoisingBm3dDenoiser, temporal)
+    {
+        cv::Mat clean = cv::imread(cvtest::findDataFile("cv/shared/lena.png"), cv::IMREAD_GRAYSCALE);
+        ASSERT_FALSE(clean.empty());
+        cv::resize(clean, clean, cv::Size(256, 256), 0, 0, cv::INTER_AREA);
+
+        cv::RNG rng(0);
+        const int numFrames = 3;
+        std::vector<cv::Mat> noisy(numFrames);
+        for (int i = 0; i < numFrames; ++i)
+        {
+            cv::Mat noise(clean.size(), CV_16S);
+            rng.fill(noise, cv::RNG::NORMAL, 0, 15);
+            cv::add(clean, noise, noisy[i], cv::noArray(), CV_8U);
+        }
+
+        cv::Ptr<cv::xphoto::Bm3dDenoiser> spatial = cv::xphoto::createBm3dDenoiser(15);
+        cv::Ptr<cv::xphoto::Bm3dDenoiser> temporal = cv::xphoto::createBm3dDenoiser(15);
+        temporal->setTemporalWindowSize(numFrames - 1);
+
+        cv::Mat resultSpatial, resultTemporal;
+        for (int i = 0; i < numFrames; ++i)
+        {
+            spatial->denoise(noisy[i], resultSpatial);
+            temporal->denoise(noisy[i], resultTemporal);
+        }
+
+        // The first frame has no neighbours and is denoised as a single image
+        temporal->reset();
+        cv::Mat resultFirst;
+        temporal->denoise(noisy[numFrames - 1], resultFirst);
+        ASSERT_EQ(cvtest::norm(resultFirst, resultSpatial, cv::NORM_INF), 0);
+
+        // Blocks of the previous frames make the estimate of the static scene better
+        EXPECT_GT(cv::PSNR(resultTemporal, clean), cv::PSNR(resultSpatial, clean));
+    }
+
 #ifdef TEST_TRANSFORMS
 
     TEST(xphoto_DenoisingBm3dKaiserWindow, regression_4)
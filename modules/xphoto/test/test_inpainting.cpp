@@ -71,5 +71,67 @@ TEST(xphoto_inpaint, regression_FSR_BEST)
     test_inpainting(Size(512, 512), INPAINT_FSR_BEST, 39.6);
 }
 
+static Mat periodicImage(Size size, int period)
+{
+    RNG rng(12345);
+    Mat tile(period, period, CV_8UC3);
+    rng.fill(tile, RNG::UNIFORM, 0, 256);
+    GaussianBlur(tile, tile, Size(3, 3), 0);
+
+    Mat img;
+    repeat(tile, (size.height + period - 1)/period, (size.width + period - 1)/period, img);
+    return img(Rect(Point(0, 0), size)).clone();
+}
+
+TEST(xphoto_inpaint, SHIFTMAP_periodic)
+{
+    // The hole of a periodic image is filled by shifts of a multiple of the period, which
+    // reconstruct it exactly: the original image is the reference
+    Mat original = periodicImage(Size(128, 128), 32);
+    Mat mask(original.size(), CV_8UC1, Scalar::all(255));
+    mask(Rect(58, 58, 12, 12)).setTo(0);
+
+    Mat distorted(original.size(), original.type(), Scalar::all(0));
+    original.copyTo(distorted, mask);
+
+    const int nthreads = getNumThreads();
+    setNumThreads(1);
+    Mat sequential;
+    xphoto::inpaint(distorted, mask, sequential, INPAINT_SHIFTMAP);
+    setNumThreads(std::max(nthreads, 4));
+    Mat parallel;
+    xphoto::inpaint(distorted, mask, parallel, INPAINT_SHIFTMAP);
+    setNumThreads(nthreads);
+
+    EXPECT_EQ(0, cvtest::norm(original, sequential, NORM_INF));
+    // the wavefront ANNF search and the per-thread graphs do not depend on the number of threads
+    EXPECT_EQ(0, cvtest::norm(sequential, parallel, NORM_INF));
+}
+
+TEST(xphoto_inpaint, SHIFTMAP_same_for_any_thread_count)
+{
+    Mat original = imread(cvtest::findDataFile("cv/shared/lena.png"), IMREAD_COLOR);
+    ASSERT_FALSE(original.empty());
+    Mat mask = imread(cvtest::findDataFile("cv/inpaint/mask.png"), IMREAD_GRAYSCALE);
+    ASSERT_FALSE(mask.empty());
+
+    resize(original, original, Size(128, 128), 0.0, 0.0, INTER_AREA);
+    resize(mask, mask, Size(128, 128), 0.0, 0.0, INTER_NEAREST);
+
+    Mat mask_valid = (mask == 0);
+    Mat distorted(original.size(), original.type(), Scalar::all(0));
+    original.copyTo(distorted, mask_valid);
+
+    const int nthreads = getNumThreads();
+    setNumThreads(1);
+    Mat sequential;
+    xphoto::inpaint(distorted, mask_valid, sequential, INPAINT_SHIFTMAP);
+    setNumThreads(std::max(nthreads, 4));
+    Mat parallel;
+    xphoto::inpaint(distorted, mask_valid, parallel, INPAINT_SHIFTMAP);
+    setNumThreads(nthreads);
+
+    EXPECT_EQ(0, cvtest::norm(sequential, parallel, NORM_INF));
+}
 
 }} // namespace
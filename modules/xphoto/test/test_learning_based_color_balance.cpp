@@ -43,5 +43,34 @@ TEST(xphoto_simplefeatures, regression)
     ASSERT_LE(cv::norm(dst_features[3], ref1, NORM_INF), acc_thresh);
 }
 
+TEST(xphoto_learningbasedwb, batch_matches_single)
+{
+    RNG rng(1234);
+    vector<Mat> images;
+    for (int i = 0; i < 5; i++)
+    {
+        Mat im(200 + 10 * i, 300, CV_8UC3);
+        Scalar mean(rng.uniform(40, 120), rng.uniform(40, 120), rng.uniform(40, 120));
+        rng.fill(im, RNG::NORMAL, mean, Scalar(15, 15, 15));
+        images.push_back(im);
+    }
+
+    Ptr<xphoto::LearningBasedWB> wb = xphoto::createLearningBasedWB();
+
+    vector<Mat> batch_results;
+    vector<Vec2f> illuminants;
+    wb->balanceWhiteBatch(images, batch_results);
+    wb->estimateIlluminants(images, illuminants);
+    ASSERT_EQ(images.size(), batch_results.size());
+    ASSERT_EQ(images.size(), illuminants.size());
+
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        Mat result;
+        wb->balanceWhite(images[i], result);
+        ASSERT_EQ(cvtest::norm(result, batch_results[i], NORM_INF), 0) << "image " << i;
+    }
+}
+
 
 }} // namespace